@@ -0,0 +1,150 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="benchmark_runner.cpp" company="Microsoft">
+//    Copyright 2013 Microsoft Corporation
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "benchmark_runner.h"
+#include "mock_storage_server.h"
+
+#include <iomanip>
+#include <iostream>
+
+namespace
+{
+    int g_base_port = 18000;
+    std::unique_ptr<mock_storage_server> g_server;
+    std::mutex g_server_mutex;
+
+    struct benchmark_result
+    {
+        size_t m_iterations;
+        double m_seconds;
+        utility::size64_t m_bytes;
+    };
+
+    benchmark_result measure(benchmark_case& benchmark, const benchmark_options& options)
+    {
+        benchmark.run();
+
+        benchmark_result result;
+        result.m_iterations = 0;
+        result.m_bytes = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        auto elapsed = std::chrono::steady_clock::duration::zero();
+        while (result.m_iterations < options.m_min_iterations || elapsed < options.m_min_duration)
+        {
+            result.m_bytes += benchmark.run();
+            ++result.m_iterations;
+            elapsed = std::chrono::steady_clock::now() - start;
+        }
+
+        result.m_seconds = std::chrono::duration<double>(elapsed).count();
+        return result;
+    }
+}
+
+void benchmark_registry::add(const std::string& name, factory create)
+{
+    entries().push_back(std::make_pair(name, std::move(create)));
+}
+
+int benchmark_registry::run(const benchmark_options& options)
+{
+    int failures = 0;
+
+    if (options.m_csv)
+    {
+        std::cout << "name,iterations,seconds,ops_per_second,mb_per_second" << std::endl;
+    }
+    else
+    {
+        std::cout << std::left << std::setw(48) << "benchmark" << std::right << std::setw(12) << "iterations" << std::setw(14) << "ops/s" << std::setw(12) << "MB/s" << std::endl;
+    }
+
+    auto sorted = entries();
+    std::sort(sorted.begin(), sorted.end(), [](const std::pair<std::string, factory>& left, const std::pair<std::string, factory>& right) { return left.first < right.first; });
+
+    for (const auto& entry : sorted)
+    {
+        if (!options.m_filter.empty() && entry.first.find(options.m_filter) == std::string::npos)
+        {
+            continue;
+        }
+
+        try
+        {
+            auto benchmark = entry.second();
+            benchmark->set_up();
+            benchmark_result result = measure(*benchmark, options);
+            benchmark->tear_down();
+
+            const double ops_per_second = result.m_iterations / result.m_seconds;
+            const double mb_per_second = result.m_bytes / result.m_seconds / (1024.0 * 1024.0);
+            if (options.m_csv)
+            {
+                std::cout << entry.first << ',' << result.m_iterations << ',' << result.m_seconds << ',' << ops_per_second << ',' << mb_per_second << std::endl;
+            }
+            else
+            {
+                std::cout << std::left << std::setw(48) << entry.first << std::right << std::setw(12) << result.m_iterations
+                    << std::fixed << std::setprecision(1) << std::setw(14) << ops_per_second << std::setw(12) << mb_per_second << std::endl;
+            }
+        }
+        catch (const std::exception& e)
+        {
+            ++failures;
+            std::cerr << entry.first << " failed: " << e.what() << std::endl;
+        }
+    }
+
+    return failures;
+}
+
+std::vector<std::pair<std::string, benchmark_registry::factory>>& benchmark_registry::entries()
+{
+    static std::vector<std::pair<std::string, factory>> registered;
+    return registered;
+}
+
+void benchmark_environment::set_base_port(int base_port)
+{
+    g_base_port = base_port;
+}
+
+mock_storage_server& benchmark_environment::server()
+{
+    std::lock_guard<std::mutex> guard(g_server_mutex);
+    if (!g_server)
+    {
+        std::unique_ptr<mock_storage_server> server(new mock_storage_server(g_base_port));
+        server->start();
+        g_server = std::move(server);
+    }
+
+    return *g_server;
+}
+
+azure::storage::cloud_storage_account benchmark_environment::account()
+{
+    return server().account();
+}
+
+void benchmark_environment::shut_down()
+{
+    std::lock_guard<std::mutex> guard(g_server_mutex);
+    g_server.reset();
+}
@@ -0,0 +1,97 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="benchmark_runner.h" company="Microsoft">
+//    Copyright 2013 Microsoft Corporation
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "stdafx.h"
+
+// A single measured operation. The runner calls run until both the minimum duration and the minimum number of
+// iterations have been reached, after one untimed warm-up call.
+class benchmark_case
+{
+public:
+
+    virtual ~benchmark_case()
+    {
+    }
+
+    virtual void set_up()
+    {
+    }
+
+    // Performs the operation once and returns the number of payload bytes it moved or processed.
+    virtual utility::size64_t run() = 0;
+
+    virtual void tear_down()
+    {
+    }
+};
+
+struct benchmark_options
+{
+    benchmark_options()
+        : m_min_duration(std::chrono::milliseconds(2000)), m_min_iterations(5), m_csv(false)
+    {
+    }
+
+    std::string m_filter;
+    std::chrono::milliseconds m_min_duration;
+    size_t m_min_iterations;
+    bool m_csv;
+};
+
+class benchmark_registry
+{
+public:
+
+    typedef std::function<std::unique_ptr<benchmark_case>()> factory;
+
+    static void add(const std::string& name, factory create);
+
+    // Runs every benchmark whose name contains the filter and returns the number of benchmarks that failed.
+    static int run(const benchmark_options& options);
+
+private:
+
+    static std::vector<std::pair<std::string, factory>>& entries();
+};
+
+template<typename T>
+class benchmark_registration
+{
+public:
+
+    explicit benchmark_registration(const std::string& name)
+    {
+        benchmark_registry::add(name, []() { return std::unique_ptr<benchmark_case>(new T()); });
+    }
+};
+
+#define REGISTER_BENCHMARK(type, name) static benchmark_registration<type> type##_registration(name)
+
+class mock_storage_server;
+
+// The mock server shared by all benchmarks that go through the service clients. It is started on first use.
+class benchmark_environment
+{
+public:
+
+    static void set_base_port(int base_port);
+    static mock_storage_server& server();
+    static azure::storage::cloud_storage_account account();
+    static void shut_down();
+};
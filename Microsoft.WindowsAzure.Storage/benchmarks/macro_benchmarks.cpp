@@ -0,0 +1,301 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="macro_benchmarks.cpp" company="Microsoft">
+//    Copyright 2013 Microsoft Corporation
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "benchmark_runner.h"
+#include "mock_storage_server.h"
+
+#include "was/blob.h"
+#include "was/file.h"
+#include "was/queue.h"
+#include "was/table.h"
+
+// End-to-end benchmarks that go through the public client API against the mock server. They include request
+// construction, signing, the HTTP stack and response parsing, but no network or service latency.
+
+namespace
+{
+    std::vector<uint8_t> random_payload(size_t size)
+    {
+        std::vector<uint8_t> payload(size);
+        uint32_t state = 0x12345678;
+        for (auto& value : payload)
+        {
+            state = state * 1664525 + 1013904223;
+            value = (uint8_t)(state >> 24);
+        }
+
+        return payload;
+    }
+
+    azure::storage::cloud_blob_container blob_container(const utility::string_t& name)
+    {
+        auto container = benchmark_environment::account().create_cloud_blob_client().get_container_reference(name);
+        container.create_if_not_exists();
+        return container;
+    }
+
+    template<size_t Megabytes, size_t BlockMegabytes, int Parallelism>
+    class block_blob_upload_benchmark : public benchmark_case
+    {
+    public:
+
+        void set_up() override
+        {
+            m_blob = blob_container(_XPLATSTR("upload")).get_block_blob_reference(_XPLATSTR("blob"));
+            m_payload = random_payload(Megabytes * 1024 * 1024);
+
+            // Payloads above the block size are uploaded as blocks followed by a block list.
+            m_options.set_single_blob_upload_threshold_in_bytes(BlockMegabytes * 1024 * 1024);
+            m_options.set_stream_write_size_in_bytes(BlockMegabytes * 1024 * 1024);
+            m_options.set_parallelism_factor(Parallelism);
+        }
+
+        utility::size64_t run() override
+        {
+            auto stream = concurrency::streams::rawptr_stream<uint8_t>::open_istream(m_payload.data(), m_payload.size());
+            m_blob.upload_from_stream(stream, azure::storage::access_condition(), m_options, azure::storage::operation_context());
+            return m_payload.size();
+        }
+
+    private:
+
+        azure::storage::cloud_block_blob m_blob;
+        azure::storage::blob_request_options m_options;
+        std::vector<uint8_t> m_payload;
+    };
+
+    template<size_t Megabytes, int Parallelism>
+    class block_blob_download_benchmark : public benchmark_case
+    {
+    public:
+
+        void set_up() override
+        {
+            m_blob = blob_container(_XPLATSTR("download")).get_block_blob_reference(_XPLATSTR("blob"));
+            auto payload = random_payload(Megabytes * 1024 * 1024);
+            m_blob.upload_from_stream(concurrency::streams::bytestream::open_istream(std::move(payload)));
+
+            m_options.set_parallelism_factor(Parallelism);
+        }
+
+        utility::size64_t run() override
+        {
+            concurrency::streams::container_buffer<std::vector<uint8_t>> buffer;
+            m_blob.download_to_stream(buffer.create_ostream(), azure::storage::access_condition(), m_options, azure::storage::operation_context());
+            return buffer.collection().size();
+        }
+
+    private:
+
+        azure::storage::cloud_block_blob m_blob;
+        azure::storage::blob_request_options m_options;
+    };
+
+    class list_blobs_segmented_benchmark : public benchmark_case
+    {
+    public:
+
+        void set_up() override
+        {
+            m_container = blob_container(_XPLATSTR("listing"));
+            benchmark_environment::server().seed_blobs(m_container.name(), _XPLATSTR("item"), 5000);
+        }
+
+        utility::size64_t run() override
+        {
+            auto segment = m_container.list_blobs_segmented(utility::string_t(), true, azure::storage::blob_listing_details::none, 5000, azure::storage::continuation_token(), azure::storage::blob_request_options(), azure::storage::operation_context());
+            if (segment.results().size() != 5000)
+            {
+                throw std::runtime_error("unexpected number of listed blobs");
+            }
+
+            return 0;
+        }
+
+    private:
+
+        azure::storage::cloud_blob_container m_container;
+    };
+
+    class table_batch_insert_benchmark : public benchmark_case
+    {
+    public:
+
+        void set_up() override
+        {
+            m_table = benchmark_environment::account().create_cloud_table_client().get_table_reference(_XPLATSTR("benchmarktable"));
+            m_table.create_if_not_exists();
+        }
+
+        utility::size64_t run() override
+        {
+            azure::storage::table_batch_operation batch;
+            for (int i = 0; i < 100; ++i)
+            {
+                azure::storage::table_entity entity(_XPLATSTR("partition"), utility::conversions::print_string(i));
+                auto& properties = entity.properties();
+                properties[_XPLATSTR("Name")] = azure::storage::entity_property(utility::string_t(_XPLATSTR("benchmark entity")));
+                properties[_XPLATSTR("Count")] = azure::storage::entity_property((int32_t)i);
+                properties[_XPLATSTR("Total")] = azure::storage::entity_property((int64_t)i * 1000);
+                properties[_XPLATSTR("Ratio")] = azure::storage::entity_property(i / 7.0);
+                batch.insert_or_replace_entity(entity);
+            }
+
+            auto results = m_table.execute_batch(batch);
+            if (results.size() != 100)
+            {
+                throw std::runtime_error("unexpected number of batch results");
+            }
+
+            return 0;
+        }
+
+    private:
+
+        azure::storage::cloud_table m_table;
+    };
+
+    class queue_add_message_benchmark : public benchmark_case
+    {
+    public:
+
+        void set_up() override
+        {
+            m_queue = benchmark_environment::account().create_cloud_queue_client().get_queue_reference(_XPLATSTR("addmessage"));
+            m_queue.create_if_not_exists();
+        }
+
+        utility::size64_t run() override
+        {
+            azure::storage::cloud_queue_message message(_XPLATSTR("a short benchmark message"));
+            m_queue.add_message(message);
+            return 0;
+        }
+
+        void tear_down() override
+        {
+            m_queue.clear();
+        }
+
+    private:
+
+        azure::storage::cloud_queue m_queue;
+    };
+
+    class queue_get_messages_benchmark : public benchmark_case
+    {
+    public:
+
+        void set_up() override
+        {
+            m_queue = benchmark_environment::account().create_cloud_queue_client().get_queue_reference(_XPLATSTR("getmessages"));
+            m_queue.create_if_not_exists();
+            benchmark_environment::server().seed_queue(m_queue.name(), 64, _XPLATSTR("a short benchmark message"));
+        }
+
+        utility::size64_t run() override
+        {
+            azure::storage::queue_request_options options;
+            auto messages = m_queue.get_messages(32, std::chrono::seconds(30), options, azure::storage::operation_context());
+            if (messages.size() != 32)
+            {
+                throw std::runtime_error("unexpected number of messages");
+            }
+
+            return 0;
+        }
+
+    private:
+
+        azure::storage::cloud_queue m_queue;
+    };
+
+    azure::storage::cloud_file file_reference(const utility::string_t& name)
+    {
+        auto share = benchmark_environment::account().create_cloud_file_client().get_share_reference(_XPLATSTR("benchmarkshare"));
+        share.create_if_not_exists();
+        return share.get_root_directory_reference().get_file_reference(name);
+    }
+
+    template<size_t Megabytes>
+    class file_upload_benchmark : public benchmark_case
+    {
+    public:
+
+        void set_up() override
+        {
+            m_file = file_reference(_XPLATSTR("upload"));
+            m_payload = random_payload(Megabytes * 1024 * 1024);
+        }
+
+        utility::size64_t run() override
+        {
+            m_file.upload_from_stream(concurrency::streams::rawptr_stream<uint8_t>::open_istream(m_payload.data(), m_payload.size()));
+            return m_payload.size();
+        }
+
+    private:
+
+        azure::storage::cloud_file m_file;
+        std::vector<uint8_t> m_payload;
+    };
+
+    template<size_t Megabytes>
+    class file_download_benchmark : public benchmark_case
+    {
+    public:
+
+        void set_up() override
+        {
+            m_file = file_reference(_XPLATSTR("download"));
+            auto payload = random_payload(Megabytes * 1024 * 1024);
+            m_file.upload_from_stream(concurrency::streams::bytestream::open_istream(std::move(payload)));
+        }
+
+        utility::size64_t run() override
+        {
+            concurrency::streams::container_buffer<std::vector<uint8_t>> buffer;
+            m_file.download_to_stream(buffer.create_ostream());
+            return buffer.collection().size();
+        }
+
+    private:
+
+        azure::storage::cloud_file m_file;
+    };
+
+    typedef block_blob_upload_benchmark<4, 4, 1> blob_upload_single_4mb;
+    typedef block_blob_upload_benchmark<64, 4, 1> blob_upload_blocks_64mb_serial;
+    typedef block_blob_upload_benchmark<64, 4, 8> blob_upload_blocks_64mb_parallel;
+    typedef block_blob_download_benchmark<64, 1> blob_download_64mb_serial;
+    typedef block_blob_download_benchmark<64, 8> blob_download_64mb_parallel;
+    typedef file_upload_benchmark<16> file_upload_16mb;
+    typedef file_download_benchmark<16> file_download_16mb;
+
+    REGISTER_BENCHMARK(blob_upload_single_4mb, "blob/upload_from_stream/4MB_single_put");
+    REGISTER_BENCHMARK(blob_upload_blocks_64mb_serial, "blob/upload_from_stream/64MB_blocks_serial");
+    REGISTER_BENCHMARK(blob_upload_blocks_64mb_parallel, "blob/upload_from_stream/64MB_blocks_parallel8");
+    REGISTER_BENCHMARK(blob_download_64mb_serial, "blob/download_to_stream/64MB_serial");
+    REGISTER_BENCHMARK(blob_download_64mb_parallel, "blob/download_to_stream/64MB_parallel8");
+    REGISTER_BENCHMARK(list_blobs_segmented_benchmark, "blob/list_blobs_segmented/5000");
+    REGISTER_BENCHMARK(table_batch_insert_benchmark, "table/execute_batch/100_inserts");
+    REGISTER_BENCHMARK(queue_add_message_benchmark, "queue/add_message");
+    REGISTER_BENCHMARK(queue_get_messages_benchmark, "queue/get_messages/32");
+    REGISTER_BENCHMARK(file_upload_16mb, "file/upload_from_stream/16MB");
+    REGISTER_BENCHMARK(file_download_16mb, "file/download_to_stream/16MB");
+}
@@ -0,0 +1,75 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="main.cpp" company="Microsoft">
+//    Copyright 2013 Microsoft Corporation
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "benchmark_runner.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+namespace
+{
+    void print_usage(const char* program)
+    {
+        std::cout << "Usage: " << program << " [options]" << std::endl
+            << "  --filter <text>          run only benchmarks whose name contains text" << std::endl
+            << "  --min-time <ms>          minimum measured time per benchmark (default 2000)" << std::endl
+            << "  --min-iterations <n>     minimum measured iterations per benchmark (default 5)" << std::endl
+            << "  --port <port>            first of the four ports used by the mock server (default 18000)" << std::endl
+            << "  --csv                    print results as comma-separated values" << std::endl;
+    }
+}
+
+int main(int argc, const char* argv[])
+{
+    benchmark_options options;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--filter") == 0 && has_value)
+        {
+            options.m_filter = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--min-time") == 0 && has_value)
+        {
+            options.m_min_duration = std::chrono::milliseconds(std::atoi(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--min-iterations") == 0 && has_value)
+        {
+            options.m_min_iterations = (size_t)std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--port") == 0 && has_value)
+        {
+            benchmark_environment::set_base_port(std::atoi(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--csv") == 0)
+        {
+            options.m_csv = true;
+        }
+        else
+        {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    int failures = benchmark_registry::run(options);
+    benchmark_environment::shut_down();
+    return failures;
+}
@@ -0,0 +1,371 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="micro_benchmarks.cpp" company="Microsoft">
+//    Copyright 2013 Microsoft Corporation
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "benchmark_runner.h"
+
+#include "was/auth.h"
+#include "wascore/protocol.h"
+#include "wascore/protocol_json.h"
+#include "wascore/protocol_xml.h"
+
+// Benchmarks of single components of the request pipeline on prepared input. They run without any server.
+
+namespace
+{
+    web::http::http_request put_block_request()
+    {
+        web::http::http_request request(web::http::methods::PUT);
+        request.set_request_uri(web::http::uri(_XPLATSTR("https://benchmarkaccount.blob.core.windows.net/container/folder/blob.bin?comp=block&blockid=YmxvY2stMDAwMDAx&timeout=90")));
+
+        auto& headers = request.headers();
+        headers.add(web::http::header_names::content_length, 4 * 1024 * 1024);
+        headers.add(web::http::header_names::content_md5, _XPLATSTR("1B2M2Y8AsgTpgAmY7PhCfg=="));
+        headers.add(_XPLATSTR("x-ms-version"), _XPLATSTR("2018-03-28"));
+        headers.add(_XPLATSTR("x-ms-date"), _XPLATSTR("Mon, 01 Jan 2018 00:00:00 GMT"));
+        headers.add(_XPLATSTR("x-ms-client-request-id"), _XPLATSTR("7d1b6a3c-95a2-4ad6-9b3e-3f2d7b1e0c4a"));
+        headers.add(_XPLATSTR("x-ms-lease-id"), _XPLATSTR("2d8c36b2-8d70-4f57-a4f0-1c4d7a9b5e21"));
+        return request;
+    }
+
+    class canonicalize_benchmark : public benchmark_case
+    {
+    public:
+
+        canonicalize_benchmark()
+            : m_canonicalizer(_XPLATSTR("benchmarkaccount")), m_request(put_block_request())
+        {
+        }
+
+        utility::size64_t run() override
+        {
+            utility::size64_t length = 0;
+            for (int i = 0; i < 1000; ++i)
+            {
+                length += m_canonicalizer.canonicalize(m_request, m_context).size();
+            }
+
+            return length * sizeof(utility::char_t);
+        }
+
+    private:
+
+        azure::storage::protocol::shared_key_blob_queue_canonicalizer m_canonicalizer;
+        web::http::http_request m_request;
+        azure::storage::operation_context m_context;
+    };
+
+    class sign_request_benchmark : public benchmark_case
+    {
+    public:
+
+        sign_request_benchmark()
+            : m_handler(std::make_shared<azure::storage::protocol::shared_key_blob_queue_canonicalizer>(_XPLATSTR("benchmarkaccount")),
+                azure::storage::storage_credentials(_XPLATSTR("benchmarkaccount"), utility::conversions::to_base64(std::vector<unsigned char>(64, 0x42))))
+        {
+        }
+
+        utility::size64_t run() override
+        {
+            for (int i = 0; i < 1000; ++i)
+            {
+                auto request = put_block_request();
+                m_handler.sign_request(request, m_context);
+            }
+
+            return 0;
+        }
+
+    private:
+
+        azure::storage::protocol::shared_key_authentication_handler m_handler;
+        azure::storage::operation_context m_context;
+    };
+
+    // Signs the same request over and over, so only the signing itself is measured and not building the request.
+    class resign_request_benchmark : public benchmark_case
+    {
+    public:
+
+        resign_request_benchmark()
+            : m_handler(std::make_shared<azure::storage::protocol::shared_key_blob_queue_canonicalizer>(_XPLATSTR("benchmarkaccount")),
+                azure::storage::storage_credentials(_XPLATSTR("benchmarkaccount"), utility::conversions::to_base64(std::vector<unsigned char>(64, 0x42)))),
+            m_request(put_block_request())
+        {
+        }
+
+        utility::size64_t run() override
+        {
+            auto& headers = m_request.headers();
+            for (int i = 0; i < 1000; ++i)
+            {
+                headers.remove(_XPLATSTR("x-ms-date"));
+                headers.remove(web::http::header_names::authorization);
+                m_handler.sign_request(m_request, m_context);
+            }
+
+            return 0;
+        }
+
+    private:
+
+        azure::storage::protocol::shared_key_authentication_handler m_handler;
+        web::http::http_request m_request;
+        azure::storage::operation_context m_context;
+    };
+
+    class list_blobs_reader_benchmark : public benchmark_case
+    {
+    public:
+
+        void set_up() override
+        {
+            std::ostringstream body;
+            body << "<?xml version=\"1.0\" encoding=\"utf-8\"?><EnumerationResults ServiceEndpoint=\"https://benchmarkaccount.blob.core.windows.net/\" ContainerName=\"container\">"
+                << "<MaxResults>5000</MaxResults><Blobs>";
+            for (int i = 0; i < 5000; ++i)
+            {
+                body << "<Blob><Name>folder/blob-" << i << ".bin</Name><Properties><Creation-Time>Mon, 01 Jan 2018 00:00:00 GMT</Creation-Time>"
+                    << "<Last-Modified>Mon, 01 Jan 2018 00:00:00 GMT</Last-Modified><Etag>0x8D5A1B2C3D4E5F" << i << "</Etag>"
+                    << "<Content-Length>" << (i * 1024) << "</Content-Length><Content-Type>application/octet-stream</Content-Type>"
+                    << "<Content-Encoding /><Content-Language /><Content-MD5>1B2M2Y8AsgTpgAmY7PhCfg==</Content-MD5><Cache-Control />"
+                    << "<BlobType>BlockBlob</BlobType><AccessTier>Hot</AccessTier><AccessTierInferred>true</AccessTierInferred>"
+                    << "<LeaseStatus>unlocked</LeaseStatus><LeaseState>available</LeaseState><ServerEncrypted>true</ServerEncrypted>"
+                    << "</Properties></Blob>";
+            }
+
+            body << "</Blobs><NextMarker>folder/blob-5000.bin</NextMarker></EnumerationResults>";
+            m_body = body.str();
+        }
+
+        utility::size64_t run() override
+        {
+            azure::storage::protocol::list_blobs_reader reader(concurrency::streams::rawptr_stream<uint8_t>::open_istream((const uint8_t*)m_body.data(), m_body.size()));
+            auto items = reader.move_blob_items();
+            if (items.size() != 5000)
+            {
+                throw std::runtime_error("unexpected number of parsed blobs");
+            }
+
+            return m_body.size();
+        }
+
+    protected:
+
+        std::string m_body;
+    };
+
+    // Parses the same listing as list_blobs_reader_benchmark into a compact segment.
+    class compact_list_blobs_reader_benchmark : public list_blobs_reader_benchmark
+    {
+    public:
+
+        utility::size64_t run() override
+        {
+            azure::storage::protocol::compact_list_blobs_reader reader(concurrency::streams::rawptr_stream<uint8_t>::open_istream((const uint8_t*)m_body.data(), m_body.size()));
+            auto segment = reader.move_segment(azure::storage::storage_location::primary);
+            if (segment.size() != 5000)
+            {
+                throw std::runtime_error("unexpected number of parsed blobs");
+            }
+
+            return m_body.size();
+        }
+    };
+
+    class message_reader_benchmark : public benchmark_case
+    {
+    public:
+
+        void set_up() override
+        {
+            std::ostringstream body;
+            body << "<?xml version=\"1.0\" encoding=\"utf-8\"?><QueueMessagesList>";
+            for (int i = 0; i < 32; ++i)
+            {
+                body << "<QueueMessage><MessageId>5974b586-0df3-4e2d-ad0c-18e3892bfc" << (10 + i) << "</MessageId>"
+                    << "<InsertionTime>Mon, 01 Jan 2018 00:00:00 GMT</InsertionTime><ExpirationTime>Mon, 08 Jan 2018 00:00:00 GMT</ExpirationTime>"
+                    << "<PopReceipt>AgAAAAMAAAAAAAAAtnpGgEuD0wE=</PopReceipt><TimeNextVisible>Mon, 01 Jan 2018 00:00:30 GMT</TimeNextVisible>"
+                    << "<DequeueCount>1</DequeueCount><MessageText>" << std::string(512, 'm') << "</MessageText></QueueMessage>";
+            }
+
+            body << "</QueueMessagesList>";
+            m_body = body.str();
+        }
+
+        utility::size64_t run() override
+        {
+            azure::storage::protocol::message_reader reader(concurrency::streams::rawptr_stream<uint8_t>::open_istream((const uint8_t*)m_body.data(), m_body.size()));
+            auto items = reader.move_items();
+            if (items.size() != 32)
+            {
+                throw std::runtime_error("unexpected number of parsed messages");
+            }
+
+            return m_body.size();
+        }
+
+    private:
+
+        std::string m_body;
+    };
+
+    class binary_message_writer_benchmark : public benchmark_case
+    {
+    public:
+
+        void set_up() override
+        {
+            std::vector<uint8_t> content(48 * 1024);
+            for (size_t i = 0; i < content.size(); ++i)
+            {
+                content[i] = static_cast<uint8_t>(i * 131 + 7);
+            }
+
+            m_size = content.size();
+            m_message.set_content(std::move(content));
+        }
+
+        utility::size64_t run() override
+        {
+            azure::storage::protocol::message_writer writer;
+            std::string body = writer.write(m_message);
+            if (body.empty())
+            {
+                throw std::runtime_error("unexpected empty message body");
+            }
+
+            return m_size;
+        }
+
+    private:
+
+        azure::storage::cloud_queue_message m_message;
+        utility::size64_t m_size;
+    };
+
+    utility::string_t query_results_body()
+    {
+        utility::ostringstream_t body;
+        body << _XPLATSTR("{\"odata.metadata\":\"https://benchmarkaccount.table.core.windows.net/$metadata#benchmarktable\",\"value\":[");
+        for (int i = 0; i < 1000; ++i)
+        {
+            if (i != 0)
+            {
+                body << _XPLATSTR(',');
+            }
+
+            body << _XPLATSTR("{\"odata.etag\":\"W/\\\"datetime'2018-01-01T00%3A00%3A00.0000000Z'\\\"\",\"PartitionKey\":\"partition\",\"RowKey\":\"row") << i
+                << _XPLATSTR("\",\"Timestamp\":\"2018-01-01T00:00:00.0000000Z\",\"Name\":\"benchmark entity\",\"Count\":") << i
+                << _XPLATSTR(",\"Total@odata.type\":\"Edm.Int64\",\"Total\":\"") << (i * 1000)
+                << _XPLATSTR("\",\"Ratio\":0.5,\"Enabled\":true,\"Id@odata.type\":\"Edm.Guid\",\"Id\":\"7d1b6a3c-95a2-4ad6-9b3e-3f2d7b1e0c4a\"}");
+        }
+
+        body << _XPLATSTR("]}");
+        return body.str();
+    }
+
+    class parse_query_results_benchmark : public benchmark_case
+    {
+    public:
+
+        void set_up() override
+        {
+            m_body = query_results_body();
+        }
+
+        utility::size64_t run() override
+        {
+            auto document = web::json::value::parse(m_body);
+            auto entities = azure::storage::protocol::table_response_parsers::parse_query_results(document);
+            if (entities.size() != 1000)
+            {
+                throw std::runtime_error("unexpected number of parsed entities");
+            }
+
+            return m_body.size() * sizeof(utility::char_t);
+        }
+
+    private:
+
+        utility::string_t m_body;
+    };
+
+    class table_query_reader_benchmark : public benchmark_case
+    {
+    public:
+
+        void set_up() override
+        {
+            m_body = utility::conversions::to_utf8string(query_results_body());
+        }
+
+        utility::size64_t run() override
+        {
+            azure::storage::protocol::table_query_reader reader(m_body.data(), m_body.size());
+            auto entities = reader.move_entities();
+            if (entities.size() != 1000)
+            {
+                throw std::runtime_error("unexpected number of parsed entities");
+            }
+
+            return m_body.size();
+        }
+
+    private:
+
+        std::string m_body;
+    };
+
+    class compact_query_reader_benchmark : public benchmark_case
+    {
+    public:
+
+        void set_up() override
+        {
+            m_body = utility::conversions::to_utf8string(query_results_body());
+        }
+
+        utility::size64_t run() override
+        {
+            std::shared_ptr<const azure::storage::table_entity_schema> schema;
+            azure::storage::protocol::table_query_reader reader(m_body.data(), m_body.size());
+            auto entities = reader.move_compact_entities(schema);
+            if (entities.size() != 1000)
+            {
+                throw std::runtime_error("unexpected number of parsed entities");
+            }
+
+            return m_body.size();
+        }
+
+    private:
+
+        std::string m_body;
+    };
+
+    REGISTER_BENCHMARK(canonicalize_benchmark, "micro/auth/canonicalize_put_block_x1000");
+    REGISTER_BENCHMARK(sign_request_benchmark, "micro/auth/sign_put_block_x1000");
+    REGISTER_BENCHMARK(resign_request_benchmark, "micro/auth/resign_put_block_x1000");
+    REGISTER_BENCHMARK(list_blobs_reader_benchmark, "micro/xml/list_blobs_reader/5000");
+    REGISTER_BENCHMARK(compact_list_blobs_reader_benchmark, "micro/xml/compact_list_blobs_reader/5000");
+    REGISTER_BENCHMARK(message_reader_benchmark, "micro/xml/message_reader/32");
+    REGISTER_BENCHMARK(binary_message_writer_benchmark, "micro/xml/binary_message_writer/48k");
+    REGISTER_BENCHMARK(parse_query_results_benchmark, "micro/json/parse_query_results/1000");
+    REGISTER_BENCHMARK(table_query_reader_benchmark, "micro/json/table_query_reader/1000");
+    REGISTER_BENCHMARK(compact_query_reader_benchmark, "micro/json/compact_query_reader/1000");
+}
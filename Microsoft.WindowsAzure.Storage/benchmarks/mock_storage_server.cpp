@@ -0,0 +1,850 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="mock_storage_server.cpp" company="Microsoft">
+//    Copyright 2013 Microsoft Corporation
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "mock_storage_server.h"
+
+#include "wascore/constants.h"
+#include "wascore/hashing.h"
+
+const utility::string_t mock_storage_server::account_name(_XPLATSTR("benchmarkaccount"));
+
+namespace
+{
+    utility::string_t query_value(const std::map<utility::string_t, utility::string_t>& query, const utility::string_t& name)
+    {
+        auto it = query.find(name);
+        return it == query.end() ? utility::string_t() : web::uri::decode(it->second);
+    }
+
+    utility::string_t header_value(const web::http::http_headers& headers, const utility::string_t& name)
+    {
+        utility::string_t value;
+        headers.match(name, value);
+        return value;
+    }
+
+    utility::string_t now_rfc1123()
+    {
+        return utility::datetime::utc_now().to_string(utility::datetime::RFC_1123);
+    }
+
+    // Parses "bytes=start-end". An open-ended range extends to the end of the content.
+    bool parse_range(const utility::string_t& value, utility::size64_t& start, utility::size64_t& end)
+    {
+        const utility::string_t prefix(_XPLATSTR("bytes="));
+        if (value.compare(0, prefix.size(), prefix) != 0)
+        {
+            return false;
+        }
+
+        auto dash = value.find(_XPLATSTR('-'), prefix.size());
+        if (dash == utility::string_t::npos)
+        {
+            return false;
+        }
+
+        start = utility::conversions::details::scan_string<utility::size64_t>(value.substr(prefix.size(), dash - prefix.size()));
+        end = dash + 1 < value.size() ? utility::conversions::details::scan_string<utility::size64_t>(value.substr(dash + 1)) : std::numeric_limits<utility::size64_t>::max();
+        return true;
+    }
+
+    // Returns the text of every element with the given name. The bodies sent by the library are small and well-formed,
+    // so a plain search is enough here.
+    std::vector<std::string> element_values(const std::string& body, const std::string& name)
+    {
+        std::vector<std::string> values;
+        const std::string begin_tag = "<" + name + ">";
+        const std::string end_tag = "</" + name + ">";
+
+        size_t position = body.find(begin_tag);
+        while (position != std::string::npos)
+        {
+            position += begin_tag.size();
+            size_t end = body.find(end_tag, position);
+            if (end == std::string::npos)
+            {
+                break;
+            }
+
+            values.push_back(body.substr(position, end - position));
+            position = body.find(begin_tag, end + end_tag.size());
+        }
+
+        return values;
+    }
+
+    void write_message(utility::ostringstream_t& body, const utility::string_t& id, const utility::string_t& text, int dequeue_count, bool include_pop_receipt)
+    {
+        const utility::string_t now = now_rfc1123();
+        body << _XPLATSTR("<QueueMessage><MessageId>") << id << _XPLATSTR("</MessageId>")
+            << _XPLATSTR("<InsertionTime>") << now << _XPLATSTR("</InsertionTime>")
+            << _XPLATSTR("<ExpirationTime>") << now << _XPLATSTR("</ExpirationTime>");
+        if (include_pop_receipt)
+        {
+            body << _XPLATSTR("<PopReceipt>receipt-") << id << _XPLATSTR("</PopReceipt>")
+                << _XPLATSTR("<TimeNextVisible>") << now << _XPLATSTR("</TimeNextVisible>");
+        }
+
+        body << _XPLATSTR("<DequeueCount>") << dequeue_count << _XPLATSTR("</DequeueCount>");
+        if (!text.empty())
+        {
+            body << _XPLATSTR("<MessageText>") << text << _XPLATSTR("</MessageText>");
+        }
+
+        body << _XPLATSTR("</QueueMessage>");
+    }
+
+    void reply(web::http::http_request request, web::http::http_response response)
+    {
+        request.reply(response).then([](pplx::task<void> reply_task)
+        {
+            try
+            {
+                reply_task.get();
+            }
+            catch (const std::exception&)
+            {
+                // The client went away. There is nothing left to do for this request.
+            }
+        });
+    }
+}
+
+mock_storage_server::mock_storage_server(int base_port)
+    : m_base_port(base_port), m_next_id(0)
+{
+}
+
+mock_storage_server::~mock_storage_server()
+{
+    try
+    {
+        stop();
+    }
+    catch (...)
+    {
+    }
+}
+
+void mock_storage_server::start()
+{
+    typedef void (mock_storage_server::*handler)(web::http::http_request);
+    const handler handlers[] = { &mock_storage_server::handle_blob, &mock_storage_server::handle_queue, &mock_storage_server::handle_table, &mock_storage_server::handle_file };
+
+    for (int i = 0; i < 4; ++i)
+    {
+        utility::ostringstream_t address;
+        address << _XPLATSTR("http://127.0.0.1:") << (m_base_port + i);
+
+        std::unique_ptr<web::http::experimental::listener::http_listener> listener(new web::http::experimental::listener::http_listener(web::uri(address.str())));
+        handler service_handler = handlers[i];
+        listener->support([this, service_handler](web::http::http_request request)
+        {
+            try
+            {
+                (this->*service_handler)(request);
+            }
+            catch (const std::exception&)
+            {
+                reply(request, create_response(web::http::status_codes::InternalError));
+            }
+        });
+
+        listener->open().wait();
+        m_listeners.push_back(std::move(listener));
+    }
+}
+
+void mock_storage_server::stop()
+{
+    for (auto& listener : m_listeners)
+    {
+        listener->close().wait();
+    }
+
+    m_listeners.clear();
+}
+
+azure::storage::cloud_storage_account mock_storage_server::account() const
+{
+    std::vector<unsigned char> key(64, 0x42);
+    azure::storage::storage_credentials credentials(account_name, utility::conversions::to_base64(key));
+
+    std::vector<azure::storage::storage_uri> endpoints;
+    for (int i = 0; i < 4; ++i)
+    {
+        utility::ostringstream_t address;
+        address << _XPLATSTR("http://127.0.0.1:") << (m_base_port + i) << _XPLATSTR("/") << account_name;
+        endpoints.push_back(azure::storage::storage_uri(web::http::uri(address.str())));
+    }
+
+    return azure::storage::cloud_storage_account(credentials, endpoints[0], endpoints[1], endpoints[2], endpoints[3]);
+}
+
+void mock_storage_server::seed_blobs(const utility::string_t& container_name, const utility::string_t& prefix, size_t blob_count)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    for (size_t i = 0; i < blob_count; ++i)
+    {
+        utility::ostringstream_t name;
+        name << container_name << _XPLATSTR('/') << prefix << i;
+
+        stored_item& item = m_blobs[name.str()];
+        item.m_etag = next_etag();
+    }
+}
+
+void mock_storage_server::seed_queue(const utility::string_t& queue_name, size_t message_count, const utility::string_t& message_text)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    auto& queue = m_queues[queue_name];
+    for (size_t i = 0; i < message_count; ++i)
+    {
+        stored_message message;
+        message.m_id = utility::conversions::print_string(++m_next_id);
+        message.m_text = message_text;
+        message.m_dequeue_count = 0;
+        queue.push_back(message);
+    }
+}
+
+void mock_storage_server::handle_blob(web::http::http_request request)
+{
+    auto segments = path_segments(request);
+    auto query = web::uri::split_query(request.request_uri().query());
+    const auto& method = request.method();
+
+    if (segments.empty())
+    {
+        reply(request, create_response(web::http::status_codes::OK));
+        return;
+    }
+
+    if (segments.size() == 1)
+    {
+        if (method == web::http::methods::GET && query_value(query, _XPLATSTR("comp")) == _XPLATSTR("list"))
+        {
+            list_blobs(request, segments[0], query);
+        }
+        else if (method == web::http::methods::PUT)
+        {
+            reply(request, create_response(web::http::status_codes::Created));
+        }
+        else if (method == web::http::methods::DEL)
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            const utility::string_t prefix = segments[0] + _XPLATSTR('/');
+            auto it = m_blobs.lower_bound(prefix);
+            while (it != m_blobs.end() && it->first.compare(0, prefix.size(), prefix) == 0)
+            {
+                it = m_blobs.erase(it);
+            }
+
+            reply(request, create_response(web::http::status_codes::Accepted));
+        }
+        else
+        {
+            reply(request, create_response(web::http::status_codes::OK));
+        }
+
+        return;
+    }
+
+    const utility::string_t key = segments[0] + _XPLATSTR('/') + join_segments(segments, 1);
+    if (method == web::http::methods::PUT)
+    {
+        put_blob(request, key, query);
+    }
+    else if (method == web::http::methods::GET || method == web::http::methods::HEAD)
+    {
+        get_item(request, key, false);
+    }
+    else if (method == web::http::methods::DEL)
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        bool found = m_blobs.erase(key) != 0;
+        reply(request, create_response(found ? web::http::status_codes::Accepted : web::http::status_codes::NotFound));
+    }
+    else
+    {
+        reply(request, create_response(web::http::status_codes::MethodNotAllowed));
+    }
+}
+
+void mock_storage_server::put_blob(web::http::http_request request, const utility::string_t& key, const std::map<utility::string_t, utility::string_t>& query)
+{
+    const utility::string_t comp = query_value(query, _XPLATSTR("comp"));
+    const utility::string_t block_id = query_value(query, _XPLATSTR("blockid"));
+    const utility::string_t content_md5 = header_value(request.headers(), azure::storage::protocol::ms_header_blob_content_md5);
+
+    request.extract_vector().then([this, request, key, comp, block_id, content_md5](std::vector<unsigned char> body)
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        stored_item& item = m_blobs[key];
+
+        if (comp.empty())
+        {
+            item.m_data = std::make_shared<std::vector<uint8_t>>(std::move(body));
+            item.m_uncommitted_blocks.clear();
+            item.m_content_md5 = content_md5;
+        }
+        else if (comp == _XPLATSTR("block"))
+        {
+            item.m_uncommitted_blocks[block_id] = std::move(body);
+        }
+        else if (comp == _XPLATSTR("blocklist"))
+        {
+            const std::string block_list(body.begin(), body.end());
+            auto data = std::make_shared<std::vector<uint8_t>>();
+
+            // Only uncommitted blocks are kept, which covers every upload path of the library.
+            for (const char* tag : { "Latest", "Uncommitted", "Committed" })
+            {
+                for (const auto& id : element_values(block_list, tag))
+                {
+                    auto block = item.m_uncommitted_blocks.find(utility::conversions::to_string_t(id));
+                    if (block == item.m_uncommitted_blocks.end())
+                    {
+                        reply(request, create_response(web::http::status_codes::BadRequest));
+                        return;
+                    }
+
+                    data->insert(data->end(), block->second.begin(), block->second.end());
+                }
+            }
+
+            item.m_data = data;
+            item.m_uncommitted_blocks.clear();
+            item.m_content_md5 = content_md5;
+        }
+        else if (comp == _XPLATSTR("properties") && !content_md5.empty())
+        {
+            item.m_content_md5 = content_md5;
+        }
+
+        if (comp != _XPLATSTR("block"))
+        {
+            item.m_etag = next_etag();
+        }
+
+        auto response = create_response(comp.empty() || comp == _XPLATSTR("block") || comp == _XPLATSTR("blocklist") ? web::http::status_codes::Created : web::http::status_codes::OK);
+        response.headers().add(web::http::header_names::etag, item.m_etag);
+        response.headers().add(web::http::header_names::last_modified, now_rfc1123());
+        response.headers().add(azure::storage::protocol::ms_header_request_server_encrypted, _XPLATSTR("false"));
+        reply(request, response);
+    });
+}
+
+void mock_storage_server::list_blobs(web::http::http_request request, const utility::string_t& container, const std::map<utility::string_t, utility::string_t>& query)
+{
+    const utility::string_t prefix = query_value(query, _XPLATSTR("prefix"));
+    const utility::string_t marker = query_value(query, _XPLATSTR("marker"));
+    const utility::string_t max_results_value = query_value(query, _XPLATSTR("maxresults"));
+    const size_t max_results = max_results_value.empty() ? 5000 : utility::conversions::details::scan_string<size_t>(max_results_value);
+    const utility::string_t container_prefix = container + _XPLATSTR('/');
+    const utility::string_t last_modified = now_rfc1123();
+
+    utility::ostringstream_t body;
+    body << _XPLATSTR("<?xml version=\"1.0\" encoding=\"utf-8\"?><EnumerationResults ServiceEndpoint=\"") << request.request_uri().authority().to_string()
+        << _XPLATSTR("\" ContainerName=\"") << container << _XPLATSTR("\"><Prefix>") << prefix << _XPLATSTR("</Prefix><Marker>") << marker
+        << _XPLATSTR("</Marker><MaxResults>") << max_results << _XPLATSTR("</MaxResults><Blobs>");
+
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        auto it = m_blobs.lower_bound(container_prefix + std::max(prefix, marker));
+        size_t count = 0;
+        for (; it != m_blobs.end() && count < max_results; ++it, ++count)
+        {
+            if (it->first.compare(0, container_prefix.size() + prefix.size(), container_prefix + prefix) != 0)
+            {
+                break;
+            }
+
+            body << _XPLATSTR("<Blob><Name>") << it->first.substr(container_prefix.size()) << _XPLATSTR("</Name><Properties>")
+                << _XPLATSTR("<Last-Modified>") << last_modified << _XPLATSTR("</Last-Modified><Etag>") << it->second.m_etag << _XPLATSTR("</Etag>")
+                << _XPLATSTR("<Content-Length>") << it->second.m_data->size() << _XPLATSTR("</Content-Length>")
+                << _XPLATSTR("<Content-Type>application/octet-stream</Content-Type><Content-MD5>") << it->second.m_content_md5 << _XPLATSTR("</Content-MD5>")
+                << _XPLATSTR("<BlobType>BlockBlob</BlobType><LeaseStatus>unlocked</LeaseStatus><LeaseState>available</LeaseState>")
+                << _XPLATSTR("<ServerEncrypted>false</ServerEncrypted></Properties></Blob>");
+        }
+
+        body << _XPLATSTR("</Blobs><NextMarker>");
+        if (it != m_blobs.end() && it->first.compare(0, container_prefix.size() + prefix.size(), container_prefix + prefix) == 0)
+        {
+            body << it->first.substr(container_prefix.size());
+        }
+    }
+
+    body << _XPLATSTR("</NextMarker></EnumerationResults>");
+
+    auto response = create_response(web::http::status_codes::OK);
+    response.set_body(body.str(), _XPLATSTR("application/xml"));
+    reply(request, response);
+}
+
+void mock_storage_server::get_item(web::http::http_request request, const utility::string_t& key, bool is_file)
+{
+    std::shared_ptr<std::vector<uint8_t>> data;
+    utility::string_t content_md5;
+    utility::string_t etag;
+
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        auto& items = is_file ? m_files : m_blobs;
+        auto it = items.find(key);
+        if (it == items.end())
+        {
+            reply(request, create_response(web::http::status_codes::NotFound));
+            return;
+        }
+
+        data = it->second.m_data;
+        content_md5 = it->second.m_content_md5;
+        etag = it->second.m_etag;
+    }
+
+    const utility::size64_t size = data->size();
+    utility::size64_t start = 0;
+    utility::size64_t end = size == 0 ? 0 : size - 1;
+
+    utility::string_t range = header_value(request.headers(), azure::storage::protocol::ms_header_range);
+    if (range.empty())
+    {
+        range = header_value(request.headers(), web::http::header_names::range);
+    }
+
+    const bool has_range = !range.empty() && parse_range(range, start, end);
+    if (has_range)
+    {
+        if (start >= size)
+        {
+            reply(request, create_response(web::http::status_codes::RangeNotSatisfiable));
+            return;
+        }
+
+        end = std::min(end, size - 1);
+    }
+
+    const utility::size64_t length = size == 0 ? 0 : end - start + 1;
+    auto response = create_response(has_range ? web::http::status_codes::PartialContent : web::http::status_codes::OK);
+    auto& headers = response.headers();
+    headers.add(web::http::header_names::etag, etag);
+    headers.add(web::http::header_names::last_modified, now_rfc1123());
+    headers.add(web::http::header_names::accept_ranges, _XPLATSTR("bytes"));
+    headers.add(azure::storage::protocol::ms_header_server_encrypted, _XPLATSTR("false"));
+    if (is_file)
+    {
+        headers.add(_XPLATSTR("x-ms-type"), _XPLATSTR("File"));
+    }
+    else
+    {
+        headers.add(azure::storage::protocol::ms_header_blob_type, _XPLATSTR("BlockBlob"));
+    }
+
+    if (has_range)
+    {
+        utility::ostringstream_t content_range;
+        content_range << _XPLATSTR("bytes ") << start << _XPLATSTR('-') << end << _XPLATSTR('/') << size;
+        headers.add(web::http::header_names::content_range, content_range.str());
+
+        if (!content_md5.empty())
+        {
+            headers.add(is_file ? azure::storage::protocol::ms_header_content_md5 : azure::storage::protocol::ms_header_blob_content_md5, content_md5);
+        }
+
+        if (header_value(request.headers(), azure::storage::protocol::ms_header_range_get_content_md5) == _XPLATSTR("true"))
+        {
+            auto provider = azure::storage::core::hash_provider::create_md5_hash_provider();
+            provider.write(data->data() + start, (size_t)length);
+            provider.close();
+            headers.add(web::http::header_names::content_md5, provider.hash());
+        }
+    }
+    else if (!content_md5.empty())
+    {
+        headers.add(web::http::header_names::content_md5, content_md5);
+    }
+
+    if (request.method() == web::http::methods::HEAD)
+    {
+        headers.set_content_length(size);
+        headers.set_content_type(_XPLATSTR("application/octet-stream"));
+        reply(request, response);
+        return;
+    }
+
+    response.set_body(concurrency::streams::rawptr_stream<uint8_t>::open_istream(data->data() + start, (size_t)length), length, _XPLATSTR("application/octet-stream"));
+
+    // The response streams straight out of the stored content, so the snapshot has to stay alive until it has been sent.
+    request.reply(response).then([data](pplx::task<void> reply_task)
+    {
+        try
+        {
+            reply_task.get();
+        }
+        catch (const std::exception&)
+        {
+        }
+    });
+}
+
+void mock_storage_server::handle_queue(web::http::http_request request)
+{
+    auto segments = path_segments(request);
+    auto query = web::uri::split_query(request.request_uri().query());
+    const auto& method = request.method();
+
+    if (segments.empty())
+    {
+        reply(request, create_response(web::http::status_codes::OK));
+        return;
+    }
+
+    const utility::string_t& queue_name = segments[0];
+    if (segments.size() == 1)
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        if (method == web::http::methods::PUT)
+        {
+            m_queues[queue_name];
+            reply(request, create_response(web::http::status_codes::Created));
+        }
+        else if (method == web::http::methods::DEL)
+        {
+            m_queues.erase(queue_name);
+            reply(request, create_response(web::http::status_codes::NoContent));
+        }
+        else
+        {
+            auto response = create_response(web::http::status_codes::OK);
+            response.headers().add(azure::storage::protocol::ms_header_approximate_messages_count, m_queues[queue_name].size());
+            reply(request, response);
+        }
+
+        return;
+    }
+
+    if (segments.size() == 3)
+    {
+        // Update and delete of a single message only need to succeed.
+        auto response = create_response(web::http::status_codes::NoContent);
+        if (method == web::http::methods::PUT)
+        {
+            response.headers().add(azure::storage::protocol::ms_header_pop_receipt, _XPLATSTR("receipt-") + segments[2]);
+            response.headers().add(azure::storage::protocol::ms_header_time_next_visible, now_rfc1123());
+        }
+        else if (method == web::http::methods::DEL)
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            auto& queue = m_queues[queue_name];
+            for (auto it = queue.begin(); it != queue.end(); ++it)
+            {
+                if (it->m_id == segments[2])
+                {
+                    queue.erase(it);
+                    break;
+                }
+            }
+        }
+
+        reply(request, response);
+        return;
+    }
+
+    if (method == web::http::methods::POST)
+    {
+        request.extract_utf8string().then([this, request, queue_name](std::string body)
+        {
+            auto texts = element_values(body, "MessageText");
+
+            stored_message message;
+            message.m_text = texts.empty() ? utility::string_t() : utility::conversions::to_string_t(texts.front());
+            message.m_dequeue_count = 0;
+
+            {
+                std::lock_guard<std::mutex> guard(m_mutex);
+                message.m_id = utility::conversions::print_string(++m_next_id);
+                m_queues[queue_name].push_back(message);
+            }
+
+            utility::ostringstream_t response_body;
+            response_body << _XPLATSTR("<?xml version=\"1.0\" encoding=\"utf-8\"?><QueueMessagesList>");
+            write_message(response_body, message.m_id, utility::string_t(), 0, true);
+            response_body << _XPLATSTR("</QueueMessagesList>");
+
+            auto response = create_response(web::http::status_codes::Created);
+            response.set_body(response_body.str(), _XPLATSTR("application/xml"));
+            reply(request, response);
+        });
+    }
+    else if (method == web::http::methods::GET)
+    {
+        const utility::string_t count_value = query_value(query, _XPLATSTR("numofmessages"));
+        const size_t count = count_value.empty() ? 1 : utility::conversions::details::scan_string<size_t>(count_value);
+        const bool peek = query_value(query, _XPLATSTR("peekonly")) == _XPLATSTR("true");
+
+        utility::ostringstream_t response_body;
+        response_body << _XPLATSTR("<?xml version=\"1.0\" encoding=\"utf-8\"?><QueueMessagesList>");
+
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            auto& queue = m_queues[queue_name];
+
+            // Messages are never hidden. Retrieved messages move to the back so that repeated reads keep returning data.
+            for (size_t i = 0; i < count && i < queue.size(); ++i)
+            {
+                stored_message message = queue.front();
+                queue.pop_front();
+                if (!peek)
+                {
+                    ++message.m_dequeue_count;
+                }
+
+                write_message(response_body, message.m_id, message.m_text, message.m_dequeue_count, !peek);
+                queue.push_back(message);
+            }
+        }
+
+        response_body << _XPLATSTR("</QueueMessagesList>");
+
+        auto response = create_response(web::http::status_codes::OK);
+        response.set_body(response_body.str(), _XPLATSTR("application/xml"));
+        reply(request, response);
+    }
+    else if (method == web::http::methods::DEL)
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_queues[queue_name].clear();
+        reply(request, create_response(web::http::status_codes::NoContent));
+    }
+    else
+    {
+        reply(request, create_response(web::http::status_codes::MethodNotAllowed));
+    }
+}
+
+void mock_storage_server::handle_table(web::http::http_request request)
+{
+    auto segments = path_segments(request);
+    const auto& method = request.method();
+
+    if (!segments.empty() && segments[0] == _XPLATSTR("$batch") && method == web::http::methods::POST)
+    {
+        request.extract_utf8string().then([this, request](std::string body)
+        {
+            // Every operation of the change set is written as its own application/http part.
+            size_t operation_count = 0;
+            const std::string part_marker("Content-Type: application/http");
+            for (size_t position = body.find(part_marker); position != std::string::npos; position = body.find(part_marker, position + part_marker.size()))
+            {
+                ++operation_count;
+            }
+
+            uint64_t id;
+            {
+                std::lock_guard<std::mutex> guard(m_mutex);
+                id = ++m_next_id;
+            }
+
+            const std::string batch_boundary("batchresponse_" + std::to_string(id));
+            const std::string changeset_boundary("changesetresponse_" + std::to_string(id));
+            const std::string etag = "W/\"datetime'" + utility::conversions::to_utf8string(web::uri::encode_data_string(utility::datetime::utc_now().to_string(utility::datetime::ISO_8601))) + "'\"";
+
+            std::string response_body;
+            response_body.reserve(128 + operation_count * 256);
+            response_body += "--" + batch_boundary + "\r\nContent-Type: multipart/mixed; boundary=" + changeset_boundary + "\r\n\r\n";
+            for (size_t i = 0; i < operation_count; ++i)
+            {
+                response_body += "--" + changeset_boundary + "\r\nContent-Type: application/http\r\nContent-Transfer-Encoding: binary\r\n\r\n";
+                response_body += "HTTP/1.1 204 No Content\r\nContent-ID: " + std::to_string(i + 1) + "\r\nX-Content-Type-Options: nosniff\r\nCache-Control: no-cache\r\nDataServiceVersion: 1.0;\r\nETag: " + etag + "\r\n\r\n";
+            }
+
+            response_body += "--" + changeset_boundary + "--\r\n--" + batch_boundary + "--\r\n";
+
+            auto response = create_response(web::http::status_codes::Accepted);
+            response.set_body(std::move(response_body), "multipart/mixed; boundary=" + batch_boundary);
+            reply(request, response);
+        });
+
+        return;
+    }
+
+    if (method == web::http::methods::POST || method == web::http::methods::DEL)
+    {
+        reply(request, create_response(web::http::status_codes::NoContent));
+        return;
+    }
+
+    // Queries always come back empty.
+    web::json::value body = web::json::value::object();
+    body[_XPLATSTR("value")] = web::json::value::array();
+
+    auto response = create_response(web::http::status_codes::OK);
+    response.set_body(body);
+    reply(request, response);
+}
+
+void mock_storage_server::handle_file(web::http::http_request request)
+{
+    auto segments = path_segments(request);
+    auto query = web::uri::split_query(request.request_uri().query());
+    const auto& method = request.method();
+
+    // Shares and directories carry no state in this server.
+    if (segments.size() <= 1 || query_value(query, _XPLATSTR("restype")) == _XPLATSTR("directory"))
+    {
+        reply(request, create_response(method == web::http::methods::PUT ? web::http::status_codes::Created : method == web::http::methods::DEL ? web::http::status_codes::Accepted : web::http::status_codes::OK));
+        return;
+    }
+
+    const utility::string_t key = join_segments(segments, 0);
+    if (method == web::http::methods::PUT)
+    {
+        put_file(request, key, query);
+    }
+    else if (method == web::http::methods::GET || method == web::http::methods::HEAD)
+    {
+        get_item(request, key, true);
+    }
+    else if (method == web::http::methods::DEL)
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        bool found = m_files.erase(key) != 0;
+        reply(request, create_response(found ? web::http::status_codes::Accepted : web::http::status_codes::NotFound));
+    }
+    else
+    {
+        reply(request, create_response(web::http::status_codes::MethodNotAllowed));
+    }
+}
+
+void mock_storage_server::put_file(web::http::http_request request, const utility::string_t& key, const std::map<utility::string_t, utility::string_t>& query)
+{
+    const utility::string_t comp = query_value(query, _XPLATSTR("comp"));
+    const utility::string_t content_md5 = header_value(request.headers(), azure::storage::protocol::ms_header_content_md5);
+    const utility::string_t content_length = header_value(request.headers(), _XPLATSTR("x-ms-content-length"));
+    const utility::string_t range = header_value(request.headers(), azure::storage::protocol::ms_header_range);
+    const bool clear = header_value(request.headers(), _XPLATSTR("x-ms-write")) == _XPLATSTR("clear");
+
+    request.extract_vector().then([this, request, key, comp, content_md5, content_length, range, clear](std::vector<unsigned char> body)
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        stored_item& item = m_files[key];
+
+        if (comp.empty())
+        {
+            const utility::size64_t length = content_length.empty() ? 0 : utility::conversions::details::scan_string<utility::size64_t>(content_length);
+            item.m_data = std::make_shared<std::vector<uint8_t>>((size_t)length);
+            item.m_content_md5 = content_md5;
+        }
+        else if (comp == _XPLATSTR("range"))
+        {
+            utility::size64_t start = 0;
+            utility::size64_t end = 0;
+            if (!parse_range(range, start, end) || end < start)
+            {
+                reply(request, create_response(web::http::status_codes::BadRequest));
+                return;
+            }
+
+            // Readers may still be sending the current content, so ranges are written to a copy.
+            auto data = std::make_shared<std::vector<uint8_t>>(*item.m_data);
+            if (data->size() <= end)
+            {
+                data->resize((size_t)end + 1);
+            }
+
+            if (clear)
+            {
+                std::fill(data->begin() + (size_t)start, data->begin() + (size_t)end + 1, (uint8_t)0);
+            }
+            else
+            {
+                std::copy(body.begin(), body.begin() + (size_t)std::min<utility::size64_t>(body.size(), end - start + 1), data->begin() + (size_t)start);
+            }
+
+            item.m_data = data;
+        }
+        else if (comp == _XPLATSTR("properties"))
+        {
+            if (!content_length.empty())
+            {
+                auto data = std::make_shared<std::vector<uint8_t>>(*item.m_data);
+                data->resize((size_t)utility::conversions::details::scan_string<utility::size64_t>(content_length));
+                item.m_data = data;
+            }
+
+            if (!content_md5.empty())
+            {
+                item.m_content_md5 = content_md5;
+            }
+        }
+
+        item.m_etag = next_etag();
+
+        auto response = create_response(comp.empty() || comp == _XPLATSTR("range") ? web::http::status_codes::Created : web::http::status_codes::OK);
+        response.headers().add(web::http::header_names::etag, item.m_etag);
+        response.headers().add(web::http::header_names::last_modified, now_rfc1123());
+        response.headers().add(azure::storage::protocol::ms_header_request_server_encrypted, _XPLATSTR("false"));
+        reply(request, response);
+    });
+}
+
+web::http::http_response mock_storage_server::create_response(web::http::status_code status_code) const
+{
+    web::http::http_response response(status_code);
+    response.headers().add(azure::storage::protocol::ms_header_request_id, _XPLATSTR("00000000-0000-0000-0000-000000000000"));
+    response.headers().add(azure::storage::protocol::ms_header_version, azure::storage::protocol::header_value_storage_version);
+    response.headers().add(web::http::header_names::date, now_rfc1123());
+    return response;
+}
+
+utility::string_t mock_storage_server::next_etag()
+{
+    utility::ostringstream_t etag;
+    etag << _XPLATSTR("\"0x") << std::hex << std::uppercase << ++m_next_id << _XPLATSTR("\"");
+    return etag.str();
+}
+
+std::vector<utility::string_t> mock_storage_server::path_segments(const web::http::http_request& request)
+{
+    // The first segment is the account name of the path-style URI.
+    auto segments = web::uri::split_path(web::uri::decode(request.relative_uri().path()));
+    if (!segments.empty() && segments.front() == account_name)
+    {
+        segments.erase(segments.begin());
+    }
+
+    return segments;
+}
+
+utility::string_t mock_storage_server::join_segments(const std::vector<utility::string_t>& segments, size_t first)
+{
+    utility::string_t result;
+    for (size_t i = first; i < segments.size(); ++i)
+    {
+        if (i != first)
+        {
+            result.push_back(_XPLATSTR('/'));
+        }
+
+        result.append(segments[i]);
+    }
+
+    return result;
+}
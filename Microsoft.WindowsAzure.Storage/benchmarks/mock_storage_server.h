@@ -0,0 +1,93 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="mock_storage_server.h" company="Microsoft">
+//    Copyright 2013 Microsoft Corporation
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "stdafx.h"
+
+// An in-process HTTP server that emulates the subset of the Blob, Queue, Table and File services used by the benchmarks.
+// Each service listens on its own port of the loopback interface, so the library addresses it with path-style URIs
+// just like the storage emulator. Requests are not authenticated, and all data is kept in memory.
+class mock_storage_server
+{
+public:
+
+    explicit mock_storage_server(int base_port);
+    ~mock_storage_server();
+
+    void start();
+    void stop();
+
+    // Returns an account whose endpoints point to this server.
+    azure::storage::cloud_storage_account account() const;
+
+    // Adds blob_count empty block blobs to a container without going through HTTP, so listings can be measured on their own.
+    void seed_blobs(const utility::string_t& container_name, const utility::string_t& prefix, size_t blob_count);
+
+    // Adds message_count messages to a queue without going through HTTP, so queue reads can be measured on their own.
+    void seed_queue(const utility::string_t& queue_name, size_t message_count, const utility::string_t& message_text);
+
+    static const utility::string_t account_name;
+
+private:
+
+    struct stored_item
+    {
+        stored_item()
+            : m_data(std::make_shared<std::vector<uint8_t>>())
+        {
+        }
+
+        // Committed content is replaced as a whole, so readers can keep sending a snapshot while it is being overwritten.
+        std::shared_ptr<std::vector<uint8_t>> m_data;
+        std::map<utility::string_t, std::vector<uint8_t>> m_uncommitted_blocks;
+        utility::string_t m_content_md5;
+        utility::string_t m_etag;
+    };
+
+    struct stored_message
+    {
+        utility::string_t m_id;
+        utility::string_t m_text;
+        int m_dequeue_count;
+    };
+
+    void handle_blob(web::http::http_request request);
+    void handle_queue(web::http::http_request request);
+    void handle_table(web::http::http_request request);
+    void handle_file(web::http::http_request request);
+
+    void put_blob(web::http::http_request request, const utility::string_t& key, const std::map<utility::string_t, utility::string_t>& query);
+    void list_blobs(web::http::http_request request, const utility::string_t& container, const std::map<utility::string_t, utility::string_t>& query);
+    void put_file(web::http::http_request request, const utility::string_t& key, const std::map<utility::string_t, utility::string_t>& query);
+    void get_item(web::http::http_request request, const utility::string_t& key, bool is_file);
+
+    web::http::http_response create_response(web::http::status_code status_code) const;
+    utility::string_t next_etag();
+
+    static std::vector<utility::string_t> path_segments(const web::http::http_request& request);
+    static utility::string_t join_segments(const std::vector<utility::string_t>& segments, size_t first);
+
+    std::vector<std::unique_ptr<web::http::experimental::listener::http_listener>> m_listeners;
+    int m_base_port;
+
+    std::mutex m_mutex;
+    std::map<utility::string_t, stored_item> m_blobs;
+    std::map<utility::string_t, stored_item> m_files;
+    std::map<utility::string_t, std::deque<stored_message>> m_queues;
+    uint64_t m_next_id;
+};
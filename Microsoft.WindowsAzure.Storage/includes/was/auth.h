@@ -29,9 +29,15 @@ namespace azure { namespace storage {
 
 }} // namespace azure::storage
 
+namespace azure { namespace storage { namespace core {
+
+    class hmac_sha256_signer;
+
+}}} // namespace azure::storage::core
+
 namespace azure { namespace storage { namespace protocol {
 
-    utility::string_t calculate_hmac_sha256_hash(const utility::string_t& string_to_hash, const storage_credentials& credentials);
+    WASTORAGE_API utility::string_t calculate_hmac_sha256_hash(const utility::string_t& string_to_hash, const storage_credentials& credentials);
 
     const utility::string_t auth_name_shared_key(_XPLATSTR("SharedKey"));
     const utility::string_t auth_name_shared_key_lite(_XPLATSTR("SharedKeyLite"));
@@ -51,7 +57,18 @@ namespace azure { namespace storage { namespace protocol {
         /// <param name="request">The request to be authenticated.</param>
         /// <param name="account_name">The storage account name.</param>
         canonicalizer_helper(const web::http::http_request& request, const utility::string_t& account_name)
-            : m_request(request), m_account_name(account_name)
+            : m_request(request), m_account_name(account_name), m_result(m_own_result)
+        {
+        }
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::protocol::canonicalizer_helper" /> class that appends to an existing string.
+        /// </summary>
+        /// <param name="request">The request to be authenticated.</param>
+        /// <param name="account_name">The storage account name.</param>
+        /// <param name="result">The string to append the canonicalization string to.</param>
+        canonicalizer_helper(const web::http::http_request& request, const utility::string_t& account_name, utility::string_t& result)
+            : m_request(request), m_account_name(account_name), m_result(result)
         {
         }
 
@@ -115,7 +132,8 @@ namespace azure { namespace storage { namespace protocol {
         
         const web::http::http_request& m_request;
         const utility::string_t& m_account_name;
-        utility::string_t m_result;
+        utility::string_t m_own_result;
+        utility::string_t& m_result;
     };
 
     /// <summary>
@@ -141,6 +159,21 @@ namespace azure { namespace storage { namespace protocol {
         /// </remarks>
         virtual utility::string_t canonicalize(const web::http::http_request& request, operation_context context) const = 0;
 
+        /// <summary>
+        /// Converts the specified HTTP request data into a standard form for signing and appends it to a string.
+        /// </summary>
+        /// <param name="request">The HTTP request to be signed.</param>
+        /// <param name="result">The string to append the canonicalized request data to.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        /// <remarks>
+        /// The default implementation appends the string returned by <see cref="azure::storage::protocol::canonicalizer::canonicalize" />.
+        /// The built-in canonicalizers write straight into <paramref name="result" />, so a caller that reuses the string does not allocate for every request.
+        /// </remarks>
+        virtual void append_canonicalized(const web::http::http_request& request, utility::string_t& result, operation_context context) const
+        {
+            result.append(canonicalize(request, context));
+        }
+
         /// <summary>
         /// Gets the authentication scheme used for canonicalization.
         /// </summary>
@@ -201,6 +234,14 @@ namespace azure { namespace storage { namespace protocol {
         /// </remarks>
         WASTORAGE_API utility::string_t canonicalize(const web::http::http_request& request, operation_context context) const override;
 
+        /// <summary>
+        /// Converts the specified HTTP request data into a standard form for signing and appends it to a string.
+        /// </summary>
+        /// <param name="request">The HTTP request to be signed.</param>
+        /// <param name="result">The string to append the canonicalized request data to.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        WASTORAGE_API void append_canonicalized(const web::http::http_request& request, utility::string_t& result, operation_context context) const override;
+
         /// <summary>
         /// Gets the authentication scheme used for canonicalization.
         /// </summary>
@@ -248,6 +289,14 @@ namespace azure { namespace storage { namespace protocol {
         /// </remarks>
         WASTORAGE_API utility::string_t canonicalize(const web::http::http_request& request, operation_context context) const override;
 
+        /// <summary>
+        /// Converts the specified HTTP request data into a standard form for signing and appends it to a string.
+        /// </summary>
+        /// <param name="request">The HTTP request to be signed.</param>
+        /// <param name="result">The string to append the canonicalized request data to.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        WASTORAGE_API void append_canonicalized(const web::http::http_request& request, utility::string_t& result, operation_context context) const override;
+
         /// <summary>
         /// Gets the authentication scheme used for canonicalization.
         /// </summary>
@@ -295,6 +344,14 @@ namespace azure { namespace storage { namespace protocol {
         /// </remarks>
         WASTORAGE_API utility::string_t canonicalize(const web::http::http_request& request, operation_context context) const override;
 
+        /// <summary>
+        /// Converts the specified HTTP request data into a standard form for signing and appends it to a string.
+        /// </summary>
+        /// <param name="request">The HTTP request to be signed.</param>
+        /// <param name="result">The string to append the canonicalized request data to.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        WASTORAGE_API void append_canonicalized(const web::http::http_request& request, utility::string_t& result, operation_context context) const override;
+
         /// <summary>
         /// Gets the authentication scheme used for canonicalization.
         /// </summary>
@@ -342,6 +399,14 @@ namespace azure { namespace storage { namespace protocol {
         /// </remarks>
         WASTORAGE_API utility::string_t canonicalize(const web::http::http_request& request, operation_context context) const override;
 
+        /// <summary>
+        /// Converts the specified HTTP request data into a standard form for signing and appends it to a string.
+        /// </summary>
+        /// <param name="request">The HTTP request to be signed.</param>
+        /// <param name="result">The string to append the canonicalized request data to.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        WASTORAGE_API void append_canonicalized(const web::http::http_request& request, utility::string_t& result, operation_context context) const override;
+
         /// <summary>
         /// Gets the authentication scheme used for canonicalization.
         /// </summary>
@@ -419,10 +484,7 @@ namespace azure { namespace storage { namespace protocol {
         /// </summary>
         /// <param name="canonicalizer">The canonicalizer to use to sign the request.</param>
         /// <param name="credentials">The <see cref="azure::storage::storage_credentials" /> to use to sign the request.</param>
-        shared_key_authentication_handler(std::shared_ptr<canonicalizer> canonicalizer, storage_credentials credentials)
-            : m_canonicalizer(canonicalizer), m_credentials(std::move(credentials))
-        {
-        }
+        WASTORAGE_API shared_key_authentication_handler(std::shared_ptr<canonicalizer> canonicalizer, storage_credentials credentials);
 
         /// <summary>
         /// Sign the specified request for authentication via Shared Key.
@@ -435,6 +497,9 @@ namespace azure { namespace storage { namespace protocol {
         
         std::shared_ptr<canonicalizer> m_canonicalizer;
         storage_credentials m_credentials;
+
+        // The account key hashed into the HMAC state once, so signing a request does not process the key again
+        std::shared_ptr<core::hmac_sha256_signer> m_signer;
     };
 
 #pragma endregion
@@ -43,6 +43,7 @@ namespace azure { namespace storage {
         class block_list_reader;
         class list_containers_reader;
         class list_blobs_reader;
+        class compact_list_blobs_reader;
     }
 
     namespace core
@@ -1231,6 +1232,239 @@ namespace azure { namespace storage {
     typedef result_segment<list_blob_item> list_blob_item_segment;
     typedef result_iterator<list_blob_item> list_blob_item_iterator;
 
+    class compact_list_blob_item;
+
+    /// <summary>
+    /// Represents a segment of a compact blob listing.
+    /// </summary>
+    /// <remarks>
+    /// The items are kept as packed records in one array, and their names, snapshot times, ETags and metadata in one shared string buffer,
+    /// so listing a large container does not allocate memory for every blob.
+    /// </remarks>
+    class compact_list_blob_item_segment
+    {
+    public:
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::compact_list_blob_item_segment" /> class.
+        /// </summary>
+        compact_list_blob_item_segment()
+            : m_strings(1, utility::char_t())
+        {
+        }
+
+#if defined(_MSC_VER) && _MSC_VER < 1900
+        // Compilers that fully support C++ 11 rvalue reference, e.g. g++ 4.8+, clang++ 3.3+ and Visual Studio 2015+, 
+        // have implicitly-declared move constructor and move assignment operator.
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::compact_list_blob_item_segment" /> class based on an existing instance.
+        /// </summary>
+        /// <param name="other">An existing <see cref="azure::storage::compact_list_blob_item_segment" /> object.</param>
+        compact_list_blob_item_segment(compact_list_blob_item_segment&& other)
+        {
+            *this = std::move(other);
+        }
+
+        /// <summary>
+        /// Returns a reference to an <see cref="azure::storage::compact_list_blob_item_segment" /> object.
+        /// </summary>
+        /// <param name="other">An existing <see cref="azure::storage::compact_list_blob_item_segment" /> object to use to set properties.</param>
+        /// <returns>An <see cref="azure::storage::compact_list_blob_item_segment" /> object with properties set.</returns>
+        compact_list_blob_item_segment& operator=(compact_list_blob_item_segment&& other)
+        {
+            if (this != &other)
+            {
+                m_items = std::move(other.m_items);
+                m_strings = std::move(other.m_strings);
+                m_metadata = std::move(other.m_metadata);
+                m_continuation_token = std::move(other.m_continuation_token);
+            }
+            return *this;
+        }
+#endif
+
+        /// <summary>
+        /// Gets the number of items in the segment.
+        /// </summary>
+        /// <returns>The number of items.</returns>
+        size_t size() const
+        {
+            return m_items.size();
+        }
+
+        /// <summary>
+        /// Gets a value indicating whether the segment has no items.
+        /// </summary>
+        /// <returns><c>true</c> if the segment has no items; otherwise, <c>false</c>.</returns>
+        bool empty() const
+        {
+            return m_items.empty();
+        }
+
+        /// <summary>
+        /// Gets an item of the segment.
+        /// </summary>
+        /// <param name="index">The index of the item.</param>
+        /// <returns>A <see cref="azure::storage::compact_list_blob_item" /> object that reads the item from this segment.</returns>
+        compact_list_blob_item operator[](size_t index) const;
+
+        /// <summary>
+        /// Gets the continuation token to use to retrieve the next segment.
+        /// </summary>
+        /// <returns>An <see cref="azure::storage::continuation_token" /> object.</returns>
+        const azure::storage::continuation_token& continuation_token() const
+        {
+            return m_continuation_token;
+        }
+
+    private:
+
+        // String fields are offsets into m_strings, where every string is followed by a null character.
+        // Offset 0 is the empty string.
+        struct item
+        {
+            uint32_t name;
+            uint32_t snapshot_time;
+            uint32_t etag;
+            uint32_t metadata_begin;
+            uint32_t metadata_count;
+            utility::size64_t size;
+            utility::datetime last_modified;
+            blob_type type;
+            bool is_blob;
+        };
+
+        std::vector<item> m_items;
+        std::vector<utility::char_t> m_strings;
+        std::vector<std::pair<uint32_t, uint32_t>> m_metadata;
+        azure::storage::continuation_token m_continuation_token;
+
+        friend class compact_list_blob_item;
+        friend class protocol::compact_list_blobs_reader;
+    };
+
+    /// <summary>
+    /// Represents a blob or a virtual directory in a <see cref="azure::storage::compact_list_blob_item_segment" />.
+    /// </summary>
+    /// <remarks>
+    /// The item reads its fields from the segment it came from, which must outlive it. The returned strings are owned by the segment.
+    /// </remarks>
+    class compact_list_blob_item
+    {
+    public:
+
+        /// <summary>
+        /// Gets a value indicating whether the item is a blob or a virtual directory.
+        /// </summary>
+        /// <returns><c>true</c> if the item is a blob; <c>false</c> if it is a virtual directory.</returns>
+        bool is_blob() const
+        {
+            return m_item->is_blob;
+        }
+
+        /// <summary>
+        /// Gets the name of the blob, or the prefix of the virtual directory.
+        /// </summary>
+        /// <returns>A null-terminated string containing the name.</returns>
+        const utility::char_t* name() const
+        {
+            return m_strings + m_item->name;
+        }
+
+        /// <summary>
+        /// Gets the snapshot time of the blob.
+        /// </summary>
+        /// <returns>A null-terminated string containing the snapshot time, or an empty string if the blob is not a snapshot.</returns>
+        const utility::char_t* snapshot_time() const
+        {
+            return m_strings + m_item->snapshot_time;
+        }
+
+        /// <summary>
+        /// Gets the ETag value of the blob.
+        /// </summary>
+        /// <returns>A null-terminated string containing the ETag value, or an empty string for a virtual directory.</returns>
+        const utility::char_t* etag() const
+        {
+            return m_strings + m_item->etag;
+        }
+
+        /// <summary>
+        /// Gets the size of the blob, in bytes.
+        /// </summary>
+        /// <returns>The blob's size in bytes.</returns>
+        utility::size64_t size() const
+        {
+            return m_item->size;
+        }
+
+        /// <summary>
+        /// Gets the last-modified time of the blob.
+        /// </summary>
+        /// <returns>The blob's last-modified time, in UTC format.</returns>
+        utility::datetime last_modified() const
+        {
+            return m_item->last_modified;
+        }
+
+        /// <summary>
+        /// Gets the type of the blob.
+        /// </summary>
+        /// <returns>An <see cref="azure::storage::blob_type" /> object that indicates the type of the blob.</returns>
+        blob_type type() const
+        {
+            return m_item->type;
+        }
+
+        /// <summary>
+        /// Gets the number of metadata entries of the blob. Metadata is only listed when it is requested.
+        /// </summary>
+        /// <returns>The number of metadata entries.</returns>
+        size_t metadata_count() const
+        {
+            return m_item->metadata_count;
+        }
+
+        /// <summary>
+        /// Gets the name of a metadata entry of the blob.
+        /// </summary>
+        /// <param name="index">The index of the metadata entry.</param>
+        /// <returns>A null-terminated string containing the name.</returns>
+        const utility::char_t* metadata_name(size_t index) const
+        {
+            return m_strings + m_metadata[m_item->metadata_begin + index].first;
+        }
+
+        /// <summary>
+        /// Gets the value of a metadata entry of the blob.
+        /// </summary>
+        /// <param name="index">The index of the metadata entry.</param>
+        /// <returns>A null-terminated string containing the value.</returns>
+        const utility::char_t* metadata_value(size_t index) const
+        {
+            return m_strings + m_metadata[m_item->metadata_begin + index].second;
+        }
+
+    private:
+
+        compact_list_blob_item(const compact_list_blob_item_segment& segment, size_t index)
+            : m_item(&segment.m_items[index]), m_strings(segment.m_strings.data()), m_metadata(segment.m_metadata.data())
+        {
+        }
+
+        const compact_list_blob_item_segment::item* m_item;
+        const utility::char_t* m_strings;
+        const std::pair<uint32_t, uint32_t>* m_metadata;
+
+        friend class compact_list_blob_item_segment;
+    };
+
+    inline compact_list_blob_item compact_list_blob_item_segment::operator[](size_t index) const
+    {
+        return compact_list_blob_item(*this, index);
+    }
+
     typedef result_segment<cloud_blob_container> container_result_segment;
     typedef result_iterator<cloud_blob_container> container_result_iterator;
 
@@ -1774,13 +2008,16 @@ namespace azure { namespace storage {
         blob_request_options()
             : request_options(),
             m_use_transactional_md5(false),
+            m_use_transactional_crc64(false),
             m_store_blob_content_md5(false),
             m_disable_content_md5_validation(false),
             m_parallelism_factor(1),
             m_single_blob_upload_threshold(protocol::default_single_blob_upload_threshold),
             m_stream_write_size(protocol::default_stream_write_size),
             m_stream_read_size(protocol::default_stream_read_size),
-            m_absorb_conditional_errors_on_retry(false)
+            m_absorb_conditional_errors_on_retry(false),
+            m_use_adaptive_upload(false),
+            m_read_ahead_range_count(0)
         {
         }
 
@@ -1808,6 +2045,7 @@ namespace azure { namespace storage {
             {
                 request_options::operator=(std::move(other));
                 m_use_transactional_md5 = std::move(other.m_use_transactional_md5);
+                m_use_transactional_crc64 = std::move(other.m_use_transactional_crc64);
                 m_store_blob_content_md5 = std::move(other.m_store_blob_content_md5);
                 m_disable_content_md5_validation = std::move(other.m_disable_content_md5_validation);
                 m_parallelism_factor = std::move(other.m_parallelism_factor);
@@ -1815,6 +2053,8 @@ namespace azure { namespace storage {
                 m_stream_write_size = std::move(other.m_stream_write_size);
                 m_stream_read_size = std::move(other.m_stream_read_size);
                 m_absorb_conditional_errors_on_retry = std::move(other.m_absorb_conditional_errors_on_retry);
+                m_use_adaptive_upload = std::move(other.m_use_adaptive_upload);
+                m_read_ahead_range_count = std::move(other.m_read_ahead_range_count);
             }
             return *this;
         }
@@ -1843,12 +2083,15 @@ namespace azure { namespace storage {
             }
 
             m_use_transactional_md5.merge(other.m_use_transactional_md5);
+            m_use_transactional_crc64.merge(other.m_use_transactional_crc64);
             m_disable_content_md5_validation.merge(other.m_disable_content_md5_validation);
             m_parallelism_factor.merge(other.m_parallelism_factor);
             m_single_blob_upload_threshold.merge(other.m_single_blob_upload_threshold);
             m_stream_write_size.merge(other.m_stream_write_size);
             m_stream_read_size.merge(other.m_stream_read_size);
             m_absorb_conditional_errors_on_retry.merge(other.m_absorb_conditional_errors_on_retry);
+            m_use_adaptive_upload.merge(other.m_use_adaptive_upload);
+            m_read_ahead_range_count.merge(other.m_read_ahead_range_count);
         }
 
         /// <summary>
@@ -1869,6 +2112,28 @@ namespace azure { namespace storage {
             m_use_transactional_md5 = value;
         }
 
+        /// <summary>
+        /// Gets a value indicating whether a CRC64 checksum will be calculated and validated for the request.
+        /// </summary>
+        /// <returns><c>true</c> if a CRC64 checksum will be calculated and validated for the request; otherwise, <c>false</c>.</returns>
+        bool use_transactional_crc64() const
+        {
+            return m_use_transactional_crc64;
+        }
+
+        /// <summary>
+        /// Indicates whether to calculate and validate a CRC64 checksum for the request, which is cheaper to compute than a content-MD5 hash.
+        /// </summary>
+        /// <param name="value"><c>true</c> to calculate and validate a CRC64 checksum for the request; otherwise, <c>false</c>.</param>
+        /// <remarks>
+        /// When both a CRC64 checksum and a content-MD5 hash are requested, transactional validation uses the CRC64 checksum.
+        /// A content-MD5 hash that is passed in explicitly is still sent with the request.
+        /// </remarks>
+        void set_use_transactional_crc64(bool value)
+        {
+            m_use_transactional_crc64 = value;
+        }
+
         /// <summary>
         /// Gets a value indicating whether the content-MD5 hash will be calculated and stored when uploading a blob.
         /// </summary>
@@ -1966,6 +2231,29 @@ namespace azure { namespace storage {
             m_stream_read_size = value;
         }
 
+        /// <summary>
+        /// Gets the number of ranges that a blob stream downloads ahead of the reader while the blob is read sequentially.
+        /// </summary>
+        /// <returns>The number of ranges, each <see cref="stream_read_size_in_bytes" /> long, to download ahead. Zero disables read-ahead.</returns>
+        int read_ahead_range_count() const
+        {
+            return m_read_ahead_range_count;
+        }
+
+        /// <summary>
+        /// Sets the number of ranges that a blob stream downloads ahead of the reader while the blob is read sequentially.
+        /// At most <see cref="parallelism_factor" /> ranges are downloaded ahead, and the range the reader is waiting for is downloaded
+        /// on top of those. Read-ahead stops when the reader seeks away from the current position and resumes once the reader has been
+        /// reading sequentially again. Ranges requested before the seek are not cancelled; they finish in the background and their data
+        /// is discarded, so shortly after a seek more ranges than that can be in flight.
+        /// </summary>
+        /// <param name="value">The number of ranges, each <see cref="stream_read_size_in_bytes" /> long, to download ahead. Zero disables read-ahead.</param>
+        void set_read_ahead_range_count(int value)
+        {
+            utility::assert_in_bounds(_XPLATSTR("value"), value, 0);
+            m_read_ahead_range_count = value;
+        }
+
         /// <summary>
         /// Gets the minimum number of bytes to buffer when writing to a blob stream.
         /// </summary>
@@ -2009,9 +2297,31 @@ namespace azure { namespace storage {
             m_absorb_conditional_errors_on_retry = value;
         }
 
+        /// <summary>
+        /// Gets a value indicating whether block blob uploads tune the block size and the number of blocks in flight while uploading.
+        /// </summary>
+        /// <returns><c>true</c> if block blob uploads are tuned while uploading; otherwise, <c>false</c>.</returns>
+        bool use_adaptive_upload() const
+        {
+            return m_use_adaptive_upload;
+        }
+
+        /// <summary>
+        /// Indicates whether block blob uploads tune the block size and the number of blocks in flight while uploading.
+        /// When enabled, the upload starts at <see cref="stream_write_size_in_bytes" /> and half of <see cref="parallelism_factor" />,
+        /// grows either value while the measured throughput improves, and backs off when the service throttles or times out requests.
+        /// The block size never goes below <see cref="stream_write_size_in_bytes" /> and the number of blocks in flight never exceeds <see cref="parallelism_factor" />.
+        /// </summary>
+        /// <param name="value"><c>true</c> to tune block blob uploads while uploading; otherwise, <c>false</c>.</param>
+        void set_use_adaptive_upload(bool value)
+        {
+            m_use_adaptive_upload = value;
+        }
+
     private:
 
         option_with_default<bool> m_use_transactional_md5;
+        option_with_default<bool> m_use_transactional_crc64;
         option_with_default<bool> m_store_blob_content_md5;
         option_with_default<bool> m_disable_content_md5_validation;
         option_with_default<int> m_parallelism_factor;
@@ -2019,6 +2329,8 @@ namespace azure { namespace storage {
         option_with_default<size_t> m_stream_write_size;
         option_with_default<size_t> m_stream_read_size;
         option_with_default<bool> m_absorb_conditional_errors_on_retry;
+        option_with_default<bool> m_use_adaptive_upload;
+        option_with_default<int> m_read_ahead_range_count;
     };
 
     /// <summary>
@@ -3944,6 +4256,119 @@ namespace azure { namespace storage {
         /// <returns>A <see cref="pplx::task" /> object of type <see cref="azure::storage::list_blob_item_segment" /> that represents the current operation.</returns>
         WASTORAGE_API pplx::task<list_blob_item_segment> list_blobs_segmented_async(const utility::string_t& prefix, bool use_flat_blob_listing, blob_listing_details::values includes, int max_results, const continuation_token& token, const blob_request_options& options, operation_context context, const pplx::cancellation_token& cancellation_token) const;
 
+        /// <summary>
+        /// Returns a <see cref="azure::storage::compact_list_blob_item_segment" /> containing the names, sizes, ETags and last-modified times of blob items in the container.
+        /// </summary>
+        /// <param name="prefix">The blob name prefix.</param>
+        /// <param name="use_flat_blob_listing">Indicates whether to list blobs in a flat listing, or whether to list blobs hierarchically, by virtual directory.</param>
+        /// <param name="includes">An <see cref="azure::storage::blob_listing_details::values" /> enumeration describing which items to include in the listing. Only metadata and snapshots are supported.</param>
+        /// <param name="max_results">A non-negative integer value that indicates the maximum number of results to be returned at a time, up to the 
+        /// per-operation limit of 5000. If this value is 0, the maximum possible number of results will be returned, up to 5000.</param>
+        /// <param name="token">An <see cref="azure::storage::continuation_token" /> returned by a previous listing operation.</param>
+        /// <param name="options">An <see cref="azure::storage::blob_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        /// <returns>A <see cref="azure::storage::compact_list_blob_item_segment" /> containing blob items in the container.</returns>
+        compact_list_blob_item_segment list_blobs_compact_segmented(const utility::string_t& prefix, bool use_flat_blob_listing, blob_listing_details::values includes, int max_results, const continuation_token& token, const blob_request_options& options, operation_context context) const
+        {
+            return list_blobs_compact_segmented_async(prefix, use_flat_blob_listing, includes, max_results, token, options, context).get();
+        }
+
+        /// <summary>
+        /// Initiates an asynchronous operation to return a <see cref="azure::storage::compact_list_blob_item_segment" /> containing the names, sizes, ETags and last-modified times of blob items in the container.
+        /// </summary>
+        /// <param name="prefix">The blob name prefix.</param>
+        /// <param name="use_flat_blob_listing">Indicates whether to list blobs in a flat listing, or whether to list blobs hierarchically, by virtual directory.</param>
+        /// <param name="includes">An <see cref="azure::storage::blob_listing_details::values" /> enumeration describing which items to include in the listing. Only metadata and snapshots are supported.</param>
+        /// <param name="max_results">A non-negative integer value that indicates the maximum number of results to be returned at a time, up to the 
+        /// per-operation limit of 5000. If this value is 0, the maximum possible number of results will be returned, up to 5000.</param>
+        /// <param name="token">An <see cref="azure::storage::continuation_token" /> returned by a previous listing operation.</param>
+        /// <param name="options">An <see cref="azure::storage::blob_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        /// <returns>A <see cref="pplx::task" /> object of type <see cref="azure::storage::compact_list_blob_item_segment" /> that represents the current operation.</returns>
+        pplx::task<compact_list_blob_item_segment> list_blobs_compact_segmented_async(const utility::string_t& prefix, bool use_flat_blob_listing, blob_listing_details::values includes, int max_results, const continuation_token& token, const blob_request_options& options, operation_context context) const
+        {
+            return list_blobs_compact_segmented_async(prefix, use_flat_blob_listing, includes, max_results, token, options, context, pplx::cancellation_token::none());
+        }
+
+        /// <summary>
+        /// Initiates an asynchronous operation to return a <see cref="azure::storage::compact_list_blob_item_segment" /> containing the names, sizes, ETags and last-modified times of blob items in the container.
+        /// </summary>
+        /// <param name="prefix">The blob name prefix.</param>
+        /// <param name="use_flat_blob_listing">Indicates whether to list blobs in a flat listing, or whether to list blobs hierarchically, by virtual directory.</param>
+        /// <param name="includes">An <see cref="azure::storage::blob_listing_details::values" /> enumeration describing which items to include in the listing. Only metadata and snapshots are supported.</param>
+        /// <param name="max_results">A non-negative integer value that indicates the maximum number of results to be returned at a time, up to the 
+        /// per-operation limit of 5000. If this value is 0, the maximum possible number of results will be returned, up to 5000.</param>
+        /// <param name="token">An <see cref="azure::storage::continuation_token" /> returned by a previous listing operation.</param>
+        /// <param name="options">An <see cref="azure::storage::blob_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        /// <param name="cancellation_token">An <see cref="pplx::cancellation_token" /> object that is used to cancel the current operation.</param>
+        /// <returns>A <see cref="pplx::task" /> object of type <see cref="azure::storage::compact_list_blob_item_segment" /> that represents the current operation.</returns>
+        /// <remarks>
+        /// Unlike <see cref="azure::storage::cloud_blob_container::list_blobs_segmented_async" />, the segment does not hold blob objects with their full properties,
+        /// which makes it suitable for enumerating containers with a very large number of blobs.
+        /// </remarks>
+        WASTORAGE_API pplx::task<compact_list_blob_item_segment> list_blobs_compact_segmented_async(const utility::string_t& prefix, bool use_flat_blob_listing, blob_listing_details::values includes, int max_results, const continuation_token& token, const blob_request_options& options, operation_context context, const pplx::cancellation_token& cancellation_token) const;
+
+        /// <summary>
+        /// Intitiates an asynchronous operation to list every blob in the container whose name starts with the prefix, listing virtual directories in parallel.
+        /// </summary>
+        /// <param name="prefix">The blob name prefix.</param>
+        /// <param name="consumer">The function that is called for each blob.</param>
+        /// <returns>A <see cref="pplx::task" /> object that represents the current operation.</returns>
+        pplx::task<void> list_blobs_parallel_async(const utility::string_t& prefix, const std::function<void(const list_blob_item&)>& consumer) const
+        {
+            return list_blobs_parallel_async(prefix, blob_listing_details::none, protocol::default_listing_parallelism, consumer, blob_request_options(), operation_context());
+        }
+
+        /// <summary>
+        /// Lists every blob in the container whose name starts with the prefix, listing virtual directories in parallel.
+        /// </summary>
+        /// <param name="prefix">The blob name prefix.</param>
+        /// <param name="includes">An <see cref="azure::storage::blob_listing_details::values" /> enumeration describing which items to include in the listing. Snapshots are not supported.</param>
+        /// <param name="parallelism">The maximum number of listing requests that are sent at the same time.</param>
+        /// <param name="consumer">The function that is called for each blob.</param>
+        /// <param name="options">An <see cref="azure::storage::blob_request_options" /> object that specifies additional options for the requests.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the requests.</param>
+        void list_blobs_parallel(const utility::string_t& prefix, blob_listing_details::values includes, int parallelism, const std::function<void(const list_blob_item&)>& consumer, const blob_request_options& options, operation_context context) const
+        {
+            list_blobs_parallel_async(prefix, includes, parallelism, consumer, options, context).wait();
+        }
+
+        /// <summary>
+        /// Intitiates an asynchronous operation to list every blob in the container whose name starts with the prefix, listing virtual directories in parallel.
+        /// </summary>
+        /// <param name="prefix">The blob name prefix.</param>
+        /// <param name="includes">An <see cref="azure::storage::blob_listing_details::values" /> enumeration describing which items to include in the listing. Snapshots are not supported.</param>
+        /// <param name="parallelism">The maximum number of listing requests that are sent at the same time.</param>
+        /// <param name="consumer">The function that is called for each blob.</param>
+        /// <param name="options">An <see cref="azure::storage::blob_request_options" /> object that specifies additional options for the requests.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the requests.</param>
+        /// <returns>A <see cref="pplx::task" /> object that represents the current operation.</returns>
+        pplx::task<void> list_blobs_parallel_async(const utility::string_t& prefix, blob_listing_details::values includes, int parallelism, const std::function<void(const list_blob_item&)>& consumer, const blob_request_options& options, operation_context context) const
+        {
+            return list_blobs_parallel_async(prefix, includes, parallelism, consumer, options, context, pplx::cancellation_token::none());
+        }
+
+        /// <summary>
+        /// Intitiates an asynchronous operation to list every blob in the container whose name starts with the prefix, listing virtual directories in parallel.
+        /// </summary>
+        /// <param name="prefix">The blob name prefix.</param>
+        /// <param name="includes">An <see cref="azure::storage::blob_listing_details::values" /> enumeration describing which items to include in the listing. Snapshots are not supported.</param>
+        /// <param name="parallelism">The maximum number of listing requests that are sent at the same time.</param>
+        /// <param name="consumer">The function that is called for each blob.</param>
+        /// <param name="options">An <see cref="azure::storage::blob_request_options" /> object that specifies additional options for the requests.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the requests.</param>
+        /// <param name="cancellation_token">An <see cref="pplx::cancellation_token" /> object that is used to cancel the current operation.</param>
+        /// <returns>A <see cref="pplx::task" /> object that represents the current operation.</returns>
+        /// <remarks>
+        /// A single listing has to follow one chain of continuation tokens. This operation lists the prefix hierarchically instead, and starts
+        /// a separate chain for every virtual directory it finds, so the key space is split up as it is discovered. Only blobs are passed to the consumer.
+        /// The consumer is never called concurrently, and blobs of one virtual directory are passed in order, but directories are interleaved.
+        /// If a request or the consumer fails, the remaining listings are canceled and the task fails with the first error.
+        /// A container that has no virtual directories under the prefix is listed by a single chain.
+        /// </remarks>
+        WASTORAGE_API pplx::task<void> list_blobs_parallel_async(const utility::string_t& prefix, blob_listing_details::values includes, int parallelism, const std::function<void(const list_blob_item&)>& consumer, const blob_request_options& options, operation_context context, const pplx::cancellation_token& cancellation_token) const;
+
         /// <summary>
         /// Sets permissions for the container.
         /// </summary>
@@ -6488,7 +6913,7 @@ namespace azure { namespace storage {
         /// <returns>A <see cref="pplx::task" /> object that represents the current operation.</returns>
         pplx::task<void> upload_block_async(const utility::string_t& block_id, concurrency::streams::istream block_data, const utility::string_t& content_md5, const access_condition& condition, const blob_request_options& options, operation_context context, const pplx::cancellation_token& cancellation_token) const
         {
-            return upload_block_async_impl(block_id, block_data, content_md5, condition, options, context, cancellation_token, true);
+            return upload_block_async_impl(block_id, block_data, content_md5, utility::string_t(), condition, options, context, cancellation_token, true);
         }
 
         /// <summary>
@@ -6778,8 +7203,10 @@ namespace azure { namespace storage {
         }
 
         WASTORAGE_API pplx::task<concurrency::streams::ostream> open_write_async_impl(const access_condition& condition, const blob_request_options& options, operation_context context, const pplx::cancellation_token& cancellation_token, bool use_request_level_timeout = false, std::shared_ptr<core::timer_handler> timer_handler = nullptr);
-        WASTORAGE_API pplx::task<void> upload_block_async_impl(const utility::string_t& block_id, concurrency::streams::istream block_data, const utility::string_t& content_md5, const access_condition& condition, const blob_request_options& options, operation_context context, const pplx::cancellation_token& cancellation_token, bool use_timeout, std::shared_ptr<core::timer_handler> timer_handler = nullptr) const;
+        WASTORAGE_API pplx::task<void> upload_block_async_impl(const utility::string_t& block_id, concurrency::streams::istream block_data, const utility::string_t& content_md5, const utility::string_t& content_crc64, const access_condition& condition, const blob_request_options& options, operation_context context, const pplx::cancellation_token& cancellation_token, bool use_timeout, std::shared_ptr<core::timer_handler> timer_handler = nullptr) const;
         WASTORAGE_API pplx::task<void> upload_block_list_async_impl(const std::vector<block_list_item>& block_list, const access_condition& condition, const blob_request_options& options, operation_context context, const pplx::cancellation_token& cancellation_token, bool use_timeout, std::shared_ptr<core::timer_handler> timer_handler = nullptr);
+        pplx::task<void> check_access_condition_async(const access_condition& condition, const blob_request_options& options, operation_context context, const pplx::cancellation_token& cancellation_token, std::shared_ptr<core::timer_handler> timer_handler);
+        static void fit_block_size_to_block_limit(utility::size64_t length, blob_request_options& options);
 
         friend class cloud_blob_container;
         friend class cloud_blob_directory;
@@ -7337,7 +7764,7 @@ namespace azure { namespace storage {
         /// <returns>A <see cref="pplx::task" /> object that represents the current operation.</returns>
         pplx::task<void> upload_pages_async(concurrency::streams::istream source, int64_t start_offset, const utility::string_t& content_md5, const access_condition& condition, const blob_request_options& options, operation_context context, const pplx::cancellation_token& cancellation_token)
         {
-            return upload_pages_async_impl(source, start_offset, content_md5, condition, options, context, cancellation_token, true);
+            return upload_pages_async_impl(source, start_offset, content_md5, utility::string_t(), condition, options, context, cancellation_token, true);
         }
 
         /// <summary>
@@ -7968,7 +8395,7 @@ namespace azure { namespace storage {
             set_type(blob_type::page_blob);
         }
 
-        WASTORAGE_API pplx::task<void> upload_pages_async_impl(concurrency::streams::istream source, int64_t start_offset, const utility::string_t& content_md5, const access_condition& condition, const blob_request_options& options, operation_context context, const pplx::cancellation_token& cancellation_token, bool use_timeout, std::shared_ptr<core::timer_handler> timer_handler = nullptr);
+        WASTORAGE_API pplx::task<void> upload_pages_async_impl(concurrency::streams::istream source, int64_t start_offset, const utility::string_t& content_md5, const utility::string_t& content_crc64, const access_condition& condition, const blob_request_options& options, operation_context context, const pplx::cancellation_token& cancellation_token, bool use_timeout, std::shared_ptr<core::timer_handler> timer_handler = nullptr);
         WASTORAGE_API pplx::task<concurrency::streams::ostream> open_write_async_impl(utility::size64_t size, int64_t sequence_number, const access_condition& condition, const blob_request_options& options, operation_context context, const pplx::cancellation_token& cancellation_token, bool use_request_level_timeout, std::shared_ptr<core::timer_handler> timer_handler = nullptr);
 
         friend class cloud_blob_container;
@@ -8160,7 +8587,7 @@ namespace azure { namespace storage {
         /// <returns>A <see cref="pplx::task" /> object that represents the current operation.</returns>
         pplx::task<int64_t> append_block_async(concurrency::streams::istream block_data, const utility::string_t& content_md5, const access_condition& condition, const blob_request_options& options, operation_context context, const pplx::cancellation_token& cancellation_token) const
         {
-            return append_block_async_impl(block_data, content_md5, condition, options, context, cancellation_token, true);
+            return append_block_async_impl(block_data, content_md5, utility::string_t(), condition, options, context, cancellation_token, true);
         }
         /// <summary>
         /// Downloads the blob's contents as a string.
@@ -8865,7 +9292,7 @@ namespace azure { namespace storage {
         /// <param name="cancellation_token">An <see cref="pplx::cancellation_token" /> object that is used to cancel the current operation.</param>
         /// <returns>A <see cref="pplx::task" /> object that represents the current operation.</returns>
         pplx::task<void> upload_from_stream_internal_async(concurrency::streams::istream source, utility::size64_t length, bool create_new, const access_condition& condition, const blob_request_options& options, operation_context context, const pplx::cancellation_token& cancellation_token, std::shared_ptr<core::timer_handler> timer_handler = nullptr);
-        WASTORAGE_API pplx::task<int64_t> append_block_async_impl(concurrency::streams::istream block_data, const utility::string_t& content_md5, const access_condition& condition, const blob_request_options& options, operation_context context, const pplx::cancellation_token& cancellation_token, bool use_timeout, std::shared_ptr<core::timer_handler> timer_handler = nullptr) const;
+        WASTORAGE_API pplx::task<int64_t> append_block_async_impl(concurrency::streams::istream block_data, const utility::string_t& content_md5, const utility::string_t& content_crc64, const access_condition& condition, const blob_request_options& options, operation_context context, const pplx::cancellation_token& cancellation_token, bool use_timeout, std::shared_ptr<core::timer_handler> timer_handler = nullptr) const;
         WASTORAGE_API pplx::task<concurrency::streams::ostream> open_write_async_impl(bool create_new, const access_condition& condition, const blob_request_options& options, operation_context context, const pplx::cancellation_token& cancellation_token, bool use_request_level_timeout, std::shared_ptr<core::timer_handler> timer_handler = nullptr);
         WASTORAGE_API pplx::task<void> create_or_replace_async_impl(const access_condition& condition, const blob_request_options& options, operation_context context, const pplx::cancellation_token& cancellation_token, std::shared_ptr<core::timer_handler> timer_handler = nullptr);
 
@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <deque>
 #include <iterator>
 #include <unordered_map>
 
@@ -283,6 +284,43 @@ namespace azure { namespace storage {
             fetch_first_segment();
         }
 
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::result_iterator{result_type}" /> class that requests segments ahead of the consumer.
+        /// </summary>
+        /// <param name="result_generator">The asynchronous result segment generator.</param>
+        /// <param name="max_results">A non-negative integer value that indicates the maximum number of results to be returned 
+        /// by the result iterator. If this value is 0, the maximum possible number of results will be returned.</param>
+        /// <param name="max_results_per_segment">A non-negative integer value that indicates the maximum number of results to 
+        /// be returned in one segment. If this value is 0, the maximum possible number of results returned in a segment will be
+        ///  determined by individual service.</param>
+        /// <param name="prefetch_depth">The number of segments to request ahead of the segment being enumerated. If this value is 0,
+        /// a segment is only requested once the previous one has been enumerated.</param>
+        /// <remarks>
+        /// Segments are still requested one after another, because each request needs the continuation token of the previous one.
+        /// Prefetched segments are held in memory until they are enumerated, and requests that are in flight when the iterator is
+        /// destroyed run to completion. Once a request fails, incrementing the iterator past the last segment received keeps throwing.
+        /// </remarks>
+        result_iterator(std::function<pplx::task<result_segment<result_type>>(const continuation_token &, size_t)> result_generator, utility::size64_t max_results, size_t max_results_per_segment, size_t prefetch_depth) :
+            m_segment_index(0),
+            m_returned_results(0),
+            m_max_results(max_results),
+            m_max_results_per_segment(max_results_per_segment)
+        {
+            if (prefetch_depth == 0)
+            {
+                m_result_generator = [result_generator](const continuation_token& token, size_t segment_max_results) -> result_segment<result_type>
+                {
+                    return result_generator(token, segment_max_results).get();
+                };
+            }
+            else
+            {
+                m_prefetcher = std::make_shared<segment_prefetcher>(std::move(result_generator), max_results, max_results_per_segment, prefetch_depth);
+            }
+
+            fetch_first_segment();
+        }
+
 #if defined(_MSC_VER) && _MSC_VER < 1900
         // Compilers that fully support C++ 11 rvalue reference, e.g. g++ 4.8+, clang++ 3.3+ and Visual Studio 2015+, 
         // have implicitly-declared move constructor and move assignment operator.
@@ -311,6 +349,7 @@ namespace azure { namespace storage {
                 m_returned_results = other.m_returned_results;
                 m_max_results = other.m_max_results;
                 m_max_results_per_segment = other.m_max_results_per_segment;
+                m_prefetcher = std::move(other.m_prefetcher);
             }
 
             return *this;
@@ -393,9 +432,147 @@ namespace azure { namespace storage {
 
     private:
 
+        // Holds the requests issued ahead of the consumer. Each request is chained on the previous one, since it needs its continuation token.
+        class segment_prefetcher
+        {
+        public:
+
+            segment_prefetcher(std::function<pplx::task<result_segment<result_type>>(const continuation_token &, size_t)> result_generator, utility::size64_t max_results, size_t max_results_per_segment, size_t prefetch_depth)
+                : m_state(std::make_shared<chain_state>()), m_prefetch_depth(prefetch_depth), m_finished(false)
+            {
+                m_state->m_result_generator = std::move(result_generator);
+                m_state->m_max_results = max_results;
+                m_state->m_max_results_per_segment = max_results_per_segment;
+                m_state->m_fetched_results = 0;
+
+                m_tail = request_segment(m_state, continuation_token(), true);
+                m_pending.push_back(m_tail);
+                top_up();
+            }
+
+            ~segment_prefetcher()
+            {
+                // Failures of segments that were never enumerated must still be observed.
+                for (auto& pending : m_pending)
+                {
+                    pending.then([](pplx::task<std::shared_ptr<prefetched_segment>> segment_task)
+                    {
+                        try
+                        {
+                            segment_task.wait();
+                        }
+                        catch (...)
+                        {
+                        }
+                    });
+                }
+            }
+
+            // Waits for the oldest outstanding segment and starts the next request. Throws the request failure, if any, without consuming the segment.
+            result_segment<result_type> take()
+            {
+                if (m_pending.empty())
+                {
+                    return result_segment<result_type>();
+                }
+
+                std::shared_ptr<prefetched_segment> segment = m_pending.front().get();
+                m_pending.pop_front();
+                if (segment->m_last)
+                {
+                    // Whatever is still queued was chained after the last segment and carries no results.
+                    m_finished = true;
+                    m_pending.clear();
+                }
+                else
+                {
+                    top_up();
+                }
+
+                return std::move(segment->m_segment);
+            }
+
+        private:
+
+            struct chain_state
+            {
+                std::function<pplx::task<result_segment<result_type>>(const continuation_token &, size_t)> m_result_generator;
+                utility::size64_t m_max_results;
+                size_t m_max_results_per_segment;
+                utility::size64_t m_fetched_results;
+            };
+
+            struct prefetched_segment
+            {
+                prefetched_segment()
+                    : m_last(false)
+                {
+                }
+
+                result_segment<result_type> m_segment;
+
+                // A copy of the segment's continuation token, so that the next request never reads the segment while it is being handed to the consumer.
+                continuation_token m_next_token;
+                bool m_last;
+            };
+
+            static pplx::task<std::shared_ptr<prefetched_segment>> request_segment(std::shared_ptr<chain_state> state, const continuation_token& token, bool first)
+            {
+                if ((!first && token.empty()) || (state->m_max_results > 0 && state->m_fetched_results >= state->m_max_results))
+                {
+                    auto last = std::make_shared<prefetched_segment>();
+                    last->m_last = true;
+                    return pplx::task_from_result(last);
+                }
+
+                size_t max_results_per_segment = state->m_max_results == 0 ? state->m_max_results_per_segment :
+                    (size_t)std::min(state->m_max_results - state->m_fetched_results, (utility::size64_t)state->m_max_results_per_segment);
+                return state->m_result_generator(token, max_results_per_segment).then([state](result_segment<result_type> segment) -> std::shared_ptr<prefetched_segment>
+                {
+                    state->m_fetched_results += segment.results().size();
+
+                    auto prefetched = std::make_shared<prefetched_segment>();
+                    prefetched->m_next_token = segment.continuation_token();
+                    prefetched->m_last = prefetched->m_next_token.empty();
+                    prefetched->m_segment = std::move(segment);
+                    return prefetched;
+                });
+            }
+
+            void top_up()
+            {
+                while (m_pending.size() < m_prefetch_depth && !m_finished)
+                {
+                    auto state = m_state;
+                    m_tail = m_tail.then([state](std::shared_ptr<prefetched_segment> previous) -> pplx::task<std::shared_ptr<prefetched_segment>>
+                    {
+                        if (previous->m_last)
+                        {
+                            auto last = std::make_shared<prefetched_segment>();
+                            last->m_last = true;
+                            return pplx::task_from_result(last);
+                        }
+
+                        return request_segment(state, previous->m_next_token, false);
+                    });
+                    m_pending.push_back(m_tail);
+                }
+            }
+
+            std::shared_ptr<chain_state> m_state;
+            size_t m_prefetch_depth;
+            std::deque<pplx::task<std::shared_ptr<prefetched_segment>>> m_pending;
+            pplx::task<std::shared_ptr<prefetched_segment>> m_tail;
+            bool m_finished;
+        };
+
         void fetch_first_segment()
         {
-            if (nullptr != m_result_generator)
+            if (nullptr != m_prefetcher)
+            {
+                fetch_next_segment();
+            }
+            else if (nullptr != m_result_generator)
             {
                 m_result_segment = m_result_generator(continuation_token(), get_remaining_results_num());
                 m_segment_index = 0;
@@ -410,7 +587,18 @@ namespace azure { namespace storage {
 
         void fetch_next_segment()
         {
-            if (nullptr != m_result_generator && !m_result_segment.continuation_token().empty())
+            if (nullptr != m_prefetcher)
+            {
+                auto tmp_segment = m_prefetcher->take();
+                while (tmp_segment.results().empty() && !tmp_segment.continuation_token().empty())
+                {
+                    tmp_segment = m_prefetcher->take();
+                }
+
+                m_result_segment = std::move(tmp_segment);
+                m_segment_index = 0;
+            }
+            else if (nullptr != m_result_generator && !m_result_segment.continuation_token().empty())
             {
                 auto tmp_segment = m_result_generator(m_result_segment.continuation_token(), get_remaining_results_num());
                 while (tmp_segment.results().empty() && !tmp_segment.continuation_token().empty())
@@ -446,6 +634,7 @@ namespace azure { namespace storage {
         utility::size64_t m_returned_results;
         utility::size64_t m_max_results;
         size_t m_max_results_per_segment;
+        std::shared_ptr<segment_prefetcher> m_prefetcher;
     };
 
     /// <summary>
@@ -2576,6 +2765,7 @@ namespace azure { namespace storage {
                 m_maximum_execution_time = std::move(other.m_maximum_execution_time);
                 m_location_mode = std::move(other.m_location_mode);
                 m_http_buffer_size = std::move(other.m_http_buffer_size);
+                m_segment_prefetch_depth = std::move(other.m_segment_prefetch_depth);
             }
             return *this;
         }
@@ -2701,6 +2891,28 @@ namespace azure { namespace storage {
             m_http_buffer_size = http_buffer_size;
         }
 
+        /// <summary>
+        /// Gets the number of result segments that a lazy listing iterator requests ahead of the segment being enumerated.
+        /// </summary>
+        /// <returns>The number of result segments to request ahead.</returns>
+        size_t segment_prefetch_depth() const
+        {
+            return m_segment_prefetch_depth;
+        }
+
+        /// <summary>
+        /// Sets the number of result segments that a lazy listing iterator requests ahead of the segment being enumerated.
+        /// </summary>
+        /// <param name="segment_prefetch_depth">The number of result segments to request ahead. The default value is 0, which requests a segment only once the previous one has been enumerated.</param>
+        /// <remarks>
+        /// This applies to the iterators returned by the listing methods and by <see cref="azure::storage::cloud_table::execute_query" />, and is read from the options passed to those methods.
+        /// Prefetching hides the round trip between segments when the caller spends time on each result, at the cost of holding up to this many extra segments in memory.
+        /// </remarks>
+        void set_segment_prefetch_depth(size_t segment_prefetch_depth)
+        {
+            m_segment_prefetch_depth = segment_prefetch_depth;
+        }
+
         /// <summary>
         /// Gets the expiry time across all potential retries for the request.
         /// </summary>
@@ -2735,6 +2947,7 @@ namespace azure { namespace storage {
             m_maximum_execution_time.merge(other.m_maximum_execution_time);
             m_location_mode.merge(other.m_location_mode);
             m_http_buffer_size.merge(other.m_http_buffer_size);
+            m_segment_prefetch_depth.merge(other.m_segment_prefetch_depth);
 
             if (apply_expiry)
             {
@@ -2759,6 +2972,7 @@ namespace azure { namespace storage {
         option_with_default<std::chrono::milliseconds> m_maximum_execution_time;
         option_with_default<azure::storage::location_mode> m_location_mode;
         option_with_default<size_t> m_http_buffer_size;
+        option_with_default<size_t> m_segment_prefetch_depth;
     };
 
     /// <summary>
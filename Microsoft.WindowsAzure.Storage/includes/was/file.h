@@ -19,6 +19,7 @@
 
 #include "limits"
 #include "service_client.h"
+#include "wascore/timer_handler.h"
 
 #pragma push_macro("max")
 #undef max
@@ -41,6 +42,11 @@ namespace azure { namespace storage {
         class get_share_stats_reader;
     }
 
+    namespace core
+    {
+        class basic_cloud_file_ostreambuf;
+    }
+
     typedef result_segment<cloud_file_share> share_result_segment;
     typedef result_iterator<cloud_file_share> share_result_iterator;
 
@@ -430,6 +436,7 @@ namespace azure { namespace storage {
         file_request_options()
             : request_options(),
             m_use_transactional_md5(false),
+            m_use_transactional_crc64(false),
             m_disable_content_md5_validation(false),
             m_store_file_content_md5(false),
             m_parallelism_factor(1)
@@ -451,6 +458,7 @@ namespace azure { namespace storage {
             {
                 request_options::operator=(std::move(other));
                 m_use_transactional_md5 = other.m_use_transactional_md5;
+                m_use_transactional_crc64 = other.m_use_transactional_crc64;
                 m_disable_content_md5_validation = other.m_disable_content_md5_validation;
                 m_store_file_content_md5 = other.m_store_file_content_md5;
                 m_parallelism_factor = other.m_parallelism_factor;
@@ -470,6 +478,7 @@ namespace azure { namespace storage {
             request_options::apply_defaults(other, apply_expiry);
 
             m_use_transactional_md5.merge(other.m_use_transactional_md5);
+            m_use_transactional_crc64.merge(other.m_use_transactional_crc64);
             m_disable_content_md5_validation.merge(other.m_disable_content_md5_validation);
             m_store_file_content_md5.merge(other.m_store_file_content_md5);
             m_parallelism_factor.merge(other.m_parallelism_factor);
@@ -493,6 +502,28 @@ namespace azure { namespace storage {
             m_use_transactional_md5 = value;
         }
 
+        /// <summary>
+        /// Gets a value indicating whether a CRC64 checksum will be calculated and validated for the request.
+        /// </summary>
+        /// <returns><c>true</c> if a CRC64 checksum will be calculated and validated for the request; otherwise, <c>false</c>.</returns>
+        bool use_transactional_crc64() const
+        {
+            return m_use_transactional_crc64;
+        }
+
+        /// <summary>
+        /// Indicates whether to calculate and validate a CRC64 checksum for the request, which is cheaper to compute than a content-MD5 hash.
+        /// </summary>
+        /// <param name="value"><c>true</c> to calculate and validate a CRC64 checksum for the request; otherwise, <c>false</c>.</param>
+        /// <remarks>
+        /// When both a CRC64 checksum and a content-MD5 hash are requested, transactional validation uses the CRC64 checksum.
+        /// A content-MD5 hash that is passed in explicitly is still sent with the request.
+        /// </remarks>
+        void set_use_transactional_crc64(bool value)
+        {
+            m_use_transactional_crc64 = value;
+        }
+
         /// <summary>
         /// Gets a value indicating whether content-MD5 validation will be disabled when downloading files.
         /// </summary>
@@ -552,6 +583,7 @@ namespace azure { namespace storage {
     private:
 
         option_with_default<bool> m_use_transactional_md5;
+        option_with_default<bool> m_use_transactional_crc64;
         option_with_default<bool> m_disable_content_md5_validation;
         option_with_default<bool> m_store_file_content_md5;
         option_with_default<int> m_parallelism_factor;
@@ -1875,6 +1907,43 @@ namespace azure { namespace storage {
         /// <returns>A <see cref="pplx::task" /> object of type <see cref="azure::storage::list_file_and_directory_result_segment" /> that represents the current operation.</returns>
         WASTORAGE_API pplx::task<list_file_and_directory_result_segment> list_files_and_directories_segmented_async(const utility::string_t& prefix, int64_t max_results, const continuation_token& token, const file_request_options& options, operation_context context) const;
 
+        /// <summary>
+        /// Intitiates an asynchronous operation to list every file and directory under the directory, including those in subdirectories, listing subdirectories in parallel.
+        /// </summary>
+        /// <param name="consumer">The function that is called for each file or directory.</param>
+        /// <returns>A <see cref="pplx::task" /> object that represents the current operation.</returns>
+        pplx::task<void> list_files_and_directories_parallel_async(const std::function<void(const list_file_and_directory_item&)>& consumer) const
+        {
+            return list_files_and_directories_parallel_async(protocol::default_listing_parallelism, consumer, file_request_options(), operation_context());
+        }
+
+        /// <summary>
+        /// Lists every file and directory under the directory, including those in subdirectories, listing subdirectories in parallel.
+        /// </summary>
+        /// <param name="parallelism">The maximum number of listing requests that are sent at the same time.</param>
+        /// <param name="consumer">The function that is called for each file or directory.</param>
+        /// <param name="options">An <see cref="azure::storage::file_request_options" /> object that specifies additional options for the requests.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the requests.</param>
+        void list_files_and_directories_parallel(int parallelism, const std::function<void(const list_file_and_directory_item&)>& consumer, const file_request_options& options, operation_context context) const
+        {
+            list_files_and_directories_parallel_async(parallelism, consumer, options, context).wait();
+        }
+
+        /// <summary>
+        /// Intitiates an asynchronous operation to list every file and directory under the directory, including those in subdirectories, listing subdirectories in parallel.
+        /// </summary>
+        /// <param name="parallelism">The maximum number of listing requests that are sent at the same time.</param>
+        /// <param name="consumer">The function that is called for each file or directory.</param>
+        /// <param name="options">An <see cref="azure::storage::file_request_options" /> object that specifies additional options for the requests.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the requests.</param>
+        /// <returns>A <see cref="pplx::task" /> object that represents the current operation.</returns>
+        /// <remarks>
+        /// Every subdirectory is listed by its own chain of continuation tokens, and up to <paramref name="parallelism" /> requests are in flight at a time.
+        /// The consumer is never called concurrently, and the items of one directory are passed in order, but directories are interleaved.
+        /// If a request or the consumer fails, no further requests are started and the task fails with the first error.
+        /// </remarks>
+        WASTORAGE_API pplx::task<void> list_files_and_directories_parallel_async(int parallelism, const std::function<void(const list_file_and_directory_item&)>& consumer, const file_request_options& options, operation_context context) const;
+
         /// <summary>
         /// Creates the directory.
         /// All parent directories must already be created. 
@@ -3440,6 +3509,20 @@ namespace azure { namespace storage {
         /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
         WASTORAGE_API pplx::task<void> write_range_async(Concurrency::streams::istream stream, int64_t start_offset, const utility::string_t& content_md5, const file_access_condition& condition, const file_request_options& options, operation_context context) const;
 
+        /// <summary>
+        /// Intitiates an asynchronous operation to write range to a file, with a precomputed CRC64 checksum.
+        /// </summary>
+        /// <param name="stream">A stream providing the file range data.</param>
+        /// <param name="start_offset">The offset at which to begin writing, in bytes. The offset must be a multiple of 512.</param>
+        /// <param name="content_md5">An optional hash value that will be used to set the Content-MD5 property
+        /// on the blob. May be an empty string.</param>
+        /// <param name="content_crc64">An optional base64-encoded CRC64 checksum of the range data that will be sent
+        /// as x-ms-content-crc64. May be an empty string.</param>
+        /// <param name="condition">An <see cref="azure::storage::access_condition" /> object that represents the access condition for the operation.</param>
+        /// <param name="options">An <see cref="azure::storage::blob_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        WASTORAGE_API pplx::task<void> write_range_async(Concurrency::streams::istream stream, int64_t start_offset, const utility::string_t& content_md5, const utility::string_t& content_crc64, const file_access_condition& condition, const file_request_options& options, operation_context context) const;
+
         /// <summary>
         /// Downloads the contents of a file to a stream.
         /// </summary>
@@ -4056,6 +4139,7 @@ namespace azure { namespace storage {
         void init(storage_credentials credentials);
         WASTORAGE_API pplx::task<bool> exists_async(bool primary_only, const file_access_condition& condition, const file_request_options& options, operation_context context) const;
         WASTORAGE_API pplx::task<void> download_single_range_to_stream_async(concurrency::streams::ostream target, utility::size64_t offset, utility::size64_t length, const file_access_condition& condition, const file_request_options& options, operation_context context, bool update_properties = false, bool validate_last_modify = false) const;
+        WASTORAGE_API pplx::task<void> write_range_async_impl(Concurrency::streams::istream stream, int64_t start_offset, const utility::string_t& content_md5, const utility::string_t& content_crc64, const file_access_condition& condition, const file_request_options& options, operation_context context, const pplx::cancellation_token& cancellation_token = pplx::cancellation_token::none(), std::shared_ptr<core::timer_handler> timer_handler = nullptr) const;
 
         utility::string_t m_name;
         cloud_file_directory m_directory;
@@ -4063,6 +4147,8 @@ namespace azure { namespace storage {
         std::shared_ptr<cloud_metadata> m_metadata;
         std::shared_ptr<cloud_file_properties> m_properties;
         std::shared_ptr<azure::storage::copy_state> m_copy_state;
+
+        friend class core::basic_cloud_file_ostreambuf;
     };
 
     /// <summary>
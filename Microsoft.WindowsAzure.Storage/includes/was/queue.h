@@ -24,6 +24,11 @@ namespace azure { namespace storage {
     class cloud_queue_message;
     class cloud_queue;
     class cloud_queue_client;
+
+    namespace protocol
+    {
+        class message_writer;
+    }
     
     /// <summary>
     /// Represents a shared access policy, which specifies the start time, expiry time, 
@@ -148,7 +153,7 @@ namespace azure { namespace storage {
         /// Initializes a new instance of the <see cref="azure::storage::cloud_queue_message" /> class.
         /// </summary>
         cloud_queue_message()
-            : m_dequeue_count(0)
+            : m_is_binary(false), m_dequeue_count(0)
         {
         }
 
@@ -157,7 +162,7 @@ namespace azure { namespace storage {
         /// </summary>
         /// <param name="content">The content of the message.</param>
         explicit cloud_queue_message(utility::string_t content)
-            : m_content(std::move(content)), m_dequeue_count(0)
+            : m_content(std::move(content)), m_is_binary(false), m_dequeue_count(0)
         {
         }
 
@@ -165,8 +170,9 @@ namespace azure { namespace storage {
         /// Initializes a new instance of the <see cref="azure::storage::cloud_queue_message" /> class with the specified raw data.
         /// </summary>
         /// <param name="content">The content of the message as raw data.</param>
-        explicit cloud_queue_message(const std::vector<uint8_t>& content)
-            : m_content(utility::conversions::to_base64(content)), m_dequeue_count(0)
+        /// <remarks>The raw data is kept as is and only encoded as base64 when the message is sent.</remarks>
+        explicit cloud_queue_message(std::vector<uint8_t> content)
+            : m_binary_content(std::move(content)), m_is_binary(true), m_dequeue_count(0)
         {
         }
 
@@ -176,7 +182,7 @@ namespace azure { namespace storage {
         /// <param name="id">The unique ID of the message.</param>
         /// <param name="pop_receipt">The pop receipt token.</param>
         cloud_queue_message(utility::string_t id, utility::string_t pop_receipt)
-            : m_id(std::move(id)), m_pop_receipt(std::move(pop_receipt)), m_dequeue_count(0)
+            : m_is_binary(false), m_id(std::move(id)), m_pop_receipt(std::move(pop_receipt)), m_dequeue_count(0)
         {
         }
 
@@ -203,6 +209,8 @@ namespace azure { namespace storage {
             if (this != &other)
             {
                 m_content = std::move(other.m_content);
+                m_binary_content = std::move(other.m_binary_content);
+                m_is_binary = other.m_is_binary;
                 m_id = std::move(other.m_id);
                 m_pop_receipt = std::move(other.m_pop_receipt);
                 m_insertion_time = std::move(other.m_insertion_time);
@@ -217,20 +225,14 @@ namespace azure { namespace storage {
         /// <summary>
         /// Gets the content of the message as text.
         /// </summary>
-        /// <returns>The content of the message as text.</returns>
-        const utility::string_t content_as_string() const
-        {
-            return m_content;
-        }
+        /// <returns>The content of the message as text. For a message with raw data, this is the base64 encoding of the data.</returns>
+        WASTORAGE_API const utility::string_t content_as_string() const;
 
         /// <summary>
         /// Gets the content of the message as raw data.
         /// </summary>
-        /// <returns>The content of the message as raw data.</returns>
-        const std::vector<uint8_t> content_as_binary() const
-        {
-            return std::vector<uint8_t>(utility::conversions::from_base64(m_content));
-        }
+        /// <returns>The content of the message as raw data. For a message with text content, this is the data that the text encodes as base64.</returns>
+        WASTORAGE_API const std::vector<uint8_t> content_as_binary() const;
 
         /// <summary>
         /// Sets the content of this message.
@@ -239,15 +241,19 @@ namespace azure { namespace storage {
         void set_content(utility::string_t value)
         {
             m_content = std::move(value);
+            m_binary_content.clear();
+            m_is_binary = false;
         }
 
         /// <summary>
         /// Sets the content of this message.
         /// </summary>
         /// <param name="value">The new message content.</param>
-        void set_content(const std::vector<uint8_t>& value)
+        void set_content(std::vector<uint8_t> value)
         {
-            m_content = utility::conversions::to_base64(value);
+            m_binary_content = std::move(value);
+            m_content.clear();
+            m_is_binary = true;
         }
 
         /// <summary>
@@ -322,7 +328,7 @@ namespace azure { namespace storage {
     private:
 
         cloud_queue_message(utility::string_t content, utility::string_t id, utility::string_t pop_receipt, utility::datetime insertion_time, utility::datetime expiration_time, utility::datetime next_visible_time, int dequeue_count)
-            : m_content(std::move(content)), m_id(std::move(id)), m_pop_receipt(std::move(pop_receipt)), m_insertion_time(insertion_time), m_expiration_time(expiration_time), m_next_visible_time(next_visible_time), m_dequeue_count(dequeue_count)
+            : m_content(std::move(content)), m_is_binary(false), m_id(std::move(id)), m_pop_receipt(std::move(pop_receipt)), m_insertion_time(insertion_time), m_expiration_time(expiration_time), m_next_visible_time(next_visible_time), m_dequeue_count(dequeue_count)
         {
         }
 
@@ -337,6 +343,9 @@ namespace azure { namespace storage {
         }
 
         utility::string_t m_content;
+        // Raw data is only encoded as base64 when it is written into a request.
+        std::vector<uint8_t> m_binary_content;
+        bool m_is_binary;
         utility::string_t m_id;
         utility::string_t m_pop_receipt;
         utility::datetime m_insertion_time;
@@ -347,6 +356,7 @@ namespace azure { namespace storage {
         void update_message_info(const cloud_queue_message& message_info);
 
         friend class cloud_queue;
+        friend class protocol::message_writer;
     };
 
     /// <summary>
@@ -405,6 +415,64 @@ namespace azure { namespace storage {
     typedef result_segment<cloud_queue> queue_result_segment;
     typedef result_iterator<cloud_queue> queue_result_iterator;
 
+    /// <summary>
+    /// Represents the outcome of adding one message with <see cref="azure::storage::cloud_queue::add_messages_async" />.
+    /// </summary>
+    class add_message_result
+    {
+    public:
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::add_message_result" /> class.
+        /// </summary>
+        add_message_result()
+        {
+        }
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::add_message_result" /> class for a message that has not been added yet.
+        /// </summary>
+        /// <param name="message">The message to add.</param>
+        explicit add_message_result(cloud_queue_message message)
+            : m_message(std::move(message))
+        {
+        }
+
+        /// <summary>
+        /// Gets the message. If it was added, the message contains the ID, pop receipt and times returned by the service.
+        /// </summary>
+        /// <returns>A reference to the <see cref="azure::storage::cloud_queue_message" /> object.</returns>
+        const cloud_queue_message& message() const
+        {
+            return m_message;
+        }
+
+        /// <summary>
+        /// Gets a value indicating whether the message was added to the queue.
+        /// </summary>
+        /// <returns><c>true</c> if the message was added; otherwise, <c>false</c>.</returns>
+        bool succeeded() const
+        {
+            return m_exception == nullptr;
+        }
+
+        /// <summary>
+        /// Gets the exception that the request for the message failed with.
+        /// </summary>
+        /// <returns>The exception, or a null pointer if the message was added.</returns>
+        std::exception_ptr exception() const
+        {
+            return m_exception;
+        }
+
+    private:
+
+        cloud_queue_message m_message;
+        std::exception_ptr m_exception;
+
+        friend class cloud_queue;
+    };
+
     /// <summary>
     /// Provides a client-side logical representation of the Windows Azure Queue service. This client is used to configure and execute requests against the Queue service.
     /// </summary>
@@ -1016,6 +1084,58 @@ namespace azure { namespace storage {
         /// <returns>A <see cref="pplx::task" /> object that represents the current operation.</returns>
         WASTORAGE_API pplx::task<void> add_message_async(cloud_queue_message& message, std::chrono::seconds time_to_live, std::chrono::seconds initial_visibility_timeout, queue_request_options& options, operation_context context);
 
+        /// <summary>
+        /// Adds several messages to the queue.
+        /// </summary>
+        /// <param name="messages">The messages to add to the queue.</param>
+        /// <returns>An enumerable collection of <see cref="azure::storage::add_message_result" /> objects, one for each message in the same order.</returns>
+        std::vector<add_message_result> add_messages(std::vector<cloud_queue_message> messages)
+        {
+            return add_messages_async(std::move(messages)).get();
+        }
+
+        /// <summary>
+        /// Adds several messages to the queue.
+        /// </summary>
+        /// <param name="messages">The messages to add to the queue.</param>
+        /// <param name="time_to_live">The maximum time to allow each message to be in the queue.</param>
+        /// <param name="initial_visibility_timeout">The length of time from now during which each message will be invisible.</param>
+        /// <param name="parallelism">The maximum number of messages that are sent at the same time.</param>
+        /// <param name="options">An <see cref="azure::storage::queue_request_options" /> object that specifies additional options for the requests.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the requests.</param>
+        /// <returns>An enumerable collection of <see cref="azure::storage::add_message_result" /> objects, one for each message in the same order.</returns>
+        std::vector<add_message_result> add_messages(std::vector<cloud_queue_message> messages, std::chrono::seconds time_to_live, std::chrono::seconds initial_visibility_timeout, int parallelism, const queue_request_options& options, operation_context context)
+        {
+            return add_messages_async(std::move(messages), time_to_live, initial_visibility_timeout, parallelism, options, context).get();
+        }
+
+        /// <summary>
+        /// Intitiates an asynchronous operation to add several messages to the queue.
+        /// </summary>
+        /// <param name="messages">The messages to add to the queue.</param>
+        /// <returns>A <see cref="pplx::task" /> object of type <see cref="std::vector" />, of type <see cref="azure::storage::add_message_result" />, that represents the current operation.</returns>
+        pplx::task<std::vector<add_message_result>> add_messages_async(std::vector<cloud_queue_message> messages)
+        {
+            return add_messages_async(std::move(messages), std::chrono::seconds(604800LL), std::chrono::seconds(0LL), protocol::default_add_messages_parallelism, queue_request_options(), operation_context());
+        }
+
+        /// <summary>
+        /// Intitiates an asynchronous operation to add several messages to the queue.
+        /// </summary>
+        /// <param name="messages">The messages to add to the queue.</param>
+        /// <param name="time_to_live">The maximum time to allow each message to be in the queue.</param>
+        /// <param name="initial_visibility_timeout">The length of time from now during which each message will be invisible.</param>
+        /// <param name="parallelism">The maximum number of messages that are sent at the same time.</param>
+        /// <param name="options">An <see cref="azure::storage::queue_request_options" /> object that specifies additional options for the requests.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the requests.</param>
+        /// <returns>A <see cref="pplx::task" /> object of type <see cref="std::vector" />, of type <see cref="azure::storage::add_message_result" />, that represents the current operation.</returns>
+        /// <remarks>
+        /// Each message is sent in its own request, since the service adds one message per request. The options are resolved once for all of the messages,
+        /// and up to <paramref name="parallelism" /> requests are in flight at a time. The task does not fail when a message cannot be added;
+        /// the failure is reported in the result for that message instead.
+        /// </remarks>
+        WASTORAGE_API pplx::task<std::vector<add_message_result>> add_messages_async(std::vector<cloud_queue_message> messages, std::chrono::seconds time_to_live, std::chrono::seconds initial_visibility_timeout, int parallelism, const queue_request_options& options, operation_context context);
+
         /// <summary>
         /// Retrieves a message from the front of the queue
         /// </summary>
@@ -1551,6 +1671,7 @@ namespace azure { namespace storage {
         static utility::string_t read_queue_name(const storage_uri& uri);
         static storage_uri create_uri(const storage_uri& uri);
         queue_request_options get_modified_options(const queue_request_options& options) const;
+        pplx::task<void> add_message_async_impl(cloud_queue_message& message, std::chrono::seconds time_to_live, std::chrono::seconds initial_visibility_timeout, const queue_request_options& modified_options, operation_context context);
         pplx::task<bool> create_async_impl(const queue_request_options& options, operation_context context, bool allow_conflict);
         pplx::task<bool> delete_async_impl(const queue_request_options& options, operation_context context, bool allow_not_found);
         pplx::task<bool> exists_async_impl(const queue_request_options& options, operation_context context, bool allow_secondary) const;
@@ -1567,4 +1688,384 @@ namespace azure { namespace storage {
     };
 
 
+    /// <summary>
+    /// Represents a set of options for a <see cref="azure::storage::cloud_queue_processor" />.
+    /// </summary>
+    class queue_processor_options
+    {
+    public:
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::queue_processor_options" /> class with default values.
+        /// </summary>
+        queue_processor_options()
+            : m_receive_loops(protocol::default_queue_processor_receive_loops),
+            m_messages_per_receive(protocol::max_get_messages_count),
+            m_handler_parallelism(protocol::default_queue_processor_handler_parallelism),
+            m_visibility_timeout(protocol::default_queue_processor_visibility_timeout),
+            m_min_backoff(protocol::default_queue_processor_min_backoff),
+            m_max_backoff(protocol::default_queue_processor_max_backoff)
+        {
+        }
+
+        /// <summary>
+        /// Gets the number of loops that receive messages at the same time.
+        /// </summary>
+        /// <returns>The number of receive loops.</returns>
+        int receive_loops() const
+        {
+            return m_receive_loops;
+        }
+
+        /// <summary>
+        /// Sets the number of loops that receive messages at the same time.
+        /// </summary>
+        /// <param name="value">The number of receive loops, which must be at least 1.</param>
+        void set_receive_loops(int value)
+        {
+            m_receive_loops = value;
+        }
+
+        /// <summary>
+        /// Gets the number of messages that a receive loop asks for in each request.
+        /// </summary>
+        /// <returns>The number of messages per request.</returns>
+        size_t messages_per_receive() const
+        {
+            return m_messages_per_receive;
+        }
+
+        /// <summary>
+        /// Sets the number of messages that a receive loop asks for in each request.
+        /// </summary>
+        /// <param name="value">The number of messages per request, between 1 and 32.</param>
+        void set_messages_per_receive(size_t value)
+        {
+            m_messages_per_receive = value;
+        }
+
+        /// <summary>
+        /// Gets the maximum number of messages that are handled at the same time.
+        /// </summary>
+        /// <returns>The maximum number of running handlers.</returns>
+        int handler_parallelism() const
+        {
+            return m_handler_parallelism;
+        }
+
+        /// <summary>
+        /// Sets the maximum number of messages that are handled at the same time.
+        /// </summary>
+        /// <param name="value">The maximum number of running handlers, which must be at least 1.</param>
+        void set_handler_parallelism(int value)
+        {
+            m_handler_parallelism = value;
+        }
+
+        /// <summary>
+        /// Gets the visibility timeout that received messages are hidden for, and that is renewed while a handler is running.
+        /// </summary>
+        /// <returns>The visibility timeout.</returns>
+        std::chrono::seconds visibility_timeout() const
+        {
+            return m_visibility_timeout;
+        }
+
+        /// <summary>
+        /// Sets the visibility timeout that received messages are hidden for, and that is renewed while a handler is running.
+        /// </summary>
+        /// <param name="value">The visibility timeout, between 1 second and 7 days.</param>
+        void set_visibility_timeout(std::chrono::seconds value)
+        {
+            m_visibility_timeout = value;
+        }
+
+        /// <summary>
+        /// Gets the time that a receive loop waits after it first finds the queue empty.
+        /// </summary>
+        /// <returns>The shortest wait.</returns>
+        std::chrono::milliseconds min_backoff() const
+        {
+            return m_min_backoff;
+        }
+
+        /// <summary>
+        /// Sets the time that a receive loop waits after it first finds the queue empty.
+        /// </summary>
+        /// <param name="value">The shortest wait, which must be greater than zero.</param>
+        void set_min_backoff(std::chrono::milliseconds value)
+        {
+            m_min_backoff = value;
+        }
+
+        /// <summary>
+        /// Gets the longest time that a receive loop waits while the queue stays empty.
+        /// </summary>
+        /// <returns>The longest wait.</returns>
+        std::chrono::milliseconds max_backoff() const
+        {
+            return m_max_backoff;
+        }
+
+        /// <summary>
+        /// Sets the longest time that a receive loop waits while the queue stays empty.
+        /// </summary>
+        /// <param name="value">The longest wait, which must not be less than the shortest wait.</param>
+        void set_max_backoff(std::chrono::milliseconds value)
+        {
+            m_max_backoff = value;
+        }
+
+    private:
+
+        int m_receive_loops;
+        size_t m_messages_per_receive;
+        int m_handler_parallelism;
+        std::chrono::seconds m_visibility_timeout;
+        std::chrono::milliseconds m_min_backoff;
+        std::chrono::milliseconds m_max_backoff;
+    };
+
+    /// <summary>
+    /// Represents a snapshot of the counters of a <see cref="azure::storage::cloud_queue_processor" />.
+    /// </summary>
+    class queue_processor_statistics
+    {
+    public:
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::queue_processor_statistics" /> class.
+        /// </summary>
+        queue_processor_statistics()
+            : m_receive_count(0), m_empty_receive_count(0), m_failed_receive_count(0), m_received_count(0), m_processed_count(0), m_failed_count(0),
+            m_deleted_count(0), m_failed_delete_count(0), m_visibility_update_count(0), m_failed_visibility_update_count(0),
+            m_elapsed_time(0), m_total_handler_latency(0), m_max_handler_latency(0)
+        {
+        }
+
+        /// <summary>
+        /// Gets the number of get messages requests that have completed.
+        /// </summary>
+        /// <returns>The number of receive requests.</returns>
+        utility::size64_t receive_count() const
+        {
+            return m_receive_count;
+        }
+
+        /// <summary>
+        /// Gets the number of get messages requests that found the queue empty.
+        /// </summary>
+        /// <returns>The number of empty receive requests.</returns>
+        utility::size64_t empty_receive_count() const
+        {
+            return m_empty_receive_count;
+        }
+
+        /// <summary>
+        /// Gets the number of get messages requests that failed.
+        /// </summary>
+        /// <returns>The number of failed receive requests.</returns>
+        utility::size64_t failed_receive_count() const
+        {
+            return m_failed_receive_count;
+        }
+
+        /// <summary>
+        /// Gets the number of messages that have been received.
+        /// </summary>
+        /// <returns>The number of received messages.</returns>
+        utility::size64_t received_count() const
+        {
+            return m_received_count;
+        }
+
+        /// <summary>
+        /// Gets the number of messages that the handler has completed without an exception.
+        /// </summary>
+        /// <returns>The number of processed messages.</returns>
+        utility::size64_t processed_count() const
+        {
+            return m_processed_count;
+        }
+
+        /// <summary>
+        /// Gets the number of messages for which the handler has thrown an exception.
+        /// </summary>
+        /// <returns>The number of failed messages.</returns>
+        utility::size64_t failed_count() const
+        {
+            return m_failed_count;
+        }
+
+        /// <summary>
+        /// Gets the number of processed messages that have been deleted from the queue.
+        /// </summary>
+        /// <returns>The number of deleted messages.</returns>
+        utility::size64_t deleted_count() const
+        {
+            return m_deleted_count;
+        }
+
+        /// <summary>
+        /// Gets the number of processed messages that could not be deleted from the queue.
+        /// </summary>
+        /// <returns>The number of failed deletes.</returns>
+        utility::size64_t failed_delete_count() const
+        {
+            return m_failed_delete_count;
+        }
+
+        /// <summary>
+        /// Gets the number of times that the visibility timeout of a message has been extended.
+        /// </summary>
+        /// <returns>The number of visibility updates.</returns>
+        utility::size64_t visibility_update_count() const
+        {
+            return m_visibility_update_count;
+        }
+
+        /// <summary>
+        /// Gets the number of visibility updates that failed.
+        /// </summary>
+        /// <returns>The number of failed visibility updates.</returns>
+        utility::size64_t failed_visibility_update_count() const
+        {
+            return m_failed_visibility_update_count;
+        }
+
+        /// <summary>
+        /// Gets the time since the processor was started.
+        /// </summary>
+        /// <returns>The elapsed time.</returns>
+        std::chrono::milliseconds elapsed_time() const
+        {
+            return m_elapsed_time;
+        }
+
+        /// <summary>
+        /// Gets the average time that the handler has taken for a message.
+        /// </summary>
+        /// <returns>The average handler latency.</returns>
+        std::chrono::microseconds average_handler_latency() const
+        {
+            utility::size64_t handled = m_processed_count + m_failed_count;
+            return handled == 0 ? std::chrono::microseconds::zero() : std::chrono::microseconds(m_total_handler_latency.count() / static_cast<std::chrono::microseconds::rep>(handled));
+        }
+
+        /// <summary>
+        /// Gets the longest time that the handler has taken for a message.
+        /// </summary>
+        /// <returns>The maximum handler latency.</returns>
+        std::chrono::microseconds max_handler_latency() const
+        {
+            return m_max_handler_latency;
+        }
+
+        /// <summary>
+        /// Gets the number of messages processed per second since the processor was started.
+        /// </summary>
+        /// <returns>The processing throughput.</returns>
+        double messages_per_second() const
+        {
+            return m_elapsed_time.count() == 0 ? 0.0 : static_cast<double>(m_processed_count) * 1000.0 / static_cast<double>(m_elapsed_time.count());
+        }
+
+    private:
+
+        utility::size64_t m_receive_count;
+        utility::size64_t m_empty_receive_count;
+        utility::size64_t m_failed_receive_count;
+        utility::size64_t m_received_count;
+        utility::size64_t m_processed_count;
+        utility::size64_t m_failed_count;
+        utility::size64_t m_deleted_count;
+        utility::size64_t m_failed_delete_count;
+        utility::size64_t m_visibility_update_count;
+        utility::size64_t m_failed_visibility_update_count;
+        std::chrono::milliseconds m_elapsed_time;
+        std::chrono::microseconds m_total_handler_latency;
+        std::chrono::microseconds m_max_handler_latency;
+
+        friend class cloud_queue_processor;
+    };
+
+    /// <summary>
+    /// Receives messages from a queue with several concurrent loops and passes each message to a handler.
+    /// </summary>
+    /// <remarks>
+    /// <para>Each receive loop waits until the handlers have room for a full request before it asks for more messages, so received messages are
+    /// not kept waiting while their visibility timeout runs out. When the queue is empty, a loop waits for the minimum backoff, doubling the wait
+    /// up to the maximum backoff for as long as the queue stays empty, and goes back to receiving without waiting once it gets a message.</para>
+    /// <para>The handler runs on the thread pool. While it runs, the visibility timeout of its message is extended whenever half of it has passed.
+    /// A message is deleted in the background once its handler returns, so the next message can be handled while the delete is sent.
+    /// If the handler throws an exception the message is not deleted, and it becomes visible again when its visibility timeout expires.</para>
+    /// </remarks>
+    class cloud_queue_processor
+    {
+    public:
+
+        /// <summary>
+        /// The function that is called for each received message.
+        /// </summary>
+        typedef std::function<void(const cloud_queue_message&)> message_handler;
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::cloud_queue_processor" /> class with default options.
+        /// </summary>
+        /// <param name="queue">The <see cref="azure::storage::cloud_queue" /> that messages are received from.</param>
+        /// <param name="handler">The function that is called for each received message.</param>
+        WASTORAGE_API cloud_queue_processor(cloud_queue queue, message_handler handler);
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::cloud_queue_processor" /> class.
+        /// </summary>
+        /// <param name="queue">The <see cref="azure::storage::cloud_queue" /> that messages are received from.</param>
+        /// <param name="handler">The function that is called for each received message.</param>
+        /// <param name="processor_options">An <see cref="azure::storage::queue_processor_options" /> object that specifies how messages are received and handled.</param>
+        /// <param name="options">An <see cref="azure::storage::queue_request_options" /> object that specifies additional options for the requests.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the requests.</param>
+        WASTORAGE_API cloud_queue_processor(cloud_queue queue, message_handler handler, const queue_processor_options& processor_options, const queue_request_options& options, operation_context context);
+
+        /// <summary>
+        /// Stops receiving messages, without waiting for the running handlers.
+        /// </summary>
+        WASTORAGE_API ~cloud_queue_processor();
+
+        /// <summary>
+        /// Starts the receive loops.
+        /// </summary>
+        /// <remarks>A processor can only be started once.</remarks>
+        WASTORAGE_API void start();
+
+        /// <summary>
+        /// Stops receiving messages and waits for the running handlers and deletes to complete.
+        /// </summary>
+        void stop()
+        {
+            stop_async().wait();
+        }
+
+        /// <summary>
+        /// Intitiates an asynchronous operation that stops receiving messages.
+        /// </summary>
+        /// <returns>A <see cref="pplx::task" /> object that completes when the receive loops have stopped and every running handler and delete has completed.</returns>
+        WASTORAGE_API pplx::task<void> stop_async();
+
+        /// <summary>
+        /// Gets the current counters of the processor.
+        /// </summary>
+        /// <returns>A <see cref="azure::storage::queue_processor_statistics" /> object.</returns>
+        WASTORAGE_API queue_processor_statistics statistics() const;
+
+    private:
+
+        class processor_state;
+
+        cloud_queue_processor(const cloud_queue_processor&) = delete;
+        cloud_queue_processor& operator=(const cloud_queue_processor&) = delete;
+
+        std::shared_ptr<processor_state> m_state;
+    };
+
+
 }} // namespace azure::storage
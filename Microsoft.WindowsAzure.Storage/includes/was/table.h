@@ -29,6 +29,7 @@ namespace azure { namespace storage {
     namespace protocol
     {
         table_entity parse_table_entity(const web::json::value& document);
+        class table_query_reader;
     }
 
     /// <summary>
@@ -895,6 +896,897 @@ namespace azure { namespace storage {
         utility::string_t m_etag;
 
         friend table_entity protocol::parse_table_entity(const web::json::value& document);
+        friend class protocol::table_query_reader;
+        friend class compact_table_entity;
+    };
+
+    /// <summary>
+    /// Represents the property names shared by a set of <see cref="azure::storage::compact_table_entity" /> objects.
+    /// </summary>
+    /// <remarks>
+    /// A schema does not change once it is created, so the entities that share it can be read from several threads.
+    /// The query methods that return compact entities create a new schema only when a property that is not in the current one is found.
+    /// </remarks>
+    class table_entity_schema
+    {
+    public:
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::table_entity_schema" /> class with no properties.
+        /// </summary>
+        table_entity_schema()
+        {
+        }
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::table_entity_schema" /> class with the specified property names.
+        /// </summary>
+        /// <param name="property_names">The property names, in the order of their indexes.</param>
+        WASTORAGE_API explicit table_entity_schema(std::vector<utility::string_t> property_names);
+
+        /// <summary>
+        /// Gets the number of properties in the schema.
+        /// </summary>
+        /// <returns>The number of properties.</returns>
+        size_t size() const
+        {
+            return m_property_names.size();
+        }
+
+        /// <summary>
+        /// Gets the property names, in the order of their indexes.
+        /// </summary>
+        /// <returns>The property names.</returns>
+        const std::vector<utility::string_t>& property_names() const
+        {
+            return m_property_names;
+        }
+
+        /// <summary>
+        /// Gets the name of the property at the specified index.
+        /// </summary>
+        /// <param name="index">The index of the property.</param>
+        /// <returns>The property name.</returns>
+        const utility::string_t& property_name(size_t index) const
+        {
+            return m_property_names.at(index);
+        }
+
+        /// <summary>
+        /// Finds the index of the specified property.
+        /// </summary>
+        /// <param name="property_name">The property name.</param>
+        /// <param name="index">Receives the index of the property.</param>
+        /// <returns><c>true</c> if the schema contains the property.</returns>
+        bool find(const utility::string_t& property_name, size_t& index) const
+        {
+            auto it = m_indexes.find(property_name);
+            if (it == m_indexes.end())
+            {
+                return false;
+            }
+
+            index = it->second;
+            return true;
+        }
+
+    private:
+
+        std::vector<utility::string_t> m_property_names;
+        std::unordered_map<utility::string_t, size_t> m_indexes;
+    };
+
+    /// <summary>
+    /// Represents a typed property value of a <see cref="azure::storage::compact_table_entity" />.
+    /// </summary>
+    /// <remarks>
+    /// Unlike <see cref="azure::storage::entity_property" />, the value is kept in its own type, so reading it does not parse a string.
+    /// </remarks>
+    class compact_entity_value
+    {
+    public:
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::compact_entity_value" /> class with a null value.
+        /// </summary>
+        /// <remarks>
+        /// The value stands for a missing property until a value is set, or it is explicitly set to null.
+        /// </remarks>
+        compact_entity_value()
+            : m_property_type(edm_type::string), m_is_null(true), m_is_set(false)
+        {
+            m_scalar.m_int64 = 0;
+        }
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::compact_entity_value" /> class with a byte array value.
+        /// </summary>
+        /// <param name="value">A byte array.</param>
+        compact_entity_value(std::vector<uint8_t> value)
+            : compact_entity_value()
+        {
+            set_value(std::move(value));
+        }
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::compact_entity_value" /> class with a boolean value.
+        /// </summary>
+        /// <param name="value">A boolean value.</param>
+        compact_entity_value(bool value)
+            : compact_entity_value()
+        {
+            set_value(value);
+        }
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::compact_entity_value" /> class with a date/time value.
+        /// </summary>
+        /// <param name="value">A datetime value.</param>
+        compact_entity_value(utility::datetime value)
+            : compact_entity_value()
+        {
+            set_value(value);
+        }
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::compact_entity_value" /> class with a double precision floating-point number value.
+        /// </summary>
+        /// <param name="value">A double value.</param>
+        compact_entity_value(double value)
+            : compact_entity_value()
+        {
+            set_value(value);
+        }
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::compact_entity_value" /> class with a GUID value.
+        /// </summary>
+        /// <param name="value">A GUID value.</param>
+        compact_entity_value(const utility::uuid& value)
+            : compact_entity_value()
+        {
+            set_value(value);
+        }
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::compact_entity_value" /> class with a 32-bit integer value.
+        /// </summary>
+        /// <param name="value">A 32-bit integer value.</param>
+        compact_entity_value(int32_t value)
+            : compact_entity_value()
+        {
+            set_value(value);
+        }
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::compact_entity_value" /> class with a 64-bit integer value.
+        /// </summary>
+        /// <param name="value">A 64-bit integer value.</param>
+        compact_entity_value(int64_t value)
+            : compact_entity_value()
+        {
+            set_value(value);
+        }
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::compact_entity_value" /> class with a string value.
+        /// </summary>
+        /// <param name="value">A string value.</param>
+        compact_entity_value(utility::string_t value)
+            : compact_entity_value()
+        {
+            set_value(std::move(value));
+        }
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::compact_entity_value" /> class with a string value.
+        /// </summary>
+        /// <param name="value">A string value.</param>
+        compact_entity_value(const utility::char_t* value)
+            : compact_entity_value()
+        {
+            set_value(utility::string_t(value));
+        }
+
+        /// <summary>
+        /// Gets the property type of the value.
+        /// </summary>
+        /// <returns>An <see cref="azure::storage::edm_type" /> object.</returns>
+        azure::storage::edm_type property_type() const
+        {
+            return m_property_type;
+        }
+
+        /// <summary>
+        /// Indicates whether the value is null.
+        /// </summary>
+        /// <returns><c>true</c> if the value is null.</returns>
+        /// <remarks>
+        /// A null value is the same as a missing property: it is not sent to the service.
+        /// </remarks>
+        bool is_null() const
+        {
+            return m_is_null;
+        }
+
+        /// <summary>
+        /// Indicates whether the value was set, including to null.
+        /// </summary>
+        /// <returns><c>true</c> if the value was set; <c>false</c> if it stands for a missing property.</returns>
+        bool is_set() const
+        {
+            return m_is_set;
+        }
+
+        /// <summary>
+        /// Gets the byte array value.
+        /// </summary>
+        /// <returns>The byte array value.</returns>
+        /// <remarks>
+        /// An exception is thrown if the value is not a byte array.
+        /// </remarks>
+        WASTORAGE_API const std::vector<uint8_t>& binary_value() const;
+
+        /// <summary>
+        /// Gets the boolean value.
+        /// </summary>
+        /// <returns>The boolean value.</returns>
+        /// <remarks>
+        /// An exception is thrown if the value is not a boolean value.
+        /// </remarks>
+        WASTORAGE_API bool boolean_value() const;
+
+        /// <summary>
+        /// Gets the datetime value.
+        /// </summary>
+        /// <returns>The datetime value.</returns>
+        /// <remarks>
+        /// An exception is thrown if the value is not a datetime value.
+        /// </remarks>
+        WASTORAGE_API utility::datetime datetime_value() const;
+
+        /// <summary>
+        /// Gets the double-precision floating point value.
+        /// </summary>
+        /// <returns>The double-precision floating point value.</returns>
+        /// <remarks>
+        /// An exception is thrown if the value is not a double-precision floating point value.
+        /// </remarks>
+        WASTORAGE_API double double_value() const;
+
+        /// <summary>
+        /// Gets the GUID value.
+        /// </summary>
+        /// <returns>The GUID value.</returns>
+        /// <remarks>
+        /// An exception is thrown if the value is not a GUID value.
+        /// </remarks>
+        WASTORAGE_API utility::uuid guid_value() const;
+
+        /// <summary>
+        /// Gets the 32-bit integer value.
+        /// </summary>
+        /// <returns>The 32-bit integer value.</returns>
+        /// <remarks>
+        /// An exception is thrown if the value is not a 32-bit integer value.
+        /// </remarks>
+        WASTORAGE_API int32_t int32_value() const;
+
+        /// <summary>
+        /// Gets the 64-bit integer value.
+        /// </summary>
+        /// <returns>The 64-bit integer value.</returns>
+        /// <remarks>
+        /// An exception is thrown if the value is not a 64-bit integer value.
+        /// </remarks>
+        WASTORAGE_API int64_t int64_value() const;
+
+        /// <summary>
+        /// Gets the string value.
+        /// </summary>
+        /// <returns>The string value.</returns>
+        /// <remarks>
+        /// An exception is thrown if the value is not a string value.
+        /// </remarks>
+        WASTORAGE_API const utility::string_t& string_value() const;
+
+        /// <summary>
+        /// Sets the byte array value.
+        /// </summary>
+        /// <param name="value">The byte array value.</param>
+        void set_value(std::vector<uint8_t> value)
+        {
+            reset(edm_type::binary);
+            m_binary = std::move(value);
+        }
+
+        /// <summary>
+        /// Sets the boolean value.
+        /// </summary>
+        /// <param name="value">The boolean value.</param>
+        void set_value(bool value)
+        {
+            reset(edm_type::boolean);
+            m_scalar.m_boolean = value;
+        }
+
+        /// <summary>
+        /// Sets the datetime value.
+        /// </summary>
+        /// <param name="value">The datetime value.</param>
+        void set_value(utility::datetime value)
+        {
+            reset(edm_type::datetime);
+            m_scalar.m_datetime = value.to_interval();
+        }
+
+        /// <summary>
+        /// Sets the double-precision floating point value.
+        /// </summary>
+        /// <param name="value">The double-precision floating point value.</param>
+        void set_value(double value)
+        {
+            reset(edm_type::double_floating_point);
+            m_scalar.m_double = value;
+        }
+
+        /// <summary>
+        /// Sets the GUID value.
+        /// </summary>
+        /// <param name="value">The GUID value.</param>
+        void set_value(const utility::uuid& value)
+        {
+            reset(edm_type::guid);
+            m_scalar.m_guid = value;
+        }
+
+        /// <summary>
+        /// Sets the 32-bit integer value.
+        /// </summary>
+        /// <param name="value">The 32-bit integer value.</param>
+        void set_value(int32_t value)
+        {
+            reset(edm_type::int32);
+            m_scalar.m_int32 = value;
+        }
+
+        /// <summary>
+        /// Sets the 64-bit integer value.
+        /// </summary>
+        /// <param name="value">The 64-bit integer value.</param>
+        void set_value(int64_t value)
+        {
+            reset(edm_type::int64);
+            m_scalar.m_int64 = value;
+        }
+
+        /// <summary>
+        /// Sets the string value.
+        /// </summary>
+        /// <param name="value">The string value.</param>
+        void set_value(utility::string_t value)
+        {
+            reset(edm_type::string);
+            m_string = std::move(value);
+        }
+
+        /// <summary>
+        /// Sets the value to null.
+        /// </summary>
+        void set_null()
+        {
+            reset(edm_type::string);
+            m_is_null = true;
+        }
+
+        /// <summary>
+        /// Converts the value to an <see cref="azure::storage::entity_property" /> object.
+        /// </summary>
+        /// <returns>An <see cref="azure::storage::entity_property" /> object with the same type and value.</returns>
+        WASTORAGE_API entity_property to_entity_property() const;
+
+    private:
+
+        void reset(edm_type property_type)
+        {
+            if (!m_string.empty())
+            {
+                m_string.clear();
+            }
+
+            if (!m_binary.empty())
+            {
+                m_binary.clear();
+            }
+
+            m_property_type = property_type;
+            m_is_null = false;
+            m_is_set = true;
+        }
+
+        // Only the member for m_property_type is used; strings and byte arrays have their own storage.
+        union scalar_value
+        {
+            bool m_boolean;
+            int32_t m_int32;
+            int64_t m_int64;
+            double m_double;
+            uint64_t m_datetime;
+            utility::uuid m_guid;
+        };
+
+        edm_type m_property_type;
+        bool m_is_null;
+        bool m_is_set;
+        scalar_value m_scalar;
+        utility::string_t m_string;
+        std::vector<uint8_t> m_binary;
+    };
+
+    /// <summary>
+    /// Represents an entity in a table whose property names are kept in a <see cref="azure::storage::table_entity_schema" /> shared with other entities.
+    /// </summary>
+    /// <remarks>
+    /// The values are stored by property index, with typed values instead of strings, which uses much less memory than
+    /// <see cref="azure::storage::table_entity" /> when many entities with the same properties are read.
+    /// </remarks>
+    class compact_table_entity
+    {
+    public:
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::compact_table_entity" /> class.
+        /// </summary>
+        compact_table_entity()
+        {
+        }
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::compact_table_entity" /> class with the specified schema, partition key and row key.
+        /// </summary>
+        /// <param name="schema">The schema that names the properties of the entity.</param>
+        /// <param name="partition_key">The partition key value for the entity.</param>
+        /// <param name="row_key">The row key value for the entity.</param>
+        compact_table_entity(std::shared_ptr<const table_entity_schema> schema, utility::string_t partition_key, utility::string_t row_key)
+            : m_schema(std::move(schema)), m_partition_key(std::move(partition_key)), m_row_key(std::move(row_key))
+        {
+        }
+
+        /// <summary>
+        /// Gets the schema that names the properties of the entity.
+        /// </summary>
+        /// <returns>The entity schema.</returns>
+        const std::shared_ptr<const table_entity_schema>& schema() const
+        {
+            return m_schema;
+        }
+
+        /// <summary>
+        /// Gets the property values, indexed like the property names of the schema.
+        /// </summary>
+        /// <returns>The property values.</returns>
+        /// <remarks>
+        /// There can be fewer values than properties in the schema; the missing values are null.
+        /// </remarks>
+        const std::vector<compact_entity_value>& values() const
+        {
+            return m_values;
+        }
+
+        /// <summary>
+        /// Gets the value of the property at the specified index of the schema.
+        /// </summary>
+        /// <param name="index">The index of the property.</param>
+        /// <returns>The property value, which is null if the entity does not have the property.</returns>
+        WASTORAGE_API const compact_entity_value& value(size_t index) const;
+
+        /// <summary>
+        /// Gets the value of the specified property.
+        /// </summary>
+        /// <param name="property_name">The property name.</param>
+        /// <returns>The property value, which is null if the entity does not have the property.</returns>
+        WASTORAGE_API const compact_entity_value& value(const utility::string_t& property_name) const;
+
+        /// <summary>
+        /// Sets the value of the property at the specified index of the schema.
+        /// </summary>
+        /// <param name="index">The index of the property.</param>
+        /// <param name="value">The property value.</param>
+        WASTORAGE_API void set_value(size_t index, compact_entity_value value);
+
+        /// <summary>
+        /// Gets the entity's partition key.
+        /// </summary>
+        /// <returns>The entity partition key.</returns>
+        const utility::string_t& partition_key() const
+        {
+            return m_partition_key;
+        }
+
+        /// <summary>
+        /// Sets the entity's partition key.
+        /// </summary>
+        /// <param name="partition_key">The entity partition key.</param>
+        void set_partition_key(utility::string_t partition_key)
+        {
+            m_partition_key = std::move(partition_key);
+        }
+
+        /// <summary>
+        /// Gets the entity's row key.
+        /// </summary>
+        /// <returns>The entity row key.</returns>
+        const utility::string_t& row_key() const
+        {
+            return m_row_key;
+        }
+
+        /// <summary>
+        /// Sets the entity's row key.
+        /// </summary>
+        /// <param name="row_key">The entity row key.</param>
+        void set_row_key(utility::string_t row_key)
+        {
+            m_row_key = std::move(row_key);
+        }
+
+        /// <summary>
+        /// Gets the entity's timestamp.
+        /// </summary>
+        /// <returns>The entity timestamp.</returns>
+        utility::datetime timestamp() const
+        {
+            return m_timestamp;
+        }
+
+        /// <summary>
+        /// Gets the entity's current ETag.
+        /// </summary>
+        /// <returns>The entity's ETag value, as a string.</returns>
+        const utility::string_t& etag() const
+        {
+            return m_etag;
+        }
+
+        /// <summary>
+        /// Sets the entity's current ETag.
+        /// </summary>
+        /// <param name="etag">The entity's ETag value, as a string.</param>
+        /// <remarks>
+        /// Set this value to "*" in order to overwrite an entity as part of an update operation.
+        /// </remarks>
+        void set_etag(utility::string_t etag)
+        {
+            m_etag = std::move(etag);
+        }
+
+        /// <summary>
+        /// Converts the entity to a <see cref="azure::storage::table_entity" /> object.
+        /// </summary>
+        /// <returns>A <see cref="azure::storage::table_entity" /> object with the same keys, ETag and properties.</returns>
+        /// <remarks>
+        /// Values that were set to null become null properties, like in entities returned by a table query; missing values are left out.
+        /// </remarks>
+        WASTORAGE_API table_entity to_table_entity() const;
+
+    private:
+
+        void set_timestamp(utility::datetime timestamp)
+        {
+            m_timestamp = timestamp;
+        }
+
+        std::shared_ptr<const table_entity_schema> m_schema;
+        std::vector<compact_entity_value> m_values;
+        utility::string_t m_partition_key;
+        utility::string_t m_row_key;
+        utility::datetime m_timestamp;
+        utility::string_t m_etag;
+
+        friend class protocol::table_query_reader;
+    };
+
+    /// <summary>
+    /// Represents the columns that a typed table query reads, and how each column is stored into an object.
+    /// </summary>
+    /// <remarks>
+    /// Use <see cref="azure::storage::table_entity_mapping{entity_type}" /> to map the columns to the members of a type.
+    /// </remarks>
+    class table_column_mapping
+    {
+    public:
+
+        typedef std::function<void(void*, const compact_entity_value&)> column_setter;
+        typedef std::function<void(void*, utility::string_t)> string_setter;
+        typedef std::function<void(void*, utility::datetime)> datetime_setter;
+
+        /// <summary>
+        /// Represents a mapped column.
+        /// </summary>
+        struct column
+        {
+            column(utility::string_t name, edm_type property_type, column_setter setter)
+                : m_name(std::move(name)), m_property_type(property_type), m_setter(std::move(setter))
+            {
+            }
+
+            utility::string_t m_name;
+            edm_type m_property_type;
+            column_setter m_setter;
+        };
+
+        /// <summary>
+        /// Gets the mapped columns.
+        /// </summary>
+        /// <returns>The mapped columns, in the order they were added.</returns>
+        const std::vector<column>& columns() const
+        {
+            return m_columns;
+        }
+
+        /// <summary>
+        /// Finds the index of the specified column.
+        /// </summary>
+        /// <param name="name">The column name.</param>
+        /// <param name="index">Receives the index of the column.</param>
+        /// <returns><c>true</c> if the column is mapped.</returns>
+        bool find(const utility::string_t& name, size_t& index) const
+        {
+            auto it = m_indexes.find(name);
+            if (it == m_indexes.end())
+            {
+                return false;
+            }
+
+            index = it->second;
+            return true;
+        }
+
+        /// <summary>
+        /// Gets the names of the mapped columns, to be sent as the <c>$select</c> query option.
+        /// </summary>
+        /// <returns>An enumerable collection of strings containing the names of the mapped columns.</returns>
+        WASTORAGE_API std::vector<utility::string_t> select_columns() const;
+
+        /// <summary>
+        /// Gets the function that stores the partition key into an object.
+        /// </summary>
+        /// <returns>The function, which is empty if the partition key is not mapped.</returns>
+        const string_setter& partition_key_setter() const
+        {
+            return m_partition_key_setter;
+        }
+
+        /// <summary>
+        /// Gets the function that stores the row key into an object.
+        /// </summary>
+        /// <returns>The function, which is empty if the row key is not mapped.</returns>
+        const string_setter& row_key_setter() const
+        {
+            return m_row_key_setter;
+        }
+
+        /// <summary>
+        /// Gets the function that stores the ETag into an object.
+        /// </summary>
+        /// <returns>The function, which is empty if the ETag is not mapped.</returns>
+        const string_setter& etag_setter() const
+        {
+            return m_etag_setter;
+        }
+
+        /// <summary>
+        /// Gets the function that stores the timestamp into an object.
+        /// </summary>
+        /// <returns>The function, which is empty if the timestamp is not mapped.</returns>
+        const datetime_setter& timestamp_setter() const
+        {
+            return m_timestamp_setter;
+        }
+
+    protected:
+
+        WASTORAGE_API void add_column(utility::string_t name, edm_type property_type, column_setter setter);
+
+        string_setter m_partition_key_setter;
+        string_setter m_row_key_setter;
+        string_setter m_etag_setter;
+        datetime_setter m_timestamp_setter;
+
+    private:
+
+        std::vector<column> m_columns;
+        std::unordered_map<utility::string_t, size_t> m_indexes;
+    };
+
+    /// <summary>
+    /// Maps table columns to the members of a type, so that a query reads its results straight into objects of that type.
+    /// </summary>
+    /// <typeparam name="entity_type">The type of the objects to read, which must be default constructible.</typeparam>
+    /// <remarks>
+    /// The type of each column is given by the type of its member, so values are converted once from the response and
+    /// no <see cref="azure::storage::table_entity" /> is built. Columns that are not in an entity leave their member unchanged.
+    /// </remarks>
+    template<typename entity_type>
+    class table_entity_mapping : public table_column_mapping
+    {
+    public:
+
+        /// <summary>
+        /// Maps a column to a byte array member.
+        /// </summary>
+        /// <param name="name">The column name.</param>
+        /// <param name="member">The member that receives the value.</param>
+        /// <returns>A reference to this mapping.</returns>
+        table_entity_mapping& map(utility::string_t name, std::vector<uint8_t> entity_type::* member)
+        {
+            add_column(std::move(name), edm_type::binary, [member](void* object, const compact_entity_value& value)
+            {
+                static_cast<entity_type*>(object)->*member = value.binary_value();
+            });
+            return *this;
+        }
+
+        /// <summary>
+        /// Maps a column to a boolean member.
+        /// </summary>
+        /// <param name="name">The column name.</param>
+        /// <param name="member">The member that receives the value.</param>
+        /// <returns>A reference to this mapping.</returns>
+        table_entity_mapping& map(utility::string_t name, bool entity_type::* member)
+        {
+            add_column(std::move(name), edm_type::boolean, [member](void* object, const compact_entity_value& value)
+            {
+                static_cast<entity_type*>(object)->*member = value.boolean_value();
+            });
+            return *this;
+        }
+
+        /// <summary>
+        /// Maps a column to a datetime member.
+        /// </summary>
+        /// <param name="name">The column name.</param>
+        /// <param name="member">The member that receives the value.</param>
+        /// <returns>A reference to this mapping.</returns>
+        table_entity_mapping& map(utility::string_t name, utility::datetime entity_type::* member)
+        {
+            add_column(std::move(name), edm_type::datetime, [member](void* object, const compact_entity_value& value)
+            {
+                static_cast<entity_type*>(object)->*member = value.datetime_value();
+            });
+            return *this;
+        }
+
+        /// <summary>
+        /// Maps a column to a double-precision floating point member.
+        /// </summary>
+        /// <param name="name">The column name.</param>
+        /// <param name="member">The member that receives the value.</param>
+        /// <returns>A reference to this mapping.</returns>
+        table_entity_mapping& map(utility::string_t name, double entity_type::* member)
+        {
+            add_column(std::move(name), edm_type::double_floating_point, [member](void* object, const compact_entity_value& value)
+            {
+                static_cast<entity_type*>(object)->*member = value.double_value();
+            });
+            return *this;
+        }
+
+        /// <summary>
+        /// Maps a column to a GUID member.
+        /// </summary>
+        /// <param name="name">The column name.</param>
+        /// <param name="member">The member that receives the value.</param>
+        /// <returns>A reference to this mapping.</returns>
+        table_entity_mapping& map(utility::string_t name, utility::uuid entity_type::* member)
+        {
+            add_column(std::move(name), edm_type::guid, [member](void* object, const compact_entity_value& value)
+            {
+                static_cast<entity_type*>(object)->*member = value.guid_value();
+            });
+            return *this;
+        }
+
+        /// <summary>
+        /// Maps a column to a 32-bit integer member.
+        /// </summary>
+        /// <param name="name">The column name.</param>
+        /// <param name="member">The member that receives the value.</param>
+        /// <returns>A reference to this mapping.</returns>
+        table_entity_mapping& map(utility::string_t name, int32_t entity_type::* member)
+        {
+            add_column(std::move(name), edm_type::int32, [member](void* object, const compact_entity_value& value)
+            {
+                static_cast<entity_type*>(object)->*member = value.int32_value();
+            });
+            return *this;
+        }
+
+        /// <summary>
+        /// Maps a column to a 64-bit integer member.
+        /// </summary>
+        /// <param name="name">The column name.</param>
+        /// <param name="member">The member that receives the value.</param>
+        /// <returns>A reference to this mapping.</returns>
+        table_entity_mapping& map(utility::string_t name, int64_t entity_type::* member)
+        {
+            add_column(std::move(name), edm_type::int64, [member](void* object, const compact_entity_value& value)
+            {
+                static_cast<entity_type*>(object)->*member = value.int64_value();
+            });
+            return *this;
+        }
+
+        /// <summary>
+        /// Maps a column to a string member.
+        /// </summary>
+        /// <param name="name">The column name.</param>
+        /// <param name="member">The member that receives the value.</param>
+        /// <returns>A reference to this mapping.</returns>
+        table_entity_mapping& map(utility::string_t name, utility::string_t entity_type::* member)
+        {
+            add_column(std::move(name), edm_type::string, [member](void* object, const compact_entity_value& value)
+            {
+                static_cast<entity_type*>(object)->*member = value.string_value();
+            });
+            return *this;
+        }
+
+        /// <summary>
+        /// Maps the partition key to a string member.
+        /// </summary>
+        /// <param name="member">The member that receives the partition key.</param>
+        /// <returns>A reference to this mapping.</returns>
+        table_entity_mapping& map_partition_key(utility::string_t entity_type::* member)
+        {
+            m_partition_key_setter = [member](void* object, utility::string_t value)
+            {
+                static_cast<entity_type*>(object)->*member = std::move(value);
+            };
+            return *this;
+        }
+
+        /// <summary>
+        /// Maps the row key to a string member.
+        /// </summary>
+        /// <param name="member">The member that receives the row key.</param>
+        /// <returns>A reference to this mapping.</returns>
+        table_entity_mapping& map_row_key(utility::string_t entity_type::* member)
+        {
+            m_row_key_setter = [member](void* object, utility::string_t value)
+            {
+                static_cast<entity_type*>(object)->*member = std::move(value);
+            };
+            return *this;
+        }
+
+        /// <summary>
+        /// Maps the ETag to a string member.
+        /// </summary>
+        /// <param name="member">The member that receives the ETag.</param>
+        /// <returns>A reference to this mapping.</returns>
+        table_entity_mapping& map_etag(utility::string_t entity_type::* member)
+        {
+            m_etag_setter = [member](void* object, utility::string_t value)
+            {
+                static_cast<entity_type*>(object)->*member = std::move(value);
+            };
+            return *this;
+        }
+
+        /// <summary>
+        /// Maps the timestamp to a datetime member.
+        /// </summary>
+        /// <param name="member">The member that receives the timestamp.</param>
+        /// <returns>A reference to this mapping.</returns>
+        table_entity_mapping& map_timestamp(utility::datetime entity_type::* member)
+        {
+            m_timestamp_setter = [member](void* object, utility::datetime value)
+            {
+                static_cast<entity_type*>(object)->*member = value;
+            };
+            return *this;
+        }
     };
 
     /// <summary>
@@ -1614,6 +2506,9 @@ namespace azure { namespace storage {
     typedef result_segment<table_entity> table_query_segment;
     typedef result_iterator<table_entity> table_query_iterator;
 
+    typedef result_segment<compact_table_entity> compact_table_query_segment;
+    typedef result_iterator<compact_table_entity> compact_table_query_iterator;
+
     /// <summary>
     /// Provides a client-side logical representation of the Windows Azure Table service. 
     /// This client is used to configure and execute requests against the Table service.
@@ -2048,6 +2943,51 @@ namespace azure { namespace storage {
         /// <returns>A <see cref="pplx::task" /> object of type <see cref="azure::storage::table_result" /> that represents the current operation.</returns>
         WASTORAGE_API pplx::task<table_result> execute_async(const table_operation& operation, const table_request_options& options, operation_context context) const;
 
+        /// <summary>
+        /// Executes an operation on a table with a compact entity, whose values are written to the request without being converted to an <see cref="azure::storage::entity_property" />.
+        /// </summary>
+        /// <param name="operation_type">The type of operation, which cannot be <see cref="azure::storage::table_operation_type::retrieve_operation" />.</param>
+        /// <param name="entity">The <see cref="azure::storage::compact_table_entity" /> to operate upon.</param>
+        /// <returns>An <see cref="azure::storage::table_result" /> containing the result of the operation.</returns>
+        table_result execute(table_operation_type operation_type, const compact_table_entity& entity) const
+        {
+            return execute_async(operation_type, entity, table_request_options(), operation_context()).get();
+        }
+
+        /// <summary>
+        /// Executes an operation on a table with a compact entity, whose values are written to the request without being converted to an <see cref="azure::storage::entity_property" />.
+        /// </summary>
+        /// <param name="operation_type">The type of operation, which cannot be <see cref="azure::storage::table_operation_type::retrieve_operation" />.</param>
+        /// <param name="entity">The <see cref="azure::storage::compact_table_entity" /> to operate upon.</param>
+        /// <param name="options">An <see cref="azure::storage::table_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation. This object is used to track requests to the storage service, and to provide additional runtime information about the operation.</param>
+        /// <returns>An <see cref="azure::storage::table_result" /> containing the result of the operation.</returns>
+        table_result execute(table_operation_type operation_type, const compact_table_entity& entity, const table_request_options& options, operation_context context) const
+        {
+            return execute_async(operation_type, entity, options, context).get();
+        }
+
+        /// <summary>
+        /// Intitiates an asynchronous operation that executes an operation on a table with a compact entity.
+        /// </summary>
+        /// <param name="operation_type">The type of operation, which cannot be <see cref="azure::storage::table_operation_type::retrieve_operation" />.</param>
+        /// <param name="entity">The <see cref="azure::storage::compact_table_entity" /> to operate upon.</param>
+        /// <returns>A <see cref="pplx::task" /> object of type <see cref="azure::storage::table_result" /> that represents the current operation.</returns>
+        pplx::task<table_result> execute_async(table_operation_type operation_type, const compact_table_entity& entity) const
+        {
+            return execute_async(operation_type, entity, table_request_options(), operation_context());
+        }
+
+        /// <summary>
+        /// Intitiates an asynchronous operation that executes an operation on a table with a compact entity.
+        /// </summary>
+        /// <param name="operation_type">The type of operation, which cannot be <see cref="azure::storage::table_operation_type::retrieve_operation" />.</param>
+        /// <param name="entity">The <see cref="azure::storage::compact_table_entity" /> to operate upon.</param>
+        /// <param name="options">An <see cref="azure::storage::table_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation. This object is used to track requests to the storage service, and to provide additional runtime information about the operation.</param>
+        /// <returns>A <see cref="pplx::task" /> object of type <see cref="azure::storage::table_result" /> that represents the current operation.</returns>
+        WASTORAGE_API pplx::task<table_result> execute_async(table_operation_type operation_type, const compact_table_entity& entity, const table_request_options& options, operation_context context) const;
+
         /// <summary>
         /// Executes a batch operation on a table as an atomic operation.
         /// </summary>
@@ -2155,6 +3095,222 @@ namespace azure { namespace storage {
         /// <returns>A <see cref="pplx::task" /> object of type <see cref="azure::storage::table_result_segment" /> that represents the current operation.</returns>
         WASTORAGE_API pplx::task<table_query_segment> execute_query_segmented_async(const table_query& query, const continuation_token& token, const table_request_options& options, operation_context context) const;
 
+        /// <summary>
+        /// Executes a query on a table and returns compact entities, which share the property names of a <see cref="azure::storage::table_entity_schema" /> and keep typed values.
+        /// </summary>
+        /// <param name="query">An <see cref="azure::storage::table_query" /> object.</param>
+        /// <returns>An <see cref="azure::storage::compact_table_query_iterator" /> that can be used to to lazily enumerate a collection of <see cref="azure::storage::compact_table_entity" /> objects.</returns>
+        compact_table_query_iterator execute_compact_query(const table_query& query) const
+        {
+            return execute_compact_query(query, table_request_options(), operation_context());
+        }
+
+        /// <summary>
+        /// Executes a query on a table and returns compact entities, which share the property names of a <see cref="azure::storage::table_entity_schema" /> and keep typed values.
+        /// </summary>
+        /// <param name="query">An <see cref="azure::storage::table_query" /> object.</param>
+        /// <param name="options">An <see cref="azure::storage::table_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation. This object is used to track requests to the storage service, and to provide additional runtime information about the operation.</param>
+        /// <returns>An <see cref="azure::storage::compact_table_query_iterator" /> that can be used to to lazily enumerate a collection of <see cref="azure::storage::compact_table_entity" /> objects.</returns>
+        /// <remarks>
+        /// Each segment starts from the schema of the previous one, so entities of all segments share one schema as long as no new property is found.
+        /// </remarks>
+        WASTORAGE_API compact_table_query_iterator execute_compact_query(const table_query& query, const table_request_options& options, operation_context context) const;
+
+        /// <summary>
+        /// Intitiates an asynchronous operation that executes a query with the specified <see cref="azure::storage::continuation_token" /> and returns compact entities.
+        /// </summary>
+        /// <param name="query">An <see cref="azure::storage::table_query" /> object.</param>
+        /// <param name="token">An <see cref="azure::storage::continuation_token" /> object.</param>
+        /// <param name="schema">The schema to start from, such as the schema of the entities of the previous segment, or <c>nullptr</c>.</param>
+        /// <returns>A <see cref="pplx::task" /> object of type <see cref="azure::storage::compact_table_query_segment" /> that represents the current operation.</returns>
+        pplx::task<compact_table_query_segment> execute_compact_query_segmented_async(const table_query& query, const continuation_token& token, std::shared_ptr<const table_entity_schema> schema) const
+        {
+            return execute_compact_query_segmented_async(query, token, std::move(schema), table_request_options(), operation_context());
+        }
+
+        /// <summary>
+        /// Intitiates an asynchronous operation that executes a query with the specified <see cref="azure::storage::continuation_token" /> and returns compact entities.
+        /// </summary>
+        /// <param name="query">An <see cref="azure::storage::table_query" /> object.</param>
+        /// <param name="token">An <see cref="azure::storage::continuation_token" /> object.</param>
+        /// <param name="schema">The schema to start from, such as the schema of the entities of the previous segment, or <c>nullptr</c>.</param>
+        /// <param name="options">An <see cref="azure::storage::table_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation. This object is used to track requests to the storage service, and to provide additional runtime information about the operation.</param>
+        /// <returns>A <see cref="pplx::task" /> object of type <see cref="azure::storage::compact_table_query_segment" /> that represents the current operation.</returns>
+        /// <remarks>
+        /// The schema passed in is only replaced, never changed, when the segment has properties that it does not have.
+        /// </remarks>
+        WASTORAGE_API pplx::task<compact_table_query_segment> execute_compact_query_segmented_async(const table_query& query, const continuation_token& token, std::shared_ptr<const table_entity_schema> schema, const table_request_options& options, operation_context context) const;
+
+        /// <summary>
+        /// Executes a query on a table and reads the results straight into objects of the mapped type.
+        /// </summary>
+        /// <typeparam name="entity_type">The type of the objects to read.</typeparam>
+        /// <param name="query">An <see cref="azure::storage::table_query" /> object. Its select columns are replaced by the mapped columns.</param>
+        /// <param name="mapping">The <see cref="azure::storage::table_entity_mapping{entity_type}" /> that maps the columns to members of <typeparamref name="entity_type" />.</param>
+        /// <returns>A <see cref="azure::storage::result_iterator{entity_type}" /> that can be used to to lazily enumerate the objects.</returns>
+        template<typename entity_type>
+        result_iterator<entity_type> execute_query(const table_query& query, const table_entity_mapping<entity_type>& mapping) const
+        {
+            return execute_query(query, mapping, table_request_options(), operation_context());
+        }
+
+        /// <summary>
+        /// Executes a query on a table and reads the results straight into objects of the mapped type.
+        /// </summary>
+        /// <typeparam name="entity_type">The type of the objects to read.</typeparam>
+        /// <param name="query">An <see cref="azure::storage::table_query" /> object. Its select columns are replaced by the mapped columns.</param>
+        /// <param name="mapping">The <see cref="azure::storage::table_entity_mapping{entity_type}" /> that maps the columns to members of <typeparamref name="entity_type" />.</param>
+        /// <param name="options">An <see cref="azure::storage::table_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation. This object is used to track requests to the storage service, and to provide additional runtime information about the operation.</param>
+        /// <returns>A <see cref="azure::storage::result_iterator{entity_type}" /> that can be used to to lazily enumerate the objects.</returns>
+        template<typename entity_type>
+        result_iterator<entity_type> execute_query(const table_query& query, const table_entity_mapping<entity_type>& mapping, const table_request_options& options, operation_context context) const
+        {
+            auto instance = std::make_shared<cloud_table>(*this);
+            std::shared_ptr<const table_column_mapping> shared_mapping = std::make_shared<table_entity_mapping<entity_type>>(mapping);
+            return result_iterator<entity_type>(
+                [instance, query, shared_mapping, options, context](const continuation_token& token, size_t)
+            {
+                return instance->execute_mapped_query_segmented_async<entity_type>(query, token, shared_mapping, options, context);
+            },
+                query.take_count() <= 0 ? 0 : query.take_count(), 0, options.segment_prefetch_depth());
+        }
+
+        /// <summary>
+        /// Intitiates an asynchronous operation that executes a query with the specified <see cref="azure::storage::continuation_token" /> and reads the results straight into objects of the mapped type.
+        /// </summary>
+        /// <typeparam name="entity_type">The type of the objects to read.</typeparam>
+        /// <param name="query">An <see cref="azure::storage::table_query" /> object. Its select columns are replaced by the mapped columns.</param>
+        /// <param name="token">An <see cref="azure::storage::continuation_token" /> object.</param>
+        /// <param name="mapping">The <see cref="azure::storage::table_entity_mapping{entity_type}" /> that maps the columns to members of <typeparamref name="entity_type" />.</param>
+        /// <returns>A <see cref="pplx::task" /> object of type <see cref="azure::storage::result_segment{entity_type}" /> that represents the current operation.</returns>
+        template<typename entity_type>
+        pplx::task<result_segment<entity_type>> execute_query_segmented_async(const table_query& query, const continuation_token& token, const table_entity_mapping<entity_type>& mapping) const
+        {
+            return execute_query_segmented_async(query, token, mapping, table_request_options(), operation_context());
+        }
+
+        /// <summary>
+        /// Intitiates an asynchronous operation that executes a query with the specified <see cref="azure::storage::continuation_token" /> and reads the results straight into objects of the mapped type.
+        /// </summary>
+        /// <typeparam name="entity_type">The type of the objects to read.</typeparam>
+        /// <param name="query">An <see cref="azure::storage::table_query" /> object. Its select columns are replaced by the mapped columns.</param>
+        /// <param name="token">An <see cref="azure::storage::continuation_token" /> object.</param>
+        /// <param name="mapping">The <see cref="azure::storage::table_entity_mapping{entity_type}" /> that maps the columns to members of <typeparamref name="entity_type" />.</param>
+        /// <param name="options">An <see cref="azure::storage::table_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation. This object is used to track requests to the storage service, and to provide additional runtime information about the operation.</param>
+        /// <returns>A <see cref="pplx::task" /> object of type <see cref="azure::storage::result_segment{entity_type}" /> that represents the current operation.</returns>
+        template<typename entity_type>
+        pplx::task<result_segment<entity_type>> execute_query_segmented_async(const table_query& query, const continuation_token& token, const table_entity_mapping<entity_type>& mapping, const table_request_options& options, operation_context context) const
+        {
+            return execute_mapped_query_segmented_async<entity_type>(query, token, std::make_shared<table_entity_mapping<entity_type>>(mapping), options, context);
+        }
+
+        /// <summary>
+        /// Executes a query on a table by scanning several PartitionKey ranges at the same time.
+        /// </summary>
+        /// <param name="query">An <see cref="azure::storage::table_query" /> object.</param>
+        /// <param name="partition_key_boundaries">The PartitionKey values that split the table into ranges. The first range ends before the first boundary and the last range starts at the last boundary.</param>
+        /// <param name="parallelism">The maximum number of ranges that are scanned at the same time.</param>
+        /// <param name="segment_handler">The function that receives the entities of each retrieved segment.</param>
+        void execute_query_parallel(const table_query& query, const std::vector<utility::string_t>& partition_key_boundaries, int parallelism, std::function<void(const std::vector<table_entity>&)> segment_handler) const
+        {
+            execute_query_parallel_async(query, partition_key_boundaries, parallelism, std::move(segment_handler)).wait();
+        }
+
+        /// <summary>
+        /// Executes a query on a table by scanning several PartitionKey ranges at the same time.
+        /// </summary>
+        /// <param name="query">An <see cref="azure::storage::table_query" /> object.</param>
+        /// <param name="partition_key_boundaries">The PartitionKey values that split the table into ranges. The first range ends before the first boundary and the last range starts at the last boundary.</param>
+        /// <param name="parallelism">The maximum number of ranges that are scanned at the same time.</param>
+        /// <param name="segment_handler">The function that receives the entities of each retrieved segment.</param>
+        /// <param name="options">An <see cref="azure::storage::table_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation. This object is used to track requests to the storage service, and to provide additional runtime information about the operation. </param>
+        void execute_query_parallel(const table_query& query, const std::vector<utility::string_t>& partition_key_boundaries, int parallelism, std::function<void(const std::vector<table_entity>&)> segment_handler, const table_request_options& options, operation_context context) const
+        {
+            execute_query_parallel_async(query, partition_key_boundaries, parallelism, std::move(segment_handler), options, context).wait();
+        }
+
+        /// <summary>
+        /// Intitiates an asynchronous operation that executes a query on a table by scanning several PartitionKey ranges at the same time.
+        /// </summary>
+        /// <param name="query">An <see cref="azure::storage::table_query" /> object.</param>
+        /// <param name="partition_key_boundaries">The PartitionKey values that split the table into ranges. The first range ends before the first boundary and the last range starts at the last boundary.</param>
+        /// <param name="parallelism">The maximum number of ranges that are scanned at the same time.</param>
+        /// <param name="segment_handler">The function that receives the entities of each retrieved segment.</param>
+        /// <returns>A <see cref="pplx::task" /> object that represents the current operation.</returns>
+        pplx::task<void> execute_query_parallel_async(const table_query& query, const std::vector<utility::string_t>& partition_key_boundaries, int parallelism, std::function<void(const std::vector<table_entity>&)> segment_handler) const
+        {
+            return execute_query_parallel_async(query, partition_key_boundaries, parallelism, std::move(segment_handler), table_request_options(), operation_context());
+        }
+
+        /// <summary>
+        /// Intitiates an asynchronous operation that executes a query on a table by scanning several PartitionKey ranges at the same time.
+        /// </summary>
+        /// <param name="query">An <see cref="azure::storage::table_query" /> object.</param>
+        /// <param name="partition_key_boundaries">The PartitionKey values that split the table into ranges. The first range ends before the first boundary and the last range starts at the last boundary.</param>
+        /// <param name="parallelism">The maximum number of ranges that are scanned at the same time.</param>
+        /// <param name="segment_handler">The function that receives the entities of each retrieved segment.</param>
+        /// <param name="options">An <see cref="azure::storage::table_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation. This object is used to track requests to the storage service, and to provide additional runtime information about the operation. </param>
+        /// <returns>A <see cref="pplx::task" /> object that represents the current operation.</returns>
+        /// <remarks>
+        /// <para>Each range is read segment by segment, following continuation tokens, and the next range is started as soon as one finishes.
+        /// The handler is never called concurrently, and the next segment of a range is only requested once the handler has returned, so a slow handler bounds the memory used.
+        /// Segments of different ranges are interleaved, so entities are not delivered in key order.</para>
+        /// <para>The take count of the query limits the size of each segment. If a request or the handler fails, no new request is started and the task completes with the first failure.</para>
+        /// </remarks>
+        WASTORAGE_API pplx::task<void> execute_query_parallel_async(const table_query& query, const std::vector<utility::string_t>& partition_key_boundaries, int parallelism, std::function<void(const std::vector<table_entity>&)> segment_handler, const table_request_options& options, operation_context context) const;
+
+        /// <summary>
+        /// Finds PartitionKey boundaries that split the table into approximately the specified number of ranges, for use with <see cref="azure::storage::cloud_table::execute_query_parallel" />.
+        /// </summary>
+        /// <param name="range_count">The number of ranges wanted.</param>
+        /// <returns>A sorted enumerable collection of PartitionKey values that exist in the table.</returns>
+        std::vector<utility::string_t> sample_partition_key_boundaries(int range_count) const
+        {
+            return sample_partition_key_boundaries_async(range_count).get();
+        }
+
+        /// <summary>
+        /// Finds PartitionKey boundaries that split the table into approximately the specified number of ranges, for use with <see cref="azure::storage::cloud_table::execute_query_parallel" />.
+        /// </summary>
+        /// <param name="range_count">The number of ranges wanted.</param>
+        /// <param name="options">An <see cref="azure::storage::table_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation. This object is used to track requests to the storage service, and to provide additional runtime information about the operation. </param>
+        /// <returns>A sorted enumerable collection of PartitionKey values that exist in the table.</returns>
+        std::vector<utility::string_t> sample_partition_key_boundaries(int range_count, const table_request_options& options, operation_context context) const
+        {
+            return sample_partition_key_boundaries_async(range_count, options, context).get();
+        }
+
+        /// <summary>
+        /// Intitiates an asynchronous operation that finds PartitionKey boundaries that split the table into approximately the specified number of ranges.
+        /// </summary>
+        /// <param name="range_count">The number of ranges wanted.</param>
+        /// <returns>A <see cref="pplx::task" /> object of type <see cref="std::vector" />, of type <see cref="utility::string_t" />, that represents the current operation.</returns>
+        pplx::task<std::vector<utility::string_t>> sample_partition_key_boundaries_async(int range_count) const
+        {
+            return sample_partition_key_boundaries_async(range_count, table_request_options(), operation_context());
+        }
+
+        /// <summary>
+        /// Intitiates an asynchronous operation that finds PartitionKey boundaries that split the table into approximately the specified number of ranges.
+        /// </summary>
+        /// <param name="range_count">The number of ranges wanted.</param>
+        /// <param name="options">An <see cref="azure::storage::table_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation. This object is used to track requests to the storage service, and to provide additional runtime information about the operation. </param>
+        /// <returns>A <see cref="pplx::task" /> object of type <see cref="std::vector" />, of type <see cref="utility::string_t" />, that represents the current operation.</returns>
+        /// <remarks>
+        /// <para>The key space between the first PartitionKey of the table and the end of the printable ASCII range is split evenly, and each split point
+        /// is moved to the first PartitionKey at or after it, with one small query per split point. Ranges are therefore even in key space rather than in row count.
+        /// Keys that share a long common prefix, or that start with non-ASCII characters, give fewer or uneven ranges.</para>
+        /// </remarks>
+        WASTORAGE_API pplx::task<std::vector<utility::string_t>> sample_partition_key_boundaries_async(int range_count, const table_request_options& options, operation_context context) const;
+
         /// <summary>
         /// Creates a table.
         /// </summary>
@@ -2483,6 +3639,27 @@ namespace azure { namespace storage {
         pplx::task<bool> create_async_impl(const table_request_options& options, operation_context context, bool allow_conflict);
         pplx::task<bool> delete_async_impl(const table_request_options& options, operation_context context, bool allow_not_found);
         pplx::task<bool> exists_async_impl(const table_request_options& options, operation_context context, bool allow_secondary) const;
+        pplx::task<table_result> execute_async_impl(const table_operation& operation, std::shared_ptr<const std::string> compact_body, const table_request_options& options, operation_context context) const;
+
+        template<typename entity_type>
+        pplx::task<result_segment<entity_type>> execute_mapped_query_segmented_async(const table_query& query, const continuation_token& token, std::shared_ptr<const table_column_mapping> mapping, const table_request_options& options, operation_context context) const
+        {
+            auto results = std::make_shared<std::vector<entity_type>>();
+            return execute_mapped_query_segmented_async(query, token, std::move(mapping), [results]()
+            {
+                results->clear();
+            }, [results]() -> void*
+            {
+                results->emplace_back();
+                return &results->back();
+            }, options, context).then([results](continuation_token next_token) -> result_segment<entity_type>
+            {
+                return result_segment<entity_type>(std::move(*results), std::move(next_token));
+            });
+        }
+
+        // Reads the objects of a segment through the callbacks: clear_objects is called before each response is read, then add_object once per entity.
+        WASTORAGE_API pplx::task<continuation_token> execute_mapped_query_segmented_async(const table_query& query, const continuation_token& token, std::shared_ptr<const table_column_mapping> mapping, std::function<void()> clear_objects, std::function<void*()> add_object, const table_request_options& options, operation_context context) const;
 
         cloud_table_client m_client;
         utility::string_t m_name;
@@ -2491,4 +3668,79 @@ namespace azure { namespace storage {
         friend class cloud_table_client;
     };
 
+    /// <summary>
+    /// Collects individual table operations and sends them as batch operations, one partition per batch.
+    /// </summary>
+    /// <remarks>
+    /// <para>Operations can be added from several threads at the same time. Operations with the same PartitionKey are collected into a pending batch,
+    /// which is sent when it reaches the maximum batch size or the 4MB payload limit of a batch, when the first operation in it has waited for the maximum latency, or when
+    /// <see cref="azure::storage::table_batch_writer::flush_async" /> is called. Up to the specified number of batches are sent at the same time.</para>
+    /// <para>An operation on an entity that is already in the pending batch of its partition sends that batch first, and its own batch is only sent
+    /// once the earlier one has completed, so operations on the same entity are applied in the order they were added.
+    /// Retrieve operations cannot be batched with other operations and are sent on their own.</para>
+    /// <para>If a batch fails, every operation in it completes with the same failure, because the service applies a batch atomically.</para>
+    /// </remarks>
+    class table_batch_writer
+    {
+    public:
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::table_batch_writer" /> class with default limits.
+        /// </summary>
+        /// <param name="table">The <see cref="azure::storage::cloud_table" /> that the operations are executed on.</param>
+        WASTORAGE_API explicit table_batch_writer(cloud_table table);
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::table_batch_writer" /> class.
+        /// </summary>
+        /// <param name="table">The <see cref="azure::storage::cloud_table" /> that the operations are executed on.</param>
+        /// <param name="max_batch_size">The number of operations at which a pending batch is sent, between 1 and 100.</param>
+        /// <param name="max_latency">The longest time an operation waits in a pending batch before the batch is sent. If this value is zero, batches are only sent when they are full or flushed.</param>
+        /// <param name="parallelism">The maximum number of batches that are sent at the same time.</param>
+        /// <param name="options">An <see cref="azure::storage::table_request_options" /> object that specifies additional options for the requests.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the requests.</param>
+        WASTORAGE_API table_batch_writer(cloud_table table, size_t max_batch_size, std::chrono::milliseconds max_latency, int parallelism, const table_request_options& options, operation_context context);
+
+        /// <summary>
+        /// Adds an operation and waits for its batch to complete.
+        /// </summary>
+        /// <param name="operation">An <see cref="azure::storage::table_operation" /> object that represents the operation to perform.</param>
+        /// <returns>A <see cref="azure::storage::table_result" /> containing the result of the operation.</returns>
+        table_result execute(const table_operation& operation)
+        {
+            return execute_async(operation).get();
+        }
+
+        /// <summary>
+        /// Intitiates an asynchronous operation that adds an operation to the pending batch of its partition.
+        /// </summary>
+        /// <param name="operation">An <see cref="azure::storage::table_operation" /> object that represents the operation to perform.</param>
+        /// <returns>A <see cref="pplx::task" /> object of type <see cref="azure::storage::table_result" /> that completes when the batch containing the operation has been executed.</returns>
+        WASTORAGE_API pplx::task<table_result> execute_async(const table_operation& operation);
+
+        /// <summary>
+        /// Sends all pending batches and waits for every batch sent so far to complete.
+        /// </summary>
+        void flush()
+        {
+            flush_async().wait();
+        }
+
+        /// <summary>
+        /// Intitiates an asynchronous operation that sends all pending batches.
+        /// </summary>
+        /// <returns>A <see cref="pplx::task" /> object that completes when every batch sent so far has completed. Failures are reported through the tasks of the individual operations.</returns>
+        /// <remarks>
+        /// Operations that are still pending when the last copy of the writer is destroyed are sent once the maximum latency has elapsed,
+        /// or fail if the maximum latency is zero. Call this method before the writer goes out of scope.
+        /// </remarks>
+        WASTORAGE_API pplx::task<void> flush_async();
+
+    private:
+
+        class writer_state;
+
+        std::shared_ptr<writer_state> m_state;
+    };
+
 }} // namespace azure::storage
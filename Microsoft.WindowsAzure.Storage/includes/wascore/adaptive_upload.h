@@ -0,0 +1,82 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="adaptive_upload.h" company="Microsoft">
+//    Copyright 2013 Microsoft Corporation
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <chrono>
+#include <mutex>
+
+#include "wascore/basic_types.h"
+#include "was/core.h"
+
+namespace azure { namespace storage { namespace core {
+
+    // Tunes the block size and the number of blocks in flight of a block blob upload.
+    // Throughput is measured over epochs of completed blocks. While it improves, the controller first adds one block in flight
+    // and, once the maximum parallelism is reached, doubles the block size. When throughput drops, the last step is undone.
+    // Throttling and timeouts reported by the retry path halve both values right away, at most once per epoch.
+    class WASTORAGE_API adaptive_upload_controller
+    {
+    public:
+
+        adaptive_upload_controller(size_t min_block_size, size_t max_block_size, int max_parallelism);
+
+        size_t block_size() const;
+        int parallelism() const;
+
+        void block_completed(size_t size);
+        void throttled();
+
+    private:
+
+        void start_epoch(std::chrono::steady_clock::time_point now);
+
+        size_t m_min_block_size;
+        size_t m_max_block_size;
+        size_t m_block_size;
+        int m_max_parallelism;
+        int m_parallelism;
+
+        std::chrono::steady_clock::time_point m_epoch_start;
+        utility::size64_t m_epoch_bytes;
+        int m_epoch_blocks;
+        bool m_epoch_throttled;
+        double m_last_throughput;
+
+        mutable std::mutex m_mutex;
+    };
+
+    // Forwards to the wrapped retry policy and reports throttling and timeouts to an adaptive_upload_controller.
+    class WASTORAGE_API adaptive_upload_retry_policy : public basic_retry_policy
+    {
+    public:
+
+        adaptive_upload_retry_policy(retry_policy policy, std::shared_ptr<adaptive_upload_controller> controller)
+            : basic_retry_policy(), m_policy(policy), m_controller(controller)
+        {
+        }
+
+        retry_info evaluate(const retry_context& retry_context, operation_context context) override;
+        retry_policy clone() const override;
+
+    private:
+
+        retry_policy m_policy;
+        std::shared_ptr<adaptive_upload_controller> m_controller;
+    };
+
+}}} // namespace azure::storage::core
@@ -17,8 +17,9 @@
 
 #pragma once
 
+#include <atomic>
 #include <mutex>
-#include <queue>
+#include <vector>
 
 #include "cpprest/asyncrt_utils.h"
 
@@ -26,43 +27,72 @@
 
 namespace azure { namespace storage { namespace core {
 
-    class _async_semaphore
+    // The count is a number of units, which can be slots or bytes. Acquiring units that are available only takes an atomic
+    // compare-and-swap and returns an already completed task. Callers that have to wait are queued in an intrusive FIFO list,
+    // which is only locked on that slow path.
+    class WASTORAGE_API _async_semaphore
     {
     public:
 
-        explicit _async_semaphore(int count)
-            : m_count(count), m_initial_count(count)
+        explicit _async_semaphore(int64_t count)
+            : m_available(count), m_count(count), m_waiter_count(0), m_idle_waiter_count(0), m_head(nullptr), m_tail(nullptr)
         {
-            m_empty_event.set();
         }
 
-        pplx::task<void> lock_async();
-        void unlock();
+        ~_async_semaphore();
+
+        pplx::task<void> lock_async(int64_t weight);
+        bool try_lock(int64_t weight);
+        void unlock(int64_t weight);
         pplx::task<void> wait_all_async();
+        void resize(int64_t count);
 
     private:
 
-        pplx::task_completion_event<void> dequeue_pending();
-
-        int m_count;
-        int m_initial_count;
-        pplx::task_completion_event<void> m_empty_event;
-        std::queue<pplx::task_completion_event<void>> m_queue;
-        pplx::extensibility::reader_writer_lock_t m_mutex;
+        struct waiter
+        {
+            explicit waiter(int64_t weight)
+                : m_weight(weight), m_next(nullptr)
+            {
+            }
+
+            int64_t m_weight;
+            pplx::task_completion_event<void> m_event;
+            waiter* m_next;
+        };
+
+        bool try_acquire(int64_t weight);
+        void release_waiters();
+        void release_idle_waiters();
+
+        std::atomic<int64_t> m_available;
+        std::atomic<int64_t> m_count;
+        std::atomic<int> m_waiter_count;
+        std::atomic<int> m_idle_waiter_count;
+        std::mutex m_mutex;
+        waiter* m_head;
+        waiter* m_tail;
+        std::vector<pplx::task_completion_event<void>> m_idle_waiters;
     };
 
-    class async_semaphore
+    class WASTORAGE_API async_semaphore
     {
     public:
 
-        explicit async_semaphore(int count)
+        explicit async_semaphore(int64_t count)
             : m_semaphore(std::make_shared<_async_semaphore>(count))
         {
         }
 
         pplx::task<void> lock_async()
         {
-            return m_semaphore->lock_async();
+            return m_semaphore->lock_async(1);
+        }
+
+        // Acquires weight units. A weight larger than the whole count is granted once no unit is in use.
+        pplx::task<void> lock_async(int64_t weight)
+        {
+            return m_semaphore->lock_async(weight);
         }
 
         void lock()
@@ -70,9 +100,25 @@ namespace azure { namespace storage { namespace core {
             lock_async().wait();
         }
 
+        bool try_lock()
+        {
+            return m_semaphore->try_lock(1);
+        }
+
+        bool try_lock(int64_t weight)
+        {
+            return m_semaphore->try_lock(weight);
+        }
+
         void unlock()
         {
-            return m_semaphore->unlock();
+            m_semaphore->unlock(1);
+        }
+
+        // Returns units acquired with lock_async(weight) or try_lock(weight). The weight must be the one that was acquired.
+        void unlock(int64_t weight)
+        {
+            m_semaphore->unlock(weight);
         }
 
         pplx::task<void> wait_all_async()
@@ -80,9 +126,37 @@ namespace azure { namespace storage { namespace core {
             return m_semaphore->wait_all_async();
         }
 
+        // Changes the number of slots. When the count shrinks below the number of slots in use,
+        // no pending waiter is released until enough slots have been unlocked.
+        void resize(int64_t count)
+        {
+            m_semaphore->resize(count);
+        }
+
     private:
 
         std::shared_ptr<_async_semaphore> m_semaphore;
     };
 
+    // Process-wide cap on the payload bytes of the block, page and range requests that are in flight across all transfers.
+    // There is no cap by default.
+    class transfer_byte_limit
+    {
+    public:
+
+        // Sets the maximum number of bytes in flight. Zero removes the cap. Requests already in flight are not affected.
+        WASTORAGE_API static void set_max_in_flight_bytes(utility::size64_t max_bytes);
+        WASTORAGE_API static utility::size64_t max_in_flight_bytes();
+
+        // Completes once size more bytes may be sent or received. Every acquisition must be followed by a release of the same size.
+        WASTORAGE_API static pplx::task<void> acquire_async(utility::size64_t size);
+        WASTORAGE_API static void release(utility::size64_t size);
+
+    private:
+
+        static async_semaphore& semaphore();
+
+        static std::atomic<utility::size64_t> s_max_bytes;
+    };
+
 }}} // namespace azure::storage::core
@@ -0,0 +1,47 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="base64.h" company="Microsoft">
+//    Copyright 2013 Microsoft Corporation
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "cpprest/asyncrt_utils.h"
+#include "wascore/basic_types.h"
+
+namespace azure { namespace storage { namespace core {
+
+    // Appends the padded base64 encoding of count bytes to output.
+    // Uses SSSE3 when the CPU supports it and falls back to a table-driven implementation otherwise.
+    WASTORAGE_API void append_base64(const uint8_t* data, size_t count, std::string& output);
+
+    // Appends the bytes encoded by count characters of padded base64 to output. Returns false if the text is not
+    // base64 without whitespace, in which case the contents of output beyond its original size are unspecified.
+    WASTORAGE_API bool append_from_base64(const char* text, size_t count, std::vector<uint8_t>& output);
+
+    // Always use the table-driven implementations. Exposed so the accelerated implementations can be checked against them.
+    WASTORAGE_API void append_base64_portable(const uint8_t* data, size_t count, std::string& output);
+    WASTORAGE_API bool append_from_base64_portable(const char* text, size_t count, std::vector<uint8_t>& output);
+
+    // Conversions between raw data and base64 text that give the same results as utility::conversions::to_base64 and
+    // utility::conversions::from_base64, including the exception thrown for invalid text.
+    WASTORAGE_API utility::string_t to_base64(const uint8_t* data, size_t count);
+    WASTORAGE_API std::vector<uint8_t> from_base64(const utility::string_t& text);
+
+}}} // namespace azure::storage::core
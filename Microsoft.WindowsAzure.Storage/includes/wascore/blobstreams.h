@@ -17,9 +17,12 @@
 
 #pragma once
 
+#include <deque>
+
 #include "basic_types.h"
 #include "streams.h"
 #include "async_semaphore.h"
+#include "adaptive_upload.h"
 #include "util.h"
 #include "was/blob.h"
 
@@ -34,7 +37,8 @@ namespace azure { namespace storage { namespace core {
             m_blob(blob), m_condition(condition), m_options(options), m_context(context),
             m_current_blob_offset(0), m_next_blob_offset(0), m_buffer_size(options.stream_read_size_in_bytes()),
             m_next_buffer_size(options.stream_read_size_in_bytes()), m_buffer(std::ios_base::in),
-            m_cancellation_token(cancellation_token), m_use_request_level_timeout(use_request_level_timeout)
+            m_cancellation_token(cancellation_token), m_use_request_level_timeout(use_request_level_timeout),
+            m_read_ahead_count(std::min(options.read_ahead_range_count(), options.parallelism_factor())), m_sequential_downloads(1)
         {
             if (!options.disable_content_md5_validation() && !m_blob->properties().content_md5().empty())
             {
@@ -150,8 +154,21 @@ namespace azure { namespace storage { namespace core {
 
     private:
 
+        // A range of the blob that is being downloaded, or has been downloaded, ahead of the reader.
+        struct read_ahead_range
+        {
+            off_type offset;
+            utility::size64_t size;
+            concurrency::streams::container_buffer<std::vector<char_type>> buffer;
+            std::shared_ptr<std::exception_ptr> exception;
+            pplx::task<void> task;
+        };
+
         pplx::task<bool> download_if_necessary(size_t bytes_needed);
         pplx::task<bool> download();
+        std::shared_ptr<read_ahead_range> download_range(off_type offset, utility::size64_t size);
+        void read_ahead();
+        void recycle_buffer();
 
         std::shared_ptr<cloud_blob> m_blob;
         access_condition m_condition;
@@ -165,6 +182,9 @@ namespace azure { namespace storage { namespace core {
         bool m_use_request_level_timeout;
         const pplx::cancellation_token m_cancellation_token;
         concurrency::streams::container_buffer<std::vector<char_type>> m_buffer;
+        int m_read_ahead_count;
+        int m_sequential_downloads;
+        std::deque<std::shared_ptr<read_ahead_range>> m_read_ahead_ranges;
     };
 
 
@@ -187,10 +207,8 @@ namespace azure { namespace storage { namespace core {
             m_buffer_size = options.stream_write_size_in_bytes();
             m_next_buffer_size = options.stream_write_size_in_bytes();
 
-            if (options.use_transactional_md5())
-            {
-                m_transaction_hash_provider = hash_provider::create_md5_hash_provider();
-            }
+            m_use_transactional_crc64 = options.use_transactional_crc64();
+            m_use_transactional_md5 = options.use_transactional_md5() && !m_use_transactional_crc64;
 
             if (options.store_blob_content_md5())
             {
@@ -216,8 +234,16 @@ namespace azure { namespace storage { namespace core {
     public:
         basic_cloud_block_blob_ostreambuf(std::shared_ptr<cloud_block_blob> blob, const access_condition &condition, const blob_request_options& options, operation_context context, const pplx::cancellation_token& cancellation_token, bool use_request_level_timeout, std::shared_ptr<core::timer_handler> timer_handler)
             : basic_cloud_blob_ostreambuf(condition, options, context, cancellation_token, use_request_level_timeout, timer_handler),
-            m_blob(blob), m_block_id_prefix(utility::uuid_to_string(utility::new_uuid()))
+            m_blob(blob), m_block_id_prefix(utility::uuid_to_string(utility::new_uuid())), m_parallelism(options.parallelism_factor())
         {
+            if (options.use_adaptive_upload())
+            {
+                // The block size never goes below the configured one, so the upload never needs more blocks than it would without tuning.
+                m_controller = std::make_shared<adaptive_upload_controller>(m_buffer_size, protocol::max_block_size, options.parallelism_factor());
+                m_options.set_retry_policy(retry_policy(std::make_shared<adaptive_upload_retry_policy>(m_options.retry_policy(), m_controller)));
+                m_parallelism = m_controller->parallelism();
+                m_semaphore.resize(m_parallelism);
+            }
         }
 
         bool can_seek() const
@@ -254,6 +280,8 @@ namespace azure { namespace storage { namespace core {
         std::shared_ptr<cloud_block_blob> m_blob;
         utility::string_t m_block_id_prefix;
         std::vector<block_list_item> m_block_list;
+        std::shared_ptr<adaptive_upload_controller> m_controller;
+        int m_parallelism;
     };
 
     class cloud_block_blob_ostreambuf : public concurrency::streams::streambuf<basic_cloud_block_blob_ostreambuf::char_type>
@@ -0,0 +1,84 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="buffer_pool.h" company="Microsoft">
+//    Copyright 2013 Microsoft Corporation
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <mutex>
+#include <vector>
+
+#include "wascore/basic_types.h"
+
+namespace azure { namespace storage { namespace core {
+
+    struct buffer_pool_statistics
+    {
+        // Number of bytes held by buffers that are in the pool, ready to be reused.
+        utility::size64_t pooled_bytes;
+
+        // Number of bytes held by buffers that were handed out and have not been returned yet, including buffers too large to be pooled.
+        // These bytes are not bounded by the cap, which only limits the memory kept by idle buffers.
+        utility::size64_t outstanding_bytes;
+
+        // Number of buffers that were allocated because the pool had no buffer of the requested size class.
+        utility::size64_t allocations;
+
+        // Number of buffers that were served from the pool.
+        utility::size64_t reuses;
+
+        // Number of returned buffers that were freed because keeping them would exceed the memory cap.
+        utility::size64_t discards;
+    };
+
+    // Process-wide pool of the staging buffers used by the blob and file streams and by parallel downloads.
+    // Buffers are grouped in power-of-two size classes, so a steady-state transfer keeps getting back the buffers it returned
+    // instead of allocating a new one per block or range. The cap bounds the memory retained by idle buffers only: acquire never
+    // blocks or fails, so the memory in use by transfers is bounded by their parallelism and block size, and is reported as outstanding_bytes.
+    class buffer_pool
+    {
+    public:
+
+        // Returns an empty buffer whose capacity is at least size, rounded up to its size class.
+        WASTORAGE_API static std::vector<uint8_t> acquire(size_t size);
+
+        // Returns a buffer obtained from acquire to the pool. The buffer is freed instead if keeping it would exceed the cap.
+        WASTORAGE_API static void release(std::vector<uint8_t>&& buffer);
+
+        // Sets the maximum number of bytes held by idle buffers. Buffers that are handed out do not count against it. Zero disables pooling.
+        WASTORAGE_API static void set_max_pooled_bytes(utility::size64_t max_pooled_bytes);
+        WASTORAGE_API static utility::size64_t max_pooled_bytes();
+
+        // Frees every idle buffer.
+        WASTORAGE_API static void clear();
+
+        WASTORAGE_API static buffer_pool_statistics statistics();
+
+    private:
+
+        static size_t size_class(size_t size);
+        static size_t class_size(size_t size_class);
+        static void trim(std::unique_lock<std::mutex>& lock);
+
+        // Size classes go from min_pooled_buffer_size up to the first power of two above the largest block size.
+        static const size_t s_size_class_count = 12;
+
+        static std::mutex s_mutex;
+        static std::vector<std::vector<uint8_t>> s_buffers[s_size_class_count];
+        static utility::size64_t s_max_pooled_bytes;
+        static buffer_pool_statistics s_statistics;
+    };
+
+}}} // namespace azure::storage::core
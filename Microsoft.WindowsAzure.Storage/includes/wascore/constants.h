@@ -29,6 +29,7 @@ namespace azure { namespace storage { namespace protocol {
     const utility::size64_t max_block_blob_size = static_cast<utility::size64_t>(max_block_number) * max_block_size;
     const size_t max_append_block_size = 4 * 1024 * 1024;
     const size_t max_page_size = 4 * 1024 * 1024;
+    const size_t page_size_alignment = 512;
     const size_t max_range_size = 4 * 1024 * 1024;
     const utility::size64_t max_single_blob_upload_threshold = 256 * 1024 * 1024;
     
@@ -39,6 +40,8 @@ namespace azure { namespace storage { namespace protocol {
     const utility::size64_t default_single_blob_download_threshold = 32 * 1024 * 1024;
     const utility::size64_t default_single_block_download_threshold = 4 * 1024 * 1024;
     const size_t transactional_md5_block_size = 4 * 1024 * 1024;
+    const size_t min_pooled_buffer_size = 64 * 1024;
+    const utility::size64_t default_buffer_pool_max_bytes = 256 * 1024 * 1024;
 
     // duration constants
     const std::chrono::seconds default_retry_interval(3);
@@ -51,6 +54,8 @@ namespace azure { namespace storage { namespace protocol {
     const std::chrono::seconds default_noactivity_timeout(60);
     // For the following value, "0" means "don't send a timeout to the service"
     const std::chrono::seconds default_server_timeout(0);
+    // cached HTTP clients that have not been used for this long are evicted.
+    const std::chrono::seconds default_http_client_idle_timeout(300);
 
     // lease break period and duration constants
     const std::chrono::seconds minimum_lease_break_period(0);
@@ -61,6 +66,24 @@ namespace azure { namespace storage { namespace protocol {
     // could file share limitation
     const int maximum_share_quota(5120);
 
+    // parallel listing constants
+    const int default_listing_parallelism = 16;
+
+    // table batch constants
+    const size_t max_batch_operation_count = 100;
+    const size_t max_batch_payload_size = 4 * 1024 * 1024;
+    const std::chrono::milliseconds default_batch_writer_latency(50);
+    const int default_batch_writer_parallelism = 4;
+
+    // queue constants
+    const size_t max_get_messages_count = 32;
+    const int default_add_messages_parallelism = 32;
+    const int default_queue_processor_receive_loops = 4;
+    const int default_queue_processor_handler_parallelism = 64;
+    const std::chrono::seconds default_queue_processor_visibility_timeout(30);
+    const std::chrono::milliseconds default_queue_processor_min_backoff(100);
+    const std::chrono::milliseconds default_queue_processor_max_backoff(10000);
+
 #define _CONSTANTS
 #define DAT(a, b) WASTORAGE_API extern const utility::char_t a[]; const size_t a ## _size = sizeof(b) / sizeof(utility::char_t) - 1;
 #include "constants.dat"
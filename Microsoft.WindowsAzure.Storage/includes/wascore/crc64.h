@@ -0,0 +1,37 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="crc64.h" company="Microsoft">
+//    Copyright 2013 Microsoft Corporation
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "wascore/basic_types.h"
+
+namespace azure { namespace storage { namespace core {
+
+    // CRC64 with the polynomial used by the storage service for x-ms-content-crc64, in its reflected form.
+    const uint64_t crc64_polynomial = 0x9A6C9329AC4BC9B5ULL;
+
+    // Continues the CRC64 of a message with the next count bytes. The CRC of an empty message is 0, so a new checksum starts from 0.
+    // Uses carry-less multiplication when the CPU supports it and falls back to a table-driven implementation otherwise.
+    WASTORAGE_API uint64_t update_crc64(const uint8_t* data, size_t count, uint64_t crc);
+
+    // Always uses the table-driven implementation. Exposed so the accelerated implementation can be checked against it.
+    WASTORAGE_API uint64_t update_crc64_portable(const uint8_t* data, size_t count, uint64_t crc);
+
+}}} // namespace azure::storage::core
@@ -42,7 +42,7 @@ namespace azure { namespace storage { namespace core {
         {
         }
         
-        static pplx::task<istream_descriptor> create(concurrency::streams::istream stream, bool calculate_md5 = false, utility::size64_t length = std::numeric_limits<utility::size64_t>::max(), utility::size64_t max_length = std::numeric_limits<utility::size64_t>::max(), const pplx::cancellation_token& cancellation_token = pplx::cancellation_token::none())
+        static pplx::task<istream_descriptor> create(concurrency::streams::istream stream, bool calculate_md5 = false, utility::size64_t length = std::numeric_limits<utility::size64_t>::max(), utility::size64_t max_length = std::numeric_limits<utility::size64_t>::max(), const pplx::cancellation_token& cancellation_token = pplx::cancellation_token::none(), bool calculate_crc64 = false)
         {
             if (length == std::numeric_limits<utility::size64_t>::max())
             {
@@ -54,16 +54,17 @@ namespace azure { namespace storage { namespace core {
                 throw std::invalid_argument(protocol::error_stream_length);
             }
 
-            if (!calculate_md5 && stream.can_seek())
+            if (!calculate_md5 && !calculate_crc64 && stream.can_seek())
             {
-                return pplx::task_from_result(istream_descriptor(stream, length, utility::string_t()));
+                return pplx::task_from_result(istream_descriptor(stream, length, utility::string_t(), utility::string_t()));
             }
 
-            hash_provider provider = calculate_md5 ? core::hash_provider::create_md5_hash_provider() : core::hash_provider();
+            // Only one checksum is calculated. CRC64 is preferred, as it is cheaper to calculate.
+            hash_provider provider = calculate_crc64 ? core::hash_provider::create_crc64_hash_provider() : calculate_md5 ? core::hash_provider::create_md5_hash_provider() : core::hash_provider();
             concurrency::streams::container_buffer<std::vector<uint8_t>> temp_buffer;
             concurrency::streams::ostream temp_stream;
 
-            if (calculate_md5)
+            if (provider.is_enabled())
             {
                 temp_stream = hash_wrapper_streambuf<concurrency::streams::ostream::traits::char_type>(temp_buffer, provider).create_ostream();
             }
@@ -72,10 +73,10 @@ namespace azure { namespace storage { namespace core {
                 temp_stream = temp_buffer.create_ostream();
             }
 
-            return stream_copy_async(stream, temp_stream, length, max_length, cancellation_token).then([temp_buffer, provider] (pplx::task<utility::size64_t> buffer_task) mutable -> istream_descriptor
+            return stream_copy_async(stream, temp_stream, length, max_length, cancellation_token).then([temp_buffer, provider, calculate_crc64] (pplx::task<utility::size64_t> buffer_task) mutable -> istream_descriptor
             {
                 provider.close();
-                return istream_descriptor(concurrency::streams::container_stream<std::vector<uint8_t>>::open_istream(temp_buffer.collection()), buffer_task.get(), provider.hash());
+                return istream_descriptor(concurrency::streams::container_stream<std::vector<uint8_t>>::open_istream(temp_buffer.collection()), buffer_task.get(), calculate_crc64 ? utility::string_t() : provider.hash(), calculate_crc64 ? provider.hash() : utility::string_t());
             });
         }
 
@@ -99,6 +100,11 @@ namespace azure { namespace storage { namespace core {
             return m_content_md5;
         }
 
+        const utility::string_t& content_crc64() const
+        {
+            return m_content_crc64;
+        }
+
         void rewind()
         {
             m_stream.seek(m_offset);
@@ -106,14 +112,15 @@ namespace azure { namespace storage { namespace core {
 
     private:
         
-        istream_descriptor(concurrency::streams::istream stream, utility::size64_t length, utility::string_t content_md5)
-            : m_stream(stream), m_offset(stream.tell()), m_length(length), m_content_md5(std::move(content_md5))
+        istream_descriptor(concurrency::streams::istream stream, utility::size64_t length, utility::string_t content_md5, utility::string_t content_crc64)
+            : m_stream(stream), m_offset(stream.tell()), m_length(length), m_content_md5(std::move(content_md5)), m_content_crc64(std::move(content_crc64))
         {
         }
 
         concurrency::streams::istream m_stream;
         concurrency::streams::istream::pos_type m_offset;
         utility::string_t m_content_md5;
+        utility::string_t m_content_crc64;
         utility::size64_t m_length;
     };
 
@@ -126,8 +133,8 @@ namespace azure { namespace storage { namespace core {
         {
         }
 
-        ostream_descriptor(utility::size64_t length, utility::string_t content_md5)
-            : m_length(length), m_content_md5(std::move(content_md5))
+        ostream_descriptor(utility::size64_t length, utility::string_t content_md5, utility::string_t content_crc64)
+            : m_length(length), m_content_md5(std::move(content_md5)), m_content_crc64(std::move(content_crc64))
         {
         }
 
@@ -141,9 +148,15 @@ namespace azure { namespace storage { namespace core {
             return m_content_md5;
         }
 
+        const utility::string_t& content_crc64() const
+        {
+            return m_content_crc64;
+        }
+
     private:
         
         utility::string_t m_content_md5;
+        utility::string_t m_content_crc64;
         utility::size64_t m_length;
     };
 
@@ -160,7 +173,7 @@ namespace azure { namespace storage { namespace core {
 
         explicit storage_command_base(const storage_uri& request_uri, const pplx::cancellation_token& cancellation_token, const bool use_timeout, std::shared_ptr<core::timer_handler> timer_handler)
             : m_request_uri(request_uri), m_location_mode(command_location_mode::primary_only),
-            m_cancellation_token(cancellation_token), m_calculate_response_body_md5(false), m_use_timeout(use_timeout), m_timer_handler(timer_handler)
+            m_cancellation_token(cancellation_token), m_calculate_response_body_md5(false), m_calculate_response_body_crc64(false), m_use_timeout(use_timeout), m_timer_handler(timer_handler)
         {
             if (m_use_timeout)
             {
@@ -195,6 +208,11 @@ namespace azure { namespace storage { namespace core {
             m_calculate_response_body_md5 = value;
         }
 
+        void set_calculate_response_body_crc64(bool value)
+        {
+            m_calculate_response_body_crc64 = value;
+        }
+
         void set_build_request(std::function<web::http::http_request(web::http::uri_builder&, const std::chrono::seconds&, operation_context)> value)
         {
             m_build_request = value;
@@ -276,6 +294,7 @@ namespace azure { namespace storage { namespace core {
         istream_descriptor m_request_body;
         concurrency::streams::ostream m_destination_stream;
         bool m_calculate_response_body_md5;
+        bool m_calculate_response_body_crc64;
         command_location_mode m_location_mode;
 
         const pplx::cancellation_token m_cancellation_token;
@@ -35,10 +35,9 @@ namespace azure { namespace storage { namespace core {
             m_buffer_size = protocol::max_range_size;
             m_next_buffer_size = protocol::max_range_size;
 
-            if (m_options.use_transactional_md5())
-            {
-                m_transaction_hash_provider = hash_provider::create_md5_hash_provider();
-            }
+            m_use_transactional_crc64 = m_options.use_transactional_crc64();
+            m_use_transactional_md5 = m_options.use_transactional_md5() && !m_use_transactional_crc64;
+
             if (m_options.store_file_content_md5())
             {
                 m_total_hash_provider = hash_provider::create_md5_hash_provider();
@@ -0,0 +1,63 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="hash_pipeline.h" company="Microsoft">
+//    Copyright 2013 Microsoft Corporation
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include "wascore/basic_types.h"
+#include "hashing.h"
+
+namespace azure { namespace storage { namespace core {
+
+    // Hashes whole buffers on worker threads, so the threads that fill or drain the buffers are never blocked by hashing.
+    // MD5 requests that are queued at the same time, such as the blocks of a parallel upload, are hashed together with md5_multi_buffer.
+    // The data must stay valid until the returned task completes.
+    class hash_pipeline
+    {
+    public:
+
+        // Returns the base64-encoded MD5 of the data.
+        WASTORAGE_API static pplx::task<utility::string_t> md5_async(const uint8_t* data, size_t count);
+
+        // Returns the base64-encoded CRC64 of the data.
+        WASTORAGE_API static pplx::task<utility::string_t> crc64_async(const uint8_t* data, size_t count);
+
+    private:
+
+        struct md5_request
+        {
+            const uint8_t* m_data;
+            size_t m_count;
+            pplx::task_completion_event<utility::string_t> m_event;
+        };
+
+        static void run_md5_worker();
+        static void hash_md5_batch(std::vector<md5_request>& batch);
+
+        // Number of requests a worker takes at once. Twice the SSE2 lane count, so lanes freed by short buffers can be refilled.
+        static const size_t s_md5_batch_size = 8;
+
+        static std::mutex s_mutex;
+        static std::deque<md5_request> s_md5_requests;
+        static size_t s_md5_worker_count;
+    };
+
+}}} // namespace azure::storage::core
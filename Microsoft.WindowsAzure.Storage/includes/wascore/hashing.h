@@ -20,6 +20,7 @@
 #include "cpprest/streams.h"
 
 #include "wascore/basic_types.h"
+#include "wascore/crc64.h"
 #include "was/core.h"
 
 #ifdef _WIN32
@@ -219,6 +220,35 @@ namespace azure { namespace storage { namespace core {
         }
     };
 
+    class crc64_hash_provider_impl : public hash_provider_impl
+    {
+    public:
+        crc64_hash_provider_impl()
+            : m_crc(0)
+        {
+        }
+
+        bool is_enabled() const override
+        {
+            return true;
+        }
+
+        void write(const uint8_t* data, size_t count) override
+        {
+            m_crc = update_crc64(data, count, m_crc);
+        }
+
+        void close() override
+        {
+            // no-op, as the CRC is complete after every write
+        }
+
+        utility::string_t hash() const override;
+
+    private:
+        uint64_t m_crc;
+    };
+
     class hash_provider
     {
     public:
@@ -257,6 +287,11 @@ namespace azure { namespace storage { namespace core {
             return hash_provider(std::make_shared<md5_hash_provider_impl>());
         }
 
+        static hash_provider create_crc64_hash_provider()
+        {
+            return hash_provider(std::make_shared<crc64_hash_provider_impl>());
+        }
+
     private:
         explicit hash_provider(std::shared_ptr<hash_provider_impl> implementation)
             : m_implementation(implementation)
@@ -268,4 +303,29 @@ namespace azure { namespace storage { namespace core {
         std::shared_ptr<hash_provider_impl> m_implementation;
     };
 
+    // Computes HMAC-SHA256 signatures with one key. The key is processed once, when the signer is created, and every
+    // signature starts from a copy of that keyed state, so signing does not allocate and does not touch the key again.
+    class hmac_sha256_signer
+    {
+    public:
+        static const size_t hash_size = 32;
+
+        explicit hmac_sha256_signer(const std::vector<uint8_t>& key);
+        ~hmac_sha256_signer();
+
+        void sign(const uint8_t* data, size_t count, uint8_t* hash) const;
+
+    private:
+        hmac_sha256_signer(const hmac_sha256_signer&);
+        hmac_sha256_signer& operator=(const hmac_sha256_signer&);
+
+#ifdef _WIN32
+        BCRYPT_HASH_HANDLE m_hash_handle;
+#else
+        // SHA-256 states after the inner and outer padded keys have been hashed
+        SHA256_CTX m_inner_context;
+        SHA256_CTX m_outer_context;
+#endif
+    };
+
 }}} // namespace azure::storage::core
@@ -0,0 +1,37 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="md5_multi_buffer.h" company="Microsoft">
+//    Copyright 2013 Microsoft Corporation
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "wascore/basic_types.h"
+
+namespace azure { namespace storage { namespace core {
+
+    const size_t md5_digest_size = 16;
+
+    // Calculates the MD5 of buffer_count independent buffers, writing md5_digest_size bytes per buffer to digests.
+    // On x86 and x64 four buffers are hashed at once in the lanes of SSE2 registers, which is several times faster than hashing them one by one.
+    WASTORAGE_API void md5_multi_buffer(const uint8_t* const* data, const size_t* counts, size_t buffer_count, uint8_t* digests);
+
+    // Returns whether md5_multi_buffer hashes several buffers at once on this platform, rather than one after the other.
+    WASTORAGE_API bool md5_multi_buffer_is_accelerated();
+
+}}} // namespace azure::storage::core
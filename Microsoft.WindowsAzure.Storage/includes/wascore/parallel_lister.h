@@ -0,0 +1,211 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="parallel_lister.h" company="Microsoft">
+//    Copyright 2013 Microsoft Corporation
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "cpprest/asyncrt_utils.h"
+
+#include "wascore/async_semaphore.h"
+#include "wascore/basic_types.h"
+#include "wascore/constants.h"
+#include "was/common.h"
+
+namespace azure { namespace storage { namespace core {
+
+    // Enumerates a hierarchy with one listing chain per scope, where a scope is a virtual directory of a container or a directory of a share.
+    // A segment can name child scopes, which start chains of their own, so the key space is split up as it is discovered.
+    // At most parallelism segment requests are in flight across all of the chains. The consumer is called for one item at a time;
+    // items of one chain keep their order, but chains are interleaved. The first failure of a request or of the consumer cancels
+    // the remaining chains and is reported by the returned task.
+    template<typename Scope, typename Item>
+    class parallel_lister : public std::enable_shared_from_this<parallel_lister<Scope, Item>>
+    {
+    public:
+
+        struct segment
+        {
+            std::vector<Item> items;
+            std::vector<Scope> children;
+            continuation_token token;
+        };
+
+        typedef std::function<pplx::task<segment>(const Scope&, const continuation_token&, const pplx::cancellation_token&)> list_function;
+        typedef std::function<void(const Item&)> consumer_function;
+
+        static pplx::task<void> run(Scope root, list_function list, consumer_function consumer, int parallelism, const pplx::cancellation_token& cancellation_token)
+        {
+            std::shared_ptr<parallel_lister> lister(new parallel_lister(std::move(list), std::move(consumer), parallelism, cancellation_token));
+            lister->start_chain(std::move(root));
+            return pplx::create_task(lister->m_completed_event);
+        }
+
+        ~parallel_lister()
+        {
+            if (m_cancellation_token != pplx::cancellation_token::none())
+            {
+                m_cancellation_token.deregister_callback(m_cancellation_token_registration);
+            }
+        }
+
+    private:
+
+        struct chain
+        {
+            explicit chain(Scope scope)
+                : m_scope(std::move(scope))
+            {
+            }
+
+            Scope m_scope;
+            continuation_token m_token;
+        };
+
+        parallel_lister(list_function list, consumer_function consumer, int parallelism, const pplx::cancellation_token& cancellation_token)
+            : m_list(std::move(list)), m_consumer(std::move(consumer)), m_slots(parallelism), m_cancellation_token(cancellation_token), m_pending_chains(0)
+        {
+            if (m_cancellation_token != pplx::cancellation_token::none())
+            {
+                // The callback holds the source rather than the lister, so that it does not keep the lister alive.
+                auto source = m_source;
+                m_cancellation_token_registration = m_cancellation_token.register_callback([source]()
+                {
+                    source.cancel();
+                });
+            }
+        }
+
+        void start_chain(Scope scope)
+        {
+            ++m_pending_chains;
+
+            auto lister = this->shared_from_this();
+            auto current = std::make_shared<chain>(std::move(scope));
+            pplx::details::_do_while([lister, current]() -> pplx::task<bool>
+            {
+                return lister->m_slots.lock_async().then([lister, current]() -> pplx::task<bool>
+                {
+                    if (lister->m_source.get_token().is_canceled())
+                    {
+                        lister->m_slots.unlock();
+                        return pplx::task_from_result(false);
+                    }
+
+                    return lister->m_list(current->m_scope, current->m_token, lister->m_source.get_token()).then([lister, current](pplx::task<segment> list_task) -> bool
+                    {
+                        // The slot is only held for the request, so a slow consumer does not keep other chains from listing.
+                        lister->m_slots.unlock();
+                        segment result = list_task.get();
+
+                        for (auto& child : result.children)
+                        {
+                            lister->start_chain(std::move(child));
+                        }
+
+                        lister->consume(result.items);
+                        current->m_token = std::move(result.token);
+                        return !current->m_token.empty();
+                    });
+                });
+            }).then([lister](pplx::task<bool> chain_task)
+            {
+                try
+                {
+                    chain_task.get();
+                }
+                catch (...)
+                {
+                    lister->fail(std::current_exception());
+                }
+
+                lister->end_chain();
+            });
+        }
+
+        void consume(const std::vector<Item>& items)
+        {
+            std::lock_guard<std::mutex> guard(m_consumer_mutex);
+            for (const auto& item : items)
+            {
+                if (m_source.get_token().is_canceled())
+                {
+                    return;
+                }
+
+                m_consumer(item);
+            }
+        }
+
+        void fail(std::exception_ptr exception)
+        {
+            {
+                std::lock_guard<std::mutex> guard(m_mutex);
+                if (m_exception == nullptr)
+                {
+                    m_exception = exception;
+                }
+            }
+
+            m_source.cancel();
+        }
+
+        void end_chain()
+        {
+            // A chain starts its children before it ends, so the count only drops to zero once every chain has ended.
+            if (--m_pending_chains != 0)
+            {
+                return;
+            }
+
+            std::exception_ptr exception;
+            {
+                std::lock_guard<std::mutex> guard(m_mutex);
+                exception = m_exception;
+            }
+
+            if (exception != nullptr)
+            {
+                m_completed_event.set_exception(exception);
+            }
+            else if (m_source.get_token().is_canceled())
+            {
+                m_completed_event.set_exception(storage_exception(protocol::error_operation_canceled));
+            }
+            else
+            {
+                m_completed_event.set();
+            }
+        }
+
+        list_function m_list;
+        consumer_function m_consumer;
+        async_semaphore m_slots;
+        pplx::cancellation_token m_cancellation_token;
+        pplx::cancellation_token_registration m_cancellation_token_registration;
+        pplx::cancellation_token_source m_source;
+        std::atomic<int64_t> m_pending_chains;
+        std::mutex m_consumer_mutex;
+        std::mutex m_mutex;
+        std::exception_ptr m_exception;
+        pplx::task_completion_event<void> m_completed_event;
+    };
+
+}}} // namespace azure::storage::core
@@ -17,12 +17,105 @@
 
 #pragma once
 
+#include <unordered_map>
+
 #include "wascore/basic_types.h"
 #include "was/table.h"
 
 namespace azure { namespace storage { namespace protocol {
 
+    edm_type get_property_type(const utility::string_t& type_name);
+    utility::string_t get_etag_from_timestamp(const utility::string_t& timestampStr);
     table_entity parse_table_entity(const web::json::value& document);
     storage_extended_error parse_table_error(const web::json::value& document);
 
+    // Parses the JSON body of a table query response straight into entities, without building a web::json::value document.
+    // The result is the same as parse_table_entity applied to every entity of the "value" array.
+    // Property names are decoded once per segment: entities of a segment usually list the same properties in the same order,
+    // so the name at each position is compared with the one found at that position in the previous entity.
+    class WASTORAGE_API table_query_reader
+    {
+    public:
+
+        table_query_reader(const char* data, size_t size)
+            : m_position(data), m_end(data + size), m_property_count(0)
+        {
+        }
+
+        std::vector<table_entity> move_entities();
+
+        // Parses a document that is a single entity, such as the body of a retrieve operation.
+        table_entity move_entity();
+
+        // Parses the entities into compact entities that share a schema. The schema passed in is extended with the properties
+        // it does not have, and is replaced by the schema of the last entity, so it can be passed to the reader of the next segment.
+        std::vector<compact_table_entity> move_compact_entities(std::shared_ptr<const table_entity_schema>& schema);
+
+        // Parses the entities straight into objects, storing the mapped columns only. add_object is called for each entity
+        // and returns the object to store it into.
+        void move_mapped_entities(const table_column_mapping& mapping, const std::function<void*()>& add_object);
+
+    private:
+
+        enum class name_kind
+        {
+            property,
+            partition_key,
+            row_key,
+            timestamp,
+            odata_etag,
+            odata_other,
+            type_annotation
+        };
+
+        struct interned_name
+        {
+            utility::string_t m_name;
+            name_kind m_kind;
+
+            // For a type annotation, the name of the property it applies to.
+            utility::string_t m_annotated_property;
+
+            // For a property read into compact entities or mapped objects, its index in the schema or in the mapping.
+            static const size_t no_schema_index = static_cast<size_t>(-1);
+            mutable size_t m_schema_index;
+        };
+
+        template<typename read_function>
+        void read_entities(read_function read);
+        void read_entity(table_entity& entity);
+        void read_entity(compact_table_entity& entity);
+        void read_entity(const table_column_mapping& mapping, void* object);
+        const interned_name& read_property_name(size_t index);
+        void read_property_value(entity_property& property);
+        void read_property_value(compact_entity_value& value);
+        void read_column_value(compact_entity_value& value, edm_type property_type);
+        bool read_number(int64_t& integer_value, double& double_value);
+        size_t get_schema_index(const interned_name& name);
+        size_t get_column_index(const table_column_mapping& mapping, const interned_name& name);
+        void convert_string_value(compact_entity_value& value, edm_type property_type);
+        void convert_column_value(compact_entity_value& value, edm_type property_type);
+
+        bool read_string_token(const char*& begin, const char*& end);
+        std::string decode_string(const char* begin, const char* end, bool has_escapes) const;
+        utility::string_t read_string();
+        void skip_value();
+        void skip_whitespace();
+        bool consume(char expected);
+        void expect(char expected);
+        bool at_end() const;
+
+        const char* m_position;
+        const char* m_end;
+
+        std::unordered_map<std::string, interned_name> m_names;
+        std::vector<std::pair<const std::string*, const interned_name*>> m_names_by_position;
+        std::vector<std::pair<const interned_name*, edm_type>> m_type_annotations;
+        size_t m_property_count;
+
+        std::shared_ptr<const table_entity_schema> m_schema;
+        std::vector<utility::string_t> m_schema_names;
+        compact_entity_value m_column_value;
+    };
+
 }}} // namespace azure::storage::protocol
@@ -221,7 +221,7 @@ namespace azure { namespace storage { namespace protocol {
         utility::string_t m_name;
     };
 
-    class list_blobs_reader : public core::xml::xml_reader
+    class WASTORAGE_API list_blobs_reader : public core::xml::xml_reader
     {
     public:
 
@@ -279,6 +279,44 @@ namespace azure { namespace storage { namespace protocol {
         copy_state m_copy_state;
     };
 
+    class WASTORAGE_API compact_list_blobs_reader : public core::xml::xml_reader
+    {
+    public:
+
+        explicit compact_list_blobs_reader(concurrency::streams::istream stream)
+            : xml_reader(stream)
+        {
+        }
+
+        compact_list_blob_item_segment move_segment(storage_location target_location)
+        {
+            auto result = parse();
+            if (result == xml_reader::parse_result::xml_not_complete)
+            {
+                throw storage_exception(protocol::error_xml_not_complete, true);
+            }
+
+            continuation_token next_token(std::move(m_next_marker));
+            next_token.set_target_location(target_location);
+            m_segment.m_continuation_token = std::move(next_token);
+            return std::move(m_segment);
+        }
+
+    protected:
+
+        virtual void handle_begin_element(const utility::string_t& element_name);
+        virtual void handle_element(const utility::string_t& element_name);
+        virtual void handle_end_element(const utility::string_t& element_name);
+
+        uint32_t add_string(const utility::string_t& value, bool quoted = false);
+
+        compact_list_blob_item_segment m_segment;
+        compact_list_blob_item_segment::item m_item;
+        // Every element text is read into this buffer, so its storage is reused from one element to the next.
+        utility::string_t m_text;
+        utility::string_t m_next_marker;
+    };
+
     class page_list_reader : public core::xml::xml_reader
     {
     public:
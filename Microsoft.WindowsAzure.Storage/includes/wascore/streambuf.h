@@ -17,9 +17,12 @@
 
 #pragma once
 
+#include <mutex>
+
 #include "cpprest/streams.h"
 
 #include "wascore/basic_types.h"
+#include "wascore/resources.h"
 #include "hashing.h"
 
 namespace azure { namespace storage { namespace core {
@@ -156,7 +159,7 @@ namespace azure { namespace storage { namespace core {
         typedef typename basic_ostreambuf<_CharType>::off_type off_type;
 
         basic_hash_wrapper_streambuf(concurrency::streams::streambuf<_CharType> inner_streambuf, hash_provider provider)
-            : basic_ostreambuf<_CharType>(), m_inner_streambuf(inner_streambuf), m_hash_provider(provider), m_total_written(0)
+            : basic_ostreambuf<_CharType>(), m_inner_streambuf(inner_streambuf), m_hash_provider(provider), m_hash_task(pplx::task_from_result()), m_total_written(0)
         {
         }
 
@@ -230,27 +233,52 @@ namespace azure { namespace storage { namespace core {
 
         pplx::task<void> _close_write()
         {
-            m_hash_provider.close();
-            return m_inner_streambuf.close(std::ios_base::out);
+            auto provider = m_hash_provider;
+            auto inner_streambuf = m_inner_streambuf;
+            return m_hash_task.then([provider, inner_streambuf]() mutable -> pplx::task<void>
+            {
+                provider.close();
+                return inner_streambuf.close(std::ios_base::out);
+            });
         }
 
         pplx::task<int_type> _putc(char_type ch)
         {
-            return m_inner_streambuf.putc(ch).then([this, ch](int_type ch_written) -> int_type 
+            auto provider = m_hash_provider;
+            m_hash_task = m_hash_task.then([provider, ch]() mutable
+            {
+                provider.write(&ch, 1);
+            });
+
+            auto hash_task = m_hash_task;
+            return m_inner_streambuf.putc(ch).then([this, hash_task](int_type ch_written) -> pplx::task<int_type>
             {
                 ++m_total_written;
-                m_hash_provider.write(&ch, 1);
-                return ch_written;
+                return hash_task.then([ch_written]() -> int_type
+                {
+                    return ch_written;
+                });
             });
         }
 
         pplx::task<size_t> _putn(const char_type* ptr, size_t count)
         {
-            return m_inner_streambuf.putn_nocopy(ptr, count).then([this, ptr](size_t count) -> size_t
+            // The data is hashed on a worker while it is written to the inner streambuf, so the thread delivering it is not
+            // blocked by hashing. The hash steps are chained to keep them in order, and the data stays valid until the returned task completes.
+            auto provider = m_hash_provider;
+            m_hash_task = m_hash_task.then([provider, ptr, count]() mutable
+            {
+                provider.write(ptr, count);
+            });
+
+            auto hash_task = m_hash_task;
+            return m_inner_streambuf.putn_nocopy(ptr, count).then([this, hash_task](size_t count) -> pplx::task<size_t>
             {
                 m_total_written += count;
-                m_hash_provider.write(ptr, count);
-                return count;
+                return hash_task.then([count]() -> size_t
+                {
+                    return count;
+                });
             });
         }
 
@@ -268,7 +296,154 @@ namespace azure { namespace storage { namespace core {
 
         concurrency::streams::streambuf<_CharType> m_inner_streambuf;
         hash_provider m_hash_provider;
+        pplx::task<void> m_hash_task;
         utility::size64_t m_total_written;
     };
 
+    /// <summary>
+    /// Writes into a fixed window of a seekable streambuf that is shared with other writers.
+    /// Every write is issued at base position + current position while holding the shared mutex,
+    /// so several ranges can be written out of order without buffering them in memory first.
+    /// </summary>
+    template<typename _CharType>
+    class basic_positioned_ostreambuf : public basic_ostreambuf<_CharType>
+    {
+    public:
+        typedef _CharType char_type;
+        typedef typename basic_ostreambuf<_CharType>::traits traits;
+        typedef typename basic_ostreambuf<_CharType>::int_type int_type;
+        typedef typename basic_ostreambuf<_CharType>::pos_type pos_type;
+        typedef typename basic_ostreambuf<_CharType>::off_type off_type;
+
+        basic_positioned_ostreambuf(concurrency::streams::streambuf<_CharType> inner_streambuf, pos_type base_position, std::shared_ptr<std::mutex> mutex)
+            : basic_ostreambuf<_CharType>(), m_inner_streambuf(inner_streambuf), m_base_position(base_position), m_position(0), m_mutex(mutex)
+        {
+        }
+
+        bool can_seek() const
+        {
+            return true;
+        }
+
+        bool has_size() const
+        {
+            return false;
+        }
+
+        utility::size64_t size() const
+        {
+            return 0;
+        }
+
+        size_t buffer_size(std::ios_base::openmode direction) const
+        {
+            UNREFERENCED_PARAMETER(direction);
+            return (size_t)0;
+        }
+
+        void set_buffer_size(size_t size, std::ios_base::openmode direction)
+        {
+            UNREFERENCED_PARAMETER(size);
+            UNREFERENCED_PARAMETER(direction);
+        }
+
+        pos_type getpos(std::ios_base::openmode direction) const
+        {
+            if (direction == std::ios_base::out)
+            {
+                return m_position;
+            }
+
+            return (pos_type)traits::eof();
+        }
+
+        pos_type seekoff(off_type offset, std::ios_base::seekdir way, std::ios_base::openmode direction)
+        {
+            if (direction == std::ios_base::out)
+            {
+                switch (way)
+                {
+                case std::ios_base::beg:
+                    return seekpos((pos_type)offset, direction);
+
+                case std::ios_base::cur:
+                    return seekpos((pos_type)(offset + m_position), direction);
+
+                default:
+                    break;
+                }
+            }
+
+            return (pos_type)traits::eof();
+        }
+
+        pos_type seekpos(pos_type pos, std::ios_base::openmode direction)
+        {
+            if (direction == std::ios_base::out && pos >= (pos_type)0)
+            {
+                m_position = pos;
+                return m_position;
+            }
+
+            return (pos_type)traits::eof();
+        }
+
+        char_type* _alloc(_In_ size_t count)
+        {
+            UNREFERENCED_PARAMETER(count);
+            return nullptr;
+        }
+
+        void _commit(_In_ size_t count)
+        {
+            UNREFERENCED_PARAMETER(count);
+            // no-op, as positioned streams do not support alloc/commit
+        }
+
+        pplx::task<bool> _sync()
+        {
+            return pplx::task_from_result(true);
+        }
+
+        pplx::task<void> _close_write()
+        {
+            // The inner streambuf is shared with other writers and is owned by the caller, so it is not closed here.
+            return pplx::task_from_result();
+        }
+
+        pplx::task<int_type> _putc(char_type ch)
+        {
+            std::lock_guard<std::mutex> guard(*m_mutex);
+            seek_inner();
+            m_position += 1;
+            return m_inner_streambuf.putc(ch);
+        }
+
+        pplx::task<size_t> _putn(const char_type* ptr, size_t count)
+        {
+            // Only issuing the write is serialized. The inner streambuf captures the write position when the
+            // write is issued, so the returned task completes without holding the lock.
+            std::lock_guard<std::mutex> guard(*m_mutex);
+            seek_inner();
+            m_position += count;
+            return m_inner_streambuf.putn_nocopy(ptr, count);
+        }
+
+    private:
+
+        void seek_inner()
+        {
+            pos_type target_position = m_base_position + m_position;
+            if (m_inner_streambuf.seekpos(target_position, std::ios_base::out) != target_position)
+            {
+                throw std::runtime_error(protocol::error_seek_target_stream);
+            }
+        }
+
+        concurrency::streams::streambuf<_CharType> m_inner_streambuf;
+        pos_type m_base_position;
+        pos_type m_position;
+        std::shared_ptr<std::mutex> m_mutex;
+    };
+
 }}} // namespace azure::storage::core
@@ -20,6 +20,8 @@
 #include "wascore/basic_types.h"
 #include "streambuf.h"
 #include "async_semaphore.h"
+#include "buffer_pool.h"
+#include "hash_pipeline.h"
 #include "was/common.h"
 
 namespace azure { namespace storage { namespace core {
@@ -51,12 +53,22 @@ namespace azure { namespace storage { namespace core {
         }
     };
 
+    template<typename _CharType>
+    class positioned_ostreambuf : public concurrency::streams::streambuf<_CharType>
+    {
+    public:
+        positioned_ostreambuf(concurrency::streams::streambuf<_CharType> inner_streambuf, typename basic_positioned_ostreambuf<_CharType>::pos_type base_position, std::shared_ptr<std::mutex> mutex)
+            : concurrency::streams::streambuf<_CharType>(std::make_shared<basic_positioned_ostreambuf<_CharType>>(inner_streambuf, base_position, mutex))
+        {
+        }
+    };
+
     class basic_cloud_ostreambuf : public basic_ostreambuf<concurrency::streams::ostream::traits::char_type>
     {
     public:
         basic_cloud_ostreambuf()
             : basic_ostreambuf<concurrency::streams::ostream::traits::char_type>(),
-            m_current_streambuf_offset(0), m_committed(false), m_buffer_size(0), m_next_buffer_size(0)
+            m_current_streambuf_offset(0), m_total_hash_task(pplx::task_from_result()), m_use_transactional_md5(false), m_use_transactional_crc64(false), m_committed(false), m_buffer_size(0), m_next_buffer_size(0)
         {
         }
 
@@ -143,13 +155,20 @@ namespace azure { namespace storage { namespace core {
         class buffer_to_upload
         {
         public:
-            buffer_to_upload(concurrency::streams::container_buffer<std::vector<char_type>> buffer, const utility::string_t& content_md5)
+            buffer_to_upload(concurrency::streams::container_buffer<std::vector<char_type>> buffer)
                 : m_size(buffer.size()),
-                m_stream(concurrency::streams::container_stream<std::vector<char_type>>::open_istream(std::move(buffer.collection()))),
-                m_content_md5(content_md5)
+                m_buffer(std::move(buffer.collection()), std::ios_base::in),
+                m_stream(m_buffer.create_istream()),
+                m_hash_task(pplx::task_from_result())
             {
             }
 
+            ~buffer_to_upload()
+            {
+                // The upload that used this buffer has completed, so its storage can be handed to the next block.
+                buffer_pool::release(std::move(m_buffer.collection()));
+            }
+
             concurrency::streams::istream stream() const
             {
                 return m_stream;
@@ -165,28 +184,53 @@ namespace azure { namespace storage { namespace core {
                 return m_size == 0;
             }
 
+            const char_type* data() const
+            {
+                return m_buffer.collection().data();
+            }
+
+            // Completes once the transactional hash of the buffer has been calculated.
+            pplx::task<void> hash_task() const
+            {
+                return m_hash_task;
+            }
+
             const utility::string_t& content_md5() const
             {
                 return m_content_md5;
             }
 
+            const utility::string_t& content_crc64() const
+            {
+                return m_content_crc64;
+            }
+
         private:
 
-            // Note: m_size must be initialized before m_stream, and thus must be listed first in this list.
-            // This is because we use std::move to initialize m_stream, but we need to get the size first.
+            // Note: m_size must be initialized before m_buffer, and thus must be listed first in this list.
+            // This is because we use std::move to initialize m_buffer, but we need to get the size first.
             utility::size64_t m_size;
-            utility::string_t m_content_md5;
+            concurrency::streams::container_buffer<std::vector<char_type>> m_buffer;
             concurrency::streams::istream m_stream;
+            pplx::task<void> m_hash_task;
+            utility::string_t m_content_md5;
+            utility::string_t m_content_crc64;
+
+            friend class basic_cloud_ostreambuf;
         };
 
         concurrency::streams::container_buffer<std::vector<char_type>> m_buffer;
         pos_type m_current_streambuf_offset;
         hash_provider m_total_hash_provider;
-        hash_provider m_transaction_hash_provider;
+        pplx::task<void> m_total_hash_task;
+        bool m_use_transactional_md5;
+        bool m_use_transactional_crc64;
 
         virtual pplx::task<void> upload_buffer() = 0;
         virtual pplx::task<void> commit_close() = 0;
         std::shared_ptr<buffer_to_upload> prepare_buffer();
+        pplx::task<void> close_total_hash();
+        void acquire_buffer();
 
         size_t m_buffer_size;
         size_t m_next_buffer_size;
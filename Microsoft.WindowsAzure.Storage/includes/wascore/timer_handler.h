@@ -18,19 +18,75 @@
 #pragma once
 
 #include "cpprest/http_client.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <mutex>
+#include <thread>
 
 #include "wascore/constants.h"
 
-#ifndef _WIN32
-#include <chrono>
-#include <boost/asio/basic_waitable_timer.hpp>
-#include "pplx/threadpool.h"
-#else
-#include <agents.h>
-#endif
-
 namespace azure { namespace storage { namespace core {
+
+    // An entry of the timer wheel. It is embedded in the object that owns the deadline, so arming a timer does not allocate.
+    struct timer_wheel_entry
+    {
+        timer_wheel_entry()
+            : m_prev(nullptr), m_next(nullptr), m_expiry(0), m_callback(nullptr), m_context(nullptr)
+        {
+        }
+
+        timer_wheel_entry* m_prev;
+        timer_wheel_entry* m_next;
+        uint64_t m_expiry;
+        void (*m_callback)(void*);
+        void* m_context;
+    };
+
+    // A process-wide hierarchical timer wheel with a resolution of one millisecond. Every level has 64 slots, and each slot of a level
+    // spans all 64 slots of the level below, so arming and canceling an entry take constant time. One thread serves every deadline
+    // and only wakes up when a slot of the lowest level is due or the lowest level wraps around.
+    class timer_wheel
+    {
+    public:
+
+        static timer_wheel& instance();
+
+        // Deadlines further away than the last level can hold, about 795 days, are shortened to fit.
+        // Arming an entry that is already armed replaces its deadline.
+        void arm(timer_wheel_entry& entry, const std::chrono::milliseconds& timeout);
+
+        // Once this returns, the callback of the entry is not running and will not run. A callback that cancels its own entry does not wait.
+        void cancel(timer_wheel_entry& entry);
+
+    private:
+
+        static const int slot_bits = 6;
+        static const uint64_t slot_mask = (1 << slot_bits) - 1;
+        static const int level_count = 6;
+
+        timer_wheel();
+
+        uint64_t now_tick() const;
+        void place(timer_wheel_entry& entry);
+        void advance(uint64_t tick);
+        uint64_t next_wake_tick() const;
+        void run();
+
+        std::mutex m_mutex;
+        std::condition_variable m_wake_condition;
+        std::condition_variable m_fired_condition;
+        std::chrono::steady_clock::time_point m_epoch;
+        uint64_t m_current_tick;
+        uint64_t m_wake_tick;
+        size_t m_count;
+        // Every list has a sentinel, so entries can be unlinked without knowing which list they are in.
+        timer_wheel_entry m_slots[level_count][slot_mask + 1];
+        timer_wheel_entry m_due;
+        timer_wheel_entry* m_firing;
+        std::thread::id m_thread_id;
+    };
+
     /// <summary>
     /// Used for internal logic of timer handling, including timer creation, deletion and cancellation
     /// </summary>
@@ -41,18 +97,19 @@ namespace azure { namespace storage { namespace core {
 
         WASTORAGE_API ~timer_handler();
 
+        // Every call restarts the timer with the new timeout, replacing the deadline of an earlier call.
         WASTORAGE_API void start_timer(const std::chrono::milliseconds& time);
 
         WASTORAGE_API void stop_timer();
 
         pplx::cancellation_token get_cancellation_token()
         {
-            return m_worker_cancellation_token_source->get_token();
+            return m_worker_cancellation_token_source.get_token();
         }
 
         bool is_canceled()
         {
-            return m_worker_cancellation_token_source->get_token().is_canceled();
+            return m_worker_cancellation_token_source.get_token().is_canceled();
         }
 
         bool is_canceled_by_timeout()
@@ -61,22 +118,13 @@ namespace azure { namespace storage { namespace core {
         }
 
     private:
-        std::shared_ptr<pplx::cancellation_token_source> m_worker_cancellation_token_source;
+        static void timer_fired(void* context);
+
+        pplx::cancellation_token_source m_worker_cancellation_token_source;
         pplx::cancellation_token_registration m_cancellation_token_registration;
         pplx::cancellation_token m_cancellation_token;
-        pplx::task<void> m_timeout_task;
-        bool m_is_canceled_by_timeout;
-        pplx::task_completion_event<void> m_tce;
-
-        std::shared_ptr<std::mutex> m_mutex;
-
-        WASTORAGE_API pplx::task<void> timeout_after(const std::chrono::milliseconds& time);
-
-#ifndef _WIN32
-        typedef std::chrono::steady_clock std_clock;
-        std::shared_ptr<boost::asio::basic_waitable_timer<std_clock>> m_timer;
-#else
-        std::shared_ptr<concurrency::timer<int>> m_timer;
-#endif
+        std::atomic<bool> m_is_canceled_by_timeout;
+        std::atomic<bool> m_is_started;
+        timer_wheel_entry m_timer_entry;
     };
 }}}
@@ -17,14 +17,19 @@
 
 #pragma once
 
+#include <deque>
 #include <map>
 
 #ifndef _WIN32
+    #include <atomic>
+    #include <unordered_map>
     #include "pplx/threadpool.h"
 #endif
 #include "cpprest/streams.h"
 
 #include "was/core.h"
+#include "wascore/async_semaphore.h"
+#include "wascore/hashing.h"
 #include "wascore/timer_handler.h"
 
 #pragma push_macro("max")
@@ -53,12 +58,52 @@ namespace azure { namespace storage { namespace core {
 #pragma region MIME Helpers
 
     utility::string_t generate_boundary_name(const utility::string_t& prefix);
+    void write_line_break(utility::string_t& body_text);
     void write_boundary(utility::string_t& body_text, const utility::string_t& boundary_name, bool is_closure = false);
     void write_mime_changeset_headers(utility::string_t& body_text);
     void write_request_line(utility::string_t& body_text, const web::http::method& method, const web::http::uri& uri);
+    void write_request_header(utility::string_t& body_text, const utility::string_t& header_name, const utility::string_t& header_value);
     void write_request_headers(utility::string_t& body_text, const web::http::http_headers& headers);
     void write_request_payload(utility::string_t& body_text, const web::json::value& json_object);
 
+    // A multipart body kept as a list of references to pieces of UTF-8 text. A piece that repeats, such as a boundary or the
+    // header block shared by operations of the same type, is stored once, and the body is streamed to the request without being concatenated.
+    class WASTORAGE_API mime_multipart_body
+    {
+    public:
+
+        mime_multipart_body();
+
+        // Stores a piece of text, which can then be appended any number of times.
+        size_t add_piece(utility::string_t text);
+        void append_piece(size_t piece);
+
+        void append(utility::string_t text)
+        {
+            append_piece(add_piece(std::move(text)));
+        }
+
+        utility::size64_t size() const
+        {
+            return m_size;
+        }
+
+        // The body must not be changed once a stream has been created over it.
+        concurrency::streams::istream create_istream() const;
+
+    private:
+
+        struct body_pieces
+        {
+            // A deque does not move its elements as it grows, so segments can point into it.
+            std::deque<std::string> m_pieces;
+            std::vector<const std::string*> m_segments;
+        };
+
+        std::shared_ptr<body_pieces> m_body;
+        utility::size64_t m_size;
+    };
+
 #pragma endregion
 
 #pragma region Common Utilities
@@ -66,6 +111,7 @@ namespace azure { namespace storage { namespace core {
     utility::string_t make_query_parameter(const utility::string_t& parameter_name, const utility::string_t& parameter_value, bool do_encoding = true);
     utility::size64_t get_remaining_stream_length(concurrency::streams::istream stream);
     pplx::task<utility::size64_t> stream_copy_async(concurrency::streams::istream istream, concurrency::streams::ostream ostream, utility::size64_t length, utility::size64_t max_length = std::numeric_limits<utility::size64_t>::max(), const pplx::cancellation_token& cancellation_token = pplx::cancellation_token::none(), std::shared_ptr<core::timer_handler> timer_handler = nullptr);
+    pplx::task<void> upload_file_ranges_async(const utility::string_t& path, utility::size64_t length, size_t range_size, int parallelism_factor, bool calculate_range_md5, bool calculate_range_crc64, hash_provider total_hash_provider, std::function<pplx::task<void>(concurrency::streams::istream, utility::size64_t, const utility::string_t&, const utility::string_t&)> upload_range, const pplx::cancellation_token& cancellation_token = pplx::cancellation_token::none(), std::shared_ptr<core::timer_handler> timer_handler = nullptr);
     pplx::task<void> complete_after(std::chrono::milliseconds timeout);
     std::vector<utility::string_t> string_split(const utility::string_t& string, const utility::string_t& separator);
     bool is_empty_or_whitespace(const utility::string_t& value);
@@ -119,16 +165,110 @@ namespace azure { namespace storage { namespace core {
 #pragma endregion
 
 #ifndef _WIN32
+    struct http_client_pool_statistics
+    {
+        // Number of lookups that were served by an already cached client.
+        utility::size64_t hits;
+
+        // Number of clients that were created because no cached client matched.
+        utility::size64_t creations;
+
+        // Number of idle clients that were removed from the cache.
+        utility::size64_t evictions;
+
+        // Number of clients currently in the cache.
+        utility::size64_t cached_clients;
+
+        // Number of requests that currently hold a connection slot, from sending the request until the response body is received.
+        utility::size64_t active_requests;
+
+        // Number of requests that are waiting for a connection slot because the per-host limit has been reached.
+        utility::size64_t waiting_requests;
+    };
+
     class http_client_reusable
     {
     public:
         WASTORAGE_API static std::shared_ptr<web::http::client::http_client> get_http_client(const web::uri& uri);
         WASTORAGE_API static std::shared_ptr<web::http::client::http_client> get_http_client(const web::uri& uri, const web::http::client::http_client_config& config);
 
+        // Sends the request with a cached client for the authority and configuration. If a per-host connection limit is set,
+        // the request first waits for a free connection slot, and the slot is held until the response body has been received.
+        WASTORAGE_API static pplx::task<web::http::http_response> request(const web::uri& uri, const web::http::client::http_client_config& config, web::http::http_request request, const pplx::cancellation_token& cancellation_token);
+
+        // Opens connection_count connections to the authority ahead of time, so that the first requests do not pay for connection setup.
+        WASTORAGE_API static pplx::task<void> prewarm_connections(const web::uri& uri, const web::http::client::http_client_config& config, size_t connection_count);
+
+        // Sets the maximum number of concurrent requests per authority. Zero means no limit, which is the default.
+        // The new limit applies to authorities contacted after the call.
+        WASTORAGE_API static void set_max_connections_per_host(size_t max_connections);
+        WASTORAGE_API static size_t max_connections_per_host();
+
+        // Sets how long a client may stay unused in the cache before it is evicted. Zero disables eviction.
+        WASTORAGE_API static void set_idle_timeout(std::chrono::seconds idle_timeout);
+        WASTORAGE_API static std::chrono::seconds idle_timeout();
+
+        // Removes every cached client that is not in use and has been idle for longer than the idle timeout.
+        WASTORAGE_API static size_t evict_idle_clients();
+
+        // Same as evict_idle_clients(), with idle times measured up to now instead of the current time.
+        WASTORAGE_API static size_t evict_idle_clients(std::chrono::steady_clock::time_point now);
+
+        WASTORAGE_API static http_client_pool_statistics statistics();
+
     private:
+
+        struct client_key
+        {
+            utility::string_t authority;
+            utility::string_t proxy;
+            bool proxy_specified;
+            std::chrono::microseconds::rep timeout;
+            size_t chunksize;
+            const void* ssl_context_callback;
+
+            bool operator==(const client_key& other) const
+            {
+                return proxy_specified == other.proxy_specified && timeout == other.timeout && chunksize == other.chunksize &&
+                    ssl_context_callback == other.ssl_context_callback && authority == other.authority && proxy == other.proxy;
+            }
+        };
+
+        struct client_key_hash
+        {
+            size_t operator()(const client_key& key) const;
+        };
+
+        struct cached_client
+        {
+            std::shared_ptr<web::http::client::http_client> client;
+            std::chrono::steady_clock::time_point last_used;
+        };
+
+        struct shard
+        {
+            std::mutex mutex;
+            std::unordered_map<client_key, cached_client, client_key_hash> clients;
+            std::unordered_map<utility::string_t, std::shared_ptr<async_semaphore>> host_semaphores;
+            std::chrono::steady_clock::time_point last_eviction;
+        };
+
+        static const size_t s_shard_count = 16;
+
+        static std::shared_ptr<async_semaphore> get_host_semaphore(const utility::string_t& authority);
+        static shard& get_shard(const utility::string_t& authority);
+        static size_t evict_idle_clients(shard& shard, std::chrono::steady_clock::time_point now);
+
         static const boost::asio::io_service& s_service;
-        WASTORAGE_API static std::map<utility::string_t, std::shared_ptr<web::http::client::http_client>> s_http_clients;
-        WASTORAGE_API static std::mutex s_mutex;
+        WASTORAGE_API static shard s_shards[s_shard_count];
+        WASTORAGE_API static std::atomic<size_t> s_max_connections_per_host;
+        WASTORAGE_API static std::atomic<std::chrono::seconds::rep> s_idle_timeout;
+        WASTORAGE_API static std::atomic<utility::size64_t> s_hits;
+        WASTORAGE_API static std::atomic<utility::size64_t> s_creations;
+        WASTORAGE_API static std::atomic<utility::size64_t> s_evictions;
+        WASTORAGE_API static std::atomic<utility::size64_t> s_cached_clients;
+        WASTORAGE_API static std::atomic<utility::size64_t> s_active_requests;
+        WASTORAGE_API static std::atomic<utility::size64_t> s_waiting_requests;
     };
 #endif
 
@@ -29,6 +29,8 @@
 
 #ifndef _WIN32
 #include <string>
+#include <vector>
+#include <libxml/parser.h>
 #include <libxml/xmlreader.h>
 #include <libxml/xmlwriter.h>
 
@@ -39,18 +41,31 @@ namespace azure { namespace storage { namespace core { namespace xml {
     std::string xml_char_to_string(const xmlChar *xml_char);
 
     /// <summary>
-    /// A class to wrap xmlTextReader of c library libxml2. This class provides abilities to read from xml format texts.
+    /// A class to wrap the push parser of c library libxml2. The document is handed to it in pieces as they arrive and
+    /// the parsed nodes are read one at a time in the same way as with xmlTextReader.
     /// </summary>
-    class xml_text_reader_wrapper {
+    class xml_push_reader_wrapper {
     public:
-        xml_text_reader_wrapper(const unsigned char* buffer, unsigned int size);
+        xml_push_reader_wrapper();
 
-        ~xml_text_reader_wrapper();
+        ~xml_push_reader_wrapper();
 
         /// <summary>
-        /// Moves to the next node in the stream.
+        /// Parses the next piece of the document. The nodes that it completes can then be read.
         /// </summary>
-        /// <returns>true if the node was read successfully and false if there are no more nodes to read</returns>
+        /// <param name="data">The next bytes of the document.</param>
+        /// <param name="size">The number of bytes.</param>
+        void push(const char* data, size_t size);
+
+        /// <summary>
+        /// Signals that the whole document has been pushed.
+        /// </summary>
+        void finish();
+
+        /// <summary>
+        /// Moves to the next parsed node.
+        /// </summary>
+        /// <returns>true if the node was read successfully and false if there are no more parsed nodes to read</returns>
         bool read();
 
         /// <summary>
@@ -62,7 +77,7 @@ namespace azure { namespace storage { namespace core { namespace xml {
         /// <summary>
         /// Checks if current node is empty
         /// </summary>
-        /// <returns>True if current node is empty and false if otherwise</returns>
+        /// <returns>Always false, as the end of an empty element is read as a separate node.</returns>
         bool is_empty_element();
 
         /// <summary>
@@ -77,6 +92,12 @@ namespace azure { namespace storage { namespace core { namespace xml {
         /// <returns>A string value of the node</returns>
         std::string get_value();
 
+        /// <summary>
+        /// Copies the value of the node into the given string, reusing its storage.
+        /// </summary>
+        /// <param name="value">The string to copy the value into.</param>
+        void get_value(std::string& value);
+
         /// <summary>
         /// Moves to the first attribute of the node.
         /// </summary>
@@ -90,7 +111,32 @@ namespace azure { namespace storage { namespace core { namespace xml {
         bool move_to_next_attribute();
 
     private:
-        xmlTextReaderPtr m_reader;
+
+        // Names are interned in the dictionary of the parser, so nodes only point to them.
+        // The nodes are reused once all of them have been read, which keeps the storage of their values.
+        struct node
+        {
+            unsigned type;
+            const xmlChar* local_name;
+            std::string value;
+            std::vector<std::pair<const xmlChar*, std::string>> attributes;
+        };
+
+        static void start_element(void* context, const xmlChar* local_name, const xmlChar* prefix, const xmlChar* uri, int namespace_count, const xmlChar** namespaces, int attribute_count, int defaulted_count, const xmlChar** attributes);
+        static void end_element(void* context, const xmlChar* local_name, const xmlChar* prefix, const xmlChar* uri);
+        static void characters(void* context, const xmlChar* text, int length);
+
+        node& add_node(unsigned type, const xmlChar* local_name);
+        void add_text_node();
+
+        xmlParserCtxtPtr m_context;
+        std::vector<node> m_nodes;
+        size_t m_node_count;
+        size_t m_next_node;
+        size_t m_current;
+        std::string m_text;
+        size_t m_attribute;
+        bool m_failed;
     };
 
     /// <summary>
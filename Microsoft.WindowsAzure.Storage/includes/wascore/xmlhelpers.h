@@ -60,7 +60,7 @@ namespace azure { namespace storage { namespace core { namespace xml {
 /// <summary>
 /// XML reader based on xmlllite
 /// </summary>
-class xml_reader
+class WASTORAGE_API xml_reader
 {
 public:
 
@@ -93,6 +93,13 @@ public:
     /// </summary>
     parse_result parse();
 
+    /// <summary>
+    /// Reads the XML stream to its end without blocking. On Linux, the stream is parsed piece by piece as it is read,
+    /// and nodes are handed to the handle_* routines as they are completed. On Windows, the stream is read by parse().
+    /// The reader must be kept alive until the returned task completes.
+    /// </summary>
+    pplx::task<void> read_async();
+
 protected:
 
     xml_reader() : m_continueParsing(true), m_streamDone(false)
@@ -154,6 +161,11 @@ protected:
     /// </summary>
     utility::string_t get_current_element_text();
 
+    /// <summary>
+    /// Copies the current element value into the given string, reusing its storage
+    /// </summary>
+    void read_current_element_text(utility::string_t& value);
+
     /// <summary>
     /// Moves to the first attribute in the node
     /// </summary>
@@ -185,11 +197,22 @@ protected:
     /// </summary>
     void pause() { m_continueParsing = false; }
 
+    /// <summary>
+    /// Handles the parsed nodes until there are no more or parsing is paused.
+    /// </summary>
+    void read_nodes();
+
 #ifdef _WIN32
     CComPtr<IXmlReader> m_reader;
 #else
-    std::shared_ptr<xml_text_reader_wrapper> m_reader;
-    std::string m_data;
+    /// <summary>
+    /// Pushes the next piece of the stream to the parser and handles the nodes it completes.
+    /// </summary>
+    void push_input(const uint8_t* data, size_t count);
+
+    std::shared_ptr<xml_push_reader_wrapper> m_reader;
+    concurrency::streams::streambuf<uint8_t> m_input;
+    std::vector<uint8_t> m_inputBuffer;
 #endif 
 
     std::vector<utility::string_t> m_elementStack;
@@ -0,0 +1,134 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="adaptive_upload.cpp" company="Microsoft">
+//    Copyright 2013 Microsoft Corporation
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "wascore/adaptive_upload.h"
+
+namespace azure { namespace storage { namespace core {
+
+    // A change in throughput smaller than this fraction is treated as noise.
+    const double adaptive_upload_throughput_tolerance = 0.05;
+
+    adaptive_upload_controller::adaptive_upload_controller(size_t min_block_size, size_t max_block_size, int max_parallelism)
+        : m_min_block_size(min_block_size), m_max_block_size(std::max(min_block_size, max_block_size)), m_block_size(min_block_size),
+        m_max_parallelism(std::max(max_parallelism, 1)), m_parallelism(std::max((max_parallelism + 1) / 2, 1)),
+        m_epoch_bytes(0), m_epoch_blocks(0), m_epoch_throttled(false), m_last_throughput(0)
+    {
+        start_epoch(std::chrono::steady_clock::now());
+    }
+
+    size_t adaptive_upload_controller::block_size() const
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        return m_block_size;
+    }
+
+    int adaptive_upload_controller::parallelism() const
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        return m_parallelism;
+    }
+
+    void adaptive_upload_controller::block_completed(size_t size)
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_epoch_bytes += size;
+        ++m_epoch_blocks;
+
+        // Wait for enough blocks to have gone through every slot twice, so one slow block does not decide the next step.
+        if (m_epoch_blocks < 2 * m_parallelism)
+        {
+            return;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        double elapsed = std::chrono::duration<double>(now - m_epoch_start).count();
+        double throughput = elapsed > 0 ? static_cast<double>(m_epoch_bytes) / elapsed : 0;
+
+        if (m_last_throughput == 0 || throughput > m_last_throughput * (1 + adaptive_upload_throughput_tolerance))
+        {
+            if (m_parallelism < m_max_parallelism)
+            {
+                ++m_parallelism;
+            }
+            else
+            {
+                m_block_size = std::min(m_block_size * 2, m_max_block_size);
+            }
+        }
+        else if (throughput < m_last_throughput * (1 - adaptive_upload_throughput_tolerance))
+        {
+            if (m_block_size > m_min_block_size)
+            {
+                m_block_size = std::max(m_block_size / 2, m_min_block_size);
+            }
+            else if (m_parallelism > 1)
+            {
+                --m_parallelism;
+            }
+        }
+
+        m_last_throughput = throughput;
+        start_epoch(now);
+    }
+
+    void adaptive_upload_controller::throttled()
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        if (m_epoch_throttled)
+        {
+            return;
+        }
+
+        m_parallelism = std::max(m_parallelism / 2, 1);
+        m_block_size = std::max(m_block_size / 2, m_min_block_size);
+
+        // The throughput measured before backing off is no longer a fair baseline.
+        m_last_throughput = 0;
+        start_epoch(std::chrono::steady_clock::now());
+        m_epoch_throttled = true;
+    }
+
+    void adaptive_upload_controller::start_epoch(std::chrono::steady_clock::time_point now)
+    {
+        m_epoch_start = now;
+        m_epoch_bytes = 0;
+        m_epoch_blocks = 0;
+        m_epoch_throttled = false;
+    }
+
+    retry_info adaptive_upload_retry_policy::evaluate(const retry_context& retry_context, operation_context context)
+    {
+        int status_code = retry_context.last_request_result().http_status_code();
+        if (status_code == web::http::status_codes::ServiceUnavailable ||
+            status_code == web::http::status_codes::InternalError ||
+            status_code == web::http::status_codes::RequestTimeout ||
+            status_code == 0)
+        {
+            // A status code of 0 means no response was received, which is how client side timeouts show up.
+            m_controller->throttled();
+        }
+
+        return m_policy.evaluate(retry_context, context);
+    }
+
+    retry_policy adaptive_upload_retry_policy::clone() const
+    {
+        return retry_policy(std::make_shared<adaptive_upload_retry_policy>(m_policy.clone(), m_controller));
+    }
+
+}}} // namespace azure::storage::core
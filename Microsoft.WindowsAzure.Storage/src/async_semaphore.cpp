@@ -20,55 +20,223 @@
 
 namespace azure { namespace storage {  namespace core {
 
-    pplx::task<void> _async_semaphore::lock_async()
+    namespace
     {
-        pplx::extensibility::scoped_rw_lock_t guard(m_mutex);
-        if (m_count > 0)
+        // Copying a task only copies a reference, so the fast path hands out this one instead of creating a task per call.
+        pplx::task<void> completed_task()
         {
-            if (m_count-- == m_initial_count)
+            static const pplx::task<void> completed = pplx::task_from_result();
+            return completed;
+        }
+
+        // Effectively no cap, while leaving room for the count to be exceeded by one large acquisition.
+        const int64_t unlimited_bytes = std::numeric_limits<int64_t>::max() / 4;
+    }
+
+    _async_semaphore::~_async_semaphore()
+    {
+        while (m_head != nullptr)
+        {
+            waiter* next = m_head->m_next;
+            delete m_head;
+            m_head = next;
+        }
+    }
+
+    pplx::task<void> _async_semaphore::lock_async(int64_t weight)
+    {
+        // Queued waiters go first, so a stream of small acquisitions cannot starve a large one.
+        if (m_waiter_count.load() == 0 && try_acquire(weight))
+        {
+            return completed_task();
+        }
+
+        waiter* pending = new waiter(weight);
+        auto result = pplx::create_task(pending->m_event);
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            if (m_tail == nullptr)
+            {
+                m_head = pending;
+            }
+            else
             {
-                m_empty_event = pplx::task_completion_event<void>();
+                m_tail->m_next = pending;
             }
 
-            return pplx::task_from_result();
+            m_tail = pending;
+            ++m_waiter_count;
         }
-        else
+
+        // Units may have been returned between the failed attempt and the waiter becoming visible to unlock.
+        release_waiters();
+        return result;
+    }
+
+    bool _async_semaphore::try_lock(int64_t weight)
+    {
+        return m_waiter_count.load() == 0 && try_acquire(weight);
+    }
+
+    void _async_semaphore::unlock(int64_t weight)
+    {
+        int64_t available = m_available.fetch_add(weight) + weight;
+        if (m_waiter_count.load() != 0)
+        {
+            release_waiters();
+        }
+
+        if (available >= m_count.load() && m_idle_waiter_count.load() != 0)
         {
-            pplx::task_completion_event<void> pending;
-            m_queue.push(pending);
-            return pplx::create_task(pending);
+            release_idle_waiters();
         }
     }
 
     pplx::task<void> _async_semaphore::wait_all_async()
     {
-        return pplx::create_task(m_empty_event);
+        if (m_waiter_count.load() == 0 && m_available.load() >= m_count.load())
+        {
+            return completed_task();
+        }
+
+        pplx::task_completion_event<void> idle;
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            m_idle_waiters.push_back(idle);
+            ++m_idle_waiter_count;
+        }
+
+        // The last unit may have been returned before this waiter was registered.
+        if (m_available.load() >= m_count.load())
+        {
+            release_idle_waiters();
+        }
+
+        return pplx::create_task(idle);
+    }
+
+    void _async_semaphore::resize(int64_t count)
+    {
+        int64_t previous = m_count.exchange(count);
+        m_available.fetch_add(count - previous);
+
+        release_waiters();
+        if (m_available.load() >= count && m_idle_waiter_count.load() != 0)
+        {
+            release_idle_waiters();
+        }
+    }
+
+    bool _async_semaphore::try_acquire(int64_t weight)
+    {
+        int64_t available = m_available.load();
+        for (;;)
+        {
+            // A negative count means the semaphore has been resized below the number of units in use, so nothing is granted
+            // until enough units have been returned. An acquisition larger than the whole count is granted once nothing is in use.
+            if (available < weight && available < m_count.load())
+            {
+                return false;
+            }
+
+            if (m_available.compare_exchange_weak(available, available - weight))
+            {
+                return true;
+            }
+        }
     }
 
-    void _async_semaphore::unlock()
+    void _async_semaphore::release_waiters()
     {
-        auto pending = dequeue_pending();
-        pending.set();
+        waiter* released_head = nullptr;
+        waiter* released_tail = nullptr;
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            while (m_head != nullptr && try_acquire(m_head->m_weight))
+            {
+                waiter* granted = m_head;
+                m_head = granted->m_next;
+                if (m_head == nullptr)
+                {
+                    m_tail = nullptr;
+                }
+
+                granted->m_next = nullptr;
+                if (released_tail == nullptr)
+                {
+                    released_head = granted;
+                }
+                else
+                {
+                    released_tail->m_next = granted;
+                }
+
+                released_tail = granted;
+                --m_waiter_count;
+            }
+        }
+
+        // Continuations may run inline and acquire the semaphore again, so the events are set outside of the lock.
+        while (released_head != nullptr)
+        {
+            waiter* next = released_head->m_next;
+            released_head->m_event.set();
+            delete released_head;
+            released_head = next;
+        }
     }
 
-    pplx::task_completion_event<void> _async_semaphore::dequeue_pending()
+    void _async_semaphore::release_idle_waiters()
     {
-        pplx::extensibility::scoped_rw_lock_t guard(m_mutex);
-        if (m_queue.empty())
+        std::vector<pplx::task_completion_event<void>> released;
         {
-            if (++m_count == m_initial_count)
+            std::lock_guard<std::mutex> guard(m_mutex);
+
+            // The callers check for idleness before release_waiters may have handed the returned units to a queued waiter,
+            // so check again. The unlock that makes the semaphore idle later releases the idle waiters instead.
+            if (m_head != nullptr || m_available.load() < m_count.load())
             {
-                m_empty_event.set();
+                return;
             }
 
-            return pplx::task_completion_event<void>();
+            released.swap(m_idle_waiters);
+            m_idle_waiter_count = 0;
         }
-        else
+
+        for (auto& idle : released)
         {
-            auto pending = m_queue.front();
-            m_queue.pop();
-            return pending;
+            idle.set();
         }
     }
 
+    std::atomic<utility::size64_t> transfer_byte_limit::s_max_bytes(0);
+
+    void transfer_byte_limit::set_max_in_flight_bytes(utility::size64_t max_bytes)
+    {
+        s_max_bytes = max_bytes;
+        semaphore().resize(max_bytes == 0 ? unlimited_bytes : static_cast<int64_t>(std::min<utility::size64_t>(max_bytes, unlimited_bytes)));
+    }
+
+    utility::size64_t transfer_byte_limit::max_in_flight_bytes()
+    {
+        return s_max_bytes;
+    }
+
+    pplx::task<void> transfer_byte_limit::acquire_async(utility::size64_t size)
+    {
+        return semaphore().lock_async(static_cast<int64_t>(size));
+    }
+
+    void transfer_byte_limit::release(utility::size64_t size)
+    {
+        semaphore().unlock(static_cast<int64_t>(size));
+    }
+
+    async_semaphore& transfer_byte_limit::semaphore()
+    {
+        // Acquisitions are always counted, even without a cap, so that setting one while transfers run stays consistent.
+        static async_semaphore instance(unlimited_bytes);
+        return instance;
+    }
+
 }}} // namespace azure::storage::core
@@ -21,16 +21,149 @@
 #include "wascore/constants.h"
 #include "wascore/logging.h"
 #include "wascore/streams.h"
+#include "wascore/hashing.h"
+#include "wascore/base64.h"
 
 namespace azure { namespace storage { namespace protocol {
 
+    namespace
+    {
+        struct query_parameter
+        {
+            const utility::char_t* name;
+            size_t name_size;
+            const utility::char_t* value;
+            size_t value_size;
+        };
+
+        // Orders parameter names the same way std::less<utility::string_t> does.
+        int compare_names(const query_parameter& left, const query_parameter& right)
+        {
+            int result = utility::string_t::traits_type::compare(left.name, right.name, std::min(left.name_size, right.name_size));
+            if (result != 0)
+            {
+                return result;
+            }
+
+            return left.name_size < right.name_size ? -1 : (left.name_size > right.name_size ? 1 : 0);
+        }
+
+        // Calls handler for every name=value pair of the query, split the same way as web::http::uri::split_query:
+        // pairs are separated by '&', or by ';' when there is no '&' left, and pairs without '=' are skipped.
+        template<typename Handler>
+        void for_each_query_parameter(const utility::string_t& query, Handler handler)
+        {
+            size_t begin = 0;
+            while (begin != utility::string_t::npos)
+            {
+                size_t end = query.find(_XPLATSTR('&'), begin);
+                if (end == utility::string_t::npos)
+                {
+                    end = query.find(_XPLATSTR(';'), begin);
+                }
+
+                size_t pair_end = end == utility::string_t::npos ? query.size() : end;
+                size_t equals = query.find(_XPLATSTR('='), begin);
+                if (equals < pair_end)
+                {
+                    query_parameter parameter = { query.data() + begin, equals - begin, query.data() + equals + 1, pair_end - equals - 1 };
+                    handler(parameter);
+                }
+
+                begin = end == utility::string_t::npos ? end : end + 1;
+            }
+        }
+
+        int hex_digit_value(utility::char_t c)
+        {
+            if (c >= _XPLATSTR('0') && c <= _XPLATSTR('9'))
+            {
+                return c - _XPLATSTR('0');
+            }
+            else if (c >= _XPLATSTR('A') && c <= _XPLATSTR('F'))
+            {
+                return c - _XPLATSTR('A') + 10;
+            }
+            else if (c >= _XPLATSTR('a') && c <= _XPLATSTR('f'))
+            {
+                return c - _XPLATSTR('a') + 10;
+            }
+
+            return -1;
+        }
+
+        bool try_append_decoded(utility::string_t& result, const utility::char_t* value, size_t value_size)
+        {
+            for (size_t i = 0; i < value_size; ++i)
+            {
+                utility::char_t c = value[i];
+                if (static_cast<unsigned int>(c) > 127)
+                {
+                    return false;
+                }
+
+                if (c == _XPLATSTR('%'))
+                {
+#ifdef _WIN32
+                    // The decoded bytes are UTF-8 and have to be converted to UTF-16
+                    return false;
+#else
+                    int high = i + 1 < value_size ? hex_digit_value(value[i + 1]) : -1;
+                    int low = i + 2 < value_size ? hex_digit_value(value[i + 2]) : -1;
+                    if (high < 0 || low < 0)
+                    {
+                        return false;
+                    }
+
+                    result.push_back(static_cast<char>((high << 4) | low));
+                    i += 2;
+                    continue;
+#endif
+                }
+
+                result.push_back(c);
+            }
+
+            return true;
+        }
+
+        // Appends the value decoded the same way as web::http::uri::decode. Only the values that cannot be decoded
+        // in place are passed to web::http::uri::decode, which also reports the malformed ones as before.
+        void append_decoded(utility::string_t& result, const utility::char_t* value, size_t value_size)
+        {
+            const size_t result_size = result.size();
+            if (!try_append_decoded(result, value, value_size))
+            {
+                result.resize(result_size);
+                result.append(web::http::uri::decode(utility::string_t(value, value_size)));
+            }
+        }
+
+        // The x-ms-date header only changes once a second, so each thread formats it at most once a second.
+        const utility::string_t& current_date_header()
+        {
+            static thread_local utility::datetime::interval_type cached_second = 0;
+            static thread_local utility::string_t cached_value;
+
+            utility::datetime now = utility::datetime::utc_now();
+            utility::datetime::interval_type second = now.to_interval() / 10000000;
+            if (second != cached_second || cached_value.empty())
+            {
+                cached_value = now.to_string();
+                cached_second = second;
+            }
+
+            return cached_value;
+        }
+    }
+
     utility::string_t calculate_hmac_sha256_hash(const utility::string_t& string_to_hash, const storage_credentials& credentials)
     {
         std::string utf8_string_to_hash = utility::conversions::to_utf8string(string_to_hash);
-        core::hash_provider provider = core::hash_provider::create_hmac_sha256_hash_provider(credentials.account_key());
-        provider.write(reinterpret_cast<const uint8_t*>(utf8_string_to_hash.data()), utf8_string_to_hash.size());
-        provider.close();
-        return provider.hash();
+        core::hmac_sha256_signer signer(credentials.account_key());
+        uint8_t hash[core::hmac_sha256_signer::hash_size];
+        signer.sign(reinterpret_cast<const uint8_t*>(utf8_string_to_hash.data()), utf8_string_to_hash.size(), hash);
+        return core::to_base64(hash, sizeof(hash));
     }
 
     void sas_authentication_handler::sign_request(web::http::http_request& request, operation_context context) const
@@ -40,15 +173,27 @@ namespace azure { namespace storage { namespace protocol {
         request.set_request_uri(request_uri);
     }
 
+    shared_key_authentication_handler::shared_key_authentication_handler(std::shared_ptr<canonicalizer> canonicalizer, storage_credentials credentials)
+        : m_canonicalizer(canonicalizer), m_credentials(std::move(credentials))
+    {
+        if (m_credentials.is_shared_key())
+        {
+            m_signer = std::make_shared<core::hmac_sha256_signer>(m_credentials.account_key());
+        }
+    }
+
     void shared_key_authentication_handler::sign_request(web::http::http_request& request, operation_context context) const
     {
         web::http::http_headers& headers = request.headers();
-        headers.add(ms_header_date, utility::datetime::utc_now().to_string());
+        headers.add(ms_header_date, current_date_header());
 
         if (m_credentials.is_shared_key())
         {
-            utility::string_t string_to_sign = m_canonicalizer->canonicalize(request, context);
-            
+            // Each thread reuses its buffer, so building the string to sign stops allocating once it is large enough.
+            static thread_local utility::string_t string_to_sign;
+            string_to_sign.clear();
+            m_canonicalizer->append_canonicalized(request, string_to_sign, context);
+
             if (core::logger::instance().should_log(context, client_log_level::log_level_verbose))
             {
                 utility::string_t with_dots(string_to_sign);
@@ -62,7 +207,17 @@ namespace azure { namespace storage { namespace protocol {
             header_value.append(_XPLATSTR(" "));
             header_value.append(m_credentials.account_name());
             header_value.append(_XPLATSTR(":"));
-            header_value.append(calculate_hmac_sha256_hash(string_to_sign, m_credentials));
+
+            uint8_t hash[core::hmac_sha256_signer::hash_size];
+#ifdef _WIN32
+            std::string utf8_string_to_sign = utility::conversions::to_utf8string(string_to_sign);
+            m_signer->sign(reinterpret_cast<const uint8_t*>(utf8_string_to_sign.data()), utf8_string_to_sign.size(), hash);
+            header_value.append(core::to_base64(hash, sizeof(hash)));
+#else
+            // utility::string_t is already UTF-8
+            m_signer->sign(reinterpret_cast<const uint8_t*>(string_to_sign.data()), string_to_sign.size(), hash);
+            core::append_base64(hash, sizeof(hash), header_value);
+#endif
 
             headers.add(web::http::header_names::authorization, header_value);
         }
@@ -73,7 +228,7 @@ namespace azure { namespace storage { namespace protocol {
         m_result.append(_XPLATSTR("/"));
         m_result.append(m_account_name);
 
-        web::http::uri uri = m_request.request_uri();
+        const web::http::uri& uri = m_request.request_uri();
         const utility::string_t& resource = uri.path();
         if (resource.front() != _XPLATSTR('/'))
         {
@@ -82,64 +237,116 @@ namespace azure { namespace storage { namespace protocol {
 
         m_result.append(resource);
 
-        std::map<utility::string_t, utility::string_t> query_map = web::http::uri::split_query(uri.query());
+        const utility::string_t& query = uri.query();
         if (query_only_comp)
         {
-            std::map<utility::string_t, utility::string_t>::iterator it = query_map.find(_XPLATSTR("comp"));
-            if (it != query_map.end())
+            // As with std::map, the last comp parameter wins
+            query_parameter comp = { nullptr, 0, nullptr, 0 };
+            for_each_query_parameter(query, [&comp](const query_parameter& parameter)
+            {
+                if (parameter.name_size == 4 && utility::string_t::traits_type::compare(parameter.name, _XPLATSTR("comp"), 4) == 0)
+                {
+                    comp = parameter;
+                }
+            });
+
+            if (comp.name != nullptr)
             {
                 m_result.append(_XPLATSTR("?comp="));
-                m_result.append(web::http::uri::decode(it->second));
+                append_decoded(m_result, comp.value, comp.value_size);
             }
         }
         else
         {
-            // std::map keys are already sorted
-            for (std::map<utility::string_t, utility::string_t>::const_iterator it = query_map.cbegin(); it != query_map.cend(); ++it)
+            // The parameters point into the query and are kept sorted by name, with the last value winning for a repeated
+            // name, as web::http::uri::split_query gives them. Requests rarely have more than a handful of parameters.
+            const size_t max_inline_parameters = 16;
+            query_parameter inline_parameters[max_inline_parameters];
+            std::vector<query_parameter> heap_parameters;
+            query_parameter* parameters = inline_parameters;
+
+            size_t max_parameters = 1 + static_cast<size_t>(std::count(query.begin(), query.end(), _XPLATSTR('&')) + std::count(query.begin(), query.end(), _XPLATSTR(';')));
+            if (max_parameters > max_inline_parameters)
+            {
+                heap_parameters.resize(max_parameters);
+                parameters = heap_parameters.data();
+            }
+
+            size_t parameter_count = 0;
+            for_each_query_parameter(query, [parameters, &parameter_count](const query_parameter& parameter)
             {
-                utility::string_t parameter_name = it->first;
-                std::transform(parameter_name.begin(), parameter_name.end(), parameter_name.begin(), core::utility_char_tolower);
+                size_t position = parameter_count;
+                int result = 1;
+                while (position > 0 && (result = compare_names(parameters[position - 1], parameter)) > 0)
+                {
+                    --position;
+                }
+
+                if (position > 0 && result == 0)
+                {
+                    parameters[position - 1] = parameter;
+                    return;
+                }
+
+                std::copy_backward(parameters + position, parameters + parameter_count, parameters + parameter_count + 1);
+                parameters[position] = parameter;
+                ++parameter_count;
+            });
 
+            for (size_t i = 0; i < parameter_count; ++i)
+            {
                 m_result.append(_XPLATSTR("\n"));
-                m_result.append(parameter_name);
+                for (size_t j = 0; j < parameters[i].name_size; ++j)
+                {
+                    m_result.push_back(core::utility_char_tolower(parameters[i].name[j]));
+                }
+
                 m_result.append(_XPLATSTR(":"));
-                m_result.append(web::http::uri::decode(it->second));
+                append_decoded(m_result, parameters[i].value, parameters[i].value_size);
             }
         }
     }
 
     void canonicalizer_helper::append_header(const utility::string_t& header_name)
     {
-        utility::string_t value;
-        m_request.headers().match(header_name, value);
-        append(value);
+        const web::http::http_headers& headers = m_request.headers();
+        web::http::http_headers::const_iterator it = headers.find(header_name);
+        if (it != headers.end())
+        {
+            m_result.append(it->second);
+        }
+
+        m_result.append(_XPLATSTR("\n"));
     }
 
     void canonicalizer_helper::append_content_length_header()
     {
-        utility::string_t value;
-        m_request.headers().match(web::http::header_names::content_length, value);
-        if (value == _XPLATSTR("0"))
+        const web::http::http_headers& headers = m_request.headers();
+        web::http::http_headers::const_iterator it = headers.find(web::http::header_names::content_length);
+        if (it != headers.end() && it->second != _XPLATSTR("0"))
         {
-            value.clear();
+            m_result.append(it->second);
         }
-        append(value);
+
+        m_result.append(_XPLATSTR("\n"));
     }
 
     void canonicalizer_helper::append_date_header(bool allow_x_ms_date)
     {
-        utility::string_t value;
-        if (!m_request.headers().match(ms_header_date, value))
+        const web::http::http_headers& headers = m_request.headers();
+        web::http::http_headers::const_iterator it = headers.find(ms_header_date);
+        if (it == headers.end())
         {
             append_header(web::http::header_names::date);
         }
-        else if (allow_x_ms_date)
-        {
-            append(value);
-        }
         else
         {
-            append(utility::string_t());
+            if (allow_x_ms_date)
+            {
+                m_result.append(it->second);
+            }
+
+            m_result.append(_XPLATSTR("\n"));
         }
     }
 
@@ -156,9 +363,11 @@ namespace azure { namespace storage { namespace protocol {
             if ((key_size > ms_header_prefix_size) &&
                 std::equal(ms_header_prefix, ms_header_prefix + ms_header_prefix_size, key, [](const utility::char_t &c1, const utility::char_t &c2) {return c1 == c2;}))
             {
-                utility::string_t transformed_key(key);
-                std::transform(transformed_key.begin(), transformed_key.end(), transformed_key.begin(), core::utility_char_tolower);
-                m_result.append(transformed_key);
+                for (size_t i = 0; i < key_size; ++i)
+                {
+                    m_result.push_back(core::utility_char_tolower(key[i]));
+                }
+
                 m_result.append(_XPLATSTR(":"));
                 append(it->second);
             }
@@ -167,7 +376,14 @@ namespace azure { namespace storage { namespace protocol {
 
     utility::string_t shared_key_blob_queue_canonicalizer::canonicalize(const web::http::http_request& request, operation_context context) const
     {
-        canonicalizer_helper helper(request, m_account_name);
+        utility::string_t result;
+        append_canonicalized(request, result, context);
+        return result;
+    }
+
+    void shared_key_blob_queue_canonicalizer::append_canonicalized(const web::http::http_request& request, utility::string_t& result, operation_context context) const
+    {
+        canonicalizer_helper helper(request, m_account_name, result);
         helper.append(request.method());
         helper.append_header(web::http::header_names::content_encoding);
         helper.append_header(web::http::header_names::content_language);
@@ -182,38 +398,55 @@ namespace azure { namespace storage { namespace protocol {
         helper.append_header(web::http::header_names::range);
         helper.append_x_ms_headers();
         helper.append_resource(false);
-        return helper.str();
     }
 
     utility::string_t shared_key_lite_blob_queue_canonicalizer::canonicalize(const web::http::http_request& request, operation_context context) const
     {
-        canonicalizer_helper helper(request, m_account_name);
+        utility::string_t result;
+        append_canonicalized(request, result, context);
+        return result;
+    }
+
+    void shared_key_lite_blob_queue_canonicalizer::append_canonicalized(const web::http::http_request& request, utility::string_t& result, operation_context context) const
+    {
+        canonicalizer_helper helper(request, m_account_name, result);
         helper.append(request.method());
         helper.append_header(web::http::header_names::content_md5);
         helper.append_header(web::http::header_names::content_type);
         helper.append_date_header(false);
         helper.append_x_ms_headers();
         helper.append_resource(true);
-        return helper.str();
     }
 
     utility::string_t shared_key_table_canonicalizer::canonicalize(const web::http::http_request& request, operation_context context) const
     {
-        canonicalizer_helper helper(request, m_account_name);
+        utility::string_t result;
+        append_canonicalized(request, result, context);
+        return result;
+    }
+
+    void shared_key_table_canonicalizer::append_canonicalized(const web::http::http_request& request, utility::string_t& result, operation_context context) const
+    {
+        canonicalizer_helper helper(request, m_account_name, result);
         helper.append(request.method());
         helper.append_header(web::http::header_names::content_md5);
         helper.append_header(web::http::header_names::content_type);
         helper.append_date_header(true);
         helper.append_resource(true);
-        return helper.str();
     }
 
     utility::string_t shared_key_lite_table_canonicalizer::canonicalize(const web::http::http_request& request, operation_context context) const
     {
-        canonicalizer_helper helper(request, m_account_name);
+        utility::string_t result;
+        append_canonicalized(request, result, context);
+        return result;
+    }
+
+    void shared_key_lite_table_canonicalizer::append_canonicalized(const web::http::http_request& request, utility::string_t& result, operation_context context) const
+    {
+        canonicalizer_helper helper(request, m_account_name, result);
         helper.append_date_header(true);
         helper.append_resource(true);
-        return helper.str();
     }
 
 }}} // namespace azure::storage::protocol
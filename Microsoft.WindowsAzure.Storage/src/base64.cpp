@@ -0,0 +1,421 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="base64.cpp" company="Microsoft">
+//    Copyright 2013 Microsoft Corporation
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "wascore/base64.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define WASTORAGE_BASE64_SSSE3
+#include <tmmintrin.h>
+#ifdef _WIN32
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace azure { namespace storage { namespace core {
+
+    namespace
+    {
+        const char base64_alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        const char base64_padding = '=';
+
+        class base64_decoding_table
+        {
+        public:
+            base64_decoding_table()
+            {
+                for (size_t i = 0; i < 256; ++i)
+                {
+                    m_values[i] = invalid;
+                }
+
+                for (uint8_t i = 0; i < 64; ++i)
+                {
+                    m_values[static_cast<uint8_t>(base64_alphabet[i])] = i;
+                }
+            }
+
+            static const uint8_t invalid = 0xFF;
+
+            uint8_t value(char c) const
+            {
+                return m_values[static_cast<uint8_t>(c)];
+            }
+
+        private:
+            uint8_t m_values[256];
+        };
+
+        const base64_decoding_table& decoding_table()
+        {
+            static const base64_decoding_table instance;
+            return instance;
+        }
+
+        size_t encoded_size(size_t count)
+        {
+            return (count + 2) / 3 * 4;
+        }
+
+        // Writes the encoding of count bytes, including the padding of the last group.
+        void encode_portable(const uint8_t* data, size_t count, char* output)
+        {
+            while (count >= 3)
+            {
+                uint32_t group = static_cast<uint32_t>(data[0]) << 16 | static_cast<uint32_t>(data[1]) << 8 | data[2];
+                output[0] = base64_alphabet[group >> 18];
+                output[1] = base64_alphabet[(group >> 12) & 0x3F];
+                output[2] = base64_alphabet[(group >> 6) & 0x3F];
+                output[3] = base64_alphabet[group & 0x3F];
+                data += 3;
+                count -= 3;
+                output += 4;
+            }
+
+            if (count > 0)
+            {
+                uint32_t group = static_cast<uint32_t>(data[0]) << 16 | (count > 1 ? static_cast<uint32_t>(data[1]) << 8 : 0);
+                output[0] = base64_alphabet[group >> 18];
+                output[1] = base64_alphabet[(group >> 12) & 0x3F];
+                output[2] = count > 1 ? base64_alphabet[(group >> 6) & 0x3F] : base64_padding;
+                output[3] = base64_padding;
+            }
+        }
+
+        // Decodes groups of four characters without padding. Returns false on the first character outside the alphabet.
+        bool decode_portable(const char* text, size_t count, uint8_t* output)
+        {
+            const base64_decoding_table& table = decoding_table();
+            while (count >= 4)
+            {
+                uint8_t a = table.value(text[0]);
+                uint8_t b = table.value(text[1]);
+                uint8_t c = table.value(text[2]);
+                uint8_t d = table.value(text[3]);
+                if ((a | b | c | d) == base64_decoding_table::invalid)
+                {
+                    return false;
+                }
+
+                output[0] = static_cast<uint8_t>(a << 2 | b >> 4);
+                output[1] = static_cast<uint8_t>(b << 4 | c >> 2);
+                output[2] = static_cast<uint8_t>(c << 6 | d);
+                text += 4;
+                count -= 4;
+                output += 3;
+            }
+
+            return true;
+        }
+
+        // Decodes the last group, which may end with one or two padding characters, into one to three bytes.
+        bool decode_last_group(const char* text, uint8_t* output)
+        {
+            const base64_decoding_table& table = decoding_table();
+            uint8_t a = table.value(text[0]);
+            uint8_t b = table.value(text[1]);
+            if ((a | b) == base64_decoding_table::invalid)
+            {
+                return false;
+            }
+
+            // Bits of the last character that are not part of the data must be zero, as in a canonical encoding.
+            output[0] = static_cast<uint8_t>(a << 2 | b >> 4);
+            if (text[2] == base64_padding)
+            {
+                return text[3] == base64_padding && (b & 0x0F) == 0;
+            }
+
+            uint8_t c = table.value(text[2]);
+            if (c == base64_decoding_table::invalid)
+            {
+                return false;
+            }
+
+            output[1] = static_cast<uint8_t>(b << 4 | c >> 2);
+            if (text[3] == base64_padding)
+            {
+                return (c & 0x03) == 0;
+            }
+
+            uint8_t d = table.value(text[3]);
+            if (d == base64_decoding_table::invalid)
+            {
+                return false;
+            }
+
+            output[2] = static_cast<uint8_t>(c << 6 | d);
+            return true;
+        }
+
+        size_t padding_size(const char* text, size_t count)
+        {
+            if (count == 0 || text[count - 1] != base64_padding)
+            {
+                return 0;
+            }
+
+            return text[count - 2] == base64_padding ? 2 : 1;
+        }
+
+#ifdef WASTORAGE_BASE64_SSSE3
+
+        bool has_ssse3()
+        {
+            // SSSE3 is reported in bit 9 of ECX for CPUID leaf 1.
+#ifdef _WIN32
+            int info[4];
+            __cpuid(info, 1);
+            unsigned int ecx = static_cast<unsigned int>(info[2]);
+#else
+            unsigned int eax, ebx, ecx, edx;
+            if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+            {
+                return false;
+            }
+#endif
+            return (ecx & (1u << 9)) != 0;
+        }
+
+        bool ssse3_enabled()
+        {
+            static const bool enabled = has_ssse3();
+            return enabled;
+        }
+
+#if defined(__GNUC__) || defined(__clang__)
+#define WASTORAGE_BASE64_TARGET __attribute__((target("ssse3")))
+#else
+#define WASTORAGE_BASE64_TARGET
+#endif
+
+        // Encodes 12 bytes into 16 characters per step, which reads 16 bytes, so it stops while at least 16 bytes are left.
+        // Returns the number of bytes consumed, which produced 4 characters for every 3 of them.
+        WASTORAGE_BASE64_TARGET size_t encode_ssse3(const uint8_t* data, size_t count, char* output)
+        {
+            const __m128i spread = _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+            const __m128i mask_ac = _mm_set1_epi32(0x0FC0FC00);
+            const __m128i shift_ac = _mm_set1_epi32(0x04000040);
+            const __m128i mask_bd = _mm_set1_epi32(0x003F03F0);
+            const __m128i shift_bd = _mm_set1_epi32(0x01000010);
+
+            // Each 6-bit index is turned into its character by adding an offset that depends on the range the index is in.
+            const __m128i offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+
+            size_t consumed = 0;
+            while (count - consumed >= 16)
+            {
+                // Each 32-bit lane gets the three bytes of one group, and the four 6-bit indices are moved into its four bytes.
+                __m128i input = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + consumed)), spread);
+                __m128i indices = _mm_or_si128(_mm_mulhi_epu16(_mm_and_si128(input, mask_ac), shift_ac), _mm_mullo_epi16(_mm_and_si128(input, mask_bd), shift_bd));
+
+                // 0 to 25 map to slot 13, 26 to 51 to slot 0, and 52 to 63 to slots 1 to 12.
+                __m128i slots = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+                slots = _mm_or_si128(slots, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), indices), _mm_set1_epi8(13)));
+                __m128i characters = _mm_add_epi8(_mm_shuffle_epi8(offsets, slots), indices);
+
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(output), characters);
+                consumed += 12;
+                output += 16;
+            }
+
+            return consumed;
+        }
+
+        // Decodes 16 characters into 12 bytes per step, storing 16 bytes, so the output must have 4 bytes to spare after the
+        // decoded data. Returns the number of characters consumed, or count + 1 if a character outside the alphabet was found.
+        WASTORAGE_BASE64_TARGET size_t decode_ssse3(const char* text, size_t count, uint8_t* output)
+        {
+            // A character is valid if the bit for its high nibble is set in the mask for its low nibble.
+            const __m128i masks = _mm_setr_epi8(
+                static_cast<char>(0xA8), static_cast<char>(0xF8), static_cast<char>(0xF8), static_cast<char>(0xF8),
+                static_cast<char>(0xF8), static_cast<char>(0xF8), static_cast<char>(0xF8), static_cast<char>(0xF8),
+                static_cast<char>(0xF8), static_cast<char>(0xF8), static_cast<char>(0xF0), 0x54, 0x50, 0x50, 0x50, 0x54);
+            const __m128i bits = _mm_setr_epi8(0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, static_cast<char>(0x80), 0, 0, 0, 0, 0, 0, 0, 0);
+
+            // The value of a valid character is the character plus an offset that depends on its high nibble, except for '/'.
+            const __m128i offsets = _mm_setr_epi8(0, 0, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+            const __m128i slash = _mm_set1_epi8('/');
+            const __m128i slash_offset = _mm_set1_epi8(63 - '/');
+            const __m128i low_nibbles = _mm_set1_epi8(0x0F);
+
+            const __m128i merge_pairs = _mm_set1_epi32(0x01400140);
+            const __m128i merge_quads = _mm_set1_epi32(0x00011000);
+            const __m128i pack = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+            size_t consumed = 0;
+            while (count - consumed >= 16)
+            {
+                __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + consumed));
+                __m128i high = _mm_and_si128(_mm_srli_epi32(input, 4), low_nibbles);
+                __m128i low = _mm_and_si128(input, low_nibbles);
+
+                __m128i invalid = _mm_cmpeq_epi8(_mm_and_si128(_mm_shuffle_epi8(masks, low), _mm_shuffle_epi8(bits, high)), _mm_setzero_si128());
+                if (_mm_movemask_epi8(invalid) != 0)
+                {
+                    return count + 1;
+                }
+
+                __m128i is_slash = _mm_cmpeq_epi8(input, slash);
+                __m128i offset = _mm_or_si128(_mm_andnot_si128(is_slash, _mm_shuffle_epi8(offsets, high)), _mm_and_si128(is_slash, slash_offset));
+                __m128i values = _mm_add_epi8(input, offset);
+
+                // Pairs of 6-bit values are merged into 12-bit values, those into 24-bit groups, and the three bytes of each group are
+                // moved to the front of the register in big-endian order.
+                __m128i merged = _mm_madd_epi16(_mm_maddubs_epi16(values, merge_pairs), merge_quads);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(output), _mm_shuffle_epi8(merged, pack));
+                consumed += 16;
+                output += 12;
+            }
+
+            return consumed;
+        }
+
+#endif
+
+        bool decode_to_vector(const char* text, size_t count, std::vector<uint8_t>& output, bool accelerated)
+        {
+            if (count % 4 != 0)
+            {
+                return false;
+            }
+
+            size_t padding = padding_size(text, count);
+            size_t decoded_size = count / 4 * 3 - padding;
+            size_t original_size = output.size();
+
+            // The accelerated decoder stores 4 bytes past the data it decodes.
+            output.resize(original_size + decoded_size + 4);
+            uint8_t* target = output.data() + original_size;
+
+            // The last group is decoded on its own when it has padding.
+            size_t full_groups = padding == 0 ? count : count - 4;
+            size_t consumed = 0;
+#ifdef WASTORAGE_BASE64_SSSE3
+            if (accelerated && full_groups >= 16 && ssse3_enabled())
+            {
+                consumed = decode_ssse3(text, full_groups, target);
+                if (consumed > full_groups)
+                {
+                    return false;
+                }
+            }
+#else
+            UNREFERENCED_PARAMETER(accelerated);
+#endif
+
+            if (!decode_portable(text + consumed, full_groups - consumed, target + consumed / 4 * 3))
+            {
+                return false;
+            }
+
+            if (padding != 0 && !decode_last_group(text + full_groups, target + full_groups / 4 * 3))
+            {
+                return false;
+            }
+
+            output.resize(original_size + decoded_size);
+            return true;
+        }
+
+        void encode_to_string(const uint8_t* data, size_t count, std::string& output, bool accelerated)
+        {
+            size_t original_size = output.size();
+            output.resize(original_size + encoded_size(count));
+            char* target = &output[0] + original_size;
+
+            size_t consumed = 0;
+#ifdef WASTORAGE_BASE64_SSSE3
+            if (accelerated && count >= 16 && ssse3_enabled())
+            {
+                consumed = encode_ssse3(data, count, target);
+            }
+#else
+            UNREFERENCED_PARAMETER(accelerated);
+#endif
+
+            encode_portable(data + consumed, count - consumed, target + consumed / 3 * 4);
+        }
+
+        bool decode_text(const std::string& text, std::vector<uint8_t>& output)
+        {
+            return append_from_base64(text.data(), text.size(), output);
+        }
+
+        // Wide text is narrowed first. Characters outside ASCII are never valid base64, and must not be truncated into valid ones.
+        template<typename char_type>
+        bool decode_text(const std::basic_string<char_type>& text, std::vector<uint8_t>& output)
+        {
+            std::string narrow;
+            narrow.reserve(text.size());
+            for (char_type c : text)
+            {
+                if (c < 0 || c > 0x7F)
+                {
+                    return false;
+                }
+
+                narrow.push_back(static_cast<char>(c));
+            }
+
+            return decode_text(narrow, output);
+        }
+    }
+
+    void append_base64(const uint8_t* data, size_t count, std::string& output)
+    {
+        encode_to_string(data, count, output, /* accelerated */ true);
+    }
+
+    void append_base64_portable(const uint8_t* data, size_t count, std::string& output)
+    {
+        encode_to_string(data, count, output, /* accelerated */ false);
+    }
+
+    bool append_from_base64(const char* text, size_t count, std::vector<uint8_t>& output)
+    {
+        return decode_to_vector(text, count, output, /* accelerated */ true);
+    }
+
+    bool append_from_base64_portable(const char* text, size_t count, std::vector<uint8_t>& output)
+    {
+        return decode_to_vector(text, count, output, /* accelerated */ false);
+    }
+
+    utility::string_t to_base64(const uint8_t* data, size_t count)
+    {
+        std::string encoded;
+        append_base64(data, count, encoded);
+        return utility::conversions::to_string_t(std::move(encoded));
+    }
+
+    std::vector<uint8_t> from_base64(const utility::string_t& text)
+    {
+        std::vector<uint8_t> result;
+        if (!decode_text(text, result))
+        {
+            // Let the general implementation report the error in the usual way.
+            return utility::conversions::from_base64(text);
+        }
+
+        return result;
+    }
+
+}}} // namespace azure::storage::core
@@ -260,12 +260,13 @@ namespace azure { namespace storage { namespace protocol {
         }
     }
 
-    web::http::http_request put_block(const utility::string_t& block_id, const utility::string_t& content_md5, const access_condition& condition, web::http::uri_builder& uri_builder, const std::chrono::seconds& timeout, operation_context context)
+    web::http::http_request put_block(const utility::string_t& block_id, const utility::string_t& content_md5, const utility::string_t& content_crc64, const access_condition& condition, web::http::uri_builder& uri_builder, const std::chrono::seconds& timeout, operation_context context)
     {
         uri_builder.append_query(core::make_query_parameter(uri_query_component, component_block, /* do_encoding */ false));
         uri_builder.append_query(core::make_query_parameter(uri_query_block_id, block_id));
         web::http::http_request request(base_request(web::http::methods::PUT, uri_builder, timeout, context));
         request.headers().add(web::http::header_names::content_md5, content_md5);
+        add_content_crc64(request.headers(), content_crc64);
         add_lease_id(request, condition);
         return request;
     }
@@ -327,7 +328,7 @@ namespace azure { namespace storage { namespace protocol {
         return request;
     }
 
-    web::http::http_request put_page(page_range range, page_write write, const utility::string_t& content_md5, const access_condition& condition, web::http::uri_builder& uri_builder, const std::chrono::seconds& timeout, operation_context context)
+    web::http::http_request put_page(page_range range, page_write write, const utility::string_t& content_md5, const utility::string_t& content_crc64, const access_condition& condition, web::http::uri_builder& uri_builder, const std::chrono::seconds& timeout, operation_context context)
     {
         uri_builder.append_query(core::make_query_parameter(uri_query_component, component_page, /* do_encoding */ false));
         web::http::http_request request(base_request(web::http::methods::PUT, uri_builder, timeout, context));
@@ -340,6 +341,7 @@ namespace azure { namespace storage { namespace protocol {
         case page_write::update:
             headers.add(ms_header_page_write, header_value_page_write_update);
             add_optional_header(headers, web::http::header_names::content_md5, content_md5);
+            add_content_crc64(headers, content_crc64);
             break;
 
         case page_write::clear:
@@ -352,11 +354,12 @@ namespace azure { namespace storage { namespace protocol {
         return request;
     }
 
-    web::http::http_request append_block(const utility::string_t& content_md5, const access_condition& condition, web::http::uri_builder& uri_builder, const std::chrono::seconds& timeout, operation_context context)
+    web::http::http_request append_block(const utility::string_t& content_md5, const utility::string_t& content_crc64, const access_condition& condition, web::http::uri_builder& uri_builder, const std::chrono::seconds& timeout, operation_context context)
     {
         uri_builder.append_query(core::make_query_parameter(uri_query_component, component_append_block, /* do_encoding */ false));
         web::http::http_request request(base_request(web::http::methods::PUT, uri_builder, timeout, context));
         request.headers().add(web::http::header_names::content_md5, content_md5);
+        add_content_crc64(request.headers(), content_crc64);
         add_append_condition(request, condition);
         add_access_condition(request, condition);
         return request;
@@ -399,7 +402,7 @@ namespace azure { namespace storage { namespace protocol {
         return request;
     }
 
-    web::http::http_request get_blob(utility::size64_t offset, utility::size64_t length, bool get_range_content_md5, const utility::string_t& snapshot_time, const access_condition& condition, web::http::uri_builder& uri_builder, const std::chrono::seconds& timeout, operation_context context)
+    web::http::http_request get_blob(utility::size64_t offset, utility::size64_t length, bool get_range_content_md5, bool get_range_content_crc64, const utility::string_t& snapshot_time, const access_condition& condition, web::http::uri_builder& uri_builder, const std::chrono::seconds& timeout, operation_context context)
     {
         add_snapshot_time(uri_builder, snapshot_time);
         web::http::http_request request(base_request(web::http::methods::GET, uri_builder, timeout, context));
@@ -409,6 +412,11 @@ namespace azure { namespace storage { namespace protocol {
         {
             request.headers().add(ms_header_range_get_content_md5, header_value_true);
         }
+        else if ((offset < std::numeric_limits<utility::size64_t>::max()) && get_range_content_crc64)
+        {
+            request.headers().add(ms_header_range_get_content_crc64, header_value_true);
+            use_crc64_storage_version(request.headers());
+        }
 
         add_access_condition(request, condition);
         return request;
@@ -0,0 +1,173 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="buffer_pool.cpp" company="Microsoft">
+//    Copyright 2013 Microsoft Corporation
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "wascore/buffer_pool.h"
+#include "wascore/constants.h"
+
+namespace azure { namespace storage { namespace core {
+
+    std::mutex buffer_pool::s_mutex;
+    std::vector<std::vector<uint8_t>> buffer_pool::s_buffers[buffer_pool::s_size_class_count];
+    utility::size64_t buffer_pool::s_max_pooled_bytes(protocol::default_buffer_pool_max_bytes);
+    buffer_pool_statistics buffer_pool::s_statistics = { 0, 0, 0, 0, 0 };
+
+    std::vector<uint8_t> buffer_pool::acquire(size_t size)
+    {
+        std::vector<uint8_t> buffer;
+        auto index = size_class(size);
+        if (index == s_size_class_count)
+        {
+            // Larger than any size class, so this buffer is never pooled.
+            buffer.reserve(size);
+            {
+                std::lock_guard<std::mutex> guard(s_mutex);
+                s_statistics.outstanding_bytes += buffer.capacity();
+                ++s_statistics.allocations;
+            }
+
+            return buffer;
+        }
+
+        auto size_in_class = class_size(index);
+        {
+            std::lock_guard<std::mutex> guard(s_mutex);
+            s_statistics.outstanding_bytes += size_in_class;
+
+            auto& buffers = s_buffers[index];
+            if (!buffers.empty())
+            {
+                buffer = std::move(buffers.back());
+                buffers.pop_back();
+                s_statistics.pooled_bytes -= size_in_class;
+                ++s_statistics.reuses;
+            }
+            else
+            {
+                ++s_statistics.allocations;
+            }
+        }
+
+        // The allocation is done outside the lock, and clear keeps the capacity of a reused buffer.
+        buffer.clear();
+        buffer.reserve(size_in_class);
+        return buffer;
+    }
+
+    void buffer_pool::release(std::vector<uint8_t>&& buffer)
+    {
+        // Take the storage out of the caller's buffer, so a buffer that is not kept is freed here, outside the lock.
+        std::vector<uint8_t> released(std::move(buffer));
+        if (released.capacity() < protocol::min_pooled_buffer_size)
+        {
+            return;
+        }
+
+        if (released.capacity() > class_size(s_size_class_count - 1))
+        {
+            std::lock_guard<std::mutex> guard(s_mutex);
+            s_statistics.outstanding_bytes -= std::min(s_statistics.outstanding_bytes, static_cast<utility::size64_t>(released.capacity()));
+            return;
+        }
+
+        // A buffer belongs to the largest size class it can hold, so it always satisfies a request of that class.
+        auto index = size_class(released.capacity());
+        if (class_size(index) > released.capacity())
+        {
+            --index;
+        }
+
+        auto size_in_class = class_size(index);
+        std::lock_guard<std::mutex> guard(s_mutex);
+        s_statistics.outstanding_bytes -= std::min(s_statistics.outstanding_bytes, static_cast<utility::size64_t>(size_in_class));
+        if (s_statistics.pooled_bytes + size_in_class <= s_max_pooled_bytes)
+        {
+            s_buffers[index].push_back(std::move(released));
+            s_statistics.pooled_bytes += size_in_class;
+        }
+        else
+        {
+            ++s_statistics.discards;
+        }
+    }
+
+    void buffer_pool::set_max_pooled_bytes(utility::size64_t max_pooled_bytes)
+    {
+        std::unique_lock<std::mutex> lock(s_mutex);
+        s_max_pooled_bytes = max_pooled_bytes;
+        trim(lock);
+    }
+
+    utility::size64_t buffer_pool::max_pooled_bytes()
+    {
+        std::lock_guard<std::mutex> guard(s_mutex);
+        return s_max_pooled_bytes;
+    }
+
+    void buffer_pool::clear()
+    {
+        std::unique_lock<std::mutex> lock(s_mutex);
+        auto max_pooled_bytes = s_max_pooled_bytes;
+        s_max_pooled_bytes = 0;
+        trim(lock);
+
+        lock.lock();
+        s_max_pooled_bytes = max_pooled_bytes;
+    }
+
+    buffer_pool_statistics buffer_pool::statistics()
+    {
+        std::lock_guard<std::mutex> guard(s_mutex);
+        return s_statistics;
+    }
+
+    size_t buffer_pool::size_class(size_t size)
+    {
+        size_t index = 0;
+        while (index < s_size_class_count && class_size(index) < size)
+        {
+            ++index;
+        }
+
+        return index;
+    }
+
+    size_t buffer_pool::class_size(size_t size_class)
+    {
+        return protocol::min_pooled_buffer_size << size_class;
+    }
+
+    void buffer_pool::trim(std::unique_lock<std::mutex>& lock)
+    {
+        // Free the largest buffers first, as they give back the most memory. The freed buffers are destroyed after the lock is released.
+        std::vector<std::vector<uint8_t>> freed;
+        for (size_t index = s_size_class_count; index > 0 && s_statistics.pooled_bytes > s_max_pooled_bytes; --index)
+        {
+            auto& buffers = s_buffers[index - 1];
+            while (!buffers.empty() && s_statistics.pooled_bytes > s_max_pooled_bytes)
+            {
+                freed.push_back(std::move(buffers.back()));
+                buffers.pop_back();
+                s_statistics.pooled_bytes -= class_size(index - 1);
+                ++s_statistics.discards;
+            }
+        }
+
+        lock.unlock();
+    }
+
+}}} // namespace azure::storage::core
@@ -446,6 +446,7 @@ namespace azure { namespace storage {
         utility::size64_t m_total_written_to_destination_stream;
         utility::size64_t m_response_length;
         utility::string_t m_response_md5;
+        utility::string_t m_response_crc64;
         utility::string_t m_locked_etag;
         bool m_reset_target;
         concurrency::streams::ostream::pos_type m_target_offset;
@@ -461,6 +462,9 @@ namespace azure { namespace storage {
         auto copy_state = m_copy_state;
         const utility::string_t& current_snapshot_time = snapshot_time();
 
+        // CRC64 replaces the transactional MD5 of ranges, while the MD5 of a whole blob is still validated against its Content-MD5.
+        bool use_transactional_crc64 = modified_options.use_transactional_crc64() && offset < std::numeric_limits<utility::size64_t>::max();
+
         std::shared_ptr<blob_download_info> download_info = std::make_shared<blob_download_info>();
         download_info->m_are_properties_populated = false;
         download_info->m_total_written_to_destination_stream = 0;
@@ -470,7 +474,7 @@ namespace azure { namespace storage {
 
         std::shared_ptr<core::storage_command<void>> command = std::make_shared<core::storage_command<void>>(uri(), cancellation_token, false, timer_handler);
         std::weak_ptr<core::storage_command<void>> weak_command(command);
-        command->set_build_request([offset, length, modified_options, condition, current_snapshot_time, download_info](web::http::uri_builder uri_builder, const std::chrono::seconds& timeout, operation_context context) -> web::http::http_request
+        command->set_build_request([offset, length, modified_options, use_transactional_crc64, condition, current_snapshot_time, download_info](web::http::uri_builder uri_builder, const std::chrono::seconds& timeout, operation_context context) -> web::http::http_request
         {
             utility::size64_t current_offset = offset;
             utility::size64_t current_length = length;
@@ -510,12 +514,13 @@ namespace azure { namespace storage {
                 current_condition = condition;
             }
 
-            return protocol::get_blob(current_offset, current_length, modified_options.use_transactional_md5() && !download_info->m_are_properties_populated, current_snapshot_time, current_condition, uri_builder, timeout, context);
+            return protocol::get_blob(current_offset, current_length, modified_options.use_transactional_md5() && !use_transactional_crc64 && !download_info->m_are_properties_populated, use_transactional_crc64 && !download_info->m_are_properties_populated, current_snapshot_time, current_condition, uri_builder, timeout, context);
         });
         command->set_authentication_handler(service_client().authentication_handler());
         command->set_location_mode(core::command_location_mode::primary_or_secondary);
         command->set_destination_stream(target);
         command->set_calculate_response_body_md5(!modified_options.disable_content_md5_validation());
+        command->set_calculate_response_body_crc64(use_transactional_crc64);
         command->set_recover_request([target, download_info](utility::size64_t total_written_to_destination_stream, operation_context context) -> bool
         {
             if (download_info->m_reset_target)
@@ -541,7 +546,7 @@ namespace azure { namespace storage {
 
             return target.is_open();
         });
-        command->set_preprocess_response([weak_command, offset, modified_options, properties, metadata, copy_state, download_info, update_properties](const web::http::http_response& response, const request_result& result, operation_context context)
+        command->set_preprocess_response([weak_command, offset, modified_options, use_transactional_crc64, properties, metadata, copy_state, download_info, update_properties](const web::http::http_response& response, const request_result& result, operation_context context)
         {
             std::shared_ptr<core::storage_command<void>> command(weak_command);
 
@@ -573,8 +578,16 @@ namespace azure { namespace storage {
 
                 download_info->m_response_length = result.content_length();
                 download_info->m_response_md5 = result.content_md5();
+                response.headers().match(protocol::ms_header_content_crc64, download_info->m_response_crc64);
 
-                if (modified_options.use_transactional_md5() && !modified_options.disable_content_md5_validation() && download_info->m_response_md5.empty())
+                if (use_transactional_crc64)
+                {
+                    if (download_info->m_response_crc64.empty())
+                    {
+                        throw storage_exception(protocol::error_missing_crc64);
+                    }
+                }
+                else if (modified_options.use_transactional_md5() && !modified_options.disable_content_md5_validation() && download_info->m_response_md5.empty())
                 {
                     throw storage_exception(protocol::error_missing_md5);
                 }
@@ -602,6 +615,11 @@ namespace azure { namespace storage {
                 throw storage_exception(protocol::error_md5_mismatch);
             }
 
+            if (!download_info->m_response_crc64.empty() && !descriptor.content_crc64().empty() && download_info->m_response_crc64 != descriptor.content_crc64())
+            {
+                throw storage_exception(protocol::error_crc64_mismatch);
+            }
+
             return pplx::task_from_result();
         });
         return core::executor<void>::execute_async(command, modified_options, context);
@@ -621,8 +639,8 @@ namespace azure { namespace storage {
             auto instance = std::make_shared<cloud_blob>(*this);
             // if download a whole blob, enable download strategy(download 32MB first).
             utility::size64_t single_blob_download_threshold(protocol::default_single_blob_download_threshold);
-            // If transactional md5 validation is set, first range should be 4MB.
-            if (options.use_transactional_md5())
+            // If transactional md5 or crc64 validation is set, first range should be 4MB.
+            if (options.use_transactional_md5() || options.use_transactional_crc64())
             {
                 single_blob_download_threshold = protocol::default_single_block_download_threshold;
             }
@@ -640,6 +658,9 @@ namespace azure { namespace storage {
                 }
             }
 
+            // the position of the target stream where the first byte of the range is written to.
+            concurrency::streams::ostream::pos_type target_base = target.can_seek() ? target.tell() : static_cast<concurrency::streams::ostream::pos_type>(0);
+
             // download first range.
             // if 416 thrown, it's an empty blob. need to download attributes.
             // otherwise, properties must be updated for further parallel download.
@@ -686,6 +707,89 @@ namespace azure { namespace storage {
                     modified_condition.set_if_match_etag(instance->properties().etag());
                 }
 
+                if (target.can_seek())
+                {
+                    // Target stream is seekable, so every segment is written straight into its final position as it arrives.
+                    // There is no intermediate buffer and no ordering between segments; only issuing a write to the target
+                    // is serialized, which also works for memory-mapped targets exposed through a seekable streambuf.
+                    auto semaphore = std::make_shared<core::async_semaphore>(options.parallelism_factor());
+                    auto write_mutex = std::make_shared<std::mutex>();
+                    auto exception_mutex = std::make_shared<std::mutex>();
+                    auto segment_exception = std::make_shared<std::exception_ptr>();
+                    for (utility::size64_t current_offset = target_offset; current_offset < target_offset + target_length; current_offset += protocol::transactional_md5_block_size)
+                    {
+                        utility::size64_t current_length = protocol::transactional_md5_block_size;
+                        if (current_offset + current_length > target_offset + target_length)
+                        {
+                            current_length = target_offset + target_length - current_offset;
+                        }
+
+                        semaphore->lock_async().then([current_length]()
+                        {
+                            return core::transfer_byte_limit::acquire_async(current_length);
+                        }).then([instance, semaphore, write_mutex, exception_mutex, segment_exception, target, target_base, offset, current_offset, current_length, modified_condition, options, context, timer_handler]()
+                        {
+                            {
+                                std::lock_guard<std::mutex> guard(*exception_mutex);
+                                if (*segment_exception != nullptr)
+                                {
+                                    // One of the segments already failed, so the rest are not downloaded.
+                                    core::transfer_byte_limit::release(current_length);
+                                    semaphore->unlock();
+                                    return;
+                                }
+                            }
+
+                            try
+                            {
+                                core::positioned_ostreambuf<uint8_t> segment_buffer(target.streambuf(), target_base + static_cast<concurrency::streams::ostream::off_type>(current_offset - offset), write_mutex);
+                                // if transaction MD5 is enabled, it will be checked inside each download_single_range_to_stream_async.
+                                instance->download_single_range_to_stream_async(segment_buffer.create_ostream(), current_offset, current_length, modified_condition, options, context, false, timer_handler->get_cancellation_token(), timer_handler)
+                                    .then([semaphore, exception_mutex, segment_exception, current_length](pplx::task<void> download_task)
+                                {
+                                    core::transfer_byte_limit::release(current_length);
+                                    std::lock_guard<core::async_semaphore> semaphore_guard(*semaphore, std::adopt_lock);
+                                    try
+                                    {
+                                        download_task.wait();
+                                    }
+                                    catch (const std::exception&)
+                                    {
+                                        std::lock_guard<std::mutex> guard(*exception_mutex);
+                                        if (*segment_exception == nullptr)
+                                        {
+                                            *segment_exception = std::current_exception();
+                                        }
+                                    }
+                                });
+                            }
+                            catch (const std::exception&)
+                            {
+                                {
+                                    std::lock_guard<std::mutex> guard(*exception_mutex);
+                                    if (*segment_exception == nullptr)
+                                    {
+                                        *segment_exception = std::current_exception();
+                                    }
+                                }
+                                core::transfer_byte_limit::release(current_length);
+                                semaphore->unlock();
+                            }
+                        });
+                    }
+
+                    return semaphore->wait_all_async().then([segment_exception, target, target_base, offset, target_offset, target_length]()
+                    {
+                        if (*segment_exception != nullptr)
+                        {
+                            std::rethrow_exception(*segment_exception);
+                        }
+
+                        // Leave the target positioned right after the downloaded range, as a sequential download would.
+                        target.streambuf().seekpos(target_base + static_cast<concurrency::streams::ostream::off_type>(target_offset + target_length - offset), std::ios_base::out);
+                    });
+                }
+
                 return pplx::task_from_result().then([instance, offset, target, target_offset, target_length, single_blob_download_threshold, modified_condition, options, context, timer_handler]()
                 {
                     auto semaphore = std::make_shared<core::async_semaphore>(options.parallelism_factor());
@@ -707,7 +811,7 @@ namespace azure { namespace storage {
                         }
                         semaphore->lock_async().then([instance, &mutex, semaphore, condition_variable, &condition_variable_mutex, &writer, offset, target, smallest_offset, current_offset, current_length, modified_condition, options, context, timer_handler]()
                         {
-                            concurrency::streams::container_buffer<std::vector<uint8_t>> buffer;
+                            concurrency::streams::container_buffer<std::vector<uint8_t>> buffer(core::buffer_pool::acquire(static_cast<size_t>(current_length)), std::ios_base::out);
                             auto segment_ostream = buffer.create_ostream();
                             // if transaction MD5 is enabled, it will be checked inside each download_single_range_to_stream_async.
                             instance->download_single_range_to_stream_async(segment_ostream, current_offset, current_length, modified_condition, options, context, false, timer_handler->get_cancellation_token(), timer_handler)
@@ -721,65 +825,64 @@ namespace azure { namespace storage {
 
                                 // status of current semaphore.
                                 bool released = false;
-                                // target stream is seekable, could write to target stream once the download finished.
-                                if (target.can_seek())
+                                // target stream is not seekable, segments must be written in order.
                                 {
                                     pplx::extensibility::scoped_rw_lock_t guard(mutex);
-                                    target.streambuf().seekpos(current_offset - offset, std::ios_base::out);
-                                    target.streambuf().putn_nocopy(buffer.collection().data(), buffer.collection().size()).wait();
-                                    *smallest_offset += protocol::transactional_md5_block_size;
-                                    released = true;
-                                    semaphore->unlock();
+                                    if (*smallest_offset == current_offset)
+                                    {
+                                        // Below is the IO operation that may block for a relatively long time. However, this operation does not provide a interface to interrupt, so no cancellation support.
+                                        target.streambuf().putn_nocopy(buffer.collection().data(), buffer.collection().size()).wait();
+                                        *smallest_offset += protocol::transactional_md5_block_size;
+                                        condition_variable->notify_all();
+                                        released = true;
+                                        semaphore->unlock();
+                                    }
                                 }
-                                else
+                                if (!released)
                                 {
+                                    pplx::details::atomic_increment(writer);
+                                    if (writer < options.parallelism_factor())
+                                    {
+                                        released = true;
+                                        semaphore->unlock();
+                                    }
+                                    std::unique_lock<std::mutex> locker(condition_variable_mutex);
+                                    condition_variable->wait(locker, [smallest_offset, current_offset, &mutex]()
+                                    {
+                                        pplx::extensibility::scoped_rw_lock_t guard(mutex);
+                                        return *smallest_offset == current_offset;
+                                    });
+                                    bool out_of_order = false;
                                     {
                                         pplx::extensibility::scoped_rw_lock_t guard(mutex);
+
                                         if (*smallest_offset == current_offset)
                                         {
-                                            // Below is the IO operation that may block for a relatively long time. However, this operation does not provide a interface to interrupt, so no cancellation support.
                                             target.streambuf().putn_nocopy(buffer.collection().data(), buffer.collection().size()).wait();
                                             *smallest_offset += protocol::transactional_md5_block_size;
-                                            condition_variable->notify_all();
-                                            released = true;
-                                            semaphore->unlock();
+                                        }
+                                        else if (*smallest_offset > current_offset)
+                                        {
+                                            out_of_order = true;
                                         }
                                     }
+                                    condition_variable->notify_all();
+                                    pplx::details::atomic_decrement(writer);
                                     if (!released)
                                     {
-                                        pplx::details::atomic_increment(writer);
-                                        if (writer < options.parallelism_factor())
-                                        {
-                                            released = true;
-                                            semaphore->unlock();
-                                        }
-                                        std::unique_lock<std::mutex> locker(condition_variable_mutex);
-                                        condition_variable->wait(locker, [smallest_offset, current_offset, &mutex]()
-                                        {
-                                            pplx::extensibility::scoped_rw_lock_t guard(mutex);
-                                            return *smallest_offset == current_offset;
-                                        });
-                                        {
-                                            pplx::extensibility::scoped_rw_lock_t guard(mutex);
-
-                                            if (*smallest_offset == current_offset)
-                                            {
-                                                target.streambuf().putn_nocopy(buffer.collection().data(), buffer.collection().size()).wait();
-                                                *smallest_offset += protocol::transactional_md5_block_size;
-                                            }
-                                            else if (*smallest_offset > current_offset)
-                                            {
-                                                throw std::runtime_error("Out of order in parallel downloading blob.");
-                                            }
-                                        }
-                                        condition_variable->notify_all();
-                                        pplx::details::atomic_decrement(writer);
-                                        if (!released)
-                                        {
-                                            semaphore->unlock();
-                                        }
+                                        semaphore->unlock();
+                                    }
+
+                                    // The slot and the buffer are given back before failing, so the other segments are not held up.
+                                    if (out_of_order)
+                                    {
+                                        core::buffer_pool::release(std::move(buffer.collection()));
+                                        throw std::runtime_error("Out of order in parallel downloading blob.");
                                     }
                                 }
+
+                                // The segment has been written to the target, so its buffer can be used by the next segment.
+                                core::buffer_pool::release(std::move(buffer.collection()));
                             });
                         });
                     }
@@ -28,9 +28,9 @@ namespace azure { namespace storage {
         return container_result_iterator(
             [instance, prefix, includes, options, context](const continuation_token& token, size_t max_results_per_segment)
         {
-            return instance->list_containers_segmented(prefix, includes, (int)max_results_per_segment, token, options, context);
+            return instance->list_containers_segmented_async(prefix, includes, (int)max_results_per_segment, token, options, context);
         },
-            max_results, 0);
+            max_results, 0, options.segment_prefetch_depth());
     }
 
     pplx::task<container_result_segment> cloud_blob_client::list_containers_segmented_async(const utility::string_t& prefix, container_listing_details::values includes, int max_results, const continuation_token& token, const blob_request_options& options, operation_context context, const pplx::cancellation_token& cancellation_token) const
@@ -47,20 +47,23 @@ namespace azure { namespace storage {
         command->set_preprocess_response(std::bind(protocol::preprocess_response<container_result_segment>, container_result_segment(), std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
         command->set_postprocess_response([client] (const web::http::http_response& response, const request_result& result, const core::ostream_descriptor&, operation_context context) -> pplx::task<container_result_segment>
         {
-            protocol::list_containers_reader reader(response.body());
-
-            std::vector<protocol::cloud_blob_container_list_item> items(reader.move_items());
-            std::vector<cloud_blob_container> results;
-            results.reserve(items.size());
-
-            for (std::vector<protocol::cloud_blob_container_list_item>::iterator iter = items.begin(); iter != items.end(); ++iter)
+            auto reader = std::make_shared<protocol::list_containers_reader>(response.body());
+            auto target_location = result.target_location();
+            return reader->read_async().then([reader, client, target_location]() -> container_result_segment
             {
-                results.push_back(cloud_blob_container(iter->move_name(), client, iter->move_properties(), iter->move_metadata()));
-            }
-
-            continuation_token next_token(reader.move_next_marker());
-            next_token.set_target_location(result.target_location());
-            return pplx::task_from_result(container_result_segment(std::move(results), next_token));
+                std::vector<protocol::cloud_blob_container_list_item> items(reader->move_items());
+                std::vector<cloud_blob_container> results;
+                results.reserve(items.size());
+
+                for (std::vector<protocol::cloud_blob_container_list_item>::iterator iter = items.begin(); iter != items.end(); ++iter)
+                {
+                    results.push_back(cloud_blob_container(iter->move_name(), client, iter->move_properties(), iter->move_metadata()));
+                }
+
+                continuation_token next_token(reader->move_next_marker());
+                next_token.set_target_location(target_location);
+                return container_result_segment(std::move(results), next_token);
+            });
         });
         return core::executor<container_result_segment>::execute_async(command, modified_options, context);
     }
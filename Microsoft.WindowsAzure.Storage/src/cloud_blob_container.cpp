@@ -22,6 +22,7 @@
 #include "wascore/protocol_xml.h"
 #include "wascore/util.h"
 #include "wascore/constants.h"
+#include "wascore/parallel_lister.h"
 
 namespace azure { namespace storage {
 
@@ -437,9 +438,9 @@ namespace azure { namespace storage {
         return list_blob_item_iterator(
             [instance, prefix, use_flat_blob_listing, includes, options, context](const continuation_token& token, size_t max_results_per_segment)
         {
-            return instance->list_blobs_segmented(prefix, use_flat_blob_listing, includes, (int)max_results_per_segment, token, options, context);
+            return instance->list_blobs_segmented_async(prefix, use_flat_blob_listing, includes, (int)max_results_per_segment, token, options, context);
         },
-            max_results, 0);
+            max_results, 0, options.segment_prefetch_depth());
     }
 
     pplx::task<list_blob_item_segment> cloud_blob_container::list_blobs_segmented_async(const utility::string_t& prefix, bool use_flat_blob_listing, blob_listing_details::values includes, int max_results, const continuation_token& token, const blob_request_options& options, operation_context context, const pplx::cancellation_token& cancellation_token) const
@@ -467,31 +468,121 @@ namespace azure { namespace storage {
         command->set_preprocess_response(std::bind(protocol::preprocess_response<list_blob_item_segment>, list_blob_item_segment(), std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
         command->set_postprocess_response([container, delimiter] (const web::http::http_response& response, const request_result& result, const core::ostream_descriptor&, operation_context context) -> pplx::task<list_blob_item_segment>
         {
-            protocol::list_blobs_reader reader(response.body());
+            auto reader = std::make_shared<protocol::list_blobs_reader>(response.body());
+            auto target_location = result.target_location();
+            return reader->read_async().then([reader, container, target_location]() -> list_blob_item_segment
+            {
+                std::vector<protocol::cloud_blob_list_item> blob_items(reader->move_blob_items());
+                std::vector<protocol::cloud_blob_prefix_list_item> blob_prefix_items(reader->move_blob_prefix_items());
 
-            std::vector<protocol::cloud_blob_list_item> blob_items(reader.move_blob_items());
-            std::vector<protocol::cloud_blob_prefix_list_item> blob_prefix_items(reader.move_blob_prefix_items());
+                std::vector<list_blob_item> list_blob_items;
+                list_blob_items.reserve(blob_items.size() + blob_prefix_items.size());
 
-            std::vector<list_blob_item> list_blob_items;
-            list_blob_items.reserve(blob_items.size() + blob_prefix_items.size());
+                for (auto iter = blob_items.begin(); iter != blob_items.end(); ++iter)
+                {
+                    list_blob_items.push_back(list_blob_item(iter->move_name(), iter->move_snapshot_time(), container, iter->move_properties(), iter->move_metadata(), iter->move_copy_state()));
+                }
 
-            for (auto iter = blob_items.begin(); iter != blob_items.end(); ++iter)
-            {
-                list_blob_items.push_back(list_blob_item(iter->move_name(), iter->move_snapshot_time(), container, iter->move_properties(), iter->move_metadata(), iter->move_copy_state()));
-            }
+                for (auto iter = blob_prefix_items.begin(); iter != blob_prefix_items.end(); ++iter)
+                {
+                    list_blob_items.push_back(list_blob_item(iter->move_name(), container));
+                }
+
+                continuation_token next_token(reader->move_next_marker());
+                next_token.set_target_location(target_location);
+
+                return list_blob_item_segment(std::move(list_blob_items), std::move(next_token));
+            });
+        });
+
+        return core::executor<list_blob_item_segment>::execute_async(command, modified_options, context);
+    }
+
+    pplx::task<compact_list_blob_item_segment> cloud_blob_container::list_blobs_compact_segmented_async(const utility::string_t& prefix, bool use_flat_blob_listing, blob_listing_details::values includes, int max_results, const continuation_token& token, const blob_request_options& options, operation_context context, const pplx::cancellation_token& cancellation_token) const
+    {
+        // The compact segment has no room for the other details, so asking for them is an error rather than silently dropping them.
+        if ((includes & ~(blob_listing_details::metadata | blob_listing_details::snapshots)) != 0)
+        {
+            throw std::invalid_argument("includes");
+        }
+
+        blob_request_options modified_options(options);
+        modified_options.apply_defaults(service_client().default_request_options(), blob_type::unspecified);
+
+        utility::string_t delimiter;
 
-            for (auto iter = blob_prefix_items.begin(); iter != blob_prefix_items.end(); ++iter)
+        if (!use_flat_blob_listing)
+        {
+            if ((includes & blob_listing_details::snapshots) != 0)
             {
-                list_blob_items.push_back(list_blob_item(iter->move_name(), container));
+                throw std::invalid_argument("includes");
             }
 
-            continuation_token next_token(reader.move_next_marker());
-            next_token.set_target_location(result.target_location());
+            delimiter = service_client().directory_delimiter();
+        }
 
-            return pplx::task_from_result(list_blob_item_segment(std::move(list_blob_items), std::move(next_token)));
+        auto command = std::make_shared<core::storage_command<compact_list_blob_item_segment>>(uri(), cancellation_token, modified_options.is_maximum_execution_time_customized());
+        command->set_build_request(std::bind(protocol::list_blobs, prefix, delimiter, includes, max_results, token, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+        command->set_authentication_handler(service_client().authentication_handler());
+        command->set_location_mode(core::command_location_mode::primary_or_secondary, token.target_location());
+        command->set_preprocess_response(std::bind(protocol::preprocess_response<compact_list_blob_item_segment>, compact_list_blob_item_segment(), std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+        command->set_postprocess_response([] (const web::http::http_response& response, const request_result& result, const core::ostream_descriptor&, operation_context context) -> pplx::task<compact_list_blob_item_segment>
+        {
+            auto reader = std::make_shared<protocol::compact_list_blobs_reader>(response.body());
+            auto target_location = result.target_location();
+            return reader->read_async().then([reader, target_location]() -> compact_list_blob_item_segment
+            {
+                return reader->move_segment(target_location);
+            });
         });
 
-        return core::executor<list_blob_item_segment>::execute_async(command, modified_options, context);
+        return core::executor<compact_list_blob_item_segment>::execute_async(command, modified_options, context);
+    }
+
+    pplx::task<void> cloud_blob_container::list_blobs_parallel_async(const utility::string_t& prefix, blob_listing_details::values includes, int parallelism, const std::function<void(const list_blob_item&)>& consumer, const blob_request_options& options, operation_context context, const pplx::cancellation_token& cancellation_token) const
+    {
+        // Virtual directories only exist in a hierarchical listing, which cannot include snapshots.
+        if ((includes & blob_listing_details::snapshots) != 0)
+        {
+            throw std::invalid_argument("includes");
+        }
+
+        if (parallelism < 1)
+        {
+            throw std::invalid_argument("parallelism");
+        }
+
+        if (!consumer)
+        {
+            throw std::invalid_argument("consumer");
+        }
+
+        blob_request_options modified_options(options);
+        modified_options.apply_defaults(service_client().default_request_options(), blob_type::unspecified);
+
+        typedef core::parallel_lister<utility::string_t, list_blob_item> lister;
+        auto container = *this;
+        return lister::run(prefix, [container, includes, modified_options, context](const utility::string_t& scope, const continuation_token& token, const pplx::cancellation_token& chain_cancellation_token)
+        {
+            return container.list_blobs_segmented_async(scope, false, includes, 0, token, modified_options, context, chain_cancellation_token).then([](list_blob_item_segment result) -> lister::segment
+            {
+                lister::segment segment;
+                for (const auto& item : result.results())
+                {
+                    if (item.is_blob())
+                    {
+                        segment.items.push_back(item);
+                    }
+                    else
+                    {
+                        segment.children.push_back(item.as_directory().prefix());
+                    }
+                }
+
+                segment.token = result.continuation_token();
+                return segment;
+            });
+        }, consumer, parallelism, cancellation_token);
     }
 
     pplx::task<void> cloud_blob_container::upload_permissions_async(const blob_container_permissions& permissions, const access_condition& condition, const blob_request_options& options, operation_context context, const pplx::cancellation_token& cancellation_token)
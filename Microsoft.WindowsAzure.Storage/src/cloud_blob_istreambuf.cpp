@@ -21,6 +21,9 @@
 
 namespace azure { namespace storage { namespace core {
 
+    // Number of consecutive sequential downloads after a seek before ranges are downloaded ahead again.
+    const int read_ahead_sequential_threshold = 2;
+
     basic_cloud_blob_istreambuf::pos_type basic_cloud_blob_istreambuf::seekpos(basic_cloud_blob_istreambuf::pos_type pos, std::ios_base::openmode direction)
     {
         if (direction & std::ios_base::in)
@@ -34,10 +37,18 @@ namespace azure { namespace storage { namespace core {
             pos_type end(size());
             if ((pos >= 0) && (pos <= end))
             {
+                // Seeking to the end of the current range keeps the reader sequential, so the ranges downloaded ahead are still useful.
+                // Seeking anywhere else is random access, which stops read-ahead until the reader is sequential again.
+                if (pos != m_next_blob_offset)
+                {
+                    m_read_ahead_ranges.clear();
+                    m_sequential_downloads = 0;
+                }
+
                 // Do not allow read beyond the end.
+                recycle_buffer();
                 m_current_blob_offset = pos;
                 m_next_blob_offset = m_current_blob_offset;
-                m_buffer = concurrency::streams::container_buffer<std::vector<char_type>>(std::ios_base::in);
                 m_blob_hash_provider = hash_provider();
                 return pos;
             }
@@ -118,6 +129,7 @@ namespace azure { namespace storage { namespace core {
 
     pplx::task<bool> basic_cloud_blob_istreambuf::download()
     {
+        recycle_buffer();
         m_current_blob_offset = m_next_blob_offset;
 
         utility::size64_t read_size = size() - m_current_blob_offset;
@@ -126,29 +138,51 @@ namespace azure { namespace storage { namespace core {
             return pplx::task_from_result<bool>(false);
         }
 
-        m_buffer_size = m_next_buffer_size;
-        if (read_size > m_buffer_size)
+        std::shared_ptr<read_ahead_range> range;
+        if (!m_read_ahead_ranges.empty() && m_read_ahead_ranges.front()->offset == m_current_blob_offset)
         {
-            read_size = m_buffer_size;
+            range = m_read_ahead_ranges.front();
+            m_read_ahead_ranges.pop_front();
         }
+        else
+        {
+            m_read_ahead_ranges.clear();
 
-        m_next_blob_offset = m_current_blob_offset + read_size;
+            m_buffer_size = m_next_buffer_size;
+            if (read_size > m_buffer_size)
+            {
+                read_size = m_buffer_size;
+            }
+
+            range = download_range(m_current_blob_offset, read_size);
+        }
 
-        std::vector<char_type>& internal_buffer = m_buffer.collection();
-        internal_buffer.resize(static_cast<std::vector<char_type>::size_type>(read_size));
-        concurrency::streams::container_buffer<std::vector<char_type>> temp_buffer(std::move(internal_buffer), std::ios_base::out);
-        temp_buffer.seekpos(0, std::ios_base::out);
+        m_next_blob_offset = m_current_blob_offset + range->size;
+
+        if (m_sequential_downloads < read_ahead_sequential_threshold)
+        {
+            ++m_sequential_downloads;
+        }
+
+        if (m_sequential_downloads >= read_ahead_sequential_threshold)
+        {
+            read_ahead();
+        }
 
         auto this_pointer = std::dynamic_pointer_cast<basic_cloud_blob_istreambuf>(shared_from_this());
-        return m_blob->download_range_to_stream_async(temp_buffer.create_ostream(), m_current_blob_offset, read_size, m_condition, m_options, m_context, m_cancellation_token).then([this_pointer, temp_buffer] (pplx::task<void> download_task) -> pplx::task<bool>
+        return range->task.then([this_pointer, range] () -> pplx::task<bool>
         {
             try
             {
-                download_task.wait();
-                this_pointer->m_buffer = concurrency::streams::container_buffer<std::vector<char_type>>(std::move(temp_buffer.collection()), std::ios_base::in);
+                if (*range->exception != nullptr)
+                {
+                    std::rethrow_exception(*range->exception);
+                }
+
+                this_pointer->m_buffer = concurrency::streams::container_buffer<std::vector<char_type>>(std::move(range->buffer.collection()), std::ios_base::in);
                 this_pointer->m_buffer.seekpos(0, std::ios_base::in);
 
-                // Validate the blob's content MD5 hash
+                // Validate the blob's content MD5 hash. Ranges downloaded ahead are hashed here, in blob order, once the reader reaches them.
                 if (this_pointer->m_blob_hash_provider.is_enabled())
                 {
                     std::vector<char_type>& result_buffer = this_pointer->m_buffer.collection();
@@ -174,4 +208,57 @@ namespace azure { namespace storage { namespace core {
         });
     }
 
+    std::shared_ptr<basic_cloud_blob_istreambuf::read_ahead_range> basic_cloud_blob_istreambuf::download_range(off_type offset, utility::size64_t size)
+    {
+        // Buffers the reader is done with go back to the pool, so sequential reads do not allocate a new buffer per range.
+        std::vector<char_type> internal_buffer = buffer_pool::acquire(static_cast<size_t>(size));
+        internal_buffer.resize(static_cast<std::vector<char_type>::size_type>(size));
+
+        auto range = std::make_shared<read_ahead_range>();
+        range->offset = offset;
+        range->size = size;
+        range->buffer = concurrency::streams::container_buffer<std::vector<char_type>>(std::move(internal_buffer), std::ios_base::out);
+        range->buffer.seekpos(0, std::ios_base::out);
+        range->exception = std::make_shared<std::exception_ptr>();
+
+        // The failure is kept with the range and is only reported if the reader reaches it, so a range that is
+        // dropped because the reader seeked away never reports an error.
+        auto exception = range->exception;
+        range->task = m_blob->download_range_to_stream_async(range->buffer.create_ostream(), offset, size, m_condition, m_options, m_context, m_cancellation_token).then([exception] (pplx::task<void> download_task)
+        {
+            try
+            {
+                download_task.wait();
+            }
+            catch (const std::exception&)
+            {
+                *exception = std::current_exception();
+            }
+        });
+
+        return range;
+    }
+
+    void basic_cloud_blob_istreambuf::read_ahead()
+    {
+        off_type next_offset = m_read_ahead_ranges.empty() ? m_next_blob_offset : m_read_ahead_ranges.back()->offset + m_read_ahead_ranges.back()->size;
+        while ((static_cast<int>(m_read_ahead_ranges.size()) < m_read_ahead_count) && (static_cast<utility::size64_t>(next_offset) < size()))
+        {
+            utility::size64_t read_size = size() - next_offset;
+            if (read_size > m_next_buffer_size)
+            {
+                read_size = m_next_buffer_size;
+            }
+
+            m_read_ahead_ranges.push_back(download_range(next_offset, read_size));
+            next_offset += read_size;
+        }
+    }
+
+    void basic_cloud_blob_istreambuf::recycle_buffer()
+    {
+        buffer_pool::release(std::move(m_buffer.collection()));
+        m_buffer = concurrency::streams::container_buffer<std::vector<char_type>>(std::ios_base::in);
+    }
+
 }}} // namespace azure::storage::core
@@ -43,6 +43,19 @@ namespace azure { namespace storage { namespace core {
 
     pplx::task<void> basic_cloud_block_blob_ostreambuf::upload_buffer()
     {
+        if (m_controller != nullptr)
+        {
+            // The buffer being prepared keeps its size. The new block size applies to the buffer filled next.
+            m_next_buffer_size = m_controller->block_size();
+
+            int parallelism = m_controller->parallelism();
+            if (parallelism != m_parallelism)
+            {
+                m_parallelism = parallelism;
+                m_semaphore.resize(parallelism);
+            }
+        }
+
         auto buffer = prepare_buffer();
         if (buffer->is_empty())
         {
@@ -58,12 +71,24 @@ namespace azure { namespace storage { namespace core {
             {
                 try
                 {
-                    this_pointer->m_blob->upload_block_async_impl(block_id, buffer->stream(), buffer->content_md5(), this_pointer->m_condition, this_pointer->m_options, this_pointer->m_context, this_pointer->m_cancellation_token, this_pointer->m_use_request_level_timeout, this_pointer->m_timer_handler).then([this_pointer] (pplx::task<void> upload_task)
+                    transfer_byte_limit::acquire_async(buffer->size()).then([buffer] ()
+                    {
+                        return buffer->hash_task();
+                    }).then([this_pointer, buffer, block_id] () -> pplx::task<void>
                     {
+                        return this_pointer->m_blob->upload_block_async_impl(block_id, buffer->stream(), buffer->content_md5(), buffer->content_crc64(), this_pointer->m_condition, this_pointer->m_options, this_pointer->m_context, this_pointer->m_cancellation_token, this_pointer->m_use_request_level_timeout, this_pointer->m_timer_handler);
+                    }).then([this_pointer, buffer] (pplx::task<void> upload_task)
+                    {
+                        transfer_byte_limit::release(buffer->size());
                         std::lock_guard<async_semaphore> guard(this_pointer->m_semaphore, std::adopt_lock);
                         try
                         {
                             upload_task.wait();
+
+                            if (this_pointer->m_controller != nullptr)
+                            {
+                                this_pointer->m_controller->block_completed(static_cast<size_t>(buffer->size()));
+                            }
                         }
                         catch (const std::exception&)
                         {
@@ -88,6 +113,9 @@ namespace azure { namespace storage { namespace core {
     {
         auto this_pointer = std::dynamic_pointer_cast<basic_cloud_block_blob_ostreambuf>(shared_from_this());
         return _sync().then([this_pointer] (bool) -> pplx::task<void>
+        {
+            return this_pointer->close_total_hash();
+        }).then([this_pointer] () -> pplx::task<void>
         {
             if (this_pointer->m_total_hash_provider.is_enabled())
             {
@@ -127,8 +155,16 @@ namespace azure { namespace storage { namespace core {
             {
                 try
                 {
-                    this_pointer->m_blob->upload_pages_async_impl(buffer->stream(), offset, buffer->content_md5(), this_pointer->m_condition, this_pointer->m_options, this_pointer->m_context, this_pointer->m_cancellation_token, this_pointer->m_use_request_level_timeout, this_pointer->m_timer_handler).then([this_pointer] (pplx::task<void> upload_task)
+                    transfer_byte_limit::acquire_async(buffer->size()).then([buffer] ()
+                    {
+                        return buffer->hash_task();
+                    }).then([this_pointer, buffer, offset] () -> pplx::task<void>
+                    {
+                        return this_pointer->m_blob->upload_pages_async_impl(buffer->stream(), offset, buffer->content_md5(), buffer->content_crc64(), this_pointer->m_condition, this_pointer->m_options, this_pointer->m_context, this_pointer->m_cancellation_token, this_pointer->m_use_request_level_timeout, this_pointer->m_timer_handler);
+                    }).then([this_pointer, buffer] (pplx::task<void> upload_task)
                     {
+                        // The buffer is captured so that it is only returned to the pool once the upload has completed.
+                        transfer_byte_limit::release(buffer->size());
                         std::lock_guard<async_semaphore> guard(this_pointer->m_semaphore, std::adopt_lock);
                         try
                         {
@@ -158,6 +194,9 @@ namespace azure { namespace storage { namespace core {
         {
             auto this_pointer = std::dynamic_pointer_cast<basic_cloud_page_blob_ostreambuf>(shared_from_this());
             return _sync().then([this_pointer] (bool) -> pplx::task<void>
+            {
+                return this_pointer->close_total_hash();
+            }).then([this_pointer] () -> pplx::task<void>
             {
                 this_pointer->m_blob->properties().set_content_md5(this_pointer->m_total_hash_provider.hash());
                 return this_pointer->m_blob->upload_properties_async_impl(this_pointer->m_condition, this_pointer->m_options, this_pointer->m_context, this_pointer->m_cancellation_token, this_pointer->m_use_request_level_timeout, this_pointer->m_timer_handler);
@@ -198,8 +237,16 @@ namespace azure { namespace storage { namespace core {
                     this_pointer->m_condition.set_append_position(offset);
                     auto previous_results_count = this_pointer->m_context.request_results().size();
                     pplx::task<int64_t> task;
-                    this_pointer->m_blob->append_block_async_impl(buffer->stream(), buffer->content_md5(), this_pointer->m_condition, this_pointer->m_options, this_pointer->m_context, this_pointer->m_cancellation_token, this_pointer->m_use_request_level_timeout, this_pointer->m_timer_handler).then([this_pointer, previous_results_count](pplx::task<int64_t> upload_task)
+                    transfer_byte_limit::acquire_async(buffer->size()).then([buffer] ()
+                    {
+                        return buffer->hash_task();
+                    }).then([this_pointer, buffer] () -> pplx::task<int64_t>
                     {
+                        return this_pointer->m_blob->append_block_async_impl(buffer->stream(), buffer->content_md5(), buffer->content_crc64(), this_pointer->m_condition, this_pointer->m_options, this_pointer->m_context, this_pointer->m_cancellation_token, this_pointer->m_use_request_level_timeout, this_pointer->m_timer_handler);
+                    }).then([this_pointer, buffer, previous_results_count](pplx::task<int64_t> upload_task)
+                    {
+                        // The buffer is captured so that it is only returned to the pool once the upload has completed.
+                        transfer_byte_limit::release(buffer->size());
                         std::lock_guard<async_semaphore> guard(this_pointer->m_semaphore, std::adopt_lock);
                         try
                         {
@@ -248,6 +295,9 @@ namespace azure { namespace storage { namespace core {
         {
             auto this_pointer = std::dynamic_pointer_cast<basic_cloud_append_blob_ostreambuf>(shared_from_this());
             return _sync().then([this_pointer](bool) -> pplx::task<void>
+            {
+                return this_pointer->close_total_hash();
+            }).then([this_pointer]() -> pplx::task<void>
             {
                 this_pointer->m_blob->properties().set_content_md5(this_pointer->m_total_hash_provider.hash());
                 return this_pointer->m_blob->upload_properties_async_impl(this_pointer->m_condition, this_pointer->m_options, this_pointer->m_context, this_pointer->m_cancellation_token, this_pointer->m_use_request_level_timeout, this_pointer->m_timer_handler);
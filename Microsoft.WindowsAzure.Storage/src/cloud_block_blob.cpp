@@ -22,21 +22,24 @@
 
 namespace azure { namespace storage {
 
-    pplx::task<void> cloud_block_blob::upload_block_async_impl(const utility::string_t& block_id, concurrency::streams::istream block_data, const utility::string_t& content_md5, const access_condition& condition, const blob_request_options& options, operation_context context, const pplx::cancellation_token& cancellation_token, bool use_timeout, std::shared_ptr<core::timer_handler> timer_handler) const
+    pplx::task<void> cloud_block_blob::upload_block_async_impl(const utility::string_t& block_id, concurrency::streams::istream block_data, const utility::string_t& content_md5, const utility::string_t& content_crc64, const access_condition& condition, const blob_request_options& options, operation_context context, const pplx::cancellation_token& cancellation_token, bool use_timeout, std::shared_ptr<core::timer_handler> timer_handler) const
     {
         assert_no_snapshot();
         blob_request_options modified_options(options);
         modified_options.apply_defaults(service_client().default_request_options(), type());
 
-        bool needs_md5 = content_md5.empty() && modified_options.use_transactional_md5();
+        bool needs_checksum = content_md5.empty() && content_crc64.empty();
+        bool needs_md5 = needs_checksum && modified_options.use_transactional_md5() && !modified_options.use_transactional_crc64();
+        bool needs_crc64 = needs_checksum && modified_options.use_transactional_crc64();
 
         auto command = std::make_shared<core::storage_command<void>>(uri(), cancellation_token, (modified_options.is_maximum_execution_time_customized() && use_timeout), timer_handler);
         command->set_authentication_handler(service_client().authentication_handler());
         command->set_preprocess_response(std::bind(protocol::preprocess_response_void, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
-        return core::istream_descriptor::create(block_data, needs_md5, std::numeric_limits<utility::size64_t>::max(), protocol::max_block_size, command->get_cancellation_token()).then([command, context, block_id, content_md5, modified_options, condition](core::istream_descriptor request_body) -> pplx::task<void>
+        return core::istream_descriptor::create(block_data, needs_md5, std::numeric_limits<utility::size64_t>::max(), protocol::max_block_size, command->get_cancellation_token(), needs_crc64).then([command, context, block_id, content_md5, content_crc64, modified_options, condition](core::istream_descriptor request_body) -> pplx::task<void>
         {
             const utility::string_t& md5 = content_md5.empty() ? request_body.content_md5() : content_md5;
-            command->set_build_request(std::bind(protocol::put_block, block_id, md5, condition, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+            const utility::string_t& crc64 = content_crc64.empty() ? request_body.content_crc64() : content_crc64;
+            command->set_build_request(std::bind(protocol::put_block, block_id, md5, crc64, condition, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
             command->set_request_body(request_body);
             return core::executor<void>::execute_async(command, modified_options, context);
         });
@@ -89,50 +92,72 @@ namespace azure { namespace storage {
         });
         command->set_postprocess_response([] (const web::http::http_response& response, const request_result&, const core::ostream_descriptor&, operation_context context) -> pplx::task<std::vector<block_list_item>>
         {
-            protocol::block_list_reader reader(response.body());
-            return pplx::task_from_result(reader.move_result());
+            auto reader = std::make_shared<protocol::block_list_reader>(response.body());
+            return reader->read_async().then([reader]() -> std::vector<block_list_item>
+            {
+                return reader->move_result();
+            });
         });
 
         return core::executor<std::vector<block_list_item>>::execute_async(command, modified_options, context);
     }
 
-    pplx::task<concurrency::streams::ostream> cloud_block_blob::open_write_async_impl(const access_condition& condition, const blob_request_options& options, operation_context context, const pplx::cancellation_token& cancellation_token, bool use_request_level_timeout, std::shared_ptr<core::timer_handler> timer_handler)
+    pplx::task<void> cloud_block_blob::check_access_condition_async(const access_condition& condition, const blob_request_options& options, operation_context context, const pplx::cancellation_token& cancellation_token, std::shared_ptr<core::timer_handler> timer_handler)
     {
-        assert_no_snapshot();
-        blob_request_options modified_options(options);
-        modified_options.apply_defaults(service_client().default_request_options(), type(), false);
+        if (!condition.is_conditional())
+        {
+            return pplx::task_from_result();
+        }
 
-        pplx::task<void> check_condition_task;
-        if (condition.is_conditional())
+        return download_attributes_async_impl(condition, options, context, cancellation_token, false, timer_handler).then([condition, timer_handler](pplx::task<void> download_attributes_task)
         {
-            check_condition_task = download_attributes_async_impl(condition, modified_options, context, cancellation_token, false, timer_handler).then([condition, timer_handler](pplx::task<void> download_attributes_task)
+            try
             {
-                try
+                download_attributes_task.wait();
+            }
+            catch (const storage_exception& e)
+            {
+                if ((e.result().http_status_code() == web::http::status_codes::NotFound) &&
+                    condition.if_match_etag().empty())
                 {
-                    download_attributes_task.wait();
+                    // If we got a 404 and the condition was not an If-Match,
+                    // we should continue with the operation.
                 }
-                catch (const storage_exception& e)
+                else
                 {
-                    if ((e.result().http_status_code() == web::http::status_codes::NotFound) &&
-                        condition.if_match_etag().empty())
-                    {
-                        // If we got a 404 and the condition was not an If-Match,
-                        // we should continue with the operation.
-                    }
-                    else
-                    {
-                        throw;
-                    }
+                    throw;
                 }
-            });
-        }
-        else
+            }
+        });
+    }
+
+    void cloud_block_blob::fit_block_size_to_block_limit(utility::size64_t length, blob_request_options& options)
+    {
+        auto totalBlocks = std::ceil(static_cast<double>(length) / options.stream_write_size_in_bytes());
+
+        // Check if the total required blocks for the upload exceeds the maximum allowable block limit.
+        if (totalBlocks > protocol::max_block_number)
         {
-            check_condition_task = pplx::task_from_result();
+            if (options.stream_write_size_in_bytes().has_value() || length > protocol::max_block_blob_size)
+            {
+                throw storage_exception(protocol::error_blob_over_max_block_limit);
+            }
+            else
+            {
+                // Scale the block size to ensure a successful upload (only if the user did not specify a value).
+                options.set_stream_write_size_in_bytes(static_cast<size_t>(std::ceil(static_cast<double>(length) / protocol::max_block_number)));
+            }
         }
+    }
+
+    pplx::task<concurrency::streams::ostream> cloud_block_blob::open_write_async_impl(const access_condition& condition, const blob_request_options& options, operation_context context, const pplx::cancellation_token& cancellation_token, bool use_request_level_timeout, std::shared_ptr<core::timer_handler> timer_handler)
+    {
+        assert_no_snapshot();
+        blob_request_options modified_options(options);
+        modified_options.apply_defaults(service_client().default_request_options(), type(), false);
 
         auto instance = std::make_shared<cloud_block_blob>(*this);
-        return check_condition_task.then([instance, condition, modified_options, context, cancellation_token, use_request_level_timeout, timer_handler]()
+        return check_access_condition_async(condition, modified_options, context, cancellation_token, timer_handler).then([instance, condition, modified_options, context, cancellation_token, use_request_level_timeout, timer_handler]()
         {
             return core::cloud_block_blob_ostreambuf(instance, condition, modified_options, context, cancellation_token, use_request_level_timeout, timer_handler).create_ostream();
         });
@@ -198,21 +223,7 @@ namespace azure { namespace storage {
         // Otherwise, throws a storage_exception if the default value has been changed or if the blob size exceeds the maximum capacity.
         if (length != std::numeric_limits<utility::size64_t>::max())
         {
-            auto totalBlocks = std::ceil(static_cast<double>(length) / modified_options.stream_write_size_in_bytes());
-
-            // Check if the total required blocks for the upload exceeds the maximum allowable block limit.
-            if (totalBlocks > protocol::max_block_number)
-            {
-                if (modified_options.stream_write_size_in_bytes().has_value() || length > protocol::max_block_blob_size)
-                {
-                    throw storage_exception(protocol::error_blob_over_max_block_limit);
-                }
-                else
-                {
-                    // Scale the block size to ensure a successful upload (only if the user did not specify a value).
-                    modified_options.set_stream_write_size_in_bytes(static_cast<size_t>(std::ceil(static_cast<double>(length)) / protocol::max_block_number));
-                }
-            }
+            fit_block_size_to_block_limit(length, modified_options);
         }
 
         auto timer_handler = std::make_shared<core::timer_handler>(cancellation_token);
@@ -233,8 +244,12 @@ namespace azure { namespace storage {
 
     pplx::task<void> cloud_block_blob::upload_from_file_async(const utility::string_t &path, const access_condition& condition, const blob_request_options& options, operation_context context, const pplx::cancellation_token& cancellation_token)
     {
+        assert_no_snapshot();
+        blob_request_options modified_options(options);
+        modified_options.apply_defaults(service_client().default_request_options(), type());
+
         auto instance = std::make_shared<cloud_block_blob>(*this);
-        return concurrency::streams::file_stream<uint8_t>::open_istream(path).then([instance, condition, options, context, cancellation_token] (concurrency::streams::istream stream) -> pplx::task<void>
+        return concurrency::streams::file_stream<uint8_t>::open_istream(path).then([instance, path, condition, options, modified_options, context, cancellation_token] (concurrency::streams::istream stream) mutable -> pplx::task<void>
         {
             utility::size64_t remaining_stream_length = core::get_remaining_stream_length(stream);
             if (remaining_stream_length == std::numeric_limits<utility::size64_t>::max())
@@ -242,11 +257,66 @@ namespace azure { namespace storage {
                 throw storage_exception(protocol::error_stream_length_unknown);
             }
 
-            return instance->upload_from_stream_async(stream, std::numeric_limits<utility::size64_t>::max(), condition, options, context, cancellation_token).then([stream] (pplx::task<void> upload_task) -> pplx::task<void>
+            // Adaptive uploads pick the block size as they go, so they go through the blob write stream instead of a fixed range layout.
+            if (((remaining_stream_length <= modified_options.single_blob_upload_threshold_in_bytes()) &&
+                (modified_options.parallelism_factor() == 1)) ||
+                modified_options.use_adaptive_upload())
             {
-                return stream.close().then([upload_task]()
+                return instance->upload_from_stream_async(stream, std::numeric_limits<utility::size64_t>::max(), condition, options, context, cancellation_token).then([stream] (pplx::task<void> upload_task) -> pplx::task<void>
                 {
-                    upload_task.wait();
+                    return stream.close().then([upload_task]()
+                    {
+                        upload_task.wait();
+                    });
+                });
+            }
+
+            // Larger files are read range by range straight from the file into block buffers, and up to parallelism_factor
+            // blocks are read and uploaded at the same time instead of being funneled through a single blob write stream.
+            return stream.close().then([instance, path, remaining_stream_length, condition, options, modified_options, context, cancellation_token] () mutable -> pplx::task<void>
+            {
+                fit_block_size_to_block_limit(remaining_stream_length, modified_options);
+
+                auto timer_handler = std::make_shared<core::timer_handler>(cancellation_token);
+
+                if (modified_options.is_maximum_execution_time_customized())
+                {
+                    timer_handler->start_timer(options.maximum_execution_time());// azure::storage::core::timer_handler will automatically stop the timer when destructed.
+                }
+
+                return instance->check_access_condition_async(condition, modified_options, context, timer_handler->get_cancellation_token(), timer_handler).then([instance, path, remaining_stream_length, condition, modified_options, context, timer_handler]() -> pplx::task<void>
+                {
+                    utility::string_t block_id_prefix(utility::uuid_to_string(utility::new_uuid()));
+                    size_t block_size = modified_options.stream_write_size_in_bytes();
+                    size_t block_count = static_cast<size_t>((remaining_stream_length + block_size - 1) / block_size);
+
+                    auto block_list = std::make_shared<std::vector<block_list_item>>();
+                    block_list->reserve(block_count);
+                    for (size_t i = 0; i < block_count; ++i)
+                    {
+                        utility::ostringstream_t str;
+                        str << block_id_prefix << _XPLATSTR('-') << std::setw(6) << std::setfill(_XPLATSTR('0')) << i;
+                        auto utf8_block_id = utility::conversions::to_utf8string(str.str());
+                        std::vector<unsigned char> block_id_as_array(utf8_block_id.cbegin(), utf8_block_id.cend());
+                        block_list->push_back(block_list_item(utility::conversions::to_base64(block_id_as_array)));
+                    }
+
+                    auto upload_block = [instance, block_list, block_size, condition, modified_options, context, timer_handler](concurrency::streams::istream block_data, utility::size64_t offset, const utility::string_t& content_md5, const utility::string_t& content_crc64) -> pplx::task<void>
+                    {
+                        const utility::string_t& block_id = (*block_list)[static_cast<size_t>(offset / block_size)].id();
+                        return instance->upload_block_async_impl(block_id, block_data, content_md5, content_crc64, condition, modified_options, context, timer_handler->get_cancellation_token(), false, timer_handler);
+                    };
+
+                    core::hash_provider total_hash_provider = modified_options.store_blob_content_md5() ? core::hash_provider::create_md5_hash_provider() : core::hash_provider();
+                    return core::upload_file_ranges_async(path, remaining_stream_length, block_size, modified_options.parallelism_factor(), modified_options.use_transactional_md5(), modified_options.use_transactional_crc64(), total_hash_provider, upload_block, timer_handler->get_cancellation_token(), timer_handler).then([instance, block_list, total_hash_provider, condition, modified_options, context, timer_handler]() -> pplx::task<void>
+                    {
+                        if (total_hash_provider.is_enabled())
+                        {
+                            instance->properties().set_content_md5(total_hash_provider.hash());
+                        }
+
+                        return instance->upload_block_list_async_impl(*block_list, condition, modified_options, context, timer_handler->get_cancellation_token(), false, timer_handler).then([timer_handler/*timer_handler MUST be captured*/]() {});
+                    });
                 });
             });
         });
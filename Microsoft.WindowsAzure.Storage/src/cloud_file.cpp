@@ -358,7 +358,7 @@ namespace azure { namespace storage {
         file_range range(start_offset, end_offset);
 
         auto command = std::make_shared<core::storage_command<void>>(uri());
-        command->set_build_request(std::bind(protocol::put_file_range, range, file_range_write::clear, utility::string_t(), std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+        command->set_build_request(std::bind(protocol::put_file_range, range, file_range_write::clear, utility::string_t(), utility::string_t(), std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
         command->set_authentication_handler(service_client().authentication_handler());
         command->set_preprocess_response([properties](const web::http::http_response& response, const request_result& result, operation_context context)
         {
@@ -371,15 +371,27 @@ namespace azure { namespace storage {
     }
     
     pplx::task<void> cloud_file::write_range_async(Concurrency::streams::istream stream, int64_t start_offset, const utility::string_t& content_md5, const file_access_condition& access_condition, const file_request_options& options, operation_context context) const
+    {
+        return write_range_async_impl(stream, start_offset, content_md5, utility::string_t(), access_condition, options, context);
+    }
+
+    pplx::task<void> cloud_file::write_range_async(Concurrency::streams::istream stream, int64_t start_offset, const utility::string_t& content_md5, const utility::string_t& content_crc64, const file_access_condition& access_condition, const file_request_options& options, operation_context context) const
+    {
+        return write_range_async_impl(stream, start_offset, content_md5, content_crc64, access_condition, options, context);
+    }
+
+    pplx::task<void> cloud_file::write_range_async_impl(Concurrency::streams::istream stream, int64_t start_offset, const utility::string_t& content_md5, const utility::string_t& content_crc64, const file_access_condition& access_condition, const file_request_options& options, operation_context context, const pplx::cancellation_token& cancellation_token, std::shared_ptr<core::timer_handler> timer_handler) const
     {
         UNREFERENCED_PARAMETER(access_condition);
         file_request_options modified_options(options);
         modified_options.apply_defaults(service_client().default_request_options());
 
         auto properties = m_properties;
-        bool needs_md5 = content_md5.empty() && modified_options.use_transactional_md5();
+        bool needs_checksum = content_md5.empty() && content_crc64.empty();
+        bool needs_md5 = needs_checksum && modified_options.use_transactional_md5() && !modified_options.use_transactional_crc64();
+        bool needs_crc64 = needs_checksum && modified_options.use_transactional_crc64();
 
-        auto command = std::make_shared<core::storage_command<void>>(uri());
+        auto command = std::make_shared<core::storage_command<void>>(uri(), cancellation_token, false, timer_handler);
         command->set_authentication_handler(service_client().authentication_handler());
         command->set_preprocess_response([properties](const web::http::http_response& response, const request_result& result, operation_context context)
         {
@@ -388,12 +400,13 @@ namespace azure { namespace storage {
             properties->update_etag_and_last_modified(modified_properties);
             properties->m_content_md5 = modified_properties.content_md5();
         });
-        return core::istream_descriptor::create(stream, needs_md5, std::numeric_limits<utility::size64_t>::max(), protocol::max_range_size).then([command, context, start_offset, content_md5, modified_options](core::istream_descriptor request_body)->pplx::task<void>
+        return core::istream_descriptor::create(stream, needs_md5, std::numeric_limits<utility::size64_t>::max(), protocol::max_range_size, command->get_cancellation_token(), needs_crc64).then([command, context, start_offset, content_md5, content_crc64, modified_options](core::istream_descriptor request_body)->pplx::task<void>
         {
             const utility::string_t& md5 = content_md5.empty() ? request_body.content_md5() : content_md5;
+            const utility::string_t& crc64 = content_crc64.empty() ? request_body.content_crc64() : content_crc64;
             auto end_offset = start_offset + request_body.length() - 1;
             file_range range(start_offset, end_offset);
-            command->set_build_request(std::bind(protocol::put_file_range, range, file_range_write::update, md5, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+            command->set_build_request(std::bind(protocol::put_file_range, range, file_range_write::update, md5, crc64, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
             command->set_request_body(request_body);
             return core::executor<void>::execute_async(command, modified_options, context);
         });
@@ -405,6 +418,7 @@ namespace azure { namespace storage {
         utility::size64_t m_total_written_to_destination_stream;
         utility::size64_t m_response_length;
         utility::string_t m_response_md5;
+        utility::string_t m_response_crc64;
         utility::string_t m_locked_etag;
         bool m_reset_target;
         concurrency::streams::ostream::pos_type m_target_offset;
@@ -420,6 +434,9 @@ namespace azure { namespace storage {
         auto metadata = m_metadata;
         auto copy_state = m_copy_state;
 
+        // CRC64 replaces the transactional MD5 of ranges, while the MD5 of a whole file is still validated against its Content-MD5.
+        bool use_transactional_crc64 = modified_options.use_transactional_crc64() && offset < std::numeric_limits<utility::size64_t>::max();
+
         std::shared_ptr<file_download_info> download_info = std::make_shared<file_download_info>();
         download_info->m_are_properties_populated = false;
         download_info->m_total_written_to_destination_stream = 0;
@@ -429,7 +446,7 @@ namespace azure { namespace storage {
 
         std::shared_ptr<core::storage_command<void>> command = std::make_shared<core::storage_command<void>>(uri());
         std::weak_ptr<core::storage_command<void>> weak_command(command);
-        command->set_build_request([offset, length, modified_options, download_info](web::http::uri_builder uri_builder, const std::chrono::seconds& timeout, operation_context context) -> web::http::http_request
+        command->set_build_request([offset, length, modified_options, use_transactional_crc64, download_info](web::http::uri_builder uri_builder, const std::chrono::seconds& timeout, operation_context context) -> web::http::http_request
         {
             utility::size64_t current_offset = offset;
             utility::size64_t current_length = length;
@@ -454,12 +471,13 @@ namespace azure { namespace storage {
                 }
             }
 
-            return protocol::get_file(current_offset, current_length, modified_options.use_transactional_md5() && !download_info->m_are_properties_populated, uri_builder, timeout, context);
+            return protocol::get_file(current_offset, current_length, modified_options.use_transactional_md5() && !use_transactional_crc64 && !download_info->m_are_properties_populated, use_transactional_crc64 && !download_info->m_are_properties_populated, uri_builder, timeout, context);
         });
         command->set_authentication_handler(service_client().authentication_handler());
         command->set_location_mode(core::command_location_mode::primary_or_secondary);
         command->set_destination_stream(target);
         command->set_calculate_response_body_md5(!modified_options.disable_content_md5_validation());
+        command->set_calculate_response_body_crc64(use_transactional_crc64);
         command->set_recover_request([target, download_info](utility::size64_t total_written_to_destination_stream, operation_context context) -> bool
         {
             if (download_info->m_reset_target)
@@ -485,7 +503,7 @@ namespace azure { namespace storage {
 
             return target.is_open();
         });
-        command->set_preprocess_response([weak_command, offset, modified_options, properties, metadata, copy_state, download_info, update_properties, validate_last_modify](const web::http::http_response& response, const request_result& result, operation_context context)
+        command->set_preprocess_response([weak_command, offset, modified_options, use_transactional_crc64, properties, metadata, copy_state, download_info, update_properties, validate_last_modify](const web::http::http_response& response, const request_result& result, operation_context context)
         {
             std::shared_ptr<core::storage_command<void>> command(weak_command);
 
@@ -523,8 +541,16 @@ namespace azure { namespace storage {
 
                 download_info->m_response_length = result.content_length();
                 download_info->m_response_md5 = result.content_md5();
+                response.headers().match(protocol::ms_header_content_crc64, download_info->m_response_crc64);
 
-                if (modified_options.use_transactional_md5() && !modified_options.disable_content_md5_validation() && download_info->m_response_md5.empty()
+                if (use_transactional_crc64)
+                {
+                    if (download_info->m_response_crc64.empty())
+                    {
+                        throw storage_exception(protocol::error_missing_crc64);
+                    }
+                }
+                else if (modified_options.use_transactional_md5() && !modified_options.disable_content_md5_validation() && download_info->m_response_md5.empty()
                     // If range is not set and the file has no MD5 hash, no content md5 will not be returned.
                     // Consider the file has no MD5 hash in default.
                     && offset < std::numeric_limits<utility::size64_t>::max())
@@ -556,6 +582,11 @@ namespace azure { namespace storage {
                 throw storage_exception(protocol::error_md5_mismatch);
             }
 
+            if (!download_info->m_response_crc64.empty() && !descriptor.content_crc64().empty() && download_info->m_response_crc64 != descriptor.content_crc64())
+            {
+                throw storage_exception(protocol::error_crc64_mismatch);
+            }
+
             return pplx::task_from_result();
         });
         return core::executor<void>::execute_async(command, modified_options, context);
@@ -568,8 +599,8 @@ namespace azure { namespace storage {
             auto instance = std::make_shared<cloud_file>(*this);
             // if download a whole blob, enable download strategy(download 32MB first).
             utility::size64_t single_file_download_threshold(protocol::default_single_blob_download_threshold);
-            // If tranactional md5 validation is set, first range should be 4MB.
-            if (options.use_transactional_md5())
+            // If tranactional md5 or crc64 validation is set, first range should be 4MB.
+            if (options.use_transactional_md5() || options.use_transactional_crc64())
             {
                 single_file_download_threshold = protocol::default_single_block_download_threshold;
             }
@@ -699,6 +730,7 @@ namespace azure { namespace storage {
                                             pplx::extensibility::scoped_rw_lock_t guard(mutex);
                                             return *smallest_offset == current_offset;
                                         });
+                                        bool out_of_order = false;
                                         {
                                             pplx::extensibility::scoped_rw_lock_t guard(mutex);
 
@@ -709,7 +741,7 @@ namespace azure { namespace storage {
                                             }
                                             else if (*smallest_offset > current_offset)
                                             {
-                                                throw std::runtime_error("Out of order in parallel downloading blob.");
+                                                out_of_order = true;
                                             }
                                         }
                                         condition_variable->notify_all();
@@ -718,6 +750,12 @@ namespace azure { namespace storage {
                                         {
                                             semaphore->unlock();
                                         }
+
+                                        // The slot is given back before failing, so the other segments are not held up.
+                                        if (out_of_order)
+                                        {
+                                            throw std::runtime_error("Out of order in parallel downloading blob.");
+                                        }
                                     }
                                 }
                             });
@@ -820,14 +858,46 @@ namespace azure { namespace storage {
     
     pplx::task<void> cloud_file::upload_from_file_async(const utility::string_t& path, const file_access_condition& access_condition, const file_request_options& options, operation_context context) const
     {
+        file_request_options modified_options(options);
+        modified_options.apply_defaults(service_client().default_request_options());
+
         auto instance = std::make_shared<cloud_file>(*this);
-        return concurrency::streams::file_stream<uint8_t>::open_istream(path).then([instance, access_condition, options, context](concurrency::streams::istream stream) -> pplx::task<void>
+        return concurrency::streams::file_stream<uint8_t>::open_istream(path).then([instance, path, access_condition, options, modified_options, context](concurrency::streams::istream stream) -> pplx::task<void>
         {
-            return instance->upload_from_stream_async(stream, access_condition, options, context).then([stream](pplx::task<void> upload_task) -> pplx::task<void>
+            utility::size64_t length = core::get_remaining_stream_length(stream);
+            return stream.close().then([instance, path, length, access_condition, options, modified_options, context]() -> pplx::task<void>
             {
-                return stream.close().then([upload_task]()
+                if (length == std::numeric_limits<utility::size64_t>::max())
                 {
-                    upload_task.wait();
+                    throw std::logic_error(protocol::error_file_size_unknown);
+                }
+
+                auto timer_handler = std::make_shared<core::timer_handler>(pplx::cancellation_token::none());
+
+                if (modified_options.is_maximum_execution_time_customized())
+                {
+                    timer_handler->start_timer(options.maximum_execution_time());// azure::storage::core::timer_handler will automatically stop the timer when destructed.
+                }
+
+                return instance->create_async(length, access_condition, modified_options, context).then([instance, path, length, access_condition, modified_options, context, timer_handler]() -> pplx::task<void>
+                {
+                    // Ranges are read straight from the file, and up to parallelism_factor ranges are read and written at the same time.
+                    auto write_range = [instance, access_condition, modified_options, context, timer_handler](concurrency::streams::istream range_data, utility::size64_t offset, const utility::string_t& content_md5, const utility::string_t& content_crc64) -> pplx::task<void>
+                    {
+                        return instance->write_range_async_impl(range_data, static_cast<int64_t>(offset), content_md5, content_crc64, access_condition, modified_options, context, timer_handler->get_cancellation_token(), timer_handler);
+                    };
+
+                    core::hash_provider total_hash_provider = modified_options.store_file_content_md5() ? core::hash_provider::create_md5_hash_provider() : core::hash_provider();
+                    return core::upload_file_ranges_async(path, length, protocol::max_range_size, modified_options.parallelism_factor(), modified_options.use_transactional_md5(), modified_options.use_transactional_crc64(), total_hash_provider, write_range, timer_handler->get_cancellation_token(), timer_handler).then([instance, total_hash_provider, access_condition, modified_options, context, timer_handler]() -> pplx::task<void>
+                    {
+                        if (total_hash_provider.is_enabled())
+                        {
+                            instance->properties().set_content_md5(total_hash_provider.hash());
+                            return instance->upload_properties_async(access_condition, modified_options, context).then([timer_handler/*timer_handler MUST be captured*/]() {});
+                        }
+
+                        return pplx::task_from_result();
+                    });
                 });
             });
         });
@@ -22,6 +22,7 @@
 #include "wascore/protocol_xml.h"
 #include "wascore/util.h"
 #include "wascore/constants.h"
+#include "wascore/parallel_lister.h"
 
 namespace azure { namespace storage {
 
@@ -92,9 +93,9 @@ namespace azure { namespace storage {
         return list_file_and_diretory_result_iterator(
             [instance, prefix, options, context](const continuation_token& token, size_t max_results_per_segment)
         {
-            return instance->list_files_and_directories_segmented(prefix, max_results_per_segment, token, options, context);
+            return instance->list_files_and_directories_segmented_async(prefix, max_results_per_segment, token, options, context);
         },
-            max_results, 0);
+            max_results, 0, options.segment_prefetch_depth());
     }
 
     pplx::task<list_file_and_directory_result_segment> cloud_file_directory::list_files_and_directories_segmented_async(const utility::string_t& prefix, int64_t max_results, const continuation_token& token, const file_request_options& options, operation_context context) const
@@ -125,6 +126,43 @@ namespace azure { namespace storage {
         return core::executor<list_file_and_directory_result_segment>::execute_async(command, modified_options, context);
     }
 
+    pplx::task<void> cloud_file_directory::list_files_and_directories_parallel_async(int parallelism, const std::function<void(const list_file_and_directory_item&)>& consumer, const file_request_options& options, operation_context context) const
+    {
+        if (parallelism < 1)
+        {
+            throw std::invalid_argument("parallelism");
+        }
+
+        if (!consumer)
+        {
+            throw std::invalid_argument("consumer");
+        }
+
+        file_request_options modified_options(options);
+        modified_options.apply_defaults(service_client().default_request_options());
+
+        // File listings cannot be canceled once they are sent, so a failure only keeps further requests from being started.
+        typedef core::parallel_lister<cloud_file_directory, list_file_and_directory_item> lister;
+        return lister::run(*this, [modified_options, context](const cloud_file_directory& scope, const continuation_token& token, const pplx::cancellation_token&)
+        {
+            return scope.list_files_and_directories_segmented_async(utility::string_t(), 0, token, modified_options, context).then([](list_file_and_directory_result_segment result) -> lister::segment
+            {
+                lister::segment segment;
+                segment.items = result.results();
+                for (const auto& item : segment.items)
+                {
+                    if (item.is_directory())
+                    {
+                        segment.children.push_back(item.as_directory());
+                    }
+                }
+
+                segment.token = result.continuation_token();
+                return segment;
+            });
+        }, consumer, parallelism, pplx::cancellation_token::none());
+    }
+
     pplx::task<void> cloud_file_directory::create_async(const file_access_condition& access_condition, const file_request_options& options, operation_context context)
     {
         UNREFERENCED_PARAMETER(access_condition);
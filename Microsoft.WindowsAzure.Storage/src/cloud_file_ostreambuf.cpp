@@ -45,6 +45,9 @@ namespace azure { namespace storage { namespace core {
     {
         auto this_pointer = std::dynamic_pointer_cast<basic_cloud_file_ostreambuf>(shared_from_this());
         return _sync().then([this_pointer](bool) -> pplx::task<void>
+        {
+            return this_pointer->close_total_hash();
+        }).then([this_pointer]() -> pplx::task<void>
         {
             if (this_pointer->m_total_hash_provider.is_enabled())
             {
@@ -74,8 +77,16 @@ namespace azure { namespace storage { namespace core {
             {
                 try
                 {
-                    this_pointer->m_file->write_range_async(buffer->stream(), offset, buffer->content_md5(), this_pointer->m_condition, this_pointer->m_options, this_pointer->m_context).then([this_pointer](pplx::task<void> upload_task)
+                    transfer_byte_limit::acquire_async(buffer->size()).then([buffer]()
+                    {
+                        return buffer->hash_task();
+                    }).then([this_pointer, buffer, offset]() -> pplx::task<void>
+                    {
+                        return this_pointer->m_file->write_range_async_impl(buffer->stream(), offset, buffer->content_md5(), buffer->content_crc64(), this_pointer->m_condition, this_pointer->m_options, this_pointer->m_context);
+                    }).then([this_pointer, buffer](pplx::task<void> upload_task)
                     {
+                        // The buffer is captured so that it is only returned to the pool once the upload has completed.
+                        transfer_byte_limit::release(buffer->size());
                         std::lock_guard<async_semaphore> guard(this_pointer->m_semaphore, std::adopt_lock);
                         try
                         {
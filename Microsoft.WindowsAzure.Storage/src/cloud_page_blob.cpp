@@ -34,7 +34,7 @@ namespace azure { namespace storage {
         auto properties = m_properties;
 
         auto command = std::make_shared<core::storage_command<void>>(uri(), cancellation_token, modified_options.is_maximum_execution_time_customized());
-        command->set_build_request(std::bind(protocol::put_page, range, page_write::clear, utility::string_t(), condition, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+        command->set_build_request(std::bind(protocol::put_page, range, page_write::clear, utility::string_t(), utility::string_t(), condition, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
         command->set_authentication_handler(service_client().authentication_handler());
         command->set_preprocess_response([properties](const web::http::http_response& response, const request_result& result, operation_context context)
         {
@@ -47,14 +47,16 @@ namespace azure { namespace storage {
         return core::executor<void>::execute_async(command, modified_options, context);
     }
 
-    pplx::task<void> cloud_page_blob::upload_pages_async_impl(concurrency::streams::istream page_data, int64_t start_offset, const utility::string_t& content_md5, const access_condition& condition, const blob_request_options& options, operation_context context, const pplx::cancellation_token& cancellation_token, bool use_timeout, std::shared_ptr<core::timer_handler> timer_handler)
+    pplx::task<void> cloud_page_blob::upload_pages_async_impl(concurrency::streams::istream page_data, int64_t start_offset, const utility::string_t& content_md5, const utility::string_t& content_crc64, const access_condition& condition, const blob_request_options& options, operation_context context, const pplx::cancellation_token& cancellation_token, bool use_timeout, std::shared_ptr<core::timer_handler> timer_handler)
     {
         assert_no_snapshot();
         blob_request_options modified_options(options);
         modified_options.apply_defaults(service_client().default_request_options(), type());
 
         auto properties = m_properties;
-        bool needs_md5 = content_md5.empty() && modified_options.use_transactional_md5();
+        bool needs_checksum = content_md5.empty() && content_crc64.empty();
+        bool needs_md5 = needs_checksum && modified_options.use_transactional_md5() && !modified_options.use_transactional_crc64();
+        bool needs_crc64 = needs_checksum && modified_options.use_transactional_crc64();
 
         auto command = std::make_shared<core::storage_command<void>>(uri(), cancellation_token, (modified_options.is_maximum_execution_time_customized() && use_timeout), timer_handler);
         command->set_authentication_handler(service_client().authentication_handler());
@@ -66,12 +68,13 @@ namespace azure { namespace storage {
             properties->update_etag_and_last_modified(parsed_properties);
             properties->update_page_blob_sequence_number(parsed_properties);
         });
-        return core::istream_descriptor::create(page_data, needs_md5, std::numeric_limits<utility::size64_t>::max(), protocol::max_page_size, command->get_cancellation_token()).then([command, context, start_offset, content_md5, modified_options, condition, cancellation_token](core::istream_descriptor request_body) -> pplx::task<void>
+        return core::istream_descriptor::create(page_data, needs_md5, std::numeric_limits<utility::size64_t>::max(), protocol::max_page_size, command->get_cancellation_token(), needs_crc64).then([command, context, start_offset, content_md5, content_crc64, modified_options, condition, cancellation_token](core::istream_descriptor request_body) -> pplx::task<void>
         {
             const utility::string_t& md5 = content_md5.empty() ? request_body.content_md5() : content_md5;
+            const utility::string_t& crc64 = content_crc64.empty() ? request_body.content_crc64() : content_crc64;
             auto end_offset = start_offset + request_body.length() - 1;
             page_range range(start_offset, end_offset);
-            command->set_build_request(std::bind(protocol::put_page, range, page_write::update, md5, condition, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+            command->set_build_request(std::bind(protocol::put_page, range, page_write::update, md5, crc64, condition, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
             command->set_request_body(request_body);
             return core::executor<void>::execute_async(command, modified_options, context);
         });
@@ -129,6 +132,11 @@ namespace azure { namespace storage {
             }
         }
 
+        if (length % protocol::page_size_alignment != 0)
+        {
+            throw storage_exception(protocol::error_page_blob_size_not_aligned);
+        }
+
         return open_write_async_impl(length, sequence_number, condition, modified_options, context, timer_handler->get_cancellation_token(), false, timer_handler).then([source, length, timer_handler, options](concurrency::streams::ostream blob_stream) -> pplx::task<void>
         {
             return core::stream_copy_async(source, blob_stream, length, std::numeric_limits<utility::size64_t>::max(), timer_handler->get_cancellation_token(), timer_handler).then([blob_stream, timer_handler, options] (utility::size64_t) -> pplx::task<void>
@@ -140,14 +148,53 @@ namespace azure { namespace storage {
 
     pplx::task<void> cloud_page_blob::upload_from_file_async(const utility::string_t& path, int64_t sequence_number, const access_condition& condition, const blob_request_options& options, operation_context context, const pplx::cancellation_token& cancellation_token)
     {
+        assert_no_snapshot();
+        blob_request_options modified_options(options);
+        modified_options.apply_defaults(service_client().default_request_options(), type());
+
         auto instance = std::make_shared<cloud_page_blob>(*this);
-        return concurrency::streams::file_stream<uint8_t>::open_istream(path).then([instance, sequence_number, condition, options, context, cancellation_token](concurrency::streams::istream stream) -> pplx::task<void>
+        return concurrency::streams::file_stream<uint8_t>::open_istream(path).then([instance, path, sequence_number, condition, options, modified_options, context, cancellation_token](concurrency::streams::istream stream) -> pplx::task<void>
         {
-            return instance->upload_from_stream_async(stream, sequence_number, condition, options, context).then([stream](pplx::task<void> upload_task) -> pplx::task<void>
+            utility::size64_t length = core::get_remaining_stream_length(stream);
+            return stream.close().then([instance, path, length, sequence_number, condition, options, modified_options, context, cancellation_token]() -> pplx::task<void>
             {
-                return stream.close().then([upload_task]()
+                if (length == std::numeric_limits<utility::size64_t>::max())
+                {
+                    throw std::logic_error(protocol::error_page_blob_size_unknown);
+                }
+
+                // Fail before the blob is created, so a misaligned file does not leave an empty blob behind.
+                if (length % protocol::page_size_alignment != 0)
                 {
-                    upload_task.wait();
+                    throw storage_exception(protocol::error_page_blob_size_not_aligned);
+                }
+
+                auto timer_handler = std::make_shared<core::timer_handler>(cancellation_token);
+
+                if (modified_options.is_maximum_execution_time_customized())
+                {
+                    timer_handler->start_timer(options.maximum_execution_time());// azure::storage::core::timer_handler will automatically stop the timer when destructed.
+                }
+
+                return instance->create_async(length, premium_blob_tier::unknown, sequence_number, condition, modified_options, context, timer_handler->get_cancellation_token()).then([instance, path, length, condition, modified_options, context, timer_handler]() -> pplx::task<void>
+                {
+                    // Pages are read range by range straight from the file, and up to parallelism_factor ranges are read and written at the same time.
+                    auto upload_pages = [instance, condition, modified_options, context, timer_handler](concurrency::streams::istream page_data, utility::size64_t offset, const utility::string_t& content_md5, const utility::string_t& content_crc64) -> pplx::task<void>
+                    {
+                        return instance->upload_pages_async_impl(page_data, static_cast<int64_t>(offset), content_md5, content_crc64, condition, modified_options, context, timer_handler->get_cancellation_token(), false, timer_handler);
+                    };
+
+                    core::hash_provider total_hash_provider = modified_options.store_blob_content_md5() ? core::hash_provider::create_md5_hash_provider() : core::hash_provider();
+                    return core::upload_file_ranges_async(path, length, modified_options.stream_write_size_in_bytes(), modified_options.parallelism_factor(), modified_options.use_transactional_md5(), modified_options.use_transactional_crc64(), total_hash_provider, upload_pages, timer_handler->get_cancellation_token(), timer_handler).then([instance, total_hash_provider, condition, modified_options, context, timer_handler]() -> pplx::task<void>
+                    {
+                        if (total_hash_provider.is_enabled())
+                        {
+                            instance->properties().set_content_md5(total_hash_provider.hash());
+                            return instance->upload_properties_async_impl(condition, modified_options, context, timer_handler->get_cancellation_token(), false, timer_handler).then([timer_handler/*timer_handler MUST be captured*/]() {});
+                        }
+
+                        return pplx::task_from_result();
+                    });
                 });
             });
         });
@@ -242,8 +289,11 @@ namespace azure { namespace storage {
         command->set_postprocess_response([] (const web::http::http_response& response, const request_result&, const core::ostream_descriptor&, operation_context context) -> pplx::task<std::vector<page_range>>
         {
             UNREFERENCED_PARAMETER(context);
-            protocol::page_list_reader reader(response.body());
-            return pplx::task_from_result(reader.move_result());
+            auto reader = std::make_shared<protocol::page_list_reader>(response.body());
+            return reader->read_async().then([reader]() -> std::vector<page_range>
+            {
+                return reader->move_result();
+            });
         });
         return core::executor<std::vector<page_range>>::execute_async(command, modified_options, context);
     }
@@ -271,8 +321,11 @@ namespace azure { namespace storage {
         command->set_postprocess_response([](const web::http::http_response& response, const request_result&, const core::ostream_descriptor&, operation_context context) -> pplx::task<std::vector<page_diff_range>>
         {
             UNREFERENCED_PARAMETER(context);
-            protocol::page_diff_list_reader reader(response.body());
-            return pplx::task_from_result(reader.move_result());
+            auto reader = std::make_shared<protocol::page_diff_list_reader>(response.body());
+            return reader->read_async().then([reader]() -> std::vector<page_diff_range>
+            {
+                return reader->move_result();
+            });
         });
         return core::executor<std::vector<page_diff_range>>::execute_async(command, modified_options, context);
     }
@@ -22,6 +22,8 @@
 #include "wascore/resources.h"
 #include "was/queue.h"
 
+#include <atomic>
+
 namespace azure { namespace storage {
 
     cloud_queue::cloud_queue(const storage_uri& uri)
@@ -103,26 +105,112 @@ namespace azure { namespace storage {
             throw std::invalid_argument(protocol::error_large_initial_visibility_timeout);
         }
 
+        return add_message_async_impl(message, time_to_live, initial_visibility_timeout, get_modified_options(options), context);
+    }
+
+    pplx::task<std::vector<add_message_result>> cloud_queue::add_messages_async(std::vector<cloud_queue_message> messages, std::chrono::seconds time_to_live, std::chrono::seconds initial_visibility_timeout, int parallelism, const queue_request_options& options, operation_context context)
+    {
+        if ((time_to_live.count() <= 0LL) && (time_to_live.count() != -1LL))
+        {
+            throw std::invalid_argument(protocol::error_invalid_value_time_to_live);
+        }
+
+        if (initial_visibility_timeout.count() < 0LL)
+        {
+            throw std::invalid_argument(protocol::error_negative_initial_visibility_timeout);
+        }
+
+        if (initial_visibility_timeout.count() > 604800LL)
+        {
+            throw std::invalid_argument(protocol::error_large_initial_visibility_timeout);
+        }
+
+        utility::assert_in_bounds(_XPLATSTR("parallelism"), parallelism, 1);
+
+        // The options are merged once, instead of once per message.
         queue_request_options modified_options = get_modified_options(options);
 
+        auto results = std::make_shared<std::vector<add_message_result>>();
+        results->reserve(messages.size());
+        for (auto& message : messages)
+        {
+            results->push_back(add_message_result(std::move(message)));
+        }
+
+        // Each worker takes the next message that has not been sent yet, so no more than parallelism requests are in flight
+        // and no task is created for a message before it is sent.
+        auto instance = std::make_shared<cloud_queue>(*this);
+        auto next = std::make_shared<std::atomic<size_t>>(0);
+        std::vector<pplx::task<void>> workers;
+        size_t worker_count = std::min(results->size(), static_cast<size_t>(parallelism));
+        for (size_t i = 0; i < worker_count; ++i)
+        {
+            workers.push_back(pplx::details::_do_while([instance, results, next, time_to_live, initial_visibility_timeout, modified_options, context]() -> pplx::task<bool>
+            {
+                size_t index = (*next)++;
+                if (index >= results->size())
+                {
+                    return pplx::task_from_result(false);
+                }
+
+                add_message_result& result = (*results)[index];
+                pplx::task<void> add_task;
+                try
+                {
+                    add_task = instance->add_message_async_impl(result.m_message, time_to_live, initial_visibility_timeout, modified_options, context);
+                }
+                catch (...)
+                {
+                    add_task = pplx::task_from_exception<void>(std::current_exception());
+                }
+
+                return add_task.then([results, index](pplx::task<void> completed_task) -> bool
+                {
+                    try
+                    {
+                        completed_task.get();
+                    }
+                    catch (...)
+                    {
+                        (*results)[index].m_exception = std::current_exception();
+                    }
+
+                    return true;
+                });
+            }));
+        }
+
+        return pplx::when_all(workers.begin(), workers.end()).then([results]() -> std::vector<add_message_result>
+        {
+            return std::move(*results);
+        });
+    }
+
+    pplx::task<void> cloud_queue::add_message_async_impl(cloud_queue_message& message, std::chrono::seconds time_to_live, std::chrono::seconds initial_visibility_timeout, const queue_request_options& modified_options, operation_context context)
+    {
+        // The body is written once, rather than every time the request is built for a retry.
+        protocol::message_writer writer;
+        std::string content = writer.write(message);
+
         std::shared_ptr<core::storage_command<void>> command = std::make_shared<core::storage_command<void>>(queue_message_uri());
-        command->set_build_request(std::bind(protocol::add_message, message, time_to_live, initial_visibility_timeout, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+        command->set_build_request(std::bind(protocol::add_message, std::move(content), time_to_live, initial_visibility_timeout, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
         command->set_authentication_handler(service_client().authentication_handler());
         command->set_preprocess_response(std::bind(protocol::preprocess_response_void, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
         command->set_postprocess_response([&message](const web::http::http_response& response, const request_result&, const core::ostream_descriptor&, operation_context context) -> pplx::task<void>
         {
             UNREFERENCED_PARAMETER(context);
-            protocol::message_reader reader(response.body());
-            std::vector<protocol::cloud_message_list_item> queue_items = reader.move_items();
-            
-            if (!queue_items.empty())
+            auto reader = std::make_shared<protocol::message_reader>(response.body());
+            return reader->read_async().then([reader, &message]()
             {
-                protocol::cloud_message_list_item& item = queue_items.front();
-                cloud_queue_message message_info(item.move_content(), item.move_id(), item.move_pop_receipt(), item.insertion_time(), item.expiration_time(), item.next_visible_time(), item.dequeue_count());
-                message.update_message_info(message_info);
-            }
-            
-            return pplx::task_from_result();
+                std::vector<protocol::cloud_message_list_item> queue_items = reader->move_items();
+
+                if (!queue_items.empty())
+                {
+                    protocol::cloud_message_list_item& item = queue_items.front();
+                    cloud_queue_message message_info(item.move_content(), item.move_id(), item.move_pop_receipt(), item.insertion_time(), item.expiration_time(), item.next_visible_time(), item.dequeue_count());
+                    message.update_message_info(message_info);
+                }
+            });
         });
         return core::executor<void>::execute_async(command, modified_options, context);
     }
@@ -148,24 +236,26 @@ namespace azure { namespace storage {
         command->set_postprocess_response([] (const web::http::http_response& response, const request_result&, const core::ostream_descriptor&, operation_context context) -> pplx::task<cloud_queue_message>
         {
             UNREFERENCED_PARAMETER(context);
-            protocol::message_reader reader(response.body());
-            std::vector<protocol::cloud_message_list_item> queue_items = reader.move_items();
-
-            if (!queue_items.empty())
+            auto reader = std::make_shared<protocol::message_reader>(response.body());
+            return reader->read_async().then([reader]() -> cloud_queue_message
             {
-                protocol::cloud_message_list_item& item = queue_items.front();
-                cloud_queue_message message(item.move_content(), item.move_id(), item.move_pop_receipt(), item.insertion_time(), item.expiration_time(), item.next_visible_time(), item.dequeue_count());
-                return pplx::task_from_result(message);
-            }
+                std::vector<protocol::cloud_message_list_item> queue_items = reader->move_items();
+
+                if (!queue_items.empty())
+                {
+                    protocol::cloud_message_list_item& item = queue_items.front();
+                    return cloud_queue_message(item.move_content(), item.move_id(), item.move_pop_receipt(), item.insertion_time(), item.expiration_time(), item.next_visible_time(), item.dequeue_count());
+                }
 
-            return pplx::task_from_result(cloud_queue_message());
+                return cloud_queue_message();
+            });
         });
         return core::executor<cloud_queue_message>::execute_async(command, modified_options, context);
     }
 
     pplx::task<std::vector<cloud_queue_message>> cloud_queue::get_messages_async(size_t message_count, std::chrono::seconds visibility_timeout, queue_request_options& options, operation_context context)
     {
-        if (message_count > 32U)
+        if (message_count > protocol::max_get_messages_count)
         {
             throw std::invalid_argument(protocol::error_large_message_count);
         }
@@ -189,19 +279,22 @@ namespace azure { namespace storage {
         command->set_postprocess_response([] (const web::http::http_response& response, const request_result&, const core::ostream_descriptor&, operation_context context) -> pplx::task<std::vector<cloud_queue_message>>
         {
             UNREFERENCED_PARAMETER(context);
-            protocol::message_reader reader(response.body());
-            std::vector<protocol::cloud_message_list_item> queue_items = reader.move_items();
+            auto reader = std::make_shared<protocol::message_reader>(response.body());
+            return reader->read_async().then([reader]() -> std::vector<cloud_queue_message>
+            {
+                std::vector<protocol::cloud_message_list_item> queue_items = reader->move_items();
 
-            std::vector<cloud_queue_message> results;
-            results.reserve(queue_items.size());
+                std::vector<cloud_queue_message> results;
+                results.reserve(queue_items.size());
 
-            for (std::vector<protocol::cloud_message_list_item>::iterator it = queue_items.begin(); it != queue_items.end(); ++it)
-            {
-                cloud_queue_message message(it->move_content(), it->move_id(), it->move_pop_receipt(), it->insertion_time(), it->expiration_time(), it->next_visible_time(), it->dequeue_count());
-                results.push_back(message);
-            }
+                for (std::vector<protocol::cloud_message_list_item>::iterator it = queue_items.begin(); it != queue_items.end(); ++it)
+                {
+                    cloud_queue_message message(it->move_content(), it->move_id(), it->move_pop_receipt(), it->insertion_time(), it->expiration_time(), it->next_visible_time(), it->dequeue_count());
+                    results.push_back(std::move(message));
+                }
 
-            return pplx::task_from_result(results);
+                return results;
+            });
         });
         return core::executor<std::vector<cloud_queue_message>>::execute_async(command, modified_options, context);
     }
@@ -217,17 +310,19 @@ namespace azure { namespace storage {
         command->set_postprocess_response([] (const web::http::http_response& response, const request_result&, const core::ostream_descriptor&, operation_context context) -> pplx::task<cloud_queue_message>
         {
             UNREFERENCED_PARAMETER(context);
-            protocol::message_reader reader(response.body());
-            std::vector<protocol::cloud_message_list_item> queue_items = reader.move_items();
-
-            if (!queue_items.empty())
+            auto reader = std::make_shared<protocol::message_reader>(response.body());
+            return reader->read_async().then([reader]() -> cloud_queue_message
             {
-                protocol::cloud_message_list_item& item = queue_items.front();
-                cloud_queue_message message(item.move_content(), item.move_id(), item.move_pop_receipt(), item.insertion_time(), item.expiration_time(), item.next_visible_time(), item.dequeue_count());
-                return pplx::task_from_result(message);
-            }
+                std::vector<protocol::cloud_message_list_item> queue_items = reader->move_items();
+
+                if (!queue_items.empty())
+                {
+                    protocol::cloud_message_list_item& item = queue_items.front();
+                    return cloud_queue_message(item.move_content(), item.move_id(), item.move_pop_receipt(), item.insertion_time(), item.expiration_time(), item.next_visible_time(), item.dequeue_count());
+                }
 
-            return pplx::task_from_result(cloud_queue_message());
+                return cloud_queue_message();
+            });
         });
         return core::executor<cloud_queue_message>::execute_async(command, modified_options, context);
     }
@@ -243,19 +338,22 @@ namespace azure { namespace storage {
         command->set_postprocess_response([] (const web::http::http_response& response, const request_result&, const core::ostream_descriptor&, operation_context context) -> pplx::task<std::vector<cloud_queue_message>>
         {
             UNREFERENCED_PARAMETER(context);
-            protocol::message_reader reader(response.body());
-            std::vector<protocol::cloud_message_list_item> queue_items = reader.move_items();
+            auto reader = std::make_shared<protocol::message_reader>(response.body());
+            return reader->read_async().then([reader]() -> std::vector<cloud_queue_message>
+            {
+                std::vector<protocol::cloud_message_list_item> queue_items = reader->move_items();
 
-            std::vector<cloud_queue_message> results;
-            results.reserve(queue_items.size());
+                std::vector<cloud_queue_message> results;
+                results.reserve(queue_items.size());
 
-            for (std::vector<protocol::cloud_message_list_item>::iterator it = queue_items.begin(); it != queue_items.end(); ++it)
-            {
-                cloud_queue_message message(it->move_content(), it->move_id(), it->move_pop_receipt(), it->insertion_time(), it->expiration_time(), it->next_visible_time(), it->dequeue_count());
-                results.push_back(message);
-            }
+                for (std::vector<protocol::cloud_message_list_item>::iterator it = queue_items.begin(); it != queue_items.end(); ++it)
+                {
+                    cloud_queue_message message(it->move_content(), it->move_id(), it->move_pop_receipt(), it->insertion_time(), it->expiration_time(), it->next_visible_time(), it->dequeue_count());
+                    results.push_back(std::move(message));
+                }
 
-            return pplx::task_from_result(results);
+                return results;
+            });
         });
         return core::executor<std::vector<cloud_queue_message>>::execute_async(command, modified_options, context);
     }
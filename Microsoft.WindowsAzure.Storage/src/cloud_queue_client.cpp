@@ -36,9 +36,9 @@ namespace azure { namespace storage {
         return queue_result_iterator(
             [instance, prefix, get_metadata, options, context](const continuation_token& token, size_t max_results_per_segment)
         {
-            return instance->list_queues_segmented(prefix, get_metadata, (int)max_results_per_segment, token, options, context);
+            return instance->list_queues_segmented_async(prefix, get_metadata, (int)max_results_per_segment, token, options, context);
         },
-            max_results, 0);
+            max_results, 0, options.segment_prefetch_depth());
     }
 
     pplx::task<queue_result_segment> cloud_queue_client::list_queues_segmented_async(const utility::string_t& prefix, bool get_metadata, int max_results, const continuation_token& token, const queue_request_options& options, operation_context context) const
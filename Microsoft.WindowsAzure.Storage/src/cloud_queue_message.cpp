@@ -16,12 +16,34 @@
 // -----------------------------------------------------------------------------------------
 
 #include "stdafx.h"
+#include "wascore/base64.h"
 #include "was/queue.h"
 
 namespace azure { namespace storage {
 
     const std::chrono::seconds max_time_to_live(std::chrono::system_clock::duration::max().count());
 
+    const utility::string_t cloud_queue_message::content_as_string() const
+    {
+        if (m_is_binary)
+        {
+            return core::to_base64(m_binary_content.data(), m_binary_content.size());
+        }
+
+        return m_content;
+    }
+
+    const std::vector<uint8_t> cloud_queue_message::content_as_binary() const
+    {
+        if (m_is_binary)
+        {
+            return m_binary_content;
+        }
+
+        // Received messages always hold text, which is decoded straight into the result.
+        return core::from_base64(m_content);
+    }
+
     void cloud_queue_message::update_message_info(const cloud_queue_message& message_metadata)
     {
         m_id = message_metadata.m_id;
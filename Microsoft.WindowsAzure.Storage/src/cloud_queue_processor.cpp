@@ -0,0 +1,436 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="cloud_queue_processor.cpp" company="Microsoft">
+//    Copyright 2013 Microsoft Corporation
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "wascore/async_semaphore.h"
+#include "wascore/constants.h"
+#include "wascore/resources.h"
+#include "wascore/util.h"
+#include "was/queue.h"
+
+#include <atomic>
+
+namespace azure { namespace storage {
+
+    class cloud_queue_processor::processor_state : public std::enable_shared_from_this<processor_state>
+    {
+    public:
+
+        processor_state(cloud_queue queue, message_handler handler, const queue_processor_options& processor_options, const queue_request_options& options, operation_context context)
+            : m_queue(std::move(queue)), m_handler(std::move(handler)), m_processor_options(processor_options), m_options(options), m_context(context),
+            m_handler_slots(processor_options.handler_parallelism()),
+            m_receive_size(std::min(processor_options.messages_per_receive(), static_cast<size_t>(processor_options.handler_parallelism()))),
+            m_renewal_interval(std::chrono::duration_cast<std::chrono::milliseconds>(processor_options.visibility_timeout()) / 2),
+            m_stopping(false), m_drained(false), m_started(false), m_renewal_loop(pplx::task_from_result()), m_next_key(0),
+            m_receive_count(0), m_empty_receive_count(0), m_failed_receive_count(0), m_received_count(0), m_processed_count(0), m_failed_count(0),
+            m_deleted_count(0), m_failed_delete_count(0), m_visibility_update_count(0), m_failed_visibility_update_count(0),
+            m_total_handler_latency(0), m_max_handler_latency(0)
+        {
+        }
+
+        void start()
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            if (m_started)
+            {
+                throw std::runtime_error(protocol::error_queue_processor_started);
+            }
+
+            m_started = true;
+            m_start_time = std::chrono::steady_clock::now();
+            m_stop_time = m_start_time;
+
+            // The first iteration of each loop only schedules work, so none of them takes the mutex on this thread.
+            for (int i = 0; i < m_processor_options.receive_loops(); ++i)
+            {
+                m_receive_loops.push_back(receive_loop());
+            }
+
+            m_renewal_loop = renewal_loop();
+        }
+
+        pplx::task<void> stop()
+        {
+            std::vector<pplx::task<void>> receive_loops;
+            pplx::task<void> renewal_loop;
+            {
+                std::lock_guard<std::mutex> guard(m_mutex);
+                if (!m_stopping)
+                {
+                    m_stopping = true;
+                    m_stop_time = std::chrono::steady_clock::now();
+                    m_stop_event.set();
+                }
+
+                // A processor that is stopped before it is started cannot be started later.
+                m_started = true;
+                receive_loops = m_receive_loops;
+                renewal_loop = m_renewal_loop;
+            }
+
+            auto state = shared_from_this();
+            return pplx::when_all(receive_loops.begin(), receive_loops.end()).then([state]()
+            {
+                // No handler is dispatched once the receive loops have ended, so every slot is free again when the last handler returns.
+                return state->m_handler_slots.wait_all_async();
+            }).then([state, renewal_loop]()
+            {
+                state->m_drained = true;
+                state->m_drained_event.set();
+                return renewal_loop;
+            }).then([state]()
+            {
+                std::vector<pplx::task<void>> deletes;
+                {
+                    std::lock_guard<std::mutex> guard(state->m_mutex);
+                    deletes = state->m_deletes;
+                }
+
+                return pplx::when_all(deletes.begin(), deletes.end());
+            });
+        }
+
+        queue_processor_statistics statistics()
+        {
+            queue_processor_statistics result;
+            result.m_receive_count = m_receive_count;
+            result.m_empty_receive_count = m_empty_receive_count;
+            result.m_failed_receive_count = m_failed_receive_count;
+            result.m_received_count = m_received_count;
+            result.m_processed_count = m_processed_count;
+            result.m_failed_count = m_failed_count;
+            result.m_deleted_count = m_deleted_count;
+            result.m_failed_delete_count = m_failed_delete_count;
+            result.m_visibility_update_count = m_visibility_update_count;
+            result.m_failed_visibility_update_count = m_failed_visibility_update_count;
+            result.m_total_handler_latency = std::chrono::microseconds(m_total_handler_latency);
+            result.m_max_handler_latency = std::chrono::microseconds(m_max_handler_latency);
+
+            std::lock_guard<std::mutex> guard(m_mutex);
+            if (m_started)
+            {
+                auto end_time = m_stopping ? m_stop_time : std::chrono::steady_clock::now();
+                result.m_elapsed_time = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - m_start_time);
+            }
+
+            return result;
+        }
+
+    private:
+
+        struct in_flight_message
+        {
+            in_flight_message(utility::string_t id, utility::string_t pop_receipt, std::chrono::steady_clock::time_point renew_at)
+                : m_id(std::move(id)), m_pop_receipt(std::move(pop_receipt)), m_renew_at(renew_at), m_update(pplx::task_from_result())
+            {
+            }
+
+            utility::string_t m_id;
+            // Only written by the continuation of m_update, and only read once m_update has completed.
+            utility::string_t m_pop_receipt;
+            std::chrono::steady_clock::time_point m_renew_at;
+            pplx::task<void> m_update;
+        };
+
+        pplx::task<void> receive_loop()
+        {
+            auto state = shared_from_this();
+            auto backoff = std::make_shared<std::chrono::milliseconds>(std::chrono::milliseconds::zero());
+            return pplx::details::_do_while([state, backoff]() -> pplx::task<bool>
+            {
+                if (state->m_stopping)
+                {
+                    return pplx::task_from_result(false);
+                }
+
+                // Slots for a full request are taken before receiving, so that received messages never wait for a handler while their visibility timeout runs.
+                size_t receive_size = state->m_receive_size;
+                return state->m_handler_slots.lock_async(static_cast<int64_t>(receive_size)).then([state, backoff, receive_size]() -> pplx::task<bool>
+                {
+                    if (state->m_stopping)
+                    {
+                        state->m_handler_slots.unlock(static_cast<int64_t>(receive_size));
+                        return pplx::task_from_result(false);
+                    }
+
+                    queue_request_options options(state->m_options);
+                    return state->m_queue.get_messages_async(receive_size, state->m_processor_options.visibility_timeout(), options, state->m_context).then([state, backoff, receive_size](pplx::task<std::vector<cloud_queue_message>> receive_task) -> pplx::task<bool>
+                    {
+                        std::vector<cloud_queue_message> messages;
+                        try
+                        {
+                            messages = receive_task.get();
+                            ++state->m_receive_count;
+                            if (messages.empty())
+                            {
+                                ++state->m_empty_receive_count;
+                            }
+                        }
+                        catch (...)
+                        {
+                            // The executor has already retried the request, so a failure is treated like an empty queue and backs off.
+                            ++state->m_failed_receive_count;
+                        }
+
+                        state->m_handler_slots.unlock(static_cast<int64_t>(receive_size - messages.size()));
+                        for (auto& message : messages)
+                        {
+                            state->dispatch(std::move(message));
+                        }
+
+                        if (!messages.empty())
+                        {
+                            *backoff = std::chrono::milliseconds::zero();
+                            return pplx::task_from_result(true);
+                        }
+
+                        *backoff = backoff->count() == 0 ? state->m_processor_options.min_backoff() : std::min(*backoff * 2, state->m_processor_options.max_backoff());
+
+                        // Stopping the processor ends the wait early.
+                        return (core::complete_after(*backoff) || pplx::create_task(state->m_stop_event)).then([]() -> bool
+                        {
+                            return true;
+                        });
+                    });
+                });
+            });
+        }
+
+        pplx::task<void> renewal_loop()
+        {
+            // Checking twice per renewal interval extends each message well before it becomes visible again.
+            auto state = shared_from_this();
+            return pplx::details::_do_while([state]() -> pplx::task<bool>
+            {
+                return (core::complete_after(state->m_renewal_interval / 2) || pplx::create_task(state->m_drained_event)).then([state]() -> bool
+                {
+                    if (state->m_drained)
+                    {
+                        return false;
+                    }
+
+                    state->renew_expiring();
+                    return true;
+                });
+            });
+        }
+
+        void dispatch(cloud_queue_message message)
+        {
+            ++m_received_count;
+
+            auto start_time = std::chrono::steady_clock::now();
+            auto entry = std::make_shared<in_flight_message>(message.id(), message.pop_receipt(), start_time + m_renewal_interval);
+            uint64_t key;
+            {
+                std::lock_guard<std::mutex> guard(m_mutex);
+                key = m_next_key++;
+                m_messages.insert(std::make_pair(key, entry));
+            }
+
+            auto state = shared_from_this();
+            auto handled_message = std::make_shared<cloud_queue_message>(std::move(message));
+            pplx::create_task([state, handled_message]()
+            {
+                state->m_handler(*handled_message);
+            }).then([state, key, start_time](pplx::task<void> handler_task)
+            {
+                bool succeeded = true;
+                try
+                {
+                    handler_task.get();
+                    ++state->m_processed_count;
+                }
+                catch (...)
+                {
+                    succeeded = false;
+                    ++state->m_failed_count;
+                }
+
+                state->record_latency(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_time).count());
+
+                // The delete is tracked before the slot is returned, so that stopping the processor also waits for it.
+                state->complete(key, succeeded);
+                state->m_handler_slots.unlock();
+            });
+        }
+
+        void complete(uint64_t key, bool succeeded)
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            auto existing = m_messages.find(key);
+            auto entry = existing->second;
+            m_messages.erase(existing);
+
+            if (!succeeded)
+            {
+                // The message becomes visible again when its current visibility timeout expires.
+                return;
+            }
+
+            // The delete waits for a visibility update that is still running, because it needs the pop receipt returned by the update.
+            auto state = shared_from_this();
+            track(entry->m_update.then([state, entry]()
+            {
+                cloud_queue_message message(entry->m_id, entry->m_pop_receipt);
+                queue_request_options options(state->m_options);
+                return state->m_queue.delete_message_async(message, options, state->m_context);
+            }).then([state](pplx::task<void> delete_task)
+            {
+                try
+                {
+                    delete_task.get();
+                    ++state->m_deleted_count;
+                }
+                catch (...)
+                {
+                    ++state->m_failed_delete_count;
+                }
+            }));
+        }
+
+        void renew_expiring()
+        {
+            auto now = std::chrono::steady_clock::now();
+            auto state = shared_from_this();
+            std::lock_guard<std::mutex> guard(m_mutex);
+            for (auto& pending : m_messages)
+            {
+                auto entry = pending.second;
+                if (entry->m_renew_at > now || !entry->m_update.is_done())
+                {
+                    continue;
+                }
+
+                // The update reports the new pop receipt through the message, so the message is kept alive until the update completes.
+                entry->m_renew_at = now + m_renewal_interval;
+                auto message = std::make_shared<cloud_queue_message>(entry->m_id, entry->m_pop_receipt);
+                queue_request_options options(m_options);
+                entry->m_update = m_queue.update_message_async(*message, m_processor_options.visibility_timeout(), /* update_content */ false, options, m_context).then([state, entry, message](pplx::task<void> update_task)
+                {
+                    try
+                    {
+                        update_task.get();
+                        entry->m_pop_receipt = message->pop_receipt();
+                        ++state->m_visibility_update_count;
+                    }
+                    catch (...)
+                    {
+                        ++state->m_failed_visibility_update_count;
+                    }
+                });
+            }
+        }
+
+        void record_latency(int64_t latency)
+        {
+            m_total_handler_latency += latency;
+            int64_t max_latency = m_max_handler_latency.load();
+            while (latency > max_latency && !m_max_handler_latency.compare_exchange_weak(max_latency, latency))
+            {
+            }
+        }
+
+        // Must be called with m_mutex held.
+        void track(pplx::task<void> task)
+        {
+            m_deletes.erase(std::remove_if(m_deletes.begin(), m_deletes.end(), [](const pplx::task<void>& t) { return t.is_done(); }), m_deletes.end());
+            m_deletes.push_back(task);
+        }
+
+        cloud_queue m_queue;
+        message_handler m_handler;
+        queue_processor_options m_processor_options;
+        queue_request_options m_options;
+        operation_context m_context;
+        core::async_semaphore m_handler_slots;
+        size_t m_receive_size;
+        std::chrono::milliseconds m_renewal_interval;
+
+        std::atomic<bool> m_stopping;
+        std::atomic<bool> m_drained;
+        pplx::task_completion_event<void> m_stop_event;
+        pplx::task_completion_event<void> m_drained_event;
+
+        std::mutex m_mutex;
+        bool m_started;
+        std::chrono::steady_clock::time_point m_start_time;
+        std::chrono::steady_clock::time_point m_stop_time;
+        std::vector<pplx::task<void>> m_receive_loops;
+        pplx::task<void> m_renewal_loop;
+        std::unordered_map<uint64_t, std::shared_ptr<in_flight_message>> m_messages;
+        std::vector<pplx::task<void>> m_deletes;
+        uint64_t m_next_key;
+
+        std::atomic<utility::size64_t> m_receive_count;
+        std::atomic<utility::size64_t> m_empty_receive_count;
+        std::atomic<utility::size64_t> m_failed_receive_count;
+        std::atomic<utility::size64_t> m_received_count;
+        std::atomic<utility::size64_t> m_processed_count;
+        std::atomic<utility::size64_t> m_failed_count;
+        std::atomic<utility::size64_t> m_deleted_count;
+        std::atomic<utility::size64_t> m_failed_delete_count;
+        std::atomic<utility::size64_t> m_visibility_update_count;
+        std::atomic<utility::size64_t> m_failed_visibility_update_count;
+        std::atomic<int64_t> m_total_handler_latency;
+        std::atomic<int64_t> m_max_handler_latency;
+    };
+
+    cloud_queue_processor::cloud_queue_processor(cloud_queue queue, message_handler handler)
+        : cloud_queue_processor(std::move(queue), std::move(handler), queue_processor_options(), queue_request_options(), operation_context())
+    {
+    }
+
+    cloud_queue_processor::cloud_queue_processor(cloud_queue queue, message_handler handler, const queue_processor_options& processor_options, const queue_request_options& options, operation_context context)
+    {
+        if (!handler)
+        {
+            throw std::invalid_argument("handler");
+        }
+
+        utility::assert_in_bounds(_XPLATSTR("receive_loops"), processor_options.receive_loops(), 1);
+        utility::assert_in_bounds<size_t>(_XPLATSTR("messages_per_receive"), processor_options.messages_per_receive(), 1, protocol::max_get_messages_count);
+        utility::assert_in_bounds(_XPLATSTR("handler_parallelism"), processor_options.handler_parallelism(), 1);
+        utility::assert_in_bounds(_XPLATSTR("visibility_timeout"), processor_options.visibility_timeout(), std::chrono::seconds(1), std::chrono::seconds(604800));
+        utility::assert_in_bounds(_XPLATSTR("min_backoff"), processor_options.min_backoff(), std::chrono::milliseconds(1));
+        utility::assert_in_bounds(_XPLATSTR("max_backoff"), processor_options.max_backoff(), processor_options.min_backoff());
+
+        m_state = std::make_shared<processor_state>(std::move(queue), std::move(handler), processor_options, options, context);
+    }
+
+    cloud_queue_processor::~cloud_queue_processor()
+    {
+        // The loops keep the state alive, so they must be told to end. Running handlers and deletes still complete in the background.
+        m_state->stop();
+    }
+
+    void cloud_queue_processor::start()
+    {
+        m_state->start();
+    }
+
+    pplx::task<void> cloud_queue_processor::stop_async()
+    {
+        return m_state->stop();
+    }
+
+    queue_processor_statistics cloud_queue_processor::statistics() const
+    {
+        return m_state->statistics();
+    }
+
+}} // namespace azure::storage
@@ -24,6 +24,8 @@
 #include "wascore/util.h"
 #include "was/table.h"
 
+#include <atomic>
+
 namespace azure { namespace storage {
 
     const utility::string_t query_comparison_operator::equal = _XPLATSTR("eq");
@@ -100,6 +102,48 @@ namespace azure { namespace storage {
     }
 
     pplx::task<table_result> cloud_table::execute_async(const table_operation& operation, const table_request_options& options, operation_context context) const
+    {
+        return execute_async_impl(operation, nullptr, options, context);
+    }
+
+    pplx::task<table_result> cloud_table::execute_async(table_operation_type operation_type, const compact_table_entity& entity, const table_request_options& options, operation_context context) const
+    {
+        // The operation only carries the keys and the ETag, which are used for the URI and the If-Match header.
+        table_entity keys(entity.partition_key(), entity.row_key());
+        keys.set_etag(entity.etag());
+
+        std::shared_ptr<const std::string> body;
+        switch (operation_type)
+        {
+        case table_operation_type::delete_operation:
+            return execute_async_impl(table_operation::delete_entity(std::move(keys)), nullptr, options, context);
+
+        case table_operation_type::insert_operation:
+            body = std::make_shared<std::string>(protocol::generate_compact_json_body(entity));
+            return execute_async_impl(table_operation::insert_entity(std::move(keys)), body, options, context);
+
+        case table_operation_type::insert_or_merge_operation:
+            body = std::make_shared<std::string>(protocol::generate_compact_json_body(entity));
+            return execute_async_impl(table_operation::insert_or_merge_entity(std::move(keys)), body, options, context);
+
+        case table_operation_type::insert_or_replace_operation:
+            body = std::make_shared<std::string>(protocol::generate_compact_json_body(entity));
+            return execute_async_impl(table_operation::insert_or_replace_entity(std::move(keys)), body, options, context);
+
+        case table_operation_type::merge_operation:
+            body = std::make_shared<std::string>(protocol::generate_compact_json_body(entity));
+            return execute_async_impl(table_operation::merge_entity(std::move(keys)), body, options, context);
+
+        case table_operation_type::replace_operation:
+            body = std::make_shared<std::string>(protocol::generate_compact_json_body(entity));
+            return execute_async_impl(table_operation::replace_entity(std::move(keys)), body, options, context);
+
+        default:
+            throw std::invalid_argument(protocol::error_compact_entity_retrieve);
+        }
+    }
+
+    pplx::task<table_result> cloud_table::execute_async_impl(const table_operation& operation, std::shared_ptr<const std::string> compact_body, const table_request_options& options, operation_context context) const
     {
         table_request_options modified_options = get_modified_options(options);
         storage_uri uri = protocol::generate_table_uri(service_client(), *this, operation);
@@ -108,7 +152,14 @@ namespace azure { namespace storage {
         bool allow_not_found = operation.operation_type() == table_operation_type::retrieve_operation;
 
         std::shared_ptr<core::storage_command<table_result>> command = std::make_shared<core::storage_command<table_result>>(uri);
-        command->set_build_request(std::bind(protocol::execute_operation, operation, modified_options.payload_format(), std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+        if (compact_body != nullptr)
+        {
+            command->set_build_request(std::bind(protocol::execute_compact_operation, operation, compact_body, modified_options.payload_format(), std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+        }
+        else
+        {
+            command->set_build_request(std::bind(protocol::execute_operation, operation, modified_options.payload_format(), std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+        }
         command->set_authentication_handler(service_client().authentication_handler());
         command->set_location_mode(operation.operation_type() == azure::storage::table_operation_type::retrieve_operation ? core::command_location_mode::primary_or_secondary : core::command_location_mode::primary_only);
         command->set_preprocess_response([allow_not_found] (const web::http::http_response& response, const request_result& result, operation_context context) -> table_result
@@ -216,11 +267,11 @@ namespace azure { namespace storage {
     {
         auto instance = std::make_shared<cloud_table>(*this);
         return table_query_iterator(
-            [instance, &query, options, context](const continuation_token& token, size_t)
+            [instance, query, options, context](const continuation_token& token, size_t)
         {
-            return instance->execute_query_segmented(query, token, options, context);
+            return instance->execute_query_segmented_async(query, token, options, context);
         },
-            query.take_count() <= 0 ? 0 : query.take_count(), 0);
+            query.take_count() <= 0 ? 0 : query.take_count(), 0, options.segment_prefetch_depth());
     }
 
     pplx::task<table_query_segment> cloud_table::execute_query_segmented_async(const table_query& query, const continuation_token& token, const table_request_options& options, operation_context context) const
@@ -238,15 +289,353 @@ namespace azure { namespace storage {
             UNREFERENCED_PARAMETER(context);
             continuation_token next_token = protocol::table_response_parsers::parse_continuation_token(response, result);
 
-            return response.extract_json().then([next_token] (const web::json::value& obj) -> table_query_segment
+            // The body is parsed as it is into entities, without building a JSON document first.
+            return response.extract_vector().then([next_token] (const std::vector<unsigned char>& body) -> table_query_segment
             {
-                table_query_segment query_segment(protocol::table_response_parsers::parse_query_results(obj), std::move(next_token));
+                protocol::table_query_reader reader(reinterpret_cast<const char*>(body.data()), body.size());
+                table_query_segment query_segment(reader.move_entities(), std::move(next_token));
                 return query_segment;
             });
         });
         return core::executor<table_query_segment>::execute_async(command, modified_options, context);
     }
 
+    namespace
+    {
+        // Keeps the schema of the last segment read by a compact query iterator, so that the next segment starts from it.
+        class compact_schema_holder
+        {
+        public:
+
+            std::shared_ptr<const table_entity_schema> get()
+            {
+                std::lock_guard<std::mutex> guard(m_mutex);
+                return m_schema;
+            }
+
+            void set(std::shared_ptr<const table_entity_schema> schema)
+            {
+                std::lock_guard<std::mutex> guard(m_mutex);
+                m_schema = std::move(schema);
+            }
+
+        private:
+
+            std::mutex m_mutex;
+            std::shared_ptr<const table_entity_schema> m_schema;
+        };
+    }
+
+    compact_table_query_iterator cloud_table::execute_compact_query(const table_query& query, const table_request_options& options, operation_context context) const
+    {
+        auto instance = std::make_shared<cloud_table>(*this);
+        auto schema = std::make_shared<compact_schema_holder>();
+        return compact_table_query_iterator(
+            [instance, query, schema, options, context](const continuation_token& token, size_t)
+        {
+            return instance->execute_compact_query_segmented_async(query, token, schema->get(), options, context).then([schema](compact_table_query_segment segment) -> compact_table_query_segment
+            {
+                if (!segment.results().empty())
+                {
+                    schema->set(segment.results().back().schema());
+                }
+
+                return segment;
+            });
+        },
+            query.take_count() <= 0 ? 0 : query.take_count(), 0, options.segment_prefetch_depth());
+    }
+
+    pplx::task<compact_table_query_segment> cloud_table::execute_compact_query_segmented_async(const table_query& query, const continuation_token& token, std::shared_ptr<const table_entity_schema> schema, const table_request_options& options, operation_context context) const
+    {
+        table_request_options modified_options = get_modified_options(options);
+        storage_uri uri = protocol::generate_table_uri(service_client(), *this, query, token);
+
+        std::shared_ptr<core::storage_command<compact_table_query_segment>> command = std::make_shared<core::storage_command<compact_table_query_segment>>(uri);
+        command->set_build_request(std::bind(protocol::execute_query, modified_options.payload_format(), std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+        command->set_authentication_handler(service_client().authentication_handler());
+        command->set_location_mode(core::command_location_mode::primary_or_secondary, token.target_location());
+        command->set_preprocess_response(std::bind(protocol::preprocess_response<compact_table_query_segment>, compact_table_query_segment(), std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+        command->set_postprocess_response([schema] (const web::http::http_response& response, const request_result& result, const core::ostream_descriptor&, operation_context context) -> pplx::task<compact_table_query_segment>
+        {
+            UNREFERENCED_PARAMETER(context);
+            continuation_token next_token = protocol::table_response_parsers::parse_continuation_token(response, result);
+
+            return response.extract_vector().then([next_token, schema] (const std::vector<unsigned char>& body) -> compact_table_query_segment
+            {
+                std::shared_ptr<const table_entity_schema> segment_schema = schema;
+                protocol::table_query_reader reader(reinterpret_cast<const char*>(body.data()), body.size());
+                compact_table_query_segment query_segment(reader.move_compact_entities(segment_schema), std::move(next_token));
+                return query_segment;
+            });
+        });
+        return core::executor<compact_table_query_segment>::execute_async(command, modified_options, context);
+    }
+
+    pplx::task<continuation_token> cloud_table::execute_mapped_query_segmented_async(const table_query& query, const continuation_token& token, std::shared_ptr<const table_column_mapping> mapping, std::function<void()> clear_objects, std::function<void*()> add_object, const table_request_options& options, operation_context context) const
+    {
+        // Only the mapped columns are requested.
+        table_query mapped_query(query);
+        mapped_query.set_select_columns(mapping->select_columns());
+
+        table_request_options modified_options = get_modified_options(options);
+        storage_uri uri = protocol::generate_table_uri(service_client(), *this, mapped_query, token);
+
+        std::shared_ptr<core::storage_command<continuation_token>> command = std::make_shared<core::storage_command<continuation_token>>(uri);
+        command->set_build_request(std::bind(protocol::execute_query, modified_options.payload_format(), std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+        command->set_authentication_handler(service_client().authentication_handler());
+        command->set_location_mode(core::command_location_mode::primary_or_secondary, token.target_location());
+        command->set_preprocess_response(std::bind(protocol::preprocess_response<continuation_token>, continuation_token(), std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+        command->set_postprocess_response([mapping, clear_objects, add_object] (const web::http::http_response& response, const request_result& result, const core::ostream_descriptor&, operation_context context) -> pplx::task<continuation_token>
+        {
+            UNREFERENCED_PARAMETER(context);
+            continuation_token next_token = protocol::table_response_parsers::parse_continuation_token(response, result);
+
+            return response.extract_vector().then([next_token, mapping, clear_objects, add_object] (const std::vector<unsigned char>& body) -> continuation_token
+            {
+                // A retried request reads its response again from the start.
+                clear_objects();
+
+                protocol::table_query_reader reader(reinterpret_cast<const char*>(body.data()), body.size());
+                reader.move_mapped_entities(*mapping, add_object);
+                return next_token;
+            });
+        });
+        return core::executor<continuation_token>::execute_async(command, modified_options, context);
+    }
+
+    namespace
+    {
+        struct parallel_query_state
+        {
+            parallel_query_state()
+                : m_next_range(0), m_failed(false)
+            {
+            }
+
+            void set_exception(std::exception_ptr exception)
+            {
+                std::lock_guard<std::mutex> guard(m_mutex);
+                if (m_exception == nullptr)
+                {
+                    m_exception = exception;
+                }
+
+                m_failed = true;
+            }
+
+            std::vector<table_query> m_queries;
+            std::function<void(const std::vector<table_entity>&)> m_segment_handler;
+            std::atomic<size_t> m_next_range;
+            std::atomic<bool> m_failed;
+            std::mutex m_mutex;
+            std::exception_ptr m_exception;
+        };
+
+        // Returns the first PartitionKey at or after lower_bound, following continuation tokens over empty segments.
+        pplx::task<std::pair<bool, utility::string_t>> first_partition_key_async(std::shared_ptr<cloud_table> instance, const utility::string_t& lower_bound, const table_request_options& options, operation_context context)
+        {
+            table_query query;
+            query.set_take_count(1);
+            query.set_select_columns(std::vector<utility::string_t> { _XPLATSTR("PartitionKey") });
+            if (!lower_bound.empty())
+            {
+                query.set_filter_string(table_query::generate_filter_condition(_XPLATSTR("PartitionKey"), query_comparison_operator::greater_than_or_equal, lower_bound));
+            }
+
+            auto token = std::make_shared<continuation_token>();
+            auto result = std::make_shared<std::pair<bool, utility::string_t>>(false, utility::string_t());
+            return pplx::details::_do_while([instance, query, token, result, options, context]() -> pplx::task<bool>
+            {
+                return instance->execute_query_segmented_async(query, *token, options, context).then([token, result](table_query_segment segment) -> bool
+                {
+                    if (!segment.results().empty())
+                    {
+                        *result = std::make_pair(true, segment.results().front().partition_key());
+                        return false;
+                    }
+
+                    *token = segment.continuation_token();
+                    return !token->empty();
+                });
+            }).then([result](bool) -> std::pair<bool, utility::string_t>
+            {
+                return *result;
+            });
+        }
+
+        // Split points are computed on the first key_digits characters, each mapped to one of the 95 printable ASCII characters.
+        const int key_digits = 8;
+        const uint64_t key_base = 95;
+
+        uint64_t key_to_number(const utility::string_t& key)
+        {
+            uint64_t number = 0;
+            for (int i = 0; i < key_digits; ++i)
+            {
+                uint64_t digit = 0;
+                if (static_cast<size_t>(i) < key.size())
+                {
+                    auto c = static_cast<uint64_t>(key[i]);
+                    digit = c < 0x20 ? 0 : (c > 0x7e ? key_base - 1 : c - 0x20);
+                }
+
+                number = number * key_base + digit;
+            }
+
+            return number;
+        }
+
+        utility::string_t number_to_key(uint64_t number)
+        {
+            utility::string_t key(key_digits, _XPLATSTR(' '));
+            for (int i = key_digits - 1; i >= 0; --i)
+            {
+                key[i] = static_cast<utility::char_t>(0x20 + number % key_base);
+                number /= key_base;
+            }
+
+            // Trailing spaces only make the split point smaller, which does not matter once it is moved to an existing key.
+            key.erase(key.find_last_not_of(_XPLATSTR(' ')) + 1);
+            return key;
+        }
+    }
+
+    pplx::task<void> cloud_table::execute_query_parallel_async(const table_query& query, const std::vector<utility::string_t>& partition_key_boundaries, int parallelism, std::function<void(const std::vector<table_entity>&)> segment_handler, const table_request_options& options, operation_context context) const
+    {
+        utility::assert_in_bounds(_XPLATSTR("parallelism"), parallelism, 1);
+
+        std::vector<utility::string_t> boundaries(partition_key_boundaries);
+        std::sort(boundaries.begin(), boundaries.end());
+        boundaries.erase(std::unique(boundaries.begin(), boundaries.end()), boundaries.end());
+
+        auto state = std::make_shared<parallel_query_state>();
+        state->m_segment_handler = std::move(segment_handler);
+        for (size_t i = 0; i <= boundaries.size(); ++i)
+        {
+            utility::string_t range_filter;
+            if (i > 0)
+            {
+                range_filter = table_query::generate_filter_condition(_XPLATSTR("PartitionKey"), query_comparison_operator::greater_than_or_equal, boundaries[i - 1]);
+            }
+
+            if (i < boundaries.size())
+            {
+                utility::string_t upper_filter = table_query::generate_filter_condition(_XPLATSTR("PartitionKey"), query_comparison_operator::less_than, boundaries[i]);
+                range_filter = range_filter.empty() ? upper_filter : table_query::combine_filter_conditions(range_filter, query_logical_operator::op_and, upper_filter);
+            }
+
+            table_query range_query(query);
+            if (!range_filter.empty())
+            {
+                range_query.set_filter_string(query.filter_string().empty() ? range_filter : table_query::combine_filter_conditions(query.filter_string(), query_logical_operator::op_and, range_filter));
+            }
+
+            state->m_queries.push_back(std::move(range_query));
+        }
+
+        auto instance = std::make_shared<cloud_table>(*this);
+        std::vector<pplx::task<void>> workers;
+        size_t worker_count = std::min(static_cast<size_t>(parallelism), state->m_queries.size());
+        for (size_t worker = 0; worker < worker_count; ++worker)
+        {
+            // Each worker scans one range at a time, segment by segment, and then takes the next range that nobody has started.
+            workers.push_back(pplx::details::_do_while([instance, state, options, context]() -> pplx::task<bool>
+            {
+                size_t range = state->m_next_range++;
+                if (range >= state->m_queries.size() || state->m_failed)
+                {
+                    return pplx::task_from_result(false);
+                }
+
+                auto token = std::make_shared<continuation_token>();
+                return pplx::details::_do_while([instance, state, range, token, options, context]() -> pplx::task<bool>
+                {
+                    return instance->execute_query_segmented_async(state->m_queries[range], *token, options, context).then([state, token](table_query_segment segment) -> bool
+                    {
+                        {
+                            std::lock_guard<std::mutex> guard(state->m_mutex);
+                            if (state->m_failed)
+                            {
+                                return false;
+                            }
+
+                            state->m_segment_handler(segment.results());
+                        }
+
+                        *token = segment.continuation_token();
+                        return !token->empty();
+                    });
+                }).then([state](pplx::task<bool> range_task) -> bool
+                {
+                    try
+                    {
+                        range_task.wait();
+                    }
+                    catch (...)
+                    {
+                        state->set_exception(std::current_exception());
+                    }
+
+                    return !state->m_failed;
+                });
+            }).then([](bool)
+            {
+            }));
+        }
+
+        return pplx::when_all(workers.begin(), workers.end()).then([state]()
+        {
+            if (state->m_exception != nullptr)
+            {
+                std::rethrow_exception(state->m_exception);
+            }
+        });
+    }
+
+    pplx::task<std::vector<utility::string_t>> cloud_table::sample_partition_key_boundaries_async(int range_count, const table_request_options& options, operation_context context) const
+    {
+        utility::assert_in_bounds(_XPLATSTR("range_count"), range_count, 1);
+
+        auto instance = std::make_shared<cloud_table>(*this);
+        return first_partition_key_async(instance, utility::string_t(), options, context).then([instance, range_count, options, context](std::pair<bool, utility::string_t> first_key) -> pplx::task<std::vector<utility::string_t>>
+        {
+            if (!first_key.first || range_count == 1)
+            {
+                return pplx::task_from_result(std::vector<utility::string_t>());
+            }
+
+            // The upper end of the key space is the largest printable ASCII key, since tables cannot be read in descending order.
+            uint64_t low = key_to_number(first_key.second);
+            uint64_t high = key_to_number(utility::string_t(key_digits, _XPLATSTR('~')));
+            uint64_t step = (high - low) / static_cast<uint64_t>(range_count);
+
+            std::vector<pplx::task<std::pair<bool, utility::string_t>>> samples;
+            for (int i = 1; i < range_count && step > 0; ++i)
+            {
+                samples.push_back(first_partition_key_async(instance, number_to_key(low + step * static_cast<uint64_t>(i)), options, context));
+            }
+
+            utility::string_t lowest = first_key.second;
+            return pplx::when_all(samples.begin(), samples.end()).then([lowest](std::vector<std::pair<bool, utility::string_t>> sampled_keys) -> std::vector<utility::string_t>
+            {
+                std::vector<utility::string_t> boundaries;
+                for (auto& key : sampled_keys)
+                {
+                    // Split points past the last key and split points that moved to the first key do not split anything.
+                    if (key.first && key.second != lowest)
+                    {
+                        boundaries.push_back(std::move(key.second));
+                    }
+                }
+
+                std::sort(boundaries.begin(), boundaries.end());
+                boundaries.erase(std::unique(boundaries.begin(), boundaries.end()), boundaries.end());
+                return boundaries;
+            });
+        });
+    }
+
     utility::string_t cloud_table::get_shared_access_signature(const table_shared_access_policy& policy, const utility::string_t& stored_policy_identifier, const utility::string_t& start_partition_key, const utility::string_t& start_row_key, const utility::string_t& end_partition_key, const utility::string_t& end_row_key) const
     {
         if (!service_client().credentials().is_shared_key())
@@ -34,9 +34,9 @@ namespace azure { namespace storage {
         return table_result_iterator(
             [instance, prefix, options, context](const continuation_token& token, size_t max_results_per_segment)
         {
-            return instance->list_tables_segmented(prefix, (int)max_results_per_segment, token, options, context);
+            return instance->list_tables_segmented_async(prefix, (int)max_results_per_segment, token, options, context);
         },
-            max_results, 0);
+            max_results, 0, options.segment_prefetch_depth());
     }
 
     pplx::task<table_result_segment> cloud_table_client::list_tables_segmented_async(const utility::string_t& prefix, int max_results, const continuation_token& token, const table_request_options& options, operation_context context) const
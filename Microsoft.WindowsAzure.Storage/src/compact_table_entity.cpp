@@ -0,0 +1,207 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="compact_table_entity.cpp" company="Microsoft">
+//    Copyright 2013 Microsoft Corporation
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "was/table.h"
+#include "wascore/util.h"
+#include "wascore/resources.h"
+
+namespace azure { namespace storage {
+
+    namespace
+    {
+        const compact_entity_value null_value;
+    }
+
+    table_entity_schema::table_entity_schema(std::vector<utility::string_t> property_names)
+        : m_property_names(std::move(property_names))
+    {
+        m_indexes.reserve(m_property_names.size());
+        for (size_t i = 0; i < m_property_names.size(); ++i)
+        {
+            if (!m_indexes.insert(std::make_pair(m_property_names[i], i)).second)
+            {
+                throw std::invalid_argument(protocol::error_duplicate_schema_property);
+            }
+        }
+    }
+
+    const std::vector<uint8_t>& compact_entity_value::binary_value() const
+    {
+        if (m_property_type != edm_type::binary)
+        {
+            throw std::runtime_error(protocol::error_entity_property_not_binary);
+        }
+
+        return m_binary;
+    }
+
+    bool compact_entity_value::boolean_value() const
+    {
+        if (m_property_type != edm_type::boolean)
+        {
+            throw std::runtime_error(protocol::error_entity_property_not_boolean);
+        }
+
+        return m_scalar.m_boolean;
+    }
+
+    utility::datetime compact_entity_value::datetime_value() const
+    {
+        if (m_property_type != edm_type::datetime)
+        {
+            throw std::runtime_error(protocol::error_entity_property_not_datetime);
+        }
+
+        return utility::datetime() + m_scalar.m_datetime;
+    }
+
+    double compact_entity_value::double_value() const
+    {
+        if (m_property_type != edm_type::double_floating_point)
+        {
+            throw std::runtime_error(protocol::error_entity_property_not_double);
+        }
+
+        return m_scalar.m_double;
+    }
+
+    utility::uuid compact_entity_value::guid_value() const
+    {
+        if (m_property_type != edm_type::guid)
+        {
+            throw std::runtime_error(protocol::error_entity_property_not_guid);
+        }
+
+        return m_scalar.m_guid;
+    }
+
+    int32_t compact_entity_value::int32_value() const
+    {
+        if (m_property_type != edm_type::int32)
+        {
+            throw std::runtime_error(protocol::error_entity_property_not_int32);
+        }
+
+        return m_scalar.m_int32;
+    }
+
+    int64_t compact_entity_value::int64_value() const
+    {
+        if (m_property_type != edm_type::int64)
+        {
+            throw std::runtime_error(protocol::error_entity_property_not_int64);
+        }
+
+        return m_scalar.m_int64;
+    }
+
+    const utility::string_t& compact_entity_value::string_value() const
+    {
+        if (m_property_type != edm_type::string)
+        {
+            throw std::runtime_error(protocol::error_entity_property_not_string);
+        }
+
+        return m_string;
+    }
+
+    entity_property compact_entity_value::to_entity_property() const
+    {
+        if (m_is_null)
+        {
+            return entity_property();
+        }
+
+        switch (m_property_type)
+        {
+        case edm_type::binary:
+            return entity_property(m_binary);
+
+        case edm_type::boolean:
+            return entity_property(m_scalar.m_boolean);
+
+        case edm_type::datetime:
+            return entity_property(datetime_value());
+
+        case edm_type::double_floating_point:
+            return entity_property(m_scalar.m_double);
+
+        case edm_type::guid:
+            return entity_property(m_scalar.m_guid);
+
+        case edm_type::int32:
+            return entity_property(m_scalar.m_int32);
+
+        case edm_type::int64:
+            return entity_property(m_scalar.m_int64);
+
+        default:
+            return entity_property(m_string);
+        }
+    }
+
+    const compact_entity_value& compact_table_entity::value(size_t index) const
+    {
+        return index < m_values.size() ? m_values[index] : null_value;
+    }
+
+    const compact_entity_value& compact_table_entity::value(const utility::string_t& property_name) const
+    {
+        size_t index;
+        if (m_schema == nullptr || !m_schema->find(property_name, index))
+        {
+            return null_value;
+        }
+
+        return value(index);
+    }
+
+    void compact_table_entity::set_value(size_t index, compact_entity_value value)
+    {
+        if (m_schema == nullptr || index >= m_schema->size())
+        {
+            throw std::out_of_range(protocol::error_schema_property_index);
+        }
+
+        if (index >= m_values.size())
+        {
+            m_values.resize(index + 1);
+        }
+
+        m_values[index] = std::move(value);
+    }
+
+    table_entity compact_table_entity::to_table_entity() const
+    {
+        table_entity::properties_type properties;
+        properties.reserve(m_values.size());
+        for (size_t i = 0; i < m_values.size(); ++i)
+        {
+            // The schema is shared by many entities, so a value that was never set is a property this entity does not have.
+            if (m_values[i].is_set())
+            {
+                properties.insert(table_entity::property_type(m_schema->property_name(i), m_values[i].to_entity_property()));
+            }
+        }
+
+        table_entity entity(m_partition_key, m_row_key, m_etag, std::move(properties));
+        entity.set_timestamp(m_timestamp);
+        return entity;
+    }
+
+}} // namespace azure::storage
@@ -0,0 +1,246 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="crc64.cpp" company="Microsoft">
+//    Copyright 2013 Microsoft Corporation
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "wascore/crc64.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define WASTORAGE_CRC64_PCLMUL
+#include <emmintrin.h>
+#include <wmmintrin.h>
+#ifdef _WIN32
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace azure { namespace storage { namespace core {
+
+    namespace
+    {
+        class crc64_tables
+        {
+        public:
+            crc64_tables()
+            {
+                // Slicing-by-8 tables: m_table[k][b] is the CRC of byte b followed by k zero bytes.
+                for (uint64_t b = 0; b < 256; ++b)
+                {
+                    uint64_t crc = b;
+                    for (int bit = 0; bit < 8; ++bit)
+                    {
+                        crc = (crc & 1) ? (crc >> 1) ^ crc64_polynomial : crc >> 1;
+                    }
+
+                    m_table[0][b] = crc;
+                }
+
+                for (size_t b = 0; b < 256; ++b)
+                {
+                    for (size_t k = 1; k < 8; ++k)
+                    {
+                        m_table[k][b] = (m_table[k - 1][b] >> 8) ^ m_table[0][m_table[k - 1][b] & 0xFF];
+                    }
+                }
+            }
+
+            // Updates the CRC register, which holds the complemented CRC.
+            uint64_t update(const uint8_t* data, size_t count, uint64_t crc) const
+            {
+                while (count >= 8)
+                {
+                    // The bytes are combined one by one so the result does not depend on the byte order of the platform.
+                    uint64_t value = crc ^ (static_cast<uint64_t>(data[0]) | static_cast<uint64_t>(data[1]) << 8 |
+                        static_cast<uint64_t>(data[2]) << 16 | static_cast<uint64_t>(data[3]) << 24 |
+                        static_cast<uint64_t>(data[4]) << 32 | static_cast<uint64_t>(data[5]) << 40 |
+                        static_cast<uint64_t>(data[6]) << 48 | static_cast<uint64_t>(data[7]) << 56);
+
+                    crc = m_table[7][value & 0xFF] ^ m_table[6][(value >> 8) & 0xFF] ^
+                        m_table[5][(value >> 16) & 0xFF] ^ m_table[4][(value >> 24) & 0xFF] ^
+                        m_table[3][(value >> 32) & 0xFF] ^ m_table[2][(value >> 40) & 0xFF] ^
+                        m_table[1][(value >> 48) & 0xFF] ^ m_table[0][value >> 56];
+
+                    data += 8;
+                    count -= 8;
+                }
+
+                while (count > 0)
+                {
+                    crc = (crc >> 8) ^ m_table[0][(crc ^ *data) & 0xFF];
+                    ++data;
+                    --count;
+                }
+
+                return crc;
+            }
+
+        private:
+            uint64_t m_table[8][256];
+        };
+
+        const crc64_tables& tables()
+        {
+            static const crc64_tables instance;
+            return instance;
+        }
+
+#ifdef WASTORAGE_CRC64_PCLMUL
+
+        // Returns x^n mod P in the reflected representation used by the folding below.
+        uint64_t x_pow_mod(unsigned int n)
+        {
+            uint64_t value = 1ULL << 63;
+            for (unsigned int i = 0; i < n; ++i)
+            {
+                value = (value & 1) ? (value >> 1) ^ crc64_polynomial : value >> 1;
+            }
+
+            return value;
+        }
+
+        bool has_pclmul()
+        {
+            // PCLMULQDQ is reported in bit 1 of ECX for CPUID leaf 1.
+#ifdef _WIN32
+            int info[4];
+            __cpuid(info, 1);
+            unsigned int ecx = static_cast<unsigned int>(info[2]);
+#else
+            unsigned int eax, ebx, ecx, edx;
+            if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+            {
+                return false;
+            }
+#endif
+            return (ecx & (1u << 1)) != 0;
+        }
+
+        class crc64_folding
+        {
+        public:
+            crc64_folding()
+                : m_enabled(has_pclmul())
+            {
+                // A 128-bit block folded forward by d bits is split in its two 64-bit halves, and each half is multiplied by
+                // x^(d + 64 - 1) and x^(d - 1) mod P. The extra -1 accounts for the product of two reflected 64-bit values being
+                // one bit short of the reflected 128-bit result.
+                m_fold_by_1 = { x_pow_mod(128 + 64 - 1), x_pow_mod(128 - 1) };
+                m_fold_by_4 = { x_pow_mod(512 + 64 - 1), x_pow_mod(512 - 1) };
+            }
+
+            bool enabled() const
+            {
+                return m_enabled;
+            }
+
+            uint64_t update(const uint8_t* data, size_t count, uint64_t crc) const;
+
+        private:
+            struct constants
+            {
+                uint64_t low;
+                uint64_t high;
+            };
+
+            bool m_enabled;
+            constants m_fold_by_1;
+            constants m_fold_by_4;
+        };
+
+        const crc64_folding& folding()
+        {
+            static const crc64_folding instance;
+            return instance;
+        }
+
+#if defined(__GNUC__) || defined(__clang__)
+#define WASTORAGE_CRC64_TARGET __attribute__((target("pclmul")))
+#else
+#define WASTORAGE_CRC64_TARGET
+#endif
+
+        WASTORAGE_CRC64_TARGET inline __m128i fold(__m128i value, __m128i constants)
+        {
+            return _mm_xor_si128(_mm_clmulepi64_si128(value, constants, 0x00), _mm_clmulepi64_si128(value, constants, 0x11));
+        }
+
+        WASTORAGE_CRC64_TARGET uint64_t crc64_folding::update(const uint8_t* data, size_t count, uint64_t crc) const
+        {
+            // Folding keeps a 64-byte remainder that is congruent modulo P to the data processed so far. The CRC register is folded
+            // into the first 8 bytes, so the final remainder is a 16-byte message with the same CRC as the data, which is then
+            // finished, along with any trailing bytes, with the table-driven implementation.
+            const __m128i fold_by_4 = _mm_set_epi64x(static_cast<long long>(m_fold_by_4.high), static_cast<long long>(m_fold_by_4.low));
+            const __m128i fold_by_1 = _mm_set_epi64x(static_cast<long long>(m_fold_by_1.high), static_cast<long long>(m_fold_by_1.low));
+
+            __m128i x0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+            __m128i x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16));
+            __m128i x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 32));
+            __m128i x3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 48));
+            x0 = _mm_xor_si128(x0, _mm_set_epi64x(0, static_cast<long long>(crc)));
+            data += 64;
+            count -= 64;
+
+            while (count >= 64)
+            {
+                x0 = _mm_xor_si128(fold(x0, fold_by_4), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data)));
+                x1 = _mm_xor_si128(fold(x1, fold_by_4), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16)));
+                x2 = _mm_xor_si128(fold(x2, fold_by_4), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 32)));
+                x3 = _mm_xor_si128(fold(x3, fold_by_4), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 48)));
+                data += 64;
+                count -= 64;
+            }
+
+            x0 = _mm_xor_si128(fold(x0, fold_by_1), x1);
+            x0 = _mm_xor_si128(fold(x0, fold_by_1), x2);
+            x0 = _mm_xor_si128(fold(x0, fold_by_1), x3);
+
+            while (count >= 16)
+            {
+                x0 = _mm_xor_si128(fold(x0, fold_by_1), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data)));
+                data += 16;
+                count -= 16;
+            }
+
+            uint8_t remainder[16];
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(remainder), x0);
+            return tables().update(data, count, tables().update(remainder, sizeof(remainder), 0));
+        }
+
+#endif
+
+    }
+
+    uint64_t update_crc64(const uint8_t* data, size_t count, uint64_t crc)
+    {
+#ifdef WASTORAGE_CRC64_PCLMUL
+        // Below this size the setup of the folding costs more than it saves.
+        if (count >= 256 && folding().enabled())
+        {
+            return ~folding().update(data, count, ~crc);
+        }
+#endif
+
+        return update_crc64_portable(data, count, crc);
+    }
+
+    uint64_t update_crc64_portable(const uint8_t* data, size_t count, uint64_t crc)
+    {
+        return ~tables().update(data, count, ~crc);
+    }
+
+}}} // namespace azure::storage::core
@@ -85,7 +85,11 @@ namespace azure { namespace storage { namespace core {
                 // Calculate the length and MD5 hash if needed as the incoming data is read
                 if (!instance->m_is_hashing_started)
                 {
-                    if (instance->m_command->m_calculate_response_body_md5)
+                    if (instance->m_command->m_calculate_response_body_crc64)
+                    {
+                        instance->m_hash_provider = hash_provider::create_crc64_hash_provider();
+                    }
+                    else if (instance->m_command->m_calculate_response_body_md5)
                     {
                         instance->m_hash_provider = hash_provider::create_md5_hash_provider();
                     }
@@ -99,7 +103,11 @@ namespace azure { namespace storage { namespace core {
 
                 if (instance->m_should_restart_hash_provider)
                 {
-                    if (instance->m_command->m_calculate_response_body_md5)
+                    if (instance->m_command->m_calculate_response_body_crc64)
+                    {
+                        instance->m_hash_provider = hash_provider::create_crc64_hash_provider();
+                    }
+                    else if (instance->m_command->m_calculate_response_body_md5)
                     {
                         instance->m_hash_provider = hash_provider::create_md5_hash_provider();
                     }
@@ -150,8 +158,7 @@ namespace azure { namespace storage { namespace core {
             web::http::client::http_client client(instance->m_request.request_uri().authority(), config);
             return client.request(instance->m_request, instance->m_command->get_cancellation_token()).then([instance](pplx::task<web::http::http_response> get_headers_task)->pplx::task<web::http::http_response>
 #else
-            std::shared_ptr<web::http::client::http_client> client = core::http_client_reusable::get_http_client(instance->m_request.request_uri().authority(), config);
-            return client->request(instance->m_request, instance->m_command->get_cancellation_token()).then([instance](pplx::task<web::http::http_response> get_headers_task)->pplx::task<web::http::http_response>
+            return core::http_client_reusable::request(instance->m_request.request_uri().authority(), config, instance->m_request, instance->m_command->get_cancellation_token()).then([instance](pplx::task<web::http::http_response> get_headers_task)->pplx::task<web::http::http_response>
 #endif // _WIN32
             {
                 // Headers are ready. It should be noted that http_client will
@@ -246,7 +253,7 @@ namespace azure { namespace storage { namespace core {
                 }
 
                 // It is now time to call m_postprocess_response
-                // Finish the MD5 hash if MD5 was being calculated
+                // Finish the MD5 hash or CRC64 if one was being calculated
                 instance->m_hash_provider.close();
                 instance->m_is_hashing_started = false;
 
@@ -254,7 +261,14 @@ namespace azure { namespace storage { namespace core {
                 if (instance->m_response_streambuf)
                 {
                     utility::size64_t total_downloaded = instance->m_total_downloaded + instance->m_response_streambuf.total_written();
-                    descriptor = ostream_descriptor(total_downloaded, instance->m_hash_provider.hash());
+                    if (instance->m_command->m_calculate_response_body_crc64)
+                    {
+                        descriptor = ostream_descriptor(total_downloaded, utility::string_t(), instance->m_hash_provider.hash());
+                    }
+                    else
+                    {
+                        descriptor = ostream_descriptor(total_downloaded, instance->m_hash_provider.hash(), utility::string_t());
+                    }
                 }
 
                 return instance->m_command->postprocess_response(response, instance->m_request_result, descriptor, instance->m_context).then([instance](pplx::task<void> result_task)
@@ -319,7 +319,7 @@ namespace azure { namespace storage { namespace protocol {
         return request;
     }
 
-    web::http::http_request put_file_range(file_range range, file_range_write write, utility::string_t content_md5, web::http::uri_builder uri_builder, const std::chrono::seconds& timeout, operation_context context)
+    web::http::http_request put_file_range(file_range range, file_range_write write, utility::string_t content_md5, utility::string_t content_crc64, web::http::uri_builder uri_builder, const std::chrono::seconds& timeout, operation_context context)
     {
         uri_builder.append_query(core::make_query_parameter(uri_query_component, component_range, /* do_encoding */ false));
         web::http::http_request request(base_request(web::http::methods::PUT, uri_builder, timeout, context));
@@ -332,6 +332,7 @@ namespace azure { namespace storage { namespace protocol {
         case file_range_write::update:
             headers.add(_XPLATSTR("x-ms-write"), _XPLATSTR("update"));
             add_optional_header(headers, web::http::header_names::content_md5, content_md5);
+            add_content_crc64(headers, content_crc64);
             break;
 
         case file_range_write::clear:
@@ -341,7 +342,7 @@ namespace azure { namespace storage { namespace protocol {
         return request;
     }
 
-    web::http::http_request get_file(utility::size64_t start_offset, utility::size64_t length, bool md5_validation, web::http::uri_builder uri_builder, const std::chrono::seconds& timeout, operation_context context)
+    web::http::http_request get_file(utility::size64_t start_offset, utility::size64_t length, bool md5_validation, bool crc64_validation, web::http::uri_builder uri_builder, const std::chrono::seconds& timeout, operation_context context)
     {
         web::http::http_request request(base_request(web::http::methods::GET, uri_builder, timeout, context));
         web::http::http_headers& headers = request.headers();
@@ -351,6 +352,11 @@ namespace azure { namespace storage { namespace protocol {
         {
             headers.add(_XPLATSTR("x-ms-range-get-content-md5"), _XPLATSTR("true"));
         }
+        else if (start_offset < std::numeric_limits<utility::size64_t>::max() && crc64_validation)
+        {
+            headers.add(ms_header_range_get_content_crc64, header_value_true);
+            use_crc64_storage_version(headers);
+        }
         return request;
     }
 }}}
\ No newline at end of file
@@ -0,0 +1,146 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="hash_pipeline.cpp" company="Microsoft">
+//    Copyright 2013 Microsoft Corporation
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+
+#include "stdafx.h"
+#include "wascore/hash_pipeline.h"
+#include "wascore/md5_multi_buffer.h"
+
+#include <thread>
+
+namespace azure { namespace storage { namespace core {
+
+    std::mutex hash_pipeline::s_mutex;
+    std::deque<hash_pipeline::md5_request> hash_pipeline::s_md5_requests;
+    size_t hash_pipeline::s_md5_worker_count(0);
+
+    pplx::task<utility::string_t> hash_pipeline::md5_async(const uint8_t* data, size_t count)
+    {
+        md5_request request;
+        request.m_data = data;
+        request.m_count = count;
+        auto result = pplx::create_task(request.m_event);
+
+        bool start_worker = false;
+        {
+            std::lock_guard<std::mutex> guard(s_mutex);
+            s_md5_requests.push_back(request);
+
+            // One worker drains the queue while requests trickle in. More workers are started only when the queue
+            // holds more than the running workers can take in one batch.
+            size_t max_worker_count = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+            if (s_md5_worker_count == 0 || (s_md5_requests.size() > s_md5_worker_count * s_md5_batch_size && s_md5_worker_count < max_worker_count))
+            {
+                ++s_md5_worker_count;
+                start_worker = true;
+            }
+        }
+
+        if (start_worker)
+        {
+            pplx::create_task([]()
+            {
+                run_md5_worker();
+            });
+        }
+
+        return result;
+    }
+
+    pplx::task<utility::string_t> hash_pipeline::crc64_async(const uint8_t* data, size_t count)
+    {
+        return pplx::create_task([data, count]() -> utility::string_t
+        {
+            hash_provider provider = hash_provider::create_crc64_hash_provider();
+            provider.write(data, count);
+            provider.close();
+            return provider.hash();
+        });
+    }
+
+    void hash_pipeline::run_md5_worker()
+    {
+        std::vector<md5_request> batch;
+        for (;;)
+        {
+            batch.clear();
+            {
+                std::lock_guard<std::mutex> guard(s_mutex);
+                if (s_md5_requests.empty())
+                {
+                    --s_md5_worker_count;
+                    return;
+                }
+
+                while (!s_md5_requests.empty() && batch.size() < s_md5_batch_size)
+                {
+                    batch.push_back(s_md5_requests.front());
+                    s_md5_requests.pop_front();
+                }
+            }
+
+            try
+            {
+                hash_md5_batch(batch);
+            }
+            catch (...)
+            {
+                for (auto& request : batch)
+                {
+                    request.m_event.set_exception(std::current_exception());
+                }
+            }
+        }
+    }
+
+    void hash_pipeline::hash_md5_batch(std::vector<md5_request>& batch)
+    {
+        // With fewer than three buffers too many SIMD lanes stay idle to beat the platform implementation.
+        if (batch.size() < 3 || !md5_multi_buffer_is_accelerated())
+        {
+            for (auto& request : batch)
+            {
+                hash_provider provider = hash_provider::create_md5_hash_provider();
+                provider.write(request.m_data, request.m_count);
+                provider.close();
+                request.m_event.set(provider.hash());
+            }
+
+            return;
+        }
+
+        std::vector<const uint8_t*> data;
+        std::vector<size_t> counts;
+        data.reserve(batch.size());
+        counts.reserve(batch.size());
+        for (const auto& request : batch)
+        {
+            data.push_back(request.m_data);
+            counts.push_back(request.m_count);
+        }
+
+        std::vector<uint8_t> digests(batch.size() * md5_digest_size);
+        md5_multi_buffer(data.data(), counts.data(), batch.size(), digests.data());
+
+        for (size_t i = 0; i < batch.size(); ++i)
+        {
+            std::vector<uint8_t> digest(digests.begin() + i * md5_digest_size, digests.begin() + (i + 1) * md5_digest_size);
+            batch[i].m_event.set(utility::conversions::to_base64(digest));
+        }
+    }
+
+}}} // namespace azure::storage::core
@@ -103,6 +103,43 @@ namespace azure { namespace storage { namespace core {
     {
     }
 
+    hmac_sha256_signer::hmac_sha256_signer(const std::vector<uint8_t>& key)
+    {
+        NTSTATUS status = BCryptCreateHash(hmac_sha256_hash_algorithm::instance(), &m_hash_handle, NULL, 0, (PUCHAR)key.data(), (ULONG)key.size(), 0);
+        if (status != 0)
+        {
+            throw utility::details::create_system_error(status);
+        }
+    }
+
+    hmac_sha256_signer::~hmac_sha256_signer()
+    {
+        BCryptDestroyHash(m_hash_handle);
+    }
+
+    void hmac_sha256_signer::sign(const uint8_t* data, size_t count, uint8_t* hash) const
+    {
+        // The keyed hash that was never written to is only used as a template, every signature works on a duplicate of it.
+        BCRYPT_HASH_HANDLE hash_handle;
+        NTSTATUS status = BCryptDuplicateHash(m_hash_handle, &hash_handle, NULL, 0, 0);
+        if (status != 0)
+        {
+            throw utility::details::create_system_error(status);
+        }
+
+        status = BCryptHashData(hash_handle, (PUCHAR)data, (ULONG)count, 0);
+        if (status == 0)
+        {
+            status = BCryptFinishHash(hash_handle, (PUCHAR)hash, (ULONG)hash_size, 0);
+        }
+
+        BCryptDestroyHash(hash_handle);
+        if (status != 0)
+        {
+            throw utility::details::create_system_error(status);
+        }
+    }
+
 #else // Linux
 
     hmac_sha256_hash_provider_impl::hmac_sha256_hash_provider_impl(const std::vector<uint8_t>& key)
@@ -172,7 +209,71 @@ namespace azure { namespace storage { namespace core {
         MD5_Final(m_hash.data(), m_hash_context);
     }
 
+    hmac_sha256_signer::hmac_sha256_signer(const std::vector<uint8_t>& key)
+    {
+        // HMAC(K, m) = H((K' ^ opad) || H((K' ^ ipad) || m)), where K' is the key padded to one block, or its hash if it is longer.
+        uint8_t block[SHA256_CBLOCK] = { 0 };
+        if (key.size() > SHA256_CBLOCK)
+        {
+            SHA256(key.data(), key.size(), block);
+        }
+        else if (!key.empty())
+        {
+            std::memcpy(block, key.data(), key.size());
+        }
+
+        uint8_t padded_key[SHA256_CBLOCK];
+        for (size_t i = 0; i < SHA256_CBLOCK; ++i)
+        {
+            padded_key[i] = block[i] ^ 0x36;
+        }
+
+        SHA256_Init(&m_inner_context);
+        SHA256_Update(&m_inner_context, padded_key, SHA256_CBLOCK);
+
+        for (size_t i = 0; i < SHA256_CBLOCK; ++i)
+        {
+            padded_key[i] = block[i] ^ 0x5c;
+        }
+
+        SHA256_Init(&m_outer_context);
+        SHA256_Update(&m_outer_context, padded_key, SHA256_CBLOCK);
+
+        OPENSSL_cleanse(block, sizeof(block));
+        OPENSSL_cleanse(padded_key, sizeof(padded_key));
+    }
+
+    hmac_sha256_signer::~hmac_sha256_signer()
+    {
+        OPENSSL_cleanse(&m_inner_context, sizeof(m_inner_context));
+        OPENSSL_cleanse(&m_outer_context, sizeof(m_outer_context));
+    }
+
+    void hmac_sha256_signer::sign(const uint8_t* data, size_t count, uint8_t* hash) const
+    {
+        SHA256_CTX context = m_inner_context;
+        SHA256_Update(&context, data, count);
+        SHA256_Final(hash, &context);
+
+        context = m_outer_context;
+        SHA256_Update(&context, hash, SHA256_DIGEST_LENGTH);
+        SHA256_Final(hash, &context);
+        OPENSSL_cleanse(&context, sizeof(context));
+    }
+
 #endif
 
+    utility::string_t crc64_hash_provider_impl::hash() const
+    {
+        // The service expects the 8 bytes of the CRC in little-endian order.
+        std::vector<uint8_t> hash(sizeof(m_crc));
+        for (size_t i = 0; i < hash.size(); ++i)
+        {
+            hash[i] = static_cast<uint8_t>(m_crc >> (8 * i));
+        }
+
+        return utility::conversions::to_base64(hash);
+    }
+
 }}} // namespace azure::storage::core
 
@@ -0,0 +1,340 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="md5_multi_buffer.cpp" company="Microsoft">
+//    Copyright 2013 Microsoft Corporation
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+
+#include "stdafx.h"
+#include "wascore/md5_multi_buffer.h"
+
+#include <cstring>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define WASTORAGE_MD5_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace azure { namespace storage { namespace core {
+
+    namespace
+    {
+        const size_t md5_block_size = 64;
+        const size_t md5_lane_count = 4;
+
+        const uint32_t md5_sines[64] =
+        {
+            0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+            0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+            0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+            0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+            0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+            0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+            0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+            0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391
+        };
+
+        const int md5_shifts[4][4] =
+        {
+            { 7, 12, 17, 22 },
+            { 5, 9, 14, 20 },
+            { 4, 11, 16, 23 },
+            { 6, 10, 15, 21 }
+        };
+
+        const uint32_t md5_initial_state[4] = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476 };
+
+        // One buffer that is being hashed: its full blocks are read in place, and the padded tail is built separately.
+        struct md5_job
+        {
+            const uint8_t* data;
+            size_t full_block_count;
+            size_t block_count;
+            size_t next_block;
+            uint8_t tail[2 * md5_block_size];
+            uint32_t state[4];
+
+            void start(const uint8_t* buffer, size_t count)
+            {
+                data = buffer;
+                full_block_count = count / md5_block_size;
+                next_block = 0;
+
+                size_t remainder = count % md5_block_size;
+                size_t tail_size = remainder < md5_block_size - 8 ? md5_block_size : 2 * md5_block_size;
+                block_count = full_block_count + tail_size / md5_block_size;
+
+                std::memset(tail, 0, sizeof(tail));
+                if (remainder > 0)
+                {
+                    std::memcpy(tail, buffer + full_block_count * md5_block_size, remainder);
+                }
+
+                tail[remainder] = 0x80;
+                uint64_t bit_count = static_cast<uint64_t>(count) * 8;
+                for (size_t i = 0; i < 8; ++i)
+                {
+                    tail[tail_size - 8 + i] = static_cast<uint8_t>(bit_count >> (8 * i));
+                }
+
+                std::memcpy(state, md5_initial_state, sizeof(state));
+            }
+
+            const uint8_t* block(size_t index) const
+            {
+                return index < full_block_count ? data + index * md5_block_size : tail + (index - full_block_count) * md5_block_size;
+            }
+        };
+
+        inline uint32_t load_word(const uint8_t* block, size_t index)
+        {
+            const uint8_t* word = block + index * 4;
+            return static_cast<uint32_t>(word[0]) | static_cast<uint32_t>(word[1]) << 8 | static_cast<uint32_t>(word[2]) << 16 | static_cast<uint32_t>(word[3]) << 24;
+        }
+
+        inline size_t message_word(size_t step)
+        {
+            switch (step / 16)
+            {
+            case 0:
+                return step;
+
+            case 1:
+                return (5 * step + 1) % 16;
+
+            case 2:
+                return (3 * step + 5) % 16;
+
+            default:
+                return (7 * step) % 16;
+            }
+        }
+
+#ifdef WASTORAGE_MD5_SSE2
+
+        inline __m128i rotate_left(__m128i value, int shift)
+        {
+            return _mm_or_si128(_mm_sll_epi32(value, _mm_cvtsi32_si128(shift)), _mm_srl_epi32(value, _mm_cvtsi32_si128(32 - shift)));
+        }
+
+        // Runs the MD5 compression function on one block of each lane, with the four lanes side by side in SSE2 registers.
+        void md5_compress_lanes(uint32_t lane_state[4][md5_lane_count], const uint8_t* const blocks[md5_lane_count])
+        {
+            __m128i words[16];
+            for (size_t i = 0; i < 16; ++i)
+            {
+                words[i] = _mm_set_epi32(static_cast<int>(load_word(blocks[3], i)), static_cast<int>(load_word(blocks[2], i)),
+                    static_cast<int>(load_word(blocks[1], i)), static_cast<int>(load_word(blocks[0], i)));
+            }
+
+            __m128i state[4];
+            for (size_t i = 0; i < 4; ++i)
+            {
+                state[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lane_state[i]));
+            }
+
+            const __m128i all_ones = _mm_set1_epi32(-1);
+            __m128i a = state[0];
+            __m128i b = state[1];
+            __m128i c = state[2];
+            __m128i d = state[3];
+
+            for (size_t step = 0; step < 64; ++step)
+            {
+                __m128i f;
+                switch (step / 16)
+                {
+                case 0:
+                    // (b & c) | (~b & d)
+                    f = _mm_xor_si128(d, _mm_and_si128(b, _mm_xor_si128(c, d)));
+                    break;
+
+                case 1:
+                    // (b & d) | (c & ~d)
+                    f = _mm_xor_si128(c, _mm_and_si128(d, _mm_xor_si128(b, c)));
+                    break;
+
+                case 2:
+                    f = _mm_xor_si128(_mm_xor_si128(b, c), d);
+                    break;
+
+                default:
+                    // c ^ (b | ~d)
+                    f = _mm_xor_si128(c, _mm_or_si128(b, _mm_xor_si128(d, all_ones)));
+                    break;
+                }
+
+                __m128i sum = _mm_add_epi32(_mm_add_epi32(a, f), _mm_add_epi32(_mm_set1_epi32(static_cast<int>(md5_sines[step])), words[message_word(step)]));
+                a = d;
+                d = c;
+                c = b;
+                b = _mm_add_epi32(b, rotate_left(sum, md5_shifts[step / 16][step % 4]));
+            }
+
+            state[0] = _mm_add_epi32(state[0], a);
+            state[1] = _mm_add_epi32(state[1], b);
+            state[2] = _mm_add_epi32(state[2], c);
+            state[3] = _mm_add_epi32(state[3], d);
+
+            for (size_t i = 0; i < 4; ++i)
+            {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(lane_state[i]), state[i]);
+            }
+        }
+
+#else
+
+        inline uint32_t rotate_left(uint32_t value, int shift)
+        {
+            return (value << shift) | (value >> (32 - shift));
+        }
+
+        // Runs the MD5 compression function on one block of each lane, one lane after the other.
+        void md5_compress_lanes(uint32_t lane_state[4][md5_lane_count], const uint8_t* const blocks[md5_lane_count])
+        {
+            for (size_t lane = 0; lane < md5_lane_count; ++lane)
+            {
+                uint32_t a = lane_state[0][lane];
+                uint32_t b = lane_state[1][lane];
+                uint32_t c = lane_state[2][lane];
+                uint32_t d = lane_state[3][lane];
+
+                for (size_t step = 0; step < 64; ++step)
+                {
+                    uint32_t f;
+                    switch (step / 16)
+                    {
+                    case 0:
+                        f = d ^ (b & (c ^ d));
+                        break;
+
+                    case 1:
+                        f = c ^ (d & (b ^ c));
+                        break;
+
+                    case 2:
+                        f = b ^ c ^ d;
+                        break;
+
+                    default:
+                        f = c ^ (b | ~d);
+                        break;
+                    }
+
+                    uint32_t sum = a + f + md5_sines[step] + load_word(blocks[lane], message_word(step));
+                    a = d;
+                    d = c;
+                    c = b;
+                    b = b + rotate_left(sum, md5_shifts[step / 16][step % 4]);
+                }
+
+                lane_state[0][lane] += a;
+                lane_state[1][lane] += b;
+                lane_state[2][lane] += c;
+                lane_state[3][lane] += d;
+            }
+        }
+
+#endif
+
+        void store_digest(const uint32_t state[4], uint8_t* digest)
+        {
+            for (size_t i = 0; i < 4; ++i)
+            {
+                for (size_t j = 0; j < 4; ++j)
+                {
+                    digest[i * 4 + j] = static_cast<uint8_t>(state[i] >> (8 * j));
+                }
+            }
+        }
+    }
+
+    void md5_multi_buffer(const uint8_t* const* data, const size_t* counts, size_t buffer_count, uint8_t* digests)
+    {
+        static const uint8_t idle_block[md5_block_size] = { 0 };
+
+        std::vector<md5_job> jobs(buffer_count);
+        md5_job* lanes[md5_lane_count] = { nullptr };
+        size_t lane_buffer[md5_lane_count] = { 0 };
+        size_t next_buffer = 0;
+        size_t active_lanes = 0;
+
+        for (;;)
+        {
+            // Every lane that is free takes the next buffer, so the lanes stay busy while the buffers have different sizes.
+            for (size_t lane = 0; lane < md5_lane_count; ++lane)
+            {
+                if (lanes[lane] == nullptr && next_buffer < buffer_count)
+                {
+                    jobs[next_buffer].start(data[next_buffer], counts[next_buffer]);
+                    lanes[lane] = &jobs[next_buffer];
+                    lane_buffer[lane] = next_buffer;
+                    ++next_buffer;
+                    ++active_lanes;
+                }
+            }
+
+            if (active_lanes == 0)
+            {
+                break;
+            }
+
+            const uint8_t* blocks[md5_lane_count];
+            uint32_t lane_state[4][md5_lane_count];
+            for (size_t lane = 0; lane < md5_lane_count; ++lane)
+            {
+                md5_job* job = lanes[lane];
+                blocks[lane] = job != nullptr ? job->block(job->next_block) : idle_block;
+                for (size_t i = 0; i < 4; ++i)
+                {
+                    lane_state[i][lane] = job != nullptr ? job->state[i] : 0;
+                }
+            }
+
+            md5_compress_lanes(lane_state, blocks);
+
+            for (size_t lane = 0; lane < md5_lane_count; ++lane)
+            {
+                md5_job* job = lanes[lane];
+                if (job == nullptr)
+                {
+                    continue;
+                }
+
+                for (size_t i = 0; i < 4; ++i)
+                {
+                    job->state[i] = lane_state[i][lane];
+                }
+
+                if (++job->next_block == job->block_count)
+                {
+                    store_digest(job->state, digests + lane_buffer[lane] * md5_digest_size);
+                    lanes[lane] = nullptr;
+                    --active_lanes;
+                }
+            }
+        }
+    }
+
+    bool md5_multi_buffer_is_accelerated()
+    {
+#ifdef WASTORAGE_MD5_SSE2
+        return true;
+#else
+        return false;
+#endif
+    }
+
+}}} // namespace azure::storage::core
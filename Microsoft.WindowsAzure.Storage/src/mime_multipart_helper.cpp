@@ -17,8 +17,11 @@
 
 #include "stdafx.h"
 #include "wascore/util.h"
+#include "wascore/streambuf.h"
 #include "was/table.h"
 
+#include <cstring>
+
 namespace azure { namespace storage {  namespace core {
 
     utility::string_t generate_boundary_name(const utility::string_t& prefix)
@@ -80,18 +83,20 @@ namespace azure { namespace storage {  namespace core {
         write_line_break(body_text);
     }
 
+    void write_request_header(utility::string_t& body_text, const utility::string_t& header_name, const utility::string_t& header_value)
+    {
+        body_text.append(header_name);
+        body_text.push_back(_XPLATSTR(':'));
+        body_text.push_back(_XPLATSTR(' '));
+        body_text.append(header_value);
+        write_line_break(body_text);
+    }
+
     void write_request_headers(utility::string_t& body_text, const web::http::http_headers& headers)
     {
         for (web::http::http_headers::const_iterator it = headers.begin(); it != headers.end(); ++it)
         {
-            const utility::string_t& header_name = it->first;
-            const utility::string_t& header_value = it->second;
-
-            body_text.append(header_name);
-            body_text.push_back(_XPLATSTR(':'));
-            body_text.push_back(_XPLATSTR(' '));
-            body_text.append(header_value);
-            write_line_break(body_text);
+            write_request_header(body_text, it->first, it->second);
         }
 
         write_line_break(body_text);
@@ -107,4 +112,235 @@ namespace azure { namespace storage {  namespace core {
         write_line_break(body_text);
     }
 
+    // Reads a mime_multipart_body segment by segment. Reads never wait, since the whole body is in memory.
+    class basic_mime_multipart_istreambuf : public basic_istreambuf<concurrency::streams::istream::traits::char_type>
+    {
+    public:
+
+        // The segments point into storage that the shared pointer keeps alive.
+        basic_mime_multipart_istreambuf(std::shared_ptr<const std::vector<const std::string*>> segments, utility::size64_t size)
+            : basic_istreambuf<concurrency::streams::istream::traits::char_type>(),
+            m_segments(std::move(segments)), m_size(size), m_segment(0), m_offset(0), m_position(0)
+        {
+        }
+
+        bool can_seek() const
+        {
+            return is_open();
+        }
+
+        bool has_size() const
+        {
+            return true;
+        }
+
+        utility::size64_t size() const
+        {
+            return m_size;
+        }
+
+        size_t buffer_size(std::ios_base::openmode) const
+        {
+            return 0;
+        }
+
+        void set_buffer_size(size_t, std::ios_base::openmode)
+        {
+            // no-op, because the body is not buffered
+        }
+
+        size_t in_avail() const
+        {
+            return static_cast<size_t>(m_size - m_position);
+        }
+
+        pos_type getpos(std::ios_base::openmode direction) const
+        {
+            return direction == std::ios_base::in ? static_cast<pos_type>(m_position) : static_cast<pos_type>(traits::eof());
+        }
+
+        pos_type seekpos(pos_type pos, std::ios_base::openmode direction)
+        {
+            if (direction != std::ios_base::in || pos < 0 || static_cast<utility::size64_t>(pos) > m_size)
+            {
+                return static_cast<pos_type>(traits::eof());
+            }
+
+            m_segment = 0;
+            m_offset = 0;
+            m_position = 0;
+            advance(static_cast<size_t>(pos));
+            return pos;
+        }
+
+        pos_type seekoff(off_type offset, std::ios_base::seekdir way, std::ios_base::openmode direction)
+        {
+            switch (way)
+            {
+            case std::ios_base::beg:
+                return seekpos(static_cast<pos_type>(offset), direction);
+
+            case std::ios_base::cur:
+                return seekpos(static_cast<pos_type>(static_cast<off_type>(m_position) + offset), direction);
+
+            default:
+                return seekpos(static_cast<pos_type>(static_cast<off_type>(m_size) + offset), direction);
+            }
+        }
+
+        bool acquire(_Out_writes_(count) char_type*& ptr, _In_ size_t& count)
+        {
+            // The reader gets the current segment itself, which saves a copy.
+            if (m_segment >= m_segments->size())
+            {
+                ptr = nullptr;
+                count = 0;
+                return false;
+            }
+
+            const std::string& segment = *(*m_segments)[m_segment];
+            ptr = reinterpret_cast<char_type*>(const_cast<char*>(segment.data() + m_offset));
+            count = segment.size() - m_offset;
+            return true;
+        }
+
+        void release(_Out_writes_(count) char_type* ptr, _In_ size_t count)
+        {
+            UNREFERENCED_PARAMETER(ptr);
+            advance(count);
+        }
+
+        pplx::task<int_type> _bumpc()
+        {
+            return pplx::task_from_result(_sbumpc());
+        }
+
+        int_type _sbumpc()
+        {
+            int_type result = _sgetc();
+            if (result != traits::eof())
+            {
+                advance(1);
+            }
+
+            return result;
+        }
+
+        pplx::task<int_type> _getc()
+        {
+            return pplx::task_from_result(_sgetc());
+        }
+
+        int_type _sgetc()
+        {
+            if (m_segment >= m_segments->size())
+            {
+                return traits::eof();
+            }
+
+            return static_cast<int_type>(static_cast<unsigned char>((*(*m_segments)[m_segment])[m_offset]));
+        }
+
+        pplx::task<int_type> _nextc()
+        {
+            if (m_segment < m_segments->size())
+            {
+                advance(1);
+            }
+
+            return pplx::task_from_result(_sgetc());
+        }
+
+        pplx::task<int_type> _ungetc()
+        {
+            if (m_position == 0)
+            {
+                return pplx::task_from_result<int_type>(traits::eof());
+            }
+
+            seekpos(static_cast<pos_type>(m_position - 1), std::ios_base::in);
+            return pplx::task_from_result(_sgetc());
+        }
+
+        pplx::task<size_t> _getn(_Out_writes_(count) char_type* ptr, _In_ size_t count)
+        {
+            size_t copied = _scopy(ptr, count);
+            advance(copied);
+            return pplx::task_from_result(copied);
+        }
+
+        size_t _scopy(_Out_writes_(count) char_type* ptr, _In_ size_t count)
+        {
+            size_t copied = 0;
+            size_t segment_index = m_segment;
+            size_t offset = m_offset;
+            while (copied < count && segment_index < m_segments->size())
+            {
+                const std::string& segment = *(*m_segments)[segment_index];
+                size_t length = std::min(count - copied, segment.size() - offset);
+                std::memcpy(ptr + copied, segment.data() + offset, length);
+                copied += length;
+                offset = 0;
+                ++segment_index;
+            }
+
+            return copied;
+        }
+
+    private:
+
+        void advance(size_t count)
+        {
+            m_position += count;
+            while (count > 0 && m_segment < m_segments->size())
+            {
+                size_t remaining = (*m_segments)[m_segment]->size() - m_offset;
+                if (count < remaining)
+                {
+                    m_offset += count;
+                    return;
+                }
+
+                count -= remaining;
+                m_offset = 0;
+                ++m_segment;
+            }
+        }
+
+        std::shared_ptr<const std::vector<const std::string*>> m_segments;
+        utility::size64_t m_size;
+        size_t m_segment;
+        size_t m_offset;
+        utility::size64_t m_position;
+    };
+
+    mime_multipart_body::mime_multipart_body()
+        : m_body(std::make_shared<body_pieces>()), m_size(0)
+    {
+    }
+
+    size_t mime_multipart_body::add_piece(utility::string_t text)
+    {
+        m_body->m_pieces.push_back(utility::conversions::to_utf8string(std::move(text)));
+        return m_body->m_pieces.size() - 1;
+    }
+
+    void mime_multipart_body::append_piece(size_t piece)
+    {
+        const std::string& text = m_body->m_pieces[piece];
+        if (!text.empty())
+        {
+            // Empty segments are left out, so that a reader positioned on a segment always has a character to read.
+            m_body->m_segments.push_back(&text);
+            m_size += text.size();
+        }
+    }
+
+    concurrency::streams::istream mime_multipart_body::create_istream() const
+    {
+        std::shared_ptr<const std::vector<const std::string*>> segments(m_body, &m_body->m_segments);
+        auto streambuf = std::make_shared<basic_mime_multipart_istreambuf>(segments, m_size);
+        return concurrency::streams::streambuf<concurrency::streams::istream::traits::char_type>(streambuf).create_istream();
+    }
+
 }}} // namespace azure::storage::core
@@ -19,6 +19,10 @@
 #include "wascore/protocol.h"
 #include "wascore/protocol_json.h"
 
+#include <cerrno>
+#include <cstdlib>
+#include <limits>
+
 namespace azure { namespace storage { namespace protocol {
 
     edm_type get_property_type(const utility::string_t& type_name)
@@ -190,6 +194,1086 @@ namespace azure { namespace storage { namespace protocol {
         return entity;
     }
 
+    std::vector<table_entity> table_query_reader::move_entities()
+    {
+        std::vector<table_entity> entities;
+        read_entities([this, &entities]()
+        {
+            table_entity entity;
+            read_entity(entity);
+
+            // Empty objects are not entities.
+            if (m_property_count > 0)
+            {
+                entities.push_back(std::move(entity));
+            }
+        });
+
+        return entities;
+    }
+
+    std::vector<compact_table_entity> table_query_reader::move_compact_entities(std::shared_ptr<const table_entity_schema>& schema)
+    {
+        if (schema == nullptr)
+        {
+            schema = std::make_shared<table_entity_schema>();
+        }
+
+        m_schema = schema;
+        m_schema_names = schema->property_names();
+
+        std::vector<compact_table_entity> entities;
+        read_entities([this, &entities]()
+        {
+            compact_table_entity entity;
+            read_entity(entity);
+
+            if (m_property_count > 0)
+            {
+                entities.push_back(std::move(entity));
+            }
+        });
+
+        schema = m_schema;
+        return entities;
+    }
+
+    void table_query_reader::move_mapped_entities(const table_column_mapping& mapping, const std::function<void*()>& add_object)
+    {
+        read_entities([this, &mapping, &add_object]()
+        {
+            read_entity(mapping, add_object());
+        });
+    }
+
+    template<typename read_function>
+    void table_query_reader::read_entities(read_function read)
+    {
+        skip_whitespace();
+        if (at_end())
+        {
+            return;
+        }
+
+        if (!consume('{'))
+        {
+            // The document is not an object, so it has no entities.
+            skip_value();
+            return;
+        }
+
+        skip_whitespace();
+        if (!consume('}'))
+        {
+            do
+            {
+                skip_whitespace();
+                utility::string_t name = read_string();
+                skip_whitespace();
+                expect(':');
+                skip_whitespace();
+
+                if (name != _XPLATSTR("value") || !consume('['))
+                {
+                    skip_value();
+                }
+                else
+                {
+                    skip_whitespace();
+                    if (!consume(']'))
+                    {
+                        do
+                        {
+                            skip_whitespace();
+                            if (at_end() || *m_position != '{')
+                            {
+                                skip_value();
+                            }
+                            else
+                            {
+                                read();
+                            }
+
+                            skip_whitespace();
+                        } while (consume(','));
+
+                        expect(']');
+                    }
+                }
+
+                skip_whitespace();
+            } while (consume(','));
+
+            expect('}');
+        }
+    }
+
+    table_entity table_query_reader::move_entity()
+    {
+        table_entity entity;
+
+        skip_whitespace();
+        if (!at_end() && *m_position == '{')
+        {
+            read_entity(entity);
+        }
+
+        return entity;
+    }
+
+    void table_query_reader::read_entity(table_entity& entity)
+    {
+        expect('{');
+        m_type_annotations.clear();
+
+        // Entities of a segment usually have the same number of properties, so the map is sized after the previous entity.
+        entity.properties().reserve(m_names_by_position.size());
+
+        utility::string_t timestamp_str;
+        size_t index = 0;
+
+        skip_whitespace();
+        if (!consume('}'))
+        {
+            do
+            {
+                skip_whitespace();
+                const interned_name& name = read_property_name(index++);
+                skip_whitespace();
+                expect(':');
+                skip_whitespace();
+
+                switch (name.m_kind)
+                {
+                case name_kind::odata_etag:
+                    if (!at_end() && *m_position == '"' && entity.etag().empty())
+                    {
+                        entity.set_etag(read_string());
+                    }
+                    else
+                    {
+                        skip_value();
+                    }
+                    break;
+
+                case name_kind::odata_other:
+                    skip_value();
+                    break;
+
+                case name_kind::type_annotation:
+                    if (!at_end() && *m_position == '"')
+                    {
+                        m_type_annotations.push_back(std::make_pair(&name, get_property_type(read_string())));
+                    }
+                    else
+                    {
+                        skip_value();
+                    }
+                    break;
+
+                case name_kind::partition_key:
+                    if (!at_end() && *m_position == '"' && entity.partition_key().empty())
+                    {
+                        entity.set_partition_key(read_string());
+                    }
+                    else
+                    {
+                        skip_value();
+                    }
+                    break;
+
+                case name_kind::row_key:
+                    if (!at_end() && *m_position == '"' && entity.row_key().empty())
+                    {
+                        entity.set_row_key(read_string());
+                    }
+                    else
+                    {
+                        skip_value();
+                    }
+                    break;
+
+                case name_kind::timestamp:
+                    if (!at_end() && *m_position == '"')
+                    {
+                        timestamp_str = read_string();
+                        if (!entity.timestamp().is_initialized())
+                        {
+                            entity.set_timestamp(utility::datetime::from_string(timestamp_str, utility::datetime::ISO_8601));
+                        }
+                    }
+                    else
+                    {
+                        skip_value();
+                    }
+                    break;
+
+                default:
+                    {
+                        entity_property property;
+                        read_property_value(property);
+                        entity.properties().insert(table_entity::property_type(name.m_name, std::move(property)));
+                    }
+                    break;
+                }
+
+                skip_whitespace();
+            } while (consume(','));
+
+            expect('}');
+        }
+
+        m_property_count = index;
+
+        // Type annotations may come before or after the property they describe, and only apply to string values.
+        for (const auto& annotation : m_type_annotations)
+        {
+            auto it = entity.properties().find(annotation.first->m_annotated_property);
+            if (it != entity.properties().end() && !it->second.is_null() && it->second.property_type() == edm_type::string)
+            {
+                it->second.set_property_type(annotation.second);
+            }
+        }
+
+        // Generate the ETag from the Timestamp if it was not in the response header or the response body
+        if (entity.etag().empty() && !timestamp_str.empty())
+        {
+            entity.set_etag(get_etag_from_timestamp(timestamp_str));
+        }
+    }
+
+    void table_query_reader::read_entity(compact_table_entity& entity)
+    {
+        expect('{');
+        m_type_annotations.clear();
+
+        // Entities that share a schema usually have all of its properties, so the values are laid out for all of them.
+        entity.m_values.resize(m_schema_names.size());
+
+        utility::string_t timestamp_str;
+        size_t index = 0;
+
+        skip_whitespace();
+        if (!consume('}'))
+        {
+            do
+            {
+                skip_whitespace();
+                const interned_name& name = read_property_name(index++);
+                skip_whitespace();
+                expect(':');
+                skip_whitespace();
+
+                switch (name.m_kind)
+                {
+                case name_kind::odata_etag:
+                    if (!at_end() && *m_position == '"' && entity.etag().empty())
+                    {
+                        entity.set_etag(read_string());
+                    }
+                    else
+                    {
+                        skip_value();
+                    }
+                    break;
+
+                case name_kind::odata_other:
+                    skip_value();
+                    break;
+
+                case name_kind::type_annotation:
+                    if (!at_end() && *m_position == '"')
+                    {
+                        m_type_annotations.push_back(std::make_pair(&name, get_property_type(read_string())));
+                    }
+                    else
+                    {
+                        skip_value();
+                    }
+                    break;
+
+                case name_kind::partition_key:
+                    if (!at_end() && *m_position == '"' && entity.partition_key().empty())
+                    {
+                        entity.set_partition_key(read_string());
+                    }
+                    else
+                    {
+                        skip_value();
+                    }
+                    break;
+
+                case name_kind::row_key:
+                    if (!at_end() && *m_position == '"' && entity.row_key().empty())
+                    {
+                        entity.set_row_key(read_string());
+                    }
+                    else
+                    {
+                        skip_value();
+                    }
+                    break;
+
+                case name_kind::timestamp:
+                    if (!at_end() && *m_position == '"')
+                    {
+                        timestamp_str = read_string();
+                        if (!entity.timestamp().is_initialized())
+                        {
+                            entity.set_timestamp(utility::datetime::from_string(timestamp_str, utility::datetime::ISO_8601));
+                        }
+                    }
+                    else
+                    {
+                        skip_value();
+                    }
+                    break;
+
+                default:
+                    {
+                        size_t schema_index = get_schema_index(name);
+                        if (schema_index >= entity.m_values.size())
+                        {
+                            entity.m_values.resize(schema_index + 1);
+                        }
+
+                        read_property_value(entity.m_values[schema_index]);
+                    }
+                    break;
+                }
+
+                skip_whitespace();
+            } while (consume(','));
+
+            expect('}');
+        }
+
+        m_property_count = index;
+
+        // Annotated values arrive as strings and are converted once, here, into their own type.
+        for (const auto& annotation : m_type_annotations)
+        {
+            auto it = m_names.find(utility::conversions::to_utf8string(annotation.first->m_annotated_property));
+            if (it != m_names.end() && it->second.m_schema_index < entity.m_values.size())
+            {
+                compact_entity_value& value = entity.m_values[it->second.m_schema_index];
+                if (!value.is_null() && value.property_type() == edm_type::string)
+                {
+                    convert_string_value(value, annotation.second);
+                }
+            }
+        }
+
+        // The schema is only replaced when this entity added properties to it, so entities with the same properties share one.
+        if (m_schema->size() != m_schema_names.size())
+        {
+            m_schema = std::make_shared<table_entity_schema>(m_schema_names);
+        }
+
+        entity.m_schema = m_schema;
+
+        if (entity.etag().empty() && !timestamp_str.empty())
+        {
+            entity.set_etag(get_etag_from_timestamp(timestamp_str));
+        }
+    }
+
+    void table_query_reader::read_entity(const table_column_mapping& mapping, void* object)
+    {
+        expect('{');
+
+        utility::string_t timestamp_str;
+        bool has_etag = false;
+        size_t index = 0;
+
+        skip_whitespace();
+        if (!consume('}'))
+        {
+            do
+            {
+                skip_whitespace();
+                const interned_name& name = read_property_name(index++);
+                skip_whitespace();
+                expect(':');
+                skip_whitespace();
+
+                // Keys and the timestamp are only decoded when they are mapped. Type annotations are not needed, as the
+                // type of every mapped column is known.
+                bool is_string = !at_end() && *m_position == '"';
+                switch (name.m_kind)
+                {
+                case name_kind::odata_etag:
+                    if (is_string && mapping.etag_setter() && !has_etag)
+                    {
+                        mapping.etag_setter()(object, read_string());
+                        has_etag = true;
+                    }
+                    else
+                    {
+                        skip_value();
+                    }
+                    break;
+
+                case name_kind::partition_key:
+                    if (is_string && mapping.partition_key_setter())
+                    {
+                        mapping.partition_key_setter()(object, read_string());
+                    }
+                    else
+                    {
+                        skip_value();
+                    }
+                    break;
+
+                case name_kind::row_key:
+                    if (is_string && mapping.row_key_setter())
+                    {
+                        mapping.row_key_setter()(object, read_string());
+                    }
+                    else
+                    {
+                        skip_value();
+                    }
+                    break;
+
+                case name_kind::timestamp:
+                    if (is_string && (mapping.timestamp_setter() || mapping.etag_setter()))
+                    {
+                        timestamp_str = read_string();
+                        if (mapping.timestamp_setter())
+                        {
+                            mapping.timestamp_setter()(object, utility::datetime::from_string(timestamp_str, utility::datetime::ISO_8601));
+                        }
+                    }
+                    else
+                    {
+                        skip_value();
+                    }
+                    break;
+
+                case name_kind::property:
+                    {
+                        size_t column_index = get_column_index(mapping, name);
+                        if (column_index >= mapping.columns().size())
+                        {
+                            skip_value();
+                            break;
+                        }
+
+                        const table_column_mapping::column& column = mapping.columns()[column_index];
+                        read_column_value(m_column_value, column.m_property_type);
+                        if (!m_column_value.is_null())
+                        {
+                            if (m_column_value.property_type() != column.m_property_type)
+                            {
+                                convert_column_value(m_column_value, column.m_property_type);
+                            }
+
+                            column.m_setter(object, m_column_value);
+                        }
+                    }
+                    break;
+
+                default:
+                    skip_value();
+                    break;
+                }
+
+                skip_whitespace();
+            } while (consume(','));
+
+            expect('}');
+        }
+
+        m_property_count = index;
+
+        if (!has_etag && mapping.etag_setter() && !timestamp_str.empty())
+        {
+            mapping.etag_setter()(object, get_etag_from_timestamp(timestamp_str));
+        }
+    }
+
+    size_t table_query_reader::get_column_index(const table_column_mapping& mapping, const interned_name& name)
+    {
+        // Like the schema index, the column index is looked up once per reader; unmapped names get an index past the last column.
+        if (name.m_schema_index == interned_name::no_schema_index)
+        {
+            if (!mapping.find(name.m_name, name.m_schema_index))
+            {
+                name.m_schema_index = mapping.columns().size();
+            }
+        }
+
+        return name.m_schema_index;
+    }
+
+    void table_query_reader::convert_column_value(compact_entity_value& value, edm_type property_type)
+    {
+        // Strings carry the values that JSON has no type for, with or without a type annotation. Numbers are already
+        // read in the column's type by read_column_value.
+        if (value.property_type() == edm_type::string)
+        {
+            convert_string_value(value, property_type);
+        }
+    }
+
+    size_t table_query_reader::get_schema_index(const interned_name& name)
+    {
+        // The index is assigned on first use, so names are looked up in the schema once per reader rather than once per entity.
+        if (name.m_schema_index == interned_name::no_schema_index)
+        {
+            if (!m_schema->find(name.m_name, name.m_schema_index))
+            {
+                name.m_schema_index = m_schema_names.size();
+                m_schema_names.push_back(name.m_name);
+            }
+        }
+
+        return name.m_schema_index;
+    }
+
+    void table_query_reader::convert_string_value(compact_entity_value& value, edm_type property_type)
+    {
+        const utility::string_t& text = value.string_value();
+        switch (property_type)
+        {
+        case edm_type::binary:
+            value.set_value(utility::conversions::from_base64(text));
+            break;
+
+        case edm_type::boolean:
+            if (text.compare(_XPLATSTR("true")) != 0 && text.compare(_XPLATSTR("false")) != 0)
+            {
+                throw storage_exception(protocol::error_parse_boolean, false);
+            }
+
+            value.set_value(text.compare(_XPLATSTR("true")) == 0);
+            break;
+
+        case edm_type::datetime:
+            {
+                utility::datetime datetime_value = utility::datetime::from_string(text, utility::datetime::ISO_8601);
+                if (!datetime_value.is_initialized())
+                {
+                    throw storage_exception(protocol::error_parse_datetime, false);
+                }
+
+                value.set_value(datetime_value);
+            }
+            break;
+
+        case edm_type::double_floating_point:
+            {
+                double double_value;
+                if (text.compare(protocol::double_not_a_number) == 0)
+                {
+                    double_value = std::numeric_limits<double>::quiet_NaN();
+                }
+                else if (text.compare(protocol::double_infinity) == 0)
+                {
+                    double_value = std::numeric_limits<double>::infinity();
+                }
+                else if (text.compare(protocol::double_negative_infinity) == 0)
+                {
+                    double_value = -std::numeric_limits<double>::infinity();
+                }
+                else
+                {
+                    std::string number = utility::conversions::to_utf8string(text);
+                    char* number_end = nullptr;
+                    double_value = std::strtod(number.c_str(), &number_end);
+                    if (number.empty() || number_end != number.c_str() + number.size())
+                    {
+                        throw storage_exception(protocol::error_parse_double, false);
+                    }
+                }
+
+                value.set_value(double_value);
+            }
+            break;
+
+        case edm_type::guid:
+            value.set_value(utility::string_to_uuid(text));
+            break;
+
+        case edm_type::int32:
+        case edm_type::int64:
+            {
+                std::string number = utility::conversions::to_utf8string(text);
+                char* number_end = nullptr;
+                errno = 0;
+                long long integer_value = std::strtoll(number.c_str(), &number_end, 10);
+                bool is_int32 = property_type == edm_type::int32;
+                if (number.empty() || number_end != number.c_str() + number.size() || errno == ERANGE ||
+                    (is_int32 && (integer_value < std::numeric_limits<int32_t>::min() || integer_value > std::numeric_limits<int32_t>::max())))
+                {
+                    throw storage_exception(is_int32 ? protocol::error_parse_int32 : protocol::error_parse_int64, false);
+                }
+
+                if (is_int32)
+                {
+                    value.set_value(static_cast<int32_t>(integer_value));
+                }
+                else
+                {
+                    value.set_value(static_cast<int64_t>(integer_value));
+                }
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    const table_query_reader::interned_name& table_query_reader::read_property_name(size_t index)
+    {
+        const char* begin;
+        const char* end;
+        bool has_escapes = read_string_token(begin, end);
+        size_t length = static_cast<size_t>(end - begin);
+
+        if (!has_escapes && index < m_names_by_position.size() && m_names_by_position[index].first != nullptr)
+        {
+            const std::string& previous = *m_names_by_position[index].first;
+            if (previous.size() == length && std::equal(begin, end, previous.begin()))
+            {
+                return *m_names_by_position[index].second;
+            }
+        }
+
+        std::string raw_name = decode_string(begin, end, has_escapes);
+        auto it = m_names.find(raw_name);
+        if (it == m_names.end())
+        {
+            interned_name name;
+            name.m_name = utility::conversions::to_string_t(raw_name);
+            name.m_schema_index = interned_name::no_schema_index;
+
+            const utility::string_t& property_name = name.m_name;
+            if (property_name.size() >= 6 && property_name.compare(0, 6, _XPLATSTR("odata.")) == 0)
+            {
+                name.m_kind = property_name.compare(6, property_name.size() - 6, _XPLATSTR("etag")) == 0 ? name_kind::odata_etag : name_kind::odata_other;
+            }
+            else if (property_name.size() >= 11 && property_name.compare(property_name.size() - 11, 11, _XPLATSTR("@odata.type")) == 0)
+            {
+                name.m_kind = name_kind::type_annotation;
+                name.m_annotated_property = property_name.substr(0, property_name.size() - 11);
+            }
+            else if (property_name.compare(_XPLATSTR("PartitionKey")) == 0)
+            {
+                name.m_kind = name_kind::partition_key;
+            }
+            else if (property_name.compare(_XPLATSTR("RowKey")) == 0)
+            {
+                name.m_kind = name_kind::row_key;
+            }
+            else if (property_name.compare(_XPLATSTR("Timestamp")) == 0)
+            {
+                name.m_kind = name_kind::timestamp;
+            }
+            else
+            {
+                name.m_kind = name_kind::property;
+            }
+
+            it = m_names.insert(std::make_pair(std::move(raw_name), std::move(name))).first;
+        }
+
+        // Elements of an unordered_map do not move when it grows, so the position cache can point into it.
+        if (index >= m_names_by_position.size())
+        {
+            m_names_by_position.resize(index + 1);
+        }
+
+        // The cache compares raw bytes, which only match the decoded key when there is nothing to decode.
+        m_names_by_position[index] = std::make_pair(has_escapes ? nullptr : &it->first, &it->second);
+
+        return it->second;
+    }
+
+    void table_query_reader::read_property_value(entity_property& property)
+    {
+        if (at_end())
+        {
+            throw storage_exception(protocol::error_json_not_valid, true);
+        }
+
+        // The type is set to String for consistency unless a specific EDM type was specified
+        char first = *m_position;
+        if (first == '"')
+        {
+            property.set_value(read_string());
+        }
+        else if (first == 't' || first == 'f')
+        {
+            bool value = first == 't';
+            skip_value();
+            property.set_value(value);
+        }
+        else if (first == '-' || (first >= '0' && first <= '9'))
+        {
+            // Without a type annotation, whole numbers are truncated to 32 bits, as web::json::value::as_integer does.
+            int64_t integer_value;
+            double double_value;
+            if (read_number(integer_value, double_value))
+            {
+                property.set_value(static_cast<int32_t>(integer_value));
+            }
+            else
+            {
+                property.set_value(double_value);
+            }
+        }
+        else
+        {
+            // Null values, and objects or arrays which tables do not support, become null properties.
+            skip_value();
+        }
+    }
+
+    void table_query_reader::read_property_value(compact_entity_value& value)
+    {
+        if (at_end())
+        {
+            throw storage_exception(protocol::error_json_not_valid, true);
+        }
+
+        char first = *m_position;
+        if (first == '"')
+        {
+            value.set_value(read_string());
+        }
+        else if (first == 't' || first == 'f')
+        {
+            bool boolean_value = first == 't';
+            skip_value();
+            value.set_value(boolean_value);
+        }
+        else if (first == '-' || (first >= '0' && first <= '9'))
+        {
+            // Truncated like the table_entity path, so both read the same values.
+            int64_t integer_value;
+            double double_value;
+            if (read_number(integer_value, double_value))
+            {
+                value.set_value(static_cast<int32_t>(integer_value));
+            }
+            else
+            {
+                value.set_value(double_value);
+            }
+        }
+        else
+        {
+            skip_value();
+            value.set_null();
+        }
+    }
+
+    void table_query_reader::read_column_value(compact_entity_value& value, edm_type property_type)
+    {
+        if (at_end() || !(*m_position == '-' || (*m_position >= '0' && *m_position <= '9')))
+        {
+            read_property_value(value);
+            return;
+        }
+
+        // The column's type is known, so whole numbers are kept at full width and only narrowed for 32-bit columns.
+        int64_t integer_value;
+        double double_value;
+        if (!read_number(integer_value, double_value))
+        {
+            value.set_value(double_value);
+            return;
+        }
+
+        switch (property_type)
+        {
+        case edm_type::int64:
+            value.set_value(integer_value);
+            break;
+
+        case edm_type::double_floating_point:
+            value.set_value(static_cast<double>(integer_value));
+            break;
+
+        case edm_type::int32:
+            if (integer_value < std::numeric_limits<int32_t>::min() || integer_value > std::numeric_limits<int32_t>::max())
+            {
+                throw storage_exception(protocol::error_parse_int32, false);
+            }
+
+            value.set_value(static_cast<int32_t>(integer_value));
+            break;
+
+        default:
+            value.set_value(static_cast<int32_t>(integer_value));
+            break;
+        }
+    }
+
+    bool table_query_reader::read_number(int64_t& integer_value, double& double_value)
+    {
+        const char* begin = m_position;
+        bool is_integer = true;
+        while (!at_end() && (*m_position == '-' || *m_position == '+' || *m_position == '.' || *m_position == 'e' || *m_position == 'E' || (*m_position >= '0' && *m_position <= '9')))
+        {
+            if (*m_position == '.' || *m_position == 'e' || *m_position == 'E')
+            {
+                is_integer = false;
+            }
+
+            ++m_position;
+        }
+
+        std::string number(begin, m_position);
+        char* number_end = nullptr;
+        errno = 0;
+        if (is_integer)
+        {
+            // Integers that do not fit in 64 bits are read as doubles, like web::json::value does.
+            int64_t value = std::strtoll(number.c_str(), &number_end, 10);
+            if (errno != ERANGE && number_end == number.c_str() + number.size())
+            {
+                integer_value = value;
+                return true;
+            }
+        }
+
+        errno = 0;
+        double_value = std::strtod(number.c_str(), &number_end);
+        if (number_end != number.c_str() + number.size())
+        {
+            throw storage_exception(protocol::error_json_not_valid, true);
+        }
+
+        return false;
+    }
+
+    bool table_query_reader::read_string_token(const char*& begin, const char*& end)
+    {
+        expect('"');
+        begin = m_position;
+
+        bool has_escapes = false;
+        while (!at_end() && *m_position != '"')
+        {
+            if (*m_position == '\\')
+            {
+                has_escapes = true;
+                ++m_position;
+                if (at_end())
+                {
+                    break;
+                }
+            }
+
+            ++m_position;
+        }
+
+        end = m_position;
+        expect('"');
+        return has_escapes;
+    }
+
+    std::string table_query_reader::decode_string(const char* begin, const char* end, bool has_escapes) const
+    {
+        if (!has_escapes)
+        {
+            return std::string(begin, end);
+        }
+
+        std::string result;
+        result.reserve(static_cast<size_t>(end - begin));
+        for (const char* it = begin; it != end; ++it)
+        {
+            if (*it != '\\')
+            {
+                result.push_back(*it);
+                continue;
+            }
+
+            // read_string_token guarantees that an escape is followed by at least one character.
+            switch (*++it)
+            {
+            case 'b': result.push_back('\b'); break;
+            case 'f': result.push_back('\f'); break;
+            case 'n': result.push_back('\n'); break;
+            case 'r': result.push_back('\r'); break;
+            case 't': result.push_back('\t'); break;
+            case 'u':
+                {
+                    auto read_code_unit = [&it, end]() -> uint32_t
+                    {
+                        if (end - it < 5)
+                        {
+                            throw storage_exception(protocol::error_json_not_valid, true);
+                        }
+
+                        uint32_t code_unit = 0;
+                        for (int i = 0; i < 4; ++i)
+                        {
+                            char digit = *++it;
+                            code_unit <<= 4;
+                            if (digit >= '0' && digit <= '9') code_unit |= static_cast<uint32_t>(digit - '0');
+                            else if (digit >= 'a' && digit <= 'f') code_unit |= static_cast<uint32_t>(digit - 'a' + 10);
+                            else if (digit >= 'A' && digit <= 'F') code_unit |= static_cast<uint32_t>(digit - 'A' + 10);
+                            else throw storage_exception(protocol::error_json_not_valid, true);
+                        }
+
+                        return code_unit;
+                    };
+
+                    uint32_t code_point = read_code_unit();
+                    if (code_point >= 0xD800 && code_point <= 0xDBFF && end - it >= 7 && it[1] == '\\' && it[2] == 'u')
+                    {
+                        const char* high_end = it;
+                        it += 2;
+                        uint32_t low = read_code_unit();
+                        if (low >= 0xDC00 && low <= 0xDFFF)
+                        {
+                            code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+                        }
+                        else
+                        {
+                            // Not a surrogate pair. The second escape is decoded on its own.
+                            it = high_end;
+                        }
+                    }
+
+                    // Encode the code point as UTF-8.
+                    if (code_point < 0x80)
+                    {
+                        result.push_back(static_cast<char>(code_point));
+                    }
+                    else if (code_point < 0x800)
+                    {
+                        result.push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+                        result.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+                    }
+                    else if (code_point < 0x10000)
+                    {
+                        result.push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+                        result.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+                        result.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+                    }
+                    else
+                    {
+                        result.push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+                        result.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+                        result.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+                        result.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+                    }
+                }
+                break;
+            default:
+                // \" \\ and \/ stand for the character itself.
+                result.push_back(*it);
+                break;
+            }
+        }
+
+        return result;
+    }
+
+    utility::string_t table_query_reader::read_string()
+    {
+        const char* begin;
+        const char* end;
+        bool has_escapes = read_string_token(begin, end);
+        return utility::conversions::to_string_t(decode_string(begin, end, has_escapes));
+    }
+
+    void table_query_reader::skip_value()
+    {
+        skip_whitespace();
+        if (at_end())
+        {
+            throw storage_exception(protocol::error_json_not_valid, true);
+        }
+
+        char first = *m_position;
+        if (first == '"')
+        {
+            const char* begin;
+            const char* end;
+            read_string_token(begin, end);
+        }
+        else if (first == '{' || first == '[')
+        {
+            char closing = first == '{' ? '}' : ']';
+            ++m_position;
+            skip_whitespace();
+            if (!consume(closing))
+            {
+                do
+                {
+                    skip_whitespace();
+                    if (first == '{')
+                    {
+                        const char* begin;
+                        const char* end;
+                        read_string_token(begin, end);
+                        skip_whitespace();
+                        expect(':');
+                    }
+
+                    skip_value();
+                    skip_whitespace();
+                } while (consume(','));
+
+                expect(closing);
+            }
+        }
+        else
+        {
+            // A number or a literal runs until the next structural character.
+            const char* begin = m_position;
+            while (!at_end() && *m_position != ',' && *m_position != '}' && *m_position != ']' && *m_position != ' ' && *m_position != '\t' && *m_position != '\r' && *m_position != '\n')
+            {
+                ++m_position;
+            }
+
+            if (m_position == begin)
+            {
+                throw storage_exception(protocol::error_json_not_valid, true);
+            }
+        }
+    }
+
+    void table_query_reader::skip_whitespace()
+    {
+        while (!at_end() && (*m_position == ' ' || *m_position == '\t' || *m_position == '\r' || *m_position == '\n'))
+        {
+            ++m_position;
+        }
+    }
+
+    bool table_query_reader::consume(char expected)
+    {
+        if (!at_end() && *m_position == expected)
+        {
+            ++m_position;
+            return true;
+        }
+
+        return false;
+    }
+
+    void table_query_reader::expect(char expected)
+    {
+        if (!consume(expected))
+        {
+            throw storage_exception(protocol::error_json_not_valid, true);
+        }
+    }
+
+    bool table_query_reader::at_end() const
+    {
+        return m_position == m_end;
+    }
+
     storage_extended_error parse_table_error(const web::json::value& document)
     {
         utility::string_t error_code;
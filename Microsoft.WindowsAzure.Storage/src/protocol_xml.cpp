@@ -16,6 +16,7 @@
 // -----------------------------------------------------------------------------------------
 
 #include "stdafx.h"
+#include "wascore/base64.h"
 #include "wascore/protocol.h"
 #include "wascore/protocol_xml.h"
 
@@ -366,6 +367,173 @@ namespace azure { namespace storage { namespace protocol {
         }
     }
 
+    namespace
+    {
+        bool read_digits(const utility::char_t* text, size_t count, int64_t& value)
+        {
+            value = 0;
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (text[i] < _XPLATSTR('0') || text[i] > _XPLATSTR('9'))
+                {
+                    return false;
+                }
+
+                value = value * 10 + (text[i] - _XPLATSTR('0'));
+            }
+
+            return true;
+        }
+
+        // Parses a date in the form "Mon, 01 Jan 2018 00:00:00 GMT", which is how the service writes Last-Modified, without allocating.
+        bool parse_rfc1123_datetime(const utility::string_t& text, utility::datetime& value)
+        {
+            static const utility::char_t months[] = _XPLATSTR("JanFebMarAprMayJunJulAugSepOctNovDec");
+
+            if (text.size() != 29 || text[3] != _XPLATSTR(',') || text[4] != _XPLATSTR(' ') || text[7] != _XPLATSTR(' ') || text[11] != _XPLATSTR(' ')
+                || text[16] != _XPLATSTR(' ') || text[19] != _XPLATSTR(':') || text[22] != _XPLATSTR(':') || text.compare(25, 4, _XPLATSTR(" GMT")) != 0)
+            {
+                return false;
+            }
+
+            int64_t day, year, hour, minute, second;
+            if (!read_digits(&text[5], 2, day) || !read_digits(&text[12], 4, year) || !read_digits(&text[17], 2, hour)
+                || !read_digits(&text[20], 2, minute) || !read_digits(&text[23], 2, second))
+            {
+                return false;
+            }
+
+            int64_t month = 1;
+            while (month <= 12 && text.compare(8, 3, months + (month - 1) * 3, 3) != 0)
+            {
+                ++month;
+            }
+
+            if (month > 12 || day < 1 || day > 31 || year < 1601 || hour > 23 || minute > 59 || second > 59)
+            {
+                return false;
+            }
+
+            // Days since 1970-01-01 in the proleptic Gregorian calendar.
+            int64_t shifted_year = month <= 2 ? year - 1 : year;
+            int64_t era = shifted_year / 400;
+            int64_t year_of_era = shifted_year - era * 400;
+            int64_t day_of_year = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+            int64_t day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+            int64_t days = era * 146097 + day_of_era - 719468;
+
+            // utility::datetime counts 100-nanosecond intervals since 1601-01-01, which is 11644473600 seconds before 1970-01-01.
+            int64_t seconds = days * 86400 + hour * 3600 + minute * 60 + second + 11644473600LL;
+            value = utility::datetime() + static_cast<utility::datetime::interval_type>(seconds) * 10000000ULL;
+            return true;
+        }
+    }
+
+    void compact_list_blobs_reader::handle_begin_element(const utility::string_t& element_name)
+    {
+        if ((element_name == xml_blob || element_name == xml_blob_prefix) && get_parent_element_name() == xml_blobs)
+        {
+            m_item = compact_list_blob_item_segment::item();
+            m_item.type = blob_type::unspecified;
+            m_item.is_blob = element_name == xml_blob;
+            m_item.metadata_begin = static_cast<uint32_t>(m_segment.m_metadata.size());
+        }
+    }
+
+    void compact_list_blobs_reader::handle_element(const utility::string_t& element_name)
+    {
+        utility::string_t parent_element_name = get_parent_element_name();
+        if (parent_element_name == xml_metadata)
+        {
+            read_current_element_text(m_text);
+            uint32_t name = add_string(element_name);
+            m_segment.m_metadata.push_back(std::make_pair(name, add_string(m_text)));
+            return;
+        }
+
+        if (parent_element_name == xml_properties)
+        {
+            if (element_name == xml_content_length)
+            {
+                read_current_element_text(m_text);
+                int64_t size;
+                if (read_digits(m_text.data(), m_text.size(), size))
+                {
+                    m_item.size = static_cast<utility::size64_t>(size);
+                }
+            }
+            else if (element_name == xml_last_modified)
+            {
+                read_current_element_text(m_text);
+                if (!parse_rfc1123_datetime(m_text, m_item.last_modified))
+                {
+                    m_item.last_modified = parse_last_modified(m_text);
+                }
+            }
+            else if (element_name == xml_etag)
+            {
+                read_current_element_text(m_text);
+                m_item.etag = add_string(m_text, /* quoted */ true);
+            }
+            else if (element_name == xml_blob_type)
+            {
+                read_current_element_text(m_text);
+                m_item.type = blob_response_parsers::parse_blob_type(m_text);
+            }
+
+            return;
+        }
+
+        if (parent_element_name == xml_blob || parent_element_name == xml_blob_prefix)
+        {
+            if (element_name == xml_name)
+            {
+                read_current_element_text(m_text);
+                m_item.name = add_string(m_text);
+            }
+            else if (element_name == xml_snapshot)
+            {
+                read_current_element_text(m_text);
+                m_item.snapshot_time = add_string(m_text);
+            }
+
+            return;
+        }
+
+        if (element_name == xml_next_marker)
+        {
+            read_current_element_text(m_next_marker);
+        }
+    }
+
+    void compact_list_blobs_reader::handle_end_element(const utility::string_t& element_name)
+    {
+        if ((element_name == xml_blob || element_name == xml_blob_prefix) && get_parent_element_name() == xml_blobs)
+        {
+            m_item.metadata_count = static_cast<uint32_t>(m_segment.m_metadata.size()) - m_item.metadata_begin;
+            m_segment.m_items.push_back(m_item);
+        }
+    }
+
+    uint32_t compact_list_blobs_reader::add_string(const utility::string_t& value, bool quoted)
+    {
+        std::vector<utility::char_t>& strings = m_segment.m_strings;
+        uint32_t offset = static_cast<uint32_t>(strings.size());
+        if (quoted)
+        {
+            strings.push_back(_XPLATSTR('"'));
+        }
+
+        strings.insert(strings.end(), value.begin(), value.end());
+        if (quoted)
+        {
+            strings.push_back(_XPLATSTR('"'));
+        }
+
+        strings.push_back(utility::char_t());
+        return offset;
+    }
+
     void page_list_reader::handle_element(const utility::string_t& element_name)
     {
         if (element_name == xml_start && m_start == -1)
@@ -724,6 +892,21 @@ namespace azure { namespace storage { namespace protocol {
 
     std::string message_writer::write(const cloud_queue_message& message)
     {
+        if (message.m_is_binary)
+        {
+            // Base64 text never needs escaping, so the body is put together directly and the data is encoded straight into it.
+            static const char body_start[] = "<?xml version=\"1.0\" encoding=\"utf-8\"?><QueueMessage><MessageText>";
+            static const char body_end[] = "</MessageText></QueueMessage>";
+
+            const std::vector<uint8_t>& content = message.m_binary_content;
+            std::string body;
+            body.reserve(sizeof(body_start) - 1 + (content.size() + 2) / 3 * 4 + sizeof(body_end) - 1);
+            body.append(body_start, sizeof(body_start) - 1);
+            core::append_base64(content.data(), content.size(), body);
+            body.append(body_end, sizeof(body_end) - 1);
+            return body;
+        }
+
         std::ostringstream outstream;
         initialize(outstream);
 
@@ -153,7 +153,7 @@ namespace azure { namespace storage { namespace protocol {
         return request;
     }
 
-    web::http::http_request add_message(const cloud_queue_message& message, std::chrono::seconds time_to_live, std::chrono::seconds initial_visibility_timeout, web::http::uri_builder& uri_builder, const std::chrono::seconds& timeout, operation_context context)
+    web::http::http_request add_message(const std::string& content, std::chrono::seconds time_to_live, std::chrono::seconds initial_visibility_timeout, web::http::uri_builder& uri_builder, const std::chrono::seconds& timeout, operation_context context)
     {
         if (time_to_live.count() >= -1LL && time_to_live.count() != 604800LL)
         {
@@ -166,9 +166,6 @@ namespace azure { namespace storage { namespace protocol {
         }
 
         web::http::http_request request = queue_base_request(web::http::methods::POST, uri_builder, timeout, context);
-
-        protocol::message_writer writer;
-        std::string content = writer.write(message);
         request.set_body(content);
 
         return request;
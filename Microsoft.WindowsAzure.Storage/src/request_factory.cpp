@@ -84,6 +84,21 @@ namespace azure { namespace storage { namespace protocol {
         }
     }
 
+    void add_content_crc64(web::http::http_headers& headers, const utility::string_t& content_crc64)
+    {
+        if (!content_crc64.empty())
+        {
+            headers.add(ms_header_content_crc64, content_crc64);
+            use_crc64_storage_version(headers);
+        }
+    }
+
+    void use_crc64_storage_version(web::http::http_headers& headers)
+    {
+        // CRC64 headers are only understood from this version on, and it does not change the operations that send them.
+        headers[ms_header_version] = header_value_crc64_storage_version;
+    }
+
     void add_metadata(web::http::http_request& request, const cloud_metadata& metadata)
     {
         web::http::http_headers& headers = request.headers();
@@ -34,34 +34,73 @@ namespace azure { namespace storage { namespace core {
         m_committed = true;
         basic_ostreambuf<basic_cloud_ostreambuf::char_type>::_close_write().wait();
 
-        if (m_total_hash_provider.is_enabled())
-        {
-            m_total_hash_provider.close();
-        }
-
         return commit_close();
     }
 
     std::shared_ptr<basic_cloud_ostreambuf::buffer_to_upload> basic_cloud_ostreambuf::prepare_buffer()
     {
-        utility::string_t block_md5;
-        if (m_transaction_hash_provider.is_enabled())
+        auto buffer = std::make_shared<basic_cloud_ostreambuf::buffer_to_upload>(m_buffer);
+        m_buffer = concurrency::streams::container_buffer<std::vector<char_type>>();
+        m_buffer_size = m_next_buffer_size;
+
+        if (buffer->is_empty())
         {
-            m_transaction_hash_provider.close();
-            block_md5 = m_transaction_hash_provider.hash();
-            m_transaction_hash_provider = hash_provider::create_md5_hash_provider();
+            return buffer;
+        }
+
+        // Buffers are hashed on workers once they are full, so the thread writing to the stream can go on filling the next one.
+        // The continuations keep the buffer alive until it has been hashed, even if its upload does not happen.
+        if (m_use_transactional_crc64)
+        {
+            buffer->m_hash_task = hash_pipeline::crc64_async(buffer->data(), static_cast<size_t>(buffer->size())).then([buffer](utility::string_t crc64)
+            {
+                buffer->m_content_crc64 = std::move(crc64);
+            });
+        }
+        else if (m_use_transactional_md5)
+        {
+            buffer->m_hash_task = hash_pipeline::md5_async(buffer->data(), static_cast<size_t>(buffer->size())).then([buffer](utility::string_t md5)
+            {
+                buffer->m_content_md5 = std::move(md5);
+            });
+        }
+
+        if (m_total_hash_provider.is_enabled())
+        {
+            // The hash of the whole stream is calculated one buffer after the other, in the order the buffers were written.
+            auto provider = m_total_hash_provider;
+            m_total_hash_task = m_total_hash_task.then([provider, buffer]() mutable
+            {
+                provider.write(buffer->data(), static_cast<size_t>(buffer->size()));
+            });
         }
 
-        auto buffer = std::make_shared<basic_cloud_ostreambuf::buffer_to_upload>(m_buffer, block_md5);
-        m_buffer = concurrency::streams::container_buffer<std::vector<char_type>>();
-        m_buffer_size = m_next_buffer_size;
         return buffer;
     }
 
+    pplx::task<void> basic_cloud_ostreambuf::close_total_hash()
+    {
+        auto provider = m_total_hash_provider;
+        return m_total_hash_task.then([provider]() mutable
+        {
+            provider.close();
+        });
+    }
+
+    void basic_cloud_ostreambuf::acquire_buffer()
+    {
+        // The next buffer is only taken from the pool once data is written to it, so closing the stream does not hold an unused buffer.
+        if (m_buffer.collection().capacity() == 0)
+        {
+            m_buffer = concurrency::streams::container_buffer<std::vector<char_type>>(buffer_pool::acquire(m_buffer_size), std::ios_base::out);
+        }
+    }
+
     pplx::task<basic_cloud_ostreambuf::int_type> basic_cloud_ostreambuf::_putc(concurrency::streams::ostream::traits::char_type ch)
     {
         pplx::task<void> upload_task = pplx::task_from_result();
 
+        acquire_buffer();
         m_current_streambuf_offset += 1;
         auto result = m_buffer.putc(ch).get();
         if (m_buffer_size == m_buffer.in_avail())
@@ -83,22 +122,13 @@ namespace azure { namespace storage { namespace core {
         auto remaining = count;
         while (remaining > 0)
         {
+            acquire_buffer();
             auto write_size = m_buffer_size - static_cast<size_t>(m_buffer.size());
             if (write_size > remaining)
             {
                 write_size = remaining;
             }
 
-            if (m_transaction_hash_provider.is_enabled())
-            {
-                m_transaction_hash_provider.write(ptr, write_size);
-            }
-
-            if (m_total_hash_provider.is_enabled())
-            {
-                m_total_hash_provider.write(ptr, write_size);
-            }
-
             // The streambuf is waited because it is a memory buffer, so does not involve async I/O
             m_buffer.putn_nocopy(ptr, write_size).wait();
             if (m_buffer_size == m_buffer.size())
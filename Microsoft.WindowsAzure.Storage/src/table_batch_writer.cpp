@@ -0,0 +1,296 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="table_batch_writer.cpp" company="Microsoft">
+//    Copyright 2013 Microsoft Corporation
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "wascore/async_semaphore.h"
+#include "wascore/constants.h"
+#include "wascore/protocol.h"
+#include "wascore/resources.h"
+#include "wascore/timer_handler.h"
+#include "was/table.h"
+
+#include <unordered_set>
+
+namespace azure { namespace storage {
+
+    class table_batch_writer::writer_state : public std::enable_shared_from_this<writer_state>
+    {
+    public:
+
+        writer_state(cloud_table table, size_t max_batch_size, std::chrono::milliseconds max_latency, int parallelism, const table_request_options& options, operation_context context)
+            : m_table(std::move(table)), m_max_batch_size(max_batch_size), m_max_latency(max_latency), m_semaphore(std::make_shared<core::async_semaphore>(parallelism)),
+            m_options(options), m_context(context), m_next_batch_id(0)
+        {
+        }
+
+        ~writer_state()
+        {
+            // Only reachable when batches are not sent on a timer, since a running timer keeps the state alive.
+            for (auto& pending : m_pending)
+            {
+                for (auto& result : pending.second->m_results)
+                {
+                    result.set_exception(std::runtime_error(protocol::error_batch_writer_destroyed));
+                }
+            }
+        }
+
+        pplx::task<table_result> add(const table_operation& operation)
+        {
+            pplx::task_completion_event<table_result> result;
+            if (operation.operation_type() == table_operation_type::retrieve_operation)
+            {
+                // A retrieve operation must be the only operation of a batch, so it is sent as a single operation.
+                auto state = shared_from_this();
+                std::lock_guard<std::mutex> guard(m_mutex);
+                track(m_semaphore->lock_async().then([state, operation]()
+                {
+                    return state->m_table.execute_async(operation, state->m_options, state->m_context);
+                }).then([state, result](pplx::task<table_result> operation_task)
+                {
+                    state->m_semaphore->unlock();
+                    try
+                    {
+                        result.set(operation_task.get());
+                    }
+                    catch (...)
+                    {
+                        result.set_exception(std::current_exception());
+                    }
+                }));
+
+                return pplx::create_task(result);
+            }
+
+            // The entity is serialized outside of the lock.
+            size_t operation_size = protocol::estimate_batch_operation_size(operation);
+
+            std::vector<std::shared_ptr<pending_batch>> ready;
+            {
+                std::lock_guard<std::mutex> guard(m_mutex);
+
+                const utility::string_t& partition_key = operation.entity().partition_key();
+                auto existing = m_pending.find(partition_key);
+                pplx::task<void> predecessor = pplx::task_from_result();
+                if (existing != m_pending.end())
+                {
+                    // The service rejects a batch that touches the same entity twice, so the pending batch goes first and the new one waits for it.
+                    // A batch that would grow past the payload limit is sent as it is, and the operation starts a new one.
+                    bool same_entity = existing->second->m_row_keys.count(operation.entity().row_key()) != 0;
+                    if (same_entity || existing->second->m_payload_size + operation_size > protocol::max_batch_payload_size)
+                    {
+                        pplx::task<void> sent = send(existing->second);
+                        if (same_entity)
+                        {
+                            predecessor = sent;
+                        }
+
+                        ready.push_back(existing->second);
+                        m_pending.erase(existing);
+                        existing = m_pending.end();
+                    }
+                }
+
+                if (existing == m_pending.end())
+                {
+                    auto batch = std::make_shared<pending_batch>(partition_key, m_next_batch_id++, std::move(predecessor));
+                    existing = m_pending.insert(std::make_pair(partition_key, batch)).first;
+                    start_timer(batch);
+                }
+
+                auto batch = existing->second;
+                batch->m_operation.operations().push_back(operation);
+                batch->m_results.push_back(result);
+                batch->m_row_keys.insert(operation.entity().row_key());
+                batch->m_payload_size += operation_size;
+
+                if (batch->m_results.size() >= m_max_batch_size)
+                {
+                    send(batch);
+                    ready.push_back(batch);
+                    m_pending.erase(existing);
+                }
+            }
+
+            stop_timers(ready);
+            return pplx::create_task(result);
+        }
+
+        pplx::task<void> flush()
+        {
+            std::vector<std::shared_ptr<pending_batch>> ready;
+            std::vector<pplx::task<void>> in_flight;
+            {
+                std::lock_guard<std::mutex> guard(m_mutex);
+                for (auto& pending : m_pending)
+                {
+                    send(pending.second);
+                    ready.push_back(pending.second);
+                }
+
+                m_pending.clear();
+                in_flight = m_in_flight;
+            }
+
+            stop_timers(ready);
+            return pplx::when_all(in_flight.begin(), in_flight.end());
+        }
+
+    private:
+
+        struct pending_batch
+        {
+            pending_batch(utility::string_t partition_key, uint64_t id, pplx::task<void> predecessor)
+                : m_partition_key(std::move(partition_key)), m_id(id), m_predecessor(std::move(predecessor)), m_payload_size(0)
+            {
+            }
+
+            utility::string_t m_partition_key;
+            uint64_t m_id;
+            pplx::task<void> m_predecessor;
+            table_batch_operation m_operation;
+            std::vector<pplx::task_completion_event<table_result>> m_results;
+            std::unordered_set<utility::string_t> m_row_keys;
+            size_t m_payload_size;
+            std::shared_ptr<core::timer_handler> m_timer;
+        };
+
+        // Must be called with m_mutex held.
+        pplx::task<void> send(std::shared_ptr<pending_batch> batch)
+        {
+            auto state = shared_from_this();
+            return track(batch->m_predecessor.then([state]()
+            {
+                return state->m_semaphore->lock_async();
+            }).then([state, batch]()
+            {
+                return state->m_table.execute_batch_async(batch->m_operation, state->m_options, state->m_context);
+            }).then([state, batch](pplx::task<std::vector<table_result>> batch_task)
+            {
+                state->m_semaphore->unlock();
+                try
+                {
+                    // The response parser has already checked that there is one result per operation.
+                    std::vector<table_result> results = batch_task.get();
+                    for (size_t i = 0; i < batch->m_results.size(); ++i)
+                    {
+                        batch->m_results[i].set(std::move(results[i]));
+                    }
+                }
+                catch (...)
+                {
+                    auto exception = std::current_exception();
+                    for (auto& result : batch->m_results)
+                    {
+                        result.set_exception(exception);
+                    }
+                }
+            }));
+        }
+
+        // Must be called with m_mutex held.
+        pplx::task<void> track(pplx::task<void> task)
+        {
+            m_in_flight.erase(std::remove_if(m_in_flight.begin(), m_in_flight.end(), [](const pplx::task<void>& t) { return t.is_done(); }), m_in_flight.end());
+            m_in_flight.push_back(task);
+            return task;
+        }
+
+        // Must be called with m_mutex held.
+        void start_timer(std::shared_ptr<pending_batch> batch)
+        {
+            if (m_max_latency.count() <= 0)
+            {
+                return;
+            }
+
+            batch->m_timer = std::make_shared<core::timer_handler>(pplx::cancellation_token::none());
+
+            // The callback keeps the state alive, so that a batch is sent on time even if the writer has been destroyed.
+            // It is registered before the timer is armed: registering on a token that is already canceled runs the callback
+            // right away on this thread, which would lock m_mutex a second time.
+            auto state = shared_from_this();
+            utility::string_t partition_key = batch->m_partition_key;
+            uint64_t id = batch->m_id;
+            batch->m_timer->get_cancellation_token().register_callback([state, partition_key, id]()
+            {
+                state->send_expired(partition_key, id);
+            });
+
+            batch->m_timer->start_timer(m_max_latency);
+        }
+
+        void send_expired(const utility::string_t& partition_key, uint64_t id)
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            auto existing = m_pending.find(partition_key);
+            if (existing != m_pending.end() && existing->second->m_id == id)
+            {
+                // The timer is kept with the batch until the batch completes, since it is still running this callback.
+                send(existing->second);
+                m_pending.erase(existing);
+            }
+        }
+
+        static void stop_timers(const std::vector<std::shared_ptr<pending_batch>>& batches)
+        {
+            for (auto& batch : batches)
+            {
+                if (batch->m_timer != nullptr)
+                {
+                    batch->m_timer->stop_timer();
+                }
+            }
+        }
+
+        cloud_table m_table;
+        size_t m_max_batch_size;
+        std::chrono::milliseconds m_max_latency;
+        std::shared_ptr<core::async_semaphore> m_semaphore;
+        table_request_options m_options;
+        operation_context m_context;
+
+        std::mutex m_mutex;
+        std::unordered_map<utility::string_t, std::shared_ptr<pending_batch>> m_pending;
+        std::vector<pplx::task<void>> m_in_flight;
+        uint64_t m_next_batch_id;
+    };
+
+    table_batch_writer::table_batch_writer(cloud_table table)
+        : table_batch_writer(std::move(table), protocol::max_batch_operation_count, protocol::default_batch_writer_latency, protocol::default_batch_writer_parallelism, table_request_options(), operation_context())
+    {
+    }
+
+    table_batch_writer::table_batch_writer(cloud_table table, size_t max_batch_size, std::chrono::milliseconds max_latency, int parallelism, const table_request_options& options, operation_context context)
+    {
+        utility::assert_in_bounds<size_t>(_XPLATSTR("max_batch_size"), max_batch_size, 1, protocol::max_batch_operation_count);
+        utility::assert_in_bounds(_XPLATSTR("parallelism"), parallelism, 1);
+
+        m_state = std::make_shared<writer_state>(std::move(table), max_batch_size, max_latency, parallelism, options, context);
+    }
+
+    pplx::task<table_result> table_batch_writer::execute_async(const table_operation& operation)
+    {
+        return m_state->add(operation);
+    }
+
+    pplx::task<void> table_batch_writer::flush_async()
+    {
+        return m_state->flush();
+    }
+
+}} // namespace azure::storage
@@ -18,6 +18,7 @@
 #include "stdafx.h"
 #include "was/table.h"
 #include "wascore/util.h"
+#include "wascore/resources.h"
 
 namespace azure { namespace storage {
 
@@ -67,4 +68,32 @@ namespace azure { namespace storage {
         return result;
     }
 
+    void table_column_mapping::add_column(utility::string_t name, edm_type property_type, column_setter setter)
+    {
+        if (!m_indexes.insert(std::make_pair(name, m_columns.size())).second)
+        {
+            throw std::invalid_argument(protocol::error_duplicate_mapped_column);
+        }
+
+        m_columns.push_back(column(std::move(name), property_type, std::move(setter)));
+    }
+
+    std::vector<utility::string_t> table_column_mapping::select_columns() const
+    {
+        std::vector<utility::string_t> names;
+        names.reserve(m_columns.size());
+        for (auto it = m_columns.cbegin(); it != m_columns.cend(); ++it)
+        {
+            names.push_back(it->m_name);
+        }
+
+        // The keys and the timestamp are always selected, so a mapping of only those still selects no other column.
+        if (names.empty())
+        {
+            names.push_back(_XPLATSTR("PartitionKey"));
+        }
+
+        return names;
+    }
+
 }} // namespace azure::storage
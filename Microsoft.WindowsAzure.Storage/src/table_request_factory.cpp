@@ -22,6 +22,8 @@
 #include "was/common.h"
 #include "was/table.h"
 
+#include <cstdio>
+
 namespace azure { namespace storage { namespace protocol {
 
     web::http::uri generate_table_uri(const web::http::uri& base_uri, const cloud_table& table)
@@ -262,11 +264,9 @@ namespace azure { namespace storage { namespace protocol {
         }
     }
 
-    void populate_http_headers(web::http::http_headers& headers, const table_operation& operation, table_payload_format payload_format)
+    void populate_if_match_header(web::http::http_headers& headers, const table_operation& operation)
     {
         table_operation_type operation_type = operation.operation_type();
-        populate_http_headers(headers, operation_type, payload_format);
-
         if (operation_type == table_operation_type::delete_operation || 
             operation_type == table_operation_type::merge_operation || 
             operation_type == table_operation_type::replace_operation)
@@ -286,6 +286,12 @@ namespace azure { namespace storage { namespace protocol {
         }
     }
 
+    void populate_http_headers(web::http::http_headers& headers, const table_operation& operation, table_payload_format payload_format)
+    {
+        populate_http_headers(headers, operation.operation_type(), payload_format);
+        populate_if_match_header(headers, operation);
+    }
+
     web::json::value generate_json_object(const table_operation& operation)
     {
         if (operation.operation_type() == table_operation_type::insert_operation || 
@@ -389,6 +395,177 @@ namespace azure { namespace storage { namespace protocol {
         return web::json::value::null();
     }
 
+    namespace
+    {
+        void append_json_string(std::string& body, const utility::string_t& value)
+        {
+            static const char hex_digits[] = "0123456789abcdef";
+
+            std::string utf8_value = utility::conversions::to_utf8string(value);
+            body.push_back('"');
+            for (char ch : utf8_value)
+            {
+                if (ch == '"' || ch == '\\')
+                {
+                    body.push_back('\\');
+                    body.push_back(ch);
+                }
+                else if (static_cast<unsigned char>(ch) < 0x20)
+                {
+                    body.append("\\u00");
+                    body.push_back(hex_digits[(ch >> 4) & 0xF]);
+                    body.push_back(hex_digits[ch & 0xF]);
+                }
+                else
+                {
+                    body.push_back(ch);
+                }
+            }
+            body.push_back('"');
+        }
+
+        void append_json_name(std::string& body, const utility::string_t& name, const char* suffix)
+        {
+            if (body.size() > 1)
+            {
+                body.push_back(',');
+            }
+
+            append_json_string(body, name);
+            if (suffix != nullptr)
+            {
+                body.insert(body.size() - 1, suffix);
+            }
+
+            body.push_back(':');
+        }
+
+        void append_json_type(std::string& body, const utility::string_t& name, edm_type property_type)
+        {
+            append_json_name(body, name, "@odata.type");
+            append_json_string(body, get_property_type_name(property_type));
+        }
+    }
+
+    size_t estimate_batch_operation_size(const table_operation& operation)
+    {
+        // Room for the boundaries, the request line and the headers of the operation in a batch body. The keys appear in the request line, escaped.
+        const size_t operation_overhead = 1024;
+        size_t size = operation_overhead + 3 * (operation.entity().partition_key().size() + operation.entity().row_key().size());
+
+        web::json::value json_object = generate_json_object(operation);
+        if (!json_object.is_null())
+        {
+            size += utility::conversions::to_utf8string(json_object.serialize()).size();
+        }
+
+        return size;
+    }
+
+    std::string generate_compact_json_body(const compact_table_entity& entity)
+    {
+        std::string body;
+        body.reserve(64 + entity.values().size() * 32);
+        body.push_back('{');
+
+        append_json_name(body, _XPLATSTR("PartitionKey"), nullptr);
+        append_json_string(body, entity.partition_key());
+        append_json_name(body, _XPLATSTR("RowKey"), nullptr);
+        append_json_string(body, entity.row_key());
+
+        // Values are written from their own type; only the types JSON cannot carry are formatted as annotated strings.
+        const std::vector<compact_entity_value>& values = entity.values();
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            const compact_entity_value& value = values[i];
+            if (value.is_null())
+            {
+                continue;
+            }
+
+            const utility::string_t& name = entity.schema()->property_name(i);
+            switch (value.property_type())
+            {
+            case edm_type::boolean:
+                append_json_name(body, name, nullptr);
+                body.append(value.boolean_value() ? "true" : "false");
+                break;
+
+            case edm_type::int32:
+                append_json_name(body, name, nullptr);
+                body.append(std::to_string(value.int32_value()));
+                break;
+
+            case edm_type::int64:
+                append_json_type(body, name, edm_type::int64);
+                append_json_name(body, name, nullptr);
+                body.push_back('"');
+                body.append(std::to_string(value.int64_value()));
+                body.push_back('"');
+                break;
+
+            case edm_type::double_floating_point:
+                {
+                    double double_value = value.double_value();
+                    if (!core::is_finite(double_value))
+                    {
+                        // Serialize special double values as strings
+                        append_json_type(body, name, edm_type::double_floating_point);
+                        append_json_name(body, name, nullptr);
+                        append_json_string(body, core::is_nan(double_value) ? protocol::double_not_a_number : double_value > 0 ? protocol::double_infinity : protocol::double_negative_infinity);
+                        break;
+                    }
+
+                    char buffer[32];
+                    int length = std::snprintf(buffer, sizeof(buffer), "%.17g", double_value);
+                    std::string number(buffer, static_cast<size_t>(length));
+                    if (number.find_first_of(".eE") == std::string::npos)
+                    {
+                        // A whole number would be read back as an Int32, so it gets a decimal point and a type annotation
+                        number.append(".0");
+                        append_json_type(body, name, edm_type::double_floating_point);
+                        append_json_name(body, name, nullptr);
+                        body.push_back('"');
+                        body.append(number);
+                        body.push_back('"');
+                    }
+                    else
+                    {
+                        append_json_name(body, name, nullptr);
+                        body.append(number);
+                    }
+                }
+                break;
+
+            case edm_type::string:
+                append_json_name(body, name, nullptr);
+                append_json_string(body, value.string_value());
+                break;
+
+            case edm_type::binary:
+                append_json_type(body, name, edm_type::binary);
+                append_json_name(body, name, nullptr);
+                append_json_string(body, utility::conversions::to_base64(value.binary_value()));
+                break;
+
+            case edm_type::datetime:
+                append_json_type(body, name, edm_type::datetime);
+                append_json_name(body, name, nullptr);
+                append_json_string(body, value.datetime_value().to_string(utility::datetime::ISO_8601));
+                break;
+
+            case edm_type::guid:
+                append_json_type(body, name, edm_type::guid);
+                append_json_name(body, name, nullptr);
+                append_json_string(body, utility::uuid_to_string(value.guid_value()));
+                break;
+            }
+        }
+
+        body.push_back('}');
+        return body;
+    }
+
     web::http::http_request table_base_request(web::http::method method, web::http::uri_builder& uri_builder, const std::chrono::seconds& timeout, operation_context context)
     {
         web::http::http_request request = base_request(method, uri_builder, timeout, context);
@@ -441,6 +618,22 @@ namespace azure { namespace storage { namespace protocol {
         return request;
     }
 
+    web::http::http_request execute_compact_operation(const table_operation& operation, std::shared_ptr<const std::string> body, table_payload_format payload_format, web::http::uri_builder& uri_builder, const std::chrono::seconds& timeout, operation_context context)
+    {
+        web::http::method method = get_http_method(operation.operation_type());
+        web::http::http_request request = table_base_request(method, uri_builder, timeout, context);
+
+        web::http::http_headers& headers = request.headers();
+        populate_http_headers(headers, operation, payload_format);
+
+        if (body != nullptr)
+        {
+            request.set_body(concurrency::streams::bytestream::open_istream(*body), body->size(), header_value_content_type_json);
+        }
+
+        return request;
+    }
+
     web::http::http_request execute_batch_operation(Concurrency::streams::stringstreambuf& response_buffer, const cloud_table& table, const table_batch_operation& batch_operation, table_payload_format payload_format, bool is_query, web::http::uri_builder& uri_builder, const std::chrono::seconds& timeout, operation_context context)
     {
         utility::string_t batch_boundary_name = core::generate_boundary_name(_XPLATSTR("batch"));
@@ -456,12 +649,31 @@ namespace azure { namespace storage { namespace protocol {
         request_headers.add(web::http::header_names::accept_charset, header_value_charset_utf8);
         populate_http_headers(request_headers, batch_boundary_name);
 
-        table_batch_operation::operations_type operations = batch_operation.operations();
+        const table_batch_operation::operations_type& operations = batch_operation.operations();
 
         web::http::uri base_uri = table.service_client().base_uri().primary_uri();
-        utility::string_t body_text;
 
-        core::write_boundary(body_text, batch_boundary_name);
+        // Text that appears several times is stored once in the body and referenced wherever it appears.
+        core::mime_multipart_body body;
+        utility::string_t piece_text;
+
+        core::write_line_break(piece_text);
+        size_t line_break = body.add_piece(std::move(piece_text));
+
+        piece_text.clear();
+        core::write_boundary(piece_text, changeset_boundary_name);
+        size_t changeset_boundary = body.add_piece(std::move(piece_text));
+
+        piece_text.clear();
+        core::write_mime_changeset_headers(piece_text);
+        size_t changeset_headers = body.add_piece(std::move(piece_text));
+
+        // The headers of an operation only depend on its type, apart from If-Match.
+        std::map<table_operation_type, size_t> operation_headers;
+
+        piece_text.clear();
+        core::write_boundary(piece_text, batch_boundary_name);
+        body.append(std::move(piece_text));
 
         // Write batch headers
         if (!is_query)
@@ -469,49 +681,84 @@ namespace azure { namespace storage { namespace protocol {
             web::http::http_headers changeset_headers;
             populate_http_headers(changeset_headers, changeset_boundary_name);
 
-            core::write_request_headers(body_text, changeset_headers);
+            piece_text.clear();
+            core::write_request_headers(piece_text, changeset_headers);
+            body.append(std::move(piece_text));
         }
 
         if (operations.size() > 0U)
         {
-            int content_id = 0;
             for (table_batch_operation::operations_type::const_iterator it = operations.cbegin(); it != operations.cend(); ++it)
             {
                 const table_operation& operation = *it;
                 web::http::method method = get_http_method(operation.operation_type());
                 web::http::uri uri = generate_table_uri(base_uri, table, operation);
 
-                web::http::http_headers operation_headers;
-                populate_http_headers(operation_headers, operation, payload_format);
-
                 if (!is_query)
                 {
-                    core::write_boundary(body_text, changeset_boundary_name);
+                    body.append_piece(changeset_boundary);
+                }
+
+                body.append_piece(changeset_headers);
+
+                piece_text.clear();
+                core::write_request_line(piece_text, method, uri);
+                body.append(std::move(piece_text));
+
+                auto headers = operation_headers.find(operation.operation_type());
+                if (headers == operation_headers.end())
+                {
+                    web::http::http_headers type_headers;
+                    populate_http_headers(type_headers, operation.operation_type(), payload_format);
+
+                    piece_text.clear();
+                    for (web::http::http_headers::const_iterator header = type_headers.begin(); header != type_headers.end(); ++header)
+                    {
+                        core::write_request_header(piece_text, header->first, header->second);
+                    }
+
+                    headers = operation_headers.insert(std::make_pair(operation.operation_type(), body.add_piece(std::move(piece_text)))).first;
+                }
+
+                body.append_piece(headers->second);
+
+                web::http::http_headers if_match_headers;
+                populate_if_match_header(if_match_headers, operation);
+                if (!if_match_headers.empty())
+                {
+                    piece_text.clear();
+                    core::write_request_header(piece_text, web::http::header_names::if_match, if_match_headers.begin()->second);
+                    body.append(std::move(piece_text));
                 }
 
-                core::write_mime_changeset_headers(body_text);
-                core::write_request_line(body_text, method, uri);
-                core::write_request_headers(body_text, operation_headers);
+                body.append_piece(line_break);
 
                 web::json::value json_object = generate_json_object(operation);
-                core::write_request_payload(body_text, json_object);
+                if (!json_object.is_null())
+                {
+                    body.append(json_object.serialize());
+                }
 
-                ++content_id;
+                body.append_piece(line_break);
             }
         }
         else
         {
-            core::write_boundary(body_text, changeset_boundary_name);
+            body.append_piece(changeset_boundary);
         }
 
         if (!is_query)
         {
-            core::write_boundary(body_text, changeset_boundary_name, /* is_closure */ true);
+            piece_text.clear();
+            core::write_boundary(piece_text, changeset_boundary_name, /* is_closure */ true);
+            body.append(std::move(piece_text));
         }
 
-        core::write_boundary(body_text, batch_boundary_name, /* is_closure */ true);
+        piece_text.clear();
+        core::write_boundary(piece_text, batch_boundary_name, /* is_closure */ true);
+        body.append(std::move(piece_text));
 
-        request.set_body(body_text);
+        request.set_body(body.create_istream(), body.size(), utility::string_t());
 
         return request;
     }
@@ -22,6 +22,9 @@
 
 #include "cpprest/asyncrt_utils.h"
 
+#include <cctype>
+#include <cstring>
+
 namespace azure { namespace storage { namespace protocol {
 
     utility::string_t table_response_parsers::parse_etag(const web::http::http_response& response)
@@ -68,164 +71,279 @@ namespace azure { namespace storage { namespace protocol {
         return token;
     }
 
-    std::vector<table_result> table_response_parsers::parse_batch_results(const web::http::http_response& response, Concurrency::streams::stringstreambuf& response_buffer, bool is_query, size_t batch_size)
+    namespace
     {
-        std::vector<table_result> batch_result;
-        batch_result.reserve(batch_size);
+        // Walks a multipart batch response once, front to back. Lines and bodies are handed out as ranges of the response buffer.
+        class multipart_cursor
+        {
+        public:
 
-        std::string& response_body = response_buffer.collection();
+            multipart_cursor(const char* begin, const char* end)
+                : m_position(begin), m_end(end)
+            {
+            }
 
-        // TODO: Make this Casablanca code more robust
+            bool at_end() const
+            {
+                return m_position >= m_end;
+            }
 
-        // More strings we will search for during the course of parsing
-        std::string http_begin("HTTP"), etag_header("ETag: "), crlf("\r\n"), crlfcrlf("\r\n\r\n"), space(" ");
+            // Reads the next line, without its line break.
+            bool read_line(const char*& line_begin, const char*& line_end)
+            {
+                if (at_end())
+                {
+                    return false;
+                }
 
-        if (is_query)
-        {
-            // Find the HTTP status line
-            size_t response_begin = response_body.find(http_begin);
+                line_begin = m_position;
+                const char* line_feed = static_cast<const char*>(std::memchr(m_position, '\n', m_end - m_position));
+                if (line_feed == nullptr)
+                {
+                    line_end = m_end;
+                    m_position = m_end;
+                }
+                else
+                {
+                    line_end = line_feed > line_begin && line_feed[-1] == '\r' ? line_feed - 1 : line_feed;
+                    m_position = line_feed + 1;
+                }
 
-            // Find the status code within that line
-            size_t status_code_begin = response_body.find(space, response_begin) + space.size();
-            size_t status_code_end = response_body.find(space, status_code_begin);
-            std::string status_code_string = response_body.substr(status_code_begin, status_code_end - status_code_begin);
+                return true;
+            }
+
+            // Reads header lines up to and including the empty line that ends them, keeping the value of the named header.
+            void read_headers(const char* name, size_t name_size, const char*& value_begin, const char*& value_end)
+            {
+                value_begin = value_end = nullptr;
 
-            // Extract the status code as an integer
-            int status_code = utility::conversions::details::scan_string<int>(utility::conversions::to_string_t(status_code_string));
+                const char* line_begin;
+                const char* line_end;
+                while (read_line(line_begin, line_end) && line_begin != line_end)
+                {
+                    if (static_cast<size_t>(line_end - line_begin) > name_size && line_begin[name_size] == ':' && equals_ignore_case(line_begin, name, name_size))
+                    {
+                        value_begin = line_begin + name_size + 1;
+                        while (value_begin < line_end && *value_begin == ' ')
+                        {
+                            ++value_begin;
+                        }
+
+                        value_end = line_end;
+                    }
+                }
+            }
 
-            // Acceptable codes are 'Created' and 'NoContent'
-            if (status_code == web::http::status_codes::OK || status_code == web::http::status_codes::Created || status_code == web::http::status_codes::Accepted || status_code == web::http::status_codes::NoContent || status_code == web::http::status_codes::PartialContent || status_code == web::http::status_codes::NotFound)
+            // Skips lines up to and including the delimiter line of the boundary. Returns false if the delimiter closes the multipart body.
+            bool skip_to_delimiter(const std::string& delimiter)
             {
-                table_result result;
-                result.set_http_status_code(status_code);
+                const char* line_begin;
+                const char* line_end;
+                while (read_line(line_begin, line_end))
+                {
+                    if (is_delimiter(line_begin, line_end, delimiter))
+                    {
+                        return !is_closing_delimiter(line_begin, line_end, delimiter);
+                    }
+                }
 
-                // The operation succeeded. Try to find an ETag: header if it exists. Delete operations will not have an etag header
-                // so copy the list of headers into a substring and search within the list, lest we cross a changeset boundary.
-                size_t headersBegin = response_body.find(crlf, status_code_end) + crlf.size();
-                size_t headersEnd = response_body.find(crlfcrlf, headersBegin) + crlf.size();
-                std::string headers = response_body.substr(headersBegin, headersEnd - headersBegin);
+                return false;
+            }
 
-                utility::string_t etag_value;
+            // Reads the body of a part, which ends at the line break before the next delimiter line. The delimiter line is left for skip_to_delimiter.
+            void read_body(const std::string& delimiter, const char*& body_begin, const char*& body_end)
+            {
+                body_begin = m_position;
+                if (static_cast<size_t>(m_end - m_position) >= delimiter.size() && std::memcmp(m_position, delimiter.data(), delimiter.size()) == 0)
+                {
+                    body_end = m_position;
+                    return;
+                }
 
-                size_t etagBegin = headers.find(etag_header);
-                if (etagBegin != std::string::npos)
+                // The delimiter is searched for with its preceding line break, which belongs to the delimiter rather than to the body.
+                const char crlf[] = { '\r', '\n' };
+                const char* found = m_position;
+                while (true)
                 {
-                    etagBegin += etag_header.size();
-                    size_t etagEnd = headers.find(crlf, etagBegin);
-                    std::string etag = headers.substr(etagBegin, etagEnd - etagBegin);
-                    etag_value = utility::conversions::to_string_t(etag);
+                    found = std::search(found, m_end, delimiter.data(), delimiter.data() + delimiter.size());
+                    if (found == m_end || (found - m_position >= 2 && found[-2] == crlf[0] && found[-1] == crlf[1]))
+                    {
+                        break;
+                    }
 
-                    result.set_etag(etag_value);
+                    ++found;
                 }
 
-                size_t content_begin_offset = response_body.find(crlfcrlf, status_code_end) + crlfcrlf.size();
-                size_t content_end_offset = response_body.find("\r\n--batchresponse", content_begin_offset) + crlf.size();
+                body_end = found == m_end ? m_end : found - 2;
+                m_position = found;
+            }
 
-                std::string content_string = response_body.substr(content_begin_offset, content_end_offset - content_begin_offset);
+        private:
 
-                web::json::value document = web::json::value::parse(utility::conversions::to_string_t(content_string));
-                table_entity entity = protocol::parse_table_entity(document);
-                entity.set_etag(etag_value);
-                result.set_entity(entity);
+            static bool equals_ignore_case(const char* text, const char* lower_case, size_t size)
+            {
+                for (size_t i = 0; i < size; ++i)
+                {
+                    if (std::tolower(static_cast<unsigned char>(text[i])) != lower_case[i])
+                    {
+                        return false;
+                    }
+                }
 
-                batch_result.push_back(result);
+                return true;
             }
-            else
-            {
-                size_t status_message_begin = status_code_end + space.size();
-                size_t status_message_end = response_body.find(crlf, status_message_begin);
 
-                std::string status_message = response_body.substr(status_message_begin, status_message_end - status_message_begin);
+            static bool is_delimiter(const char* line_begin, const char* line_end, const std::string& delimiter)
+            {
+                return static_cast<size_t>(line_end - line_begin) >= delimiter.size() && std::memcmp(line_begin, delimiter.data(), delimiter.size()) == 0;
+            }
 
-                // An operation failed. Find the start of the XML block that contains information about the error
-                size_t content_begin_offset = response_body.find(crlfcrlf, status_message_end) + crlfcrlf.size();
-                size_t content_end_offset = response_body.find("\r\n--batchresponse", content_begin_offset) + crlf.size();
+            static bool is_closing_delimiter(const char* line_begin, const char* line_end, const std::string& delimiter)
+            {
+                return static_cast<size_t>(line_end - line_begin) >= delimiter.size() + 2 && line_begin[delimiter.size()] == '-' && line_begin[delimiter.size() + 1] == '-';
+            }
 
-                std::string error_string = response_body.substr(content_begin_offset, content_end_offset - content_begin_offset);
+            const char* m_position;
+            const char* m_end;
+        };
 
-                web::json::value document = web::json::value::parse(utility::conversions::to_string_t(error_string));
-                storage_extended_error extended_error = protocol::parse_table_error(document);
-                request_result request_result(utility::datetime(), storage_location::unspecified, response, (web::http::status_code) status_code, extended_error);
-                throw storage_exception(status_message, request_result);
-            }
-        }
-        else
+        std::string get_boundary_delimiter(const char* content_type_begin, const char* content_type_end)
         {
-            // Strings we will search for during the course of parsing
-            std::string content_type("Content-Type"), boundary_begin("boundary=");
+            static const char boundary_parameter[] = "boundary=";
+            const char* boundary = std::search(content_type_begin, content_type_end, boundary_parameter, boundary_parameter + sizeof(boundary_parameter) - 1);
+            if (boundary == content_type_end)
+            {
+                return std::string();
+            }
 
-            // Find the Content-Type header for the batch - it contains the changeset marker right after the occurence of "boundary="
-            size_t content_typeOffset = response_body.find(content_type);
-            size_t changeset_begin_offset = response_body.find(boundary_begin, content_typeOffset) + boundary_begin.size();
-            size_t changeset_end_offset = response_body.find(crlf, changeset_begin_offset);
+            boundary += sizeof(boundary_parameter) - 1;
+            const char* boundary_end = std::find(boundary, content_type_end, ';');
+            return std::string("--").append(boundary, boundary_end);
+        }
 
-            std::string changeset_marker_prefix = "--" + response_body.substr(changeset_begin_offset, changeset_end_offset - changeset_begin_offset);
-            std::string changeset_begin_marker = changeset_marker_prefix + crlf;
+        // Reads the HTTP response of one operation, which follows the headers of its application/http part, up to the delimiter that ends it.
+        void parse_operation_response(multipart_cursor& cursor, const std::string& delimiter, bool is_query, const web::http::http_response& response, std::vector<table_result>& batch_result)
+        {
+            // Status line, such as "HTTP/1.1 204 No Content"
+            const char* line_begin = nullptr;
+            const char* line_end = nullptr;
+            cursor.read_line(line_begin, line_end);
 
-            size_t result_index = SIZE_MAX;
+            const char* status_message_begin = std::find(line_begin, line_end, ' ');
+            if (status_message_begin < line_end)
+            {
+                ++status_message_begin;
+            }
 
-            // Loop through the response looking for changeset begin markers.
-            size_t next_changeset = response_body.find(changeset_begin_marker, changeset_end_offset);
+            int status_code = 0;
+            for (; status_message_begin < line_end && *status_message_begin >= '0' && *status_message_begin <= '9'; ++status_message_begin)
+            {
+                status_code = status_code * 10 + (*status_message_begin - '0');
+            }
 
-            while(next_changeset != std::string::npos)
+            if (status_message_begin < line_end)
             {
-                ++result_index;
-                // Find the HTTP status line
-                size_t response_begin = response_body.find(http_begin, next_changeset + changeset_begin_marker.size());
+                ++status_message_begin;
+            }
 
-                // Find the status code within that line
-                size_t status_code_begin = response_body.find(space, response_begin) + space.size();
-                size_t status_code_end = response_body.find(space, status_code_begin);
-                std::string status_code_string = response_body.substr(status_code_begin, status_code_end - status_code_begin);
+            const char* etag_begin;
+            const char* etag_end;
+            cursor.read_headers("etag", 4, etag_begin, etag_end);
 
-                // Extract the status code as an integer
-                int status_code = utility::conversions::details::scan_string<int>(utility::conversions::to_string_t(status_code_string));
+            const char* body_begin;
+            const char* body_end;
+            cursor.read_body(delimiter, body_begin, body_end);
 
-                // Acceptable codes are 'Created' and 'NoContent'
-                if (status_code == web::http::status_codes::OK || status_code == web::http::status_codes::Created || status_code == web::http::status_codes::Accepted || status_code == web::http::status_codes::NoContent || status_code == web::http::status_codes::PartialContent)
-                {
-                    table_result result;
-                    result.set_http_status_code(status_code);
+            // Acceptable codes are 'Created' and 'NoContent', and a retrieve operation also reports 'NotFound' as a result
+            if (status_code == web::http::status_codes::OK || status_code == web::http::status_codes::Created || status_code == web::http::status_codes::Accepted || status_code == web::http::status_codes::NoContent || status_code == web::http::status_codes::PartialContent ||
+                (is_query && status_code == web::http::status_codes::NotFound))
+            {
+                table_result result;
+                result.set_http_status_code(status_code);
 
-                    // The operation succeeded. Try to find an ETag: header if it exists. Delete operations will not have an etag header
-                    // so copy the list of headers into a substring and search within the list, lest we cross a changeset boundary.
-                    size_t headersBegin = response_body.find(crlf, status_code_end) + crlf.size();
-                    size_t headersEnd = response_body.find(crlfcrlf, headersBegin) + crlf.size();
-                    std::string headers = response_body.substr(headersBegin, headersEnd - headersBegin);
+                utility::string_t etag;
+                if (etag_begin != nullptr)
+                {
+                    etag = utility::conversions::to_string_t(std::string(etag_begin, etag_end));
+                    result.set_etag(etag);
+                }
 
-                    size_t etagBegin = headers.find(etag_header);
-                    if (etagBegin != std::string::npos)
-                    {
-                        etagBegin += etag_header.size();
-                        size_t etagEnd = headers.find(crlf, etagBegin);
-                        std::string etag = headers.substr(etagBegin, etagEnd - etagBegin);
+                if (is_query)
+                {
+                    table_query_reader reader(body_begin, body_end - body_begin);
+                    table_entity entity = reader.move_entity();
+                    entity.set_etag(etag);
+                    result.set_entity(std::move(entity));
+                }
 
-                        result.set_etag(utility::conversions::to_string_t(etag));
-                    }
+                batch_result.push_back(std::move(result));
+            }
+            else
+            {
+                // An operation failed, and the body holds information about the error
+                std::string status_message(status_message_begin, line_end);
+                web::json::value document = web::json::value::parse(utility::conversions::to_string_t(std::string(body_begin, body_end)));
+                storage_extended_error extended_error = protocol::parse_table_error(document);
+                request_result request_result(utility::datetime(), storage_location::unspecified, response, (web::http::status_code) status_code, extended_error);
+                throw storage_exception(status_message, request_result);
+            }
+        }
+    }
 
-                    batch_result.push_back(result);
+    std::vector<table_result> table_response_parsers::parse_batch_results(const web::http::http_response& response, Concurrency::streams::stringstreambuf& response_buffer, bool is_query, size_t batch_size)
+    {
+        std::vector<table_result> batch_result;
+        batch_result.reserve(batch_size);
 
-                    next_changeset = response_body.find(changeset_begin_marker, headersEnd);
-                }
-                else
-                {
-                    size_t status_message_begin = status_code_end + space.size();
-                    size_t status_message_end = response_body.find(crlf, status_message_begin);
+        const std::string& response_body = response_buffer.collection();
+        multipart_cursor cursor(response_body.data(), response_body.data() + response_body.size());
 
-                    std::string status_message = response_body.substr(status_message_begin, status_message_end - status_message_begin);
+        // The batch boundary is the first delimiter line of the body
+        std::string batch_delimiter;
+        const char* line_begin;
+        const char* line_end;
+        while (batch_delimiter.empty() && cursor.read_line(line_begin, line_end))
+        {
+            if (line_end - line_begin > 2 && line_begin[0] == '-' && line_begin[1] == '-')
+            {
+                batch_delimiter.assign(line_begin, line_end);
+            }
+        }
 
-                    // An operation failed. Find the start of the XML block that contains information about the error
-                    size_t content_begin_offset = response_body.find(crlfcrlf, status_message_end) + crlfcrlf.size();
-                    size_t content_end_offset = response_body.find(changeset_marker_prefix, content_begin_offset);
+        bool more_parts = !batch_delimiter.empty();
+        while (more_parts)
+        {
+            const char* content_type_begin;
+            const char* content_type_end;
+            cursor.read_headers("content-type", 12, content_type_begin, content_type_end);
 
-                    std::string error_string = response_body.substr(content_begin_offset, content_end_offset - content_begin_offset);
+            std::string changeset_delimiter;
+            if (content_type_begin != nullptr)
+            {
+                static const char multipart_type[] = "multipart/mixed";
+                if (static_cast<size_t>(content_type_end - content_type_begin) >= sizeof(multipart_type) - 1 && std::equal(multipart_type, multipart_type + sizeof(multipart_type) - 1, content_type_begin))
+                {
+                    changeset_delimiter = get_boundary_delimiter(content_type_begin, content_type_end);
+                }
+            }
 
-                    web::json::value document = web::json::value::parse(utility::conversions::to_string_t(error_string));
-                    storage_extended_error extended_error = protocol::parse_table_error(document);
-                    request_result request_result(utility::datetime(), storage_location::unspecified, response, (web::http::status_code) status_code, extended_error);
-                    throw storage_exception(status_message, request_result);
+            if (changeset_delimiter.empty())
+            {
+                // A part of the batch itself, which is how the response to a retrieve operation is sent
+                parse_operation_response(cursor, batch_delimiter, is_query, response, batch_result);
+            }
+            else
+            {
+                bool more_operations = cursor.skip_to_delimiter(changeset_delimiter);
+                while (more_operations)
+                {
+                    cursor.read_headers("content-type", 12, content_type_begin, content_type_end);
+                    parse_operation_response(cursor, changeset_delimiter, is_query, response, batch_result);
+                    more_operations = cursor.skip_to_delimiter(changeset_delimiter);
                 }
             }
+
+            more_parts = cursor.skip_to_delimiter(batch_delimiter);
         }
 
         if (batch_result.size() != batch_size) {
@@ -20,116 +20,296 @@
 
 namespace azure {    namespace storage {    namespace core {
 
-    timer_handler::timer_handler(const pplx::cancellation_token& token) :
-        m_cancellation_token(token), m_is_canceled_by_timeout(false)
+    namespace
     {
-        m_worker_cancellation_token_source = std::make_shared<pplx::cancellation_token_source>();
-        if (m_cancellation_token != pplx::cancellation_token::none())
+        void link(timer_wheel_entry& entry, timer_wheel_entry& head)
         {
-            m_cancellation_token_registration = m_cancellation_token.register_callback([this]() 
+            entry.m_prev = head.m_prev;
+            entry.m_next = &head;
+            head.m_prev->m_next = &entry;
+            head.m_prev = &entry;
+        }
+
+        void unlink(timer_wheel_entry& entry)
+        {
+            entry.m_prev->m_next = entry.m_next;
+            entry.m_next->m_prev = entry.m_prev;
+            entry.m_prev = nullptr;
+            entry.m_next = nullptr;
+        }
+
+        bool is_empty(const timer_wheel_entry& head)
+        {
+            return head.m_next == &head;
+        }
+
+        void reset(timer_wheel_entry& head)
+        {
+            head.m_prev = &head;
+            head.m_next = &head;
+        }
+
+        // Moves every entry of source to the end of target.
+        void splice(timer_wheel_entry& source, timer_wheel_entry& target)
+        {
+            if (is_empty(source))
             {
-                this->m_worker_cancellation_token_source->cancel();
-                this->stop_timer();
-            });
+                return;
+            }
+
+            source.m_next->m_prev = target.m_prev;
+            target.m_prev->m_next = source.m_next;
+            source.m_prev->m_next = &target;
+            target.m_prev = source.m_prev;
+            reset(source);
         }
     }
 
-    timer_handler::~timer_handler()
+    timer_wheel& timer_wheel::instance()
     {
-        if (m_cancellation_token != pplx::cancellation_token::none())
+        // The wheel is never destroyed, so that its thread can keep running while static objects are destroyed at exit.
+        static timer_wheel* wheel = new timer_wheel();
+        return *wheel;
+    }
+
+    timer_wheel::timer_wheel()
+        : m_epoch(std::chrono::steady_clock::now()), m_current_tick(0), m_wake_tick(0), m_count(0), m_firing(nullptr)
+    {
+        for (int level = 0; level < level_count; ++level)
         {
-            m_cancellation_token.deregister_callback(m_cancellation_token_registration);
+            for (uint64_t slot = 0; slot <= slot_mask; ++slot)
+            {
+                reset(m_slots[level][slot]);
+            }
         }
 
-#ifdef _WIN32
-        stop_timer();
-#else // LINUX
-        try
+        reset(m_due);
+
+        std::thread thread(&timer_wheel::run, this);
+        m_thread_id = thread.get_id();
+        thread.detach();
+    }
+
+    void timer_wheel::arm(timer_wheel_entry& entry, const std::chrono::milliseconds& timeout)
+    {
+        uint64_t ticks = timeout.count() > 0 ? static_cast<uint64_t>(timeout.count()) : 0;
+
+        std::lock_guard<std::mutex> guard(m_mutex);
+        if (entry.m_next != nullptr)
         {
-            stop_timer();
+            unlink(entry);
+            --m_count;
         }
-        catch (boost::exception_detail::clone_impl<boost::exception_detail::error_info_injector<boost::system::system_error> > &e)
+
+        uint64_t now = now_tick();
+        if (m_count == 0)
         {
+            // Nothing is waiting to be cascaded, so the wheel can skip the ticks it slept through.
+            m_current_tick = std::max(m_current_tick, now);
         }
-#endif
 
+        // The current tick started up to a millisecond ago, so one more tick keeps the timer from firing early.
+        entry.m_expiry = now + ticks + 1;
+        place(entry);
+        ++m_count;
+
+        if (entry.m_expiry < m_wake_tick)
+        {
+            m_wake_condition.notify_one();
+        }
     }
 
-    void timer_handler::start_timer(const std::chrono::milliseconds& time)
+    void timer_wheel::cancel(timer_wheel_entry& entry)
     {
-        m_mutex = std::make_shared<std::mutex>();
-        m_timeout_task = timeout_after(time).then([this]()
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (entry.m_next != nullptr)
         {
-            this->m_is_canceled_by_timeout = true;
-            this->m_worker_cancellation_token_source->cancel();
-        });
+            unlink(entry);
+            --m_count;
+            return;
+        }
+
+        while (m_firing == &entry && std::this_thread::get_id() != m_thread_id)
+        {
+            m_fired_condition.wait(lock);
+        }
     }
 
-    void timer_handler::stop_timer()
+    uint64_t timer_wheel::now_tick() const
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_epoch).count());
+    }
+
+    // Must be called with m_mutex held.
+    void timer_wheel::place(timer_wheel_entry& entry)
     {
-        if (m_timer != nullptr)
+        if (entry.m_expiry <= m_current_tick)
+        {
+            link(entry, m_due);
+            return;
+        }
+
+        // An entry goes to the lowest level whose span covers its distance, so it is cascaded down one level at a time as its deadline comes closer.
+        const uint64_t max_distance = (static_cast<uint64_t>(1) << (slot_bits * level_count)) - 1;
+        entry.m_expiry = std::min(entry.m_expiry, m_current_tick + max_distance);
+        uint64_t distance = entry.m_expiry - m_current_tick;
+
+        int level = 0;
+        while (distance > slot_mask)
+        {
+            distance >>= slot_bits;
+            ++level;
+        }
+
+        link(entry, m_slots[level][(entry.m_expiry >> (slot_bits * level)) & slot_mask]);
+    }
+
+    // Must be called with m_mutex held.
+    void timer_wheel::advance(uint64_t tick)
+    {
+        if (m_count == 0)
+        {
+            m_current_tick = std::max(m_current_tick, tick);
+            return;
+        }
+
+        while (m_current_tick < tick)
         {
-            std::lock_guard<std::mutex> guard(*m_mutex);
-            if (m_timer != nullptr)
+            ++m_current_tick;
+
+            // When a level wraps around, the next slot of the level above now holds entries that fit the levels below.
+            for (int level = 1; level < level_count && (m_current_tick & ((static_cast<uint64_t>(1) << (slot_bits * level)) - 1)) == 0; ++level)
             {
-#ifndef _WIN32
-                m_timer->cancel();
-#else
-                m_timer->stop();
-#endif
-                if (!m_tce._IsTriggered())
+                timer_wheel_entry pending;
+                reset(pending);
+                splice(m_slots[level][(m_current_tick >> (slot_bits * level)) & slot_mask], pending);
+                while (!is_empty(pending))
                 {
-                    // if task_completion_event is not yet triggered, it means timeout has not been triggered.
-                    m_tce._Cancel();
+                    timer_wheel_entry& entry = *pending.m_next;
+                    unlink(entry);
+                    place(entry);
                 }
-                m_timer.reset();
             }
+
+            splice(m_slots[0][m_current_tick & slot_mask], m_due);
         }
     }
 
-#ifndef _WIN32
-    pplx::task<void> timer_handler::timeout_after(const std::chrono::milliseconds& time)
+    // Must be called with m_mutex held.
+    uint64_t timer_wheel::next_wake_tick() const
     {
-        m_timer = std::make_shared<boost::asio::basic_waitable_timer<std_clock>>(crossplat::threadpool::shared_instance().service());
-        m_timer->expires_from_now(std::chrono::duration_cast<std_clock::duration>(time));
-        auto callback = [this](const boost::system::error_code& ec)
+        if (m_count == 0)
+        {
+            return std::numeric_limits<uint64_t>::max();
+        }
+
+        if (!is_empty(m_due))
+        {
+            return m_current_tick;
+        }
+
+        // Entries of the upper levels are cascaded when the lowest level wraps around, so the thread never sleeps past that.
+        uint64_t wrap_tick = (m_current_tick | slot_mask) + 1;
+        for (uint64_t tick = m_current_tick + 1; tick < wrap_tick; ++tick)
         {
-            if (ec != boost::asio::error::operation_aborted)
+            if (!is_empty(m_slots[0][tick & slot_mask]))
             {
-                std::lock_guard<std::mutex> guard(*(this->m_mutex));
-                if (!this->m_tce._IsTriggered())
-                {
-                    this->m_tce.set();
-                }
+                return tick;
             }
-        };
-        m_timer->async_wait(callback);
-
-        auto event_set = pplx::create_task(m_tce);
+        }
 
-        return event_set.then([callback]() {});
+        return wrap_tick;
     }
-#else
-    pplx::task<void> timer_handler::timeout_after(const std::chrono::milliseconds& time)
+
+    void timer_wheel::run()
     {
-        // initialize the timer and connect the callback with completion event.
-        m_timer = std::make_shared<concurrency::timer<int>>(static_cast<unsigned int>(time.count()), 0);
-        auto callback = std::make_shared<concurrency::call<int>>([this](int)
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (;;)
         {
-            std::lock_guard<std::mutex> guard(*(this->m_mutex));
-            if (!this->m_tce._IsTriggered())
+            advance(now_tick());
+
+            // Callbacks run without the lock, one at a time, so that they can arm and cancel entries.
+            while (!is_empty(m_due))
+            {
+                timer_wheel_entry* entry = m_due.m_next;
+                unlink(*entry);
+                --m_count;
+                m_firing = entry;
+
+                lock.unlock();
+                entry->m_callback(entry->m_context);
+                lock.lock();
+
+                m_firing = nullptr;
+                m_fired_condition.notify_all();
+            }
+
+            m_wake_tick = next_wake_tick();
+            if (m_wake_tick == std::numeric_limits<uint64_t>::max())
             {
-                this->m_tce.set();
+                m_wake_condition.wait(lock);
+            }
+            else if (m_wake_tick > now_tick())
+            {
+                m_wake_condition.wait_until(lock, m_epoch + std::chrono::milliseconds(m_wake_tick));
             }
-        });
-        m_timer->link_target(callback.get());//When timer stops, tce will trigger cancellation.
-        m_timer->start();
 
-        auto event_set = pplx::create_task(m_tce);
+            // Entries armed while the thread is awake are picked up by the next pass, so they do not need to wake it.
+            m_wake_tick = 0;
+        }
+    }
+
+    timer_handler::timer_handler(const pplx::cancellation_token& token) :
+        m_cancellation_token(token), m_is_canceled_by_timeout(false), m_is_started(false)
+    {
+        m_timer_entry.m_callback = &timer_handler::timer_fired;
+        m_timer_entry.m_context = this;
 
-        //timer and callback should be preserved before event set has been triggered.
-        return event_set.then([callback]() {});
+        if (m_cancellation_token != pplx::cancellation_token::none())
+        {
+            m_cancellation_token_registration = m_cancellation_token.register_callback([this]() 
+            {
+                this->m_worker_cancellation_token_source.cancel();
+                this->stop_timer();
+            });
+        }
+    }
+
+    timer_handler::~timer_handler()
+    {
+        if (m_cancellation_token != pplx::cancellation_token::none())
+        {
+            m_cancellation_token.deregister_callback(m_cancellation_token_registration);
+        }
+
+        stop_timer();
+    }
+
+    void timer_handler::start_timer(const std::chrono::milliseconds& time)
+    {
+        m_is_started = true;
+        timer_wheel::instance().arm(m_timer_entry, time);
+    }
+
+    void timer_handler::stop_timer()
+    {
+        if (m_is_started)
+        {
+            timer_wheel::instance().cancel(m_timer_entry);
+        }
+    }
+
+    void timer_handler::timer_fired(void* context)
+    {
+        // Canceling runs every callback registered on the token, so it is done on the thread pool to keep a slow callback
+        // from delaying the other timers. It can complete the operation and destroy the handler, so the source is copied first.
+        auto handler = static_cast<timer_handler*>(context);
+        handler->m_is_canceled_by_timeout = true;
+        auto source = handler->m_worker_cancellation_token_source;
+        pplx::create_task([source]()
+        {
+            source.cancel();
+        });
     }
-#endif
 
 }}}
@@ -20,6 +20,9 @@
 #include "wascore/util.h"
 #include "wascore/constants.h"
 #include "wascore/resources.h"
+#include "wascore/async_semaphore.h"
+#include "wascore/hash_pipeline.h"
+#include "cpprest/rawptrstream.h"
 
 #ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
@@ -136,6 +139,204 @@ namespace azure { namespace storage {  namespace core {
         });
     }
 
+    class file_range_upload_state
+    {
+    public:
+
+        file_range_upload_state()
+            : m_next_offset(0)
+        {
+        }
+
+        void set_exception(std::exception_ptr exception)
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            if (m_exception == nullptr)
+            {
+                m_exception = exception;
+            }
+        }
+
+        std::exception_ptr exception()
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            return m_exception;
+        }
+
+        utility::size64_t m_next_offset;
+
+    private:
+
+        std::exception_ptr m_exception;
+        std::mutex m_mutex;
+    };
+
+    pplx::task<void> read_file_range_async(const utility::string_t& path, utility::size64_t offset, std::shared_ptr<std::vector<uint8_t>> buffer)
+    {
+        // Every range opens its own handle to the file, so ranges can be read concurrently without sharing a read position.
+        return concurrency::streams::file_stream<uint8_t>::open_istream(path).then([offset, buffer](concurrency::streams::istream stream) -> pplx::task<void>
+        {
+            // A failed seek returns eof instead of the offset. Reading from there would upload the wrong bytes.
+            auto position = stream.seek(static_cast<concurrency::streams::istream::pos_type>(offset));
+            if (static_cast<utility::size64_t>(position) != offset)
+            {
+                return stream.close().then([]()
+                {
+                    throw std::invalid_argument(protocol::error_stream_short);
+                });
+            }
+
+            auto read_ptr = std::make_shared<size_t>(0);
+            auto read_task = pplx::details::_do_while([stream, buffer, read_ptr]() -> pplx::task<bool>
+            {
+                return stream.streambuf().getn(buffer->data() + *read_ptr, buffer->size() - *read_ptr).then([buffer, read_ptr](size_t count) -> bool
+                {
+                    if (count == 0)
+                    {
+                        throw std::invalid_argument(protocol::error_stream_short);
+                    }
+
+                    *read_ptr += count;
+                    return *read_ptr < buffer->size();
+                });
+            });
+
+            return read_task.then([stream](pplx::task<bool> read_task) -> pplx::task<void>
+            {
+                return stream.close().then([read_task]()
+                {
+                    read_task.wait();
+                });
+            });
+        });
+    }
+
+    pplx::task<void> upload_file_ranges_async(const utility::string_t& path, utility::size64_t length, size_t range_size, int parallelism_factor, bool calculate_range_md5, bool calculate_range_crc64, hash_provider total_hash_provider, std::function<pplx::task<void>(concurrency::streams::istream, utility::size64_t, const utility::string_t&, const utility::string_t&)> upload_range, const pplx::cancellation_token& cancellation_token, std::shared_ptr<core::timer_handler> timer_handler)
+    {
+        auto semaphore = std::make_shared<async_semaphore>(parallelism_factor);
+        auto state = std::make_shared<file_range_upload_state>();
+
+        // The whole-file hash has to be computed in file order, while ranges are read out of order.
+        // Each range appends its hash step to this chain, and the step waits until that range has been read.
+        auto total_hash_task = std::make_shared<pplx::task<void>>(pplx::task_from_result());
+
+        return pplx::details::_do_while([path, length, range_size, calculate_range_md5, calculate_range_crc64, total_hash_provider, upload_range, cancellation_token, timer_handler, semaphore, state, total_hash_task]() -> pplx::task<bool>
+        {
+            return semaphore->lock_async().then([path, length, range_size, calculate_range_md5, calculate_range_crc64, total_hash_provider, upload_range, cancellation_token, timer_handler, semaphore, state, total_hash_task]() -> bool
+            {
+                std::unique_lock<async_semaphore> guard(*semaphore, std::adopt_lock);
+                if ((state->m_next_offset >= length) || (state->exception() != nullptr))
+                {
+                    return false;
+                }
+
+                // need to cancel the potentially heavy read/upload operation if cancellation token is canceled.
+                if (cancellation_token.is_canceled())
+                {
+                    try
+                    {
+                        assert_timed_out_by_timer(timer_handler);
+                        throw storage_exception(protocol::error_operation_canceled);
+                    }
+                    catch (...)
+                    {
+                        state->set_exception(std::current_exception());
+                    }
+
+                    return false;
+                }
+
+                utility::size64_t offset = state->m_next_offset;
+                auto buffer = std::make_shared<std::vector<uint8_t>>(static_cast<size_t>(std::min(static_cast<utility::size64_t>(range_size), length - offset)));
+                state->m_next_offset += buffer->size();
+
+                // The range counts against the process-wide cap from the time it is read until its upload completes.
+                auto read_task = transfer_byte_limit::acquire_async(buffer->size()).then([path, offset, buffer]()
+                {
+                    return read_file_range_async(path, offset, buffer);
+                });
+
+                pplx::task<void> hash_task = pplx::task_from_result();
+                if (total_hash_provider.is_enabled())
+                {
+                    *total_hash_task = total_hash_task->then([read_task, buffer, total_hash_provider]() mutable -> pplx::task<void>
+                    {
+                        return read_task.then([buffer, total_hash_provider]() mutable
+                        {
+                            total_hash_provider.write(buffer->data(), buffer->size());
+                        });
+                    });
+                    hash_task = *total_hash_task;
+                }
+
+                auto upload_task = read_task.then([upload_range, offset, buffer, calculate_range_md5, calculate_range_crc64]() -> pplx::task<void>
+                {
+                    // Ranges that are read at the same time are hashed together by the hash pipeline.
+                    pplx::task<utility::string_t> range_hash_task = pplx::task_from_result(utility::string_t());
+                    if (calculate_range_crc64)
+                    {
+                        range_hash_task = hash_pipeline::crc64_async(buffer->data(), buffer->size());
+                    }
+                    else if (calculate_range_md5)
+                    {
+                        range_hash_task = hash_pipeline::md5_async(buffer->data(), buffer->size());
+                    }
+
+                    return range_hash_task.then([upload_range, offset, buffer, calculate_range_crc64](utility::string_t range_hash) -> pplx::task<void>
+                    {
+                        // The upload reads straight out of the range buffer. The buffer is kept alive by the continuation below.
+                        auto range_data = concurrency::streams::rawptr_stream<uint8_t>::open_istream(buffer->data(), buffer->size());
+                        return calculate_range_crc64 ? upload_range(range_data, offset, utility::string_t(), range_hash) : upload_range(range_data, offset, range_hash, utility::string_t());
+                    });
+                });
+
+                // The slot is released only after the range has been uploaded and hashed, so at most parallelism_factor
+                // range buffers are held in memory at any time.
+                guard.release();
+                upload_task.then([state, buffer](pplx::task<void> upload_task)
+                {
+                    transfer_byte_limit::release(buffer->size());
+                    try
+                    {
+                        upload_task.wait();
+                    }
+                    catch (...)
+                    {
+                        state->set_exception(std::current_exception());
+                    }
+                }).then([hash_task]() -> pplx::task<void>
+                {
+                    return hash_task;
+                }).then([semaphore, state](pplx::task<void> hash_task)
+                {
+                    std::lock_guard<async_semaphore> guard(*semaphore, std::adopt_lock);
+                    try
+                    {
+                        hash_task.wait();
+                    }
+                    catch (...)
+                    {
+                        state->set_exception(std::current_exception());
+                    }
+                });
+
+                return true;
+            });
+        }).then([semaphore, state, total_hash_provider](bool) mutable -> pplx::task<void>
+        {
+            return semaphore->wait_all_async().then([state, total_hash_provider]() mutable
+            {
+                auto exception = state->exception();
+                if (exception != nullptr)
+                {
+                    std::rethrow_exception(exception);
+                }
+
+                total_hash_provider.close();
+            });
+        });
+    }
+
     utility::char_t utility_char_tolower(const utility::char_t& character)
     {
         int i = (int)character;
@@ -501,65 +702,283 @@ namespace azure { namespace storage {  namespace core {
 
 #ifndef _WIN32
     const boost::asio::io_service& http_client_reusable::s_service = crossplat::threadpool::shared_instance().service();
-    std::map<utility::string_t, std::shared_ptr<web::http::client::http_client>> http_client_reusable::s_http_clients;
-    std::mutex http_client_reusable::s_mutex;
+    http_client_reusable::shard http_client_reusable::s_shards[http_client_reusable::s_shard_count];
+    std::atomic<size_t> http_client_reusable::s_max_connections_per_host(0);
+    std::atomic<std::chrono::seconds::rep> http_client_reusable::s_idle_timeout(protocol::default_http_client_idle_timeout.count());
+    std::atomic<utility::size64_t> http_client_reusable::s_hits(0);
+    std::atomic<utility::size64_t> http_client_reusable::s_creations(0);
+    std::atomic<utility::size64_t> http_client_reusable::s_evictions(0);
+    std::atomic<utility::size64_t> http_client_reusable::s_cached_clients(0);
+    std::atomic<utility::size64_t> http_client_reusable::s_active_requests(0);
+    std::atomic<utility::size64_t> http_client_reusable::s_waiting_requests(0);
+
+    size_t http_client_reusable::client_key_hash::operator()(const client_key& key) const
+    {
+        size_t hash = std::hash<utility::string_t>()(key.authority);
+        hash = hash * 31 + std::hash<utility::string_t>()(key.proxy);
+        hash = hash * 31 + std::hash<std::chrono::microseconds::rep>()(key.timeout);
+        hash = hash * 31 + key.chunksize;
+        hash = hash * 31 + std::hash<const void*>()(key.ssl_context_callback);
+        return hash;
+    }
+
+    http_client_reusable::shard& http_client_reusable::get_shard(const utility::string_t& authority)
+    {
+        return s_shards[std::hash<utility::string_t>()(authority) % s_shard_count];
+    }
 
     std::shared_ptr<web::http::client::http_client> http_client_reusable::get_http_client(const web::uri& uri)
     {
-        utility::string_t key(uri.to_string());
+        return get_http_client(uri, web::http::client::http_client_config());
+    }
 
-        std::lock_guard<std::mutex> guard(s_mutex);
-        auto iter = s_http_clients.find(key);
-        if (iter == s_http_clients.end())
+    std::shared_ptr<web::http::client::http_client> http_client_reusable::get_http_client(const web::uri& uri, const web::http::client::http_client_config& config)
+    {
+        client_key key;
+        key.authority = uri.to_string();
+        key.proxy_specified = config.proxy().is_specified();
+        if (key.proxy_specified)
         {
-            auto http_client = std::make_shared<web::http::client::http_client>(uri);
-            s_http_clients[key] = http_client;
-            return http_client;
+            key.proxy = config.proxy().address().to_string();
         }
-        else
+        key.timeout = std::chrono::duration_cast<std::chrono::microseconds>(config.timeout()).count();
+        key.chunksize = config.chunksize();
+        key.ssl_context_callback = config.get_ssl_context_callback() != nullptr ? static_cast<const void*>(&config.get_ssl_context_callback()) : nullptr;
+
+        auto& client_shard = get_shard(key.authority);
+        auto now = std::chrono::steady_clock::now();
+
+        std::lock_guard<std::mutex> guard(client_shard.mutex);
+        auto iter = client_shard.clients.find(key);
+        if (iter != client_shard.clients.end())
+        {
+            ++s_hits;
+            iter->second.last_used = now;
+            return iter->second.client;
+        }
+
+        // Sweep the shard for idle clients at most once per idle timeout, so lookups do not scan the whole shard.
+        std::chrono::seconds timeout(s_idle_timeout.load());
+        if (timeout.count() > 0 && now - client_shard.last_eviction >= timeout)
+        {
+            client_shard.last_eviction = now;
+            evict_idle_clients(client_shard, now);
+        }
+
+        cached_client entry;
+        entry.client = std::make_shared<web::http::client::http_client>(uri, config);
+        entry.last_used = now;
+        client_shard.clients.emplace(std::move(key), entry);
+        ++s_creations;
+        ++s_cached_clients;
+        return entry.client;
+    }
+
+    std::shared_ptr<async_semaphore> http_client_reusable::get_host_semaphore(const utility::string_t& authority)
+    {
+        size_t max_connections = s_max_connections_per_host.load();
+        if (max_connections == 0)
+        {
+            return nullptr;
+        }
+
+        auto& client_shard = get_shard(authority);
+        std::lock_guard<std::mutex> guard(client_shard.mutex);
+        auto iter = client_shard.host_semaphores.find(authority);
+        if (iter != client_shard.host_semaphores.end())
         {
             return iter->second;
         }
+
+        auto semaphore = std::make_shared<async_semaphore>(static_cast<int>(max_connections));
+        client_shard.host_semaphores.emplace(authority, semaphore);
+        return semaphore;
     }
 
-    std::shared_ptr<web::http::client::http_client> http_client_reusable::get_http_client(const web::uri& uri, const web::http::client::http_client_config& config)
+    pplx::task<web::http::http_response> http_client_reusable::request(const web::uri& uri, const web::http::client::http_client_config& config, web::http::http_request request, const pplx::cancellation_token& cancellation_token)
     {
-        utility::string_t key(uri.to_string());
-        key.append(_XPLATSTR("#"));
-        if (config.proxy().is_specified())
+        auto client = get_http_client(uri, config);
+        auto semaphore = get_host_semaphore(uri.to_string());
+
+        pplx::task<void> slot_task = pplx::task_from_result();
+        if (semaphore != nullptr)
         {
-            key.append(_XPLATSTR("0#"));
-            key.append(config.proxy().address().to_string());
-            key.append(_XPLATSTR("#"));
+            ++s_waiting_requests;
+            slot_task = semaphore->lock_async().then([]()
+            {
+                --s_waiting_requests;
+            });
         }
-        else
+
+        return slot_task.then([client, semaphore, request, cancellation_token]() -> pplx::task<web::http::http_response>
+        {
+            ++s_active_requests;
+
+            pplx::task<web::http::http_response> request_task;
+            try
+            {
+                request_task = client->request(request, cancellation_token);
+            }
+            catch (...)
+            {
+                --s_active_requests;
+                if (semaphore != nullptr)
+                {
+                    semaphore->unlock();
+                }
+
+                throw;
+            }
+
+            // The connection is in use until the whole response body has been received, so the slot is released
+            // off to the side of the returned task, which completes as soon as the headers are available.
+            request_task.then([](pplx::task<web::http::http_response> response_task) -> pplx::task<void>
+            {
+                try
+                {
+                    return response_task.get().content_ready().then([](pplx::task<web::http::http_response> content_ready_task)
+                    {
+                        try
+                        {
+                            content_ready_task.wait();
+                        }
+                        catch (const std::exception&)
+                        {
+                            // The failure is reported to the caller through the response.
+                        }
+                    });
+                }
+                catch (const std::exception&)
+                {
+                    // The failure is reported to the caller through the returned task.
+                    return pplx::task_from_result();
+                }
+            }).then([semaphore]()
+            {
+                --s_active_requests;
+                if (semaphore != nullptr)
+                {
+                    semaphore->unlock();
+                }
+            });
+
+            return request_task;
+        });
+    }
+
+    pplx::task<void> http_client_reusable::prewarm_connections(const web::uri& uri, const web::http::client::http_client_config& config, size_t connection_count)
+    {
+        if (connection_count == 0)
         {
-            key.append(_XPLATSTR("1#"));
+            return pplx::task_from_result();
         }
-        key.append(core::convert_to_string(config.timeout().count()));
-        key.append(_XPLATSTR("#"));
-        key.append(core::convert_to_string(config.chunksize()));
-        key.append(_XPLATSTR("#"));
-        if (config.get_ssl_context_callback() != nullptr)
+
+        // The requests are sent at the same time, so each of them needs its own connection. The connections stay in
+        // the client's connection pool once the responses have been received.
+        std::vector<pplx::task<void>> tasks;
+        tasks.reserve(connection_count);
+        for (size_t i = 0; i < connection_count; ++i)
         {
-            char buf[16];
-            sprintf(buf, "%p", (void*)&(config.get_ssl_context_callback()));
-            key.append(buf);
-            key.append(_XPLATSTR("#"));
+            tasks.push_back(request(uri, config, web::http::http_request(web::http::methods::HEAD), pplx::cancellation_token::none()).then([](pplx::task<web::http::http_response> response_task)
+            {
+                try
+                {
+                    // Any response means the connection has been established, so the status code is not checked.
+                    response_task.wait();
+                }
+                catch (const std::exception&)
+                {
+                    // Pre-warming is best effort. A failed connection is opened again by the first request that needs it.
+                }
+            }));
         }
 
-        std::lock_guard<std::mutex> guard(s_mutex);
-        auto iter = s_http_clients.find(key);
-        if (iter == s_http_clients.end())
+        return pplx::when_all(tasks.begin(), tasks.end());
+    }
+
+    void http_client_reusable::set_max_connections_per_host(size_t max_connections)
+    {
+        s_max_connections_per_host = max_connections;
+
+        // Requests in progress keep the semaphore they acquired. New requests create a semaphore with the new limit.
+        for (auto& client_shard : s_shards)
         {
-            auto http_client = std::make_shared<web::http::client::http_client>(uri, config);
-            s_http_clients[key] = http_client;
-            return http_client;
+            std::lock_guard<std::mutex> guard(client_shard.mutex);
+            client_shard.host_semaphores.clear();
         }
-        else
+    }
+
+    size_t http_client_reusable::max_connections_per_host()
+    {
+        return s_max_connections_per_host.load();
+    }
+
+    void http_client_reusable::set_idle_timeout(std::chrono::seconds idle_timeout)
+    {
+        s_idle_timeout = idle_timeout.count();
+    }
+
+    std::chrono::seconds http_client_reusable::idle_timeout()
+    {
+        return std::chrono::seconds(s_idle_timeout.load());
+    }
+
+    size_t http_client_reusable::evict_idle_clients()
+    {
+        return evict_idle_clients(std::chrono::steady_clock::now());
+    }
+
+    size_t http_client_reusable::evict_idle_clients(std::chrono::steady_clock::time_point now)
+    {
+        size_t evicted = 0;
+        for (auto& client_shard : s_shards)
         {
-            return iter->second;
+            std::lock_guard<std::mutex> guard(client_shard.mutex);
+            evicted += evict_idle_clients(client_shard, now);
+        }
+
+        return evicted;
+    }
+
+    size_t http_client_reusable::evict_idle_clients(shard& client_shard, std::chrono::steady_clock::time_point now)
+    {
+        // The caller must hold the shard's mutex.
+        std::chrono::seconds timeout(s_idle_timeout.load());
+        if (timeout.count() <= 0)
+        {
+            return 0;
+        }
+
+        size_t evicted = 0;
+        for (auto iter = client_shard.clients.begin(); iter != client_shard.clients.end();)
+        {
+            // A client that is still referenced outside of the cache is in use, so it is kept regardless of its last use time.
+            if (now - iter->second.last_used >= timeout && iter->second.client.use_count() == 1)
+            {
+                iter = client_shard.clients.erase(iter);
+                ++evicted;
+            }
+            else
+            {
+                ++iter;
+            }
         }
+
+        s_evictions += evicted;
+        s_cached_clients -= evicted;
+        return evicted;
+    }
+
+    http_client_pool_statistics http_client_reusable::statistics()
+    {
+        http_client_pool_statistics statistics;
+        statistics.hits = s_hits.load();
+        statistics.creations = s_creations.load();
+        statistics.evictions = s_evictions.load();
+        statistics.cached_clients = s_cached_clients.load();
+        statistics.active_requests = s_active_requests.load();
+        statistics.waiting_requests = s_waiting_requests.load();
+        return statistics;
     }
 
 #endif
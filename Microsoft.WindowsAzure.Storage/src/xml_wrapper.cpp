@@ -26,6 +26,10 @@
 #include "stdafx.h"
 #include "wascore/xml_wrapper.h"
 
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
 #ifndef _WIN32
 namespace azure { namespace storage { namespace core { namespace xml {
 
@@ -34,70 +38,182 @@ std::string xml_char_to_string(const xmlChar * xml_char)
     return std::string(reinterpret_cast<const char*>(xml_char));
 }
 
-xml_text_reader_wrapper::xml_text_reader_wrapper(const unsigned char * buffer, unsigned int size)
+xml_push_reader_wrapper::xml_push_reader_wrapper()
+    : m_node_count(0), m_next_node(0), m_current(0), m_attribute(0), m_failed(false)
+{
+    xmlSAXHandler handler;
+    memset(&handler, 0, sizeof(handler));
+    handler.initialized = XML_SAX2_MAGIC;
+    handler.startElementNs = start_element;
+    handler.endElementNs = end_element;
+    handler.characters = characters;
+    handler.ignorableWhitespace = characters;
+
+    m_context = xmlCreatePushParserCtxt(&handler, this, NULL, 0, NULL);
+    if (m_context == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+
+    // Errors are reported by the parse result, so libxml2 does not need to print them.
+    xmlCtxtUseOptions(m_context, XML_PARSE_NONET | XML_PARSE_NOERROR | XML_PARSE_NOWARNING);
+}
+
+xml_push_reader_wrapper::~xml_push_reader_wrapper()
+{
+    if (m_context != nullptr)
+    {
+        xmlFreeParserCtxt(m_context);
+        m_context = nullptr;
+    }
+}
+
+void xml_push_reader_wrapper::push(const char* data, size_t size)
+{
+    // Once the document is known to be malformed, nothing after the error is read.
+    while (!m_failed && size > 0)
+    {
+        int count = static_cast<int>(std::min(size, static_cast<size_t>(INT_MAX)));
+        m_failed = xmlParseChunk(m_context, data, count, 0) != 0;
+        data += count;
+        size -= count;
+    }
+}
+
+void xml_push_reader_wrapper::finish()
 {
-    m_reader = xmlReaderForMemory((const char*)buffer, size, NULL, 0, 0);
+    if (!m_failed)
+    {
+        m_failed = xmlParseChunk(m_context, NULL, 0, 1) != 0;
+    }
 }
 
-xml_text_reader_wrapper::~xml_text_reader_wrapper()
+bool xml_push_reader_wrapper::read()
 {
-    if (m_reader != nullptr)
+    if (m_next_node == m_node_count)
     {
-        xmlFreeTextReader(m_reader);
-        m_reader = nullptr;
+        m_node_count = 0;
+        m_next_node = 0;
+        return false;
     }
+
+    m_current = m_next_node++;
+    m_attribute = 0;
+    return true;
 }
 
-bool xml_text_reader_wrapper::read()
+unsigned xml_push_reader_wrapper::get_node_type()
 {
-    return xmlTextReaderRead(m_reader) != 0;
+    return m_nodes[m_current].type;
 }
 
-unsigned xml_text_reader_wrapper::get_node_type()
+bool xml_push_reader_wrapper::is_empty_element()
 {
-    return xmlTextReaderNodeType(m_reader);
+    return false;
 }
 
-bool xml_text_reader_wrapper::is_empty_element()
+std::string xml_push_reader_wrapper::get_local_name()
 {
-    return xmlTextReaderIsEmptyElement(m_reader) != 0;
+    const node& current = m_nodes[m_current];
+    const xmlChar* local_name = m_attribute == 0 ? current.local_name : current.attributes[m_attribute - 1].first;
+    return local_name != nullptr ? xml_char_to_string(local_name) : std::string();
 }
 
-std::string xml_text_reader_wrapper::get_local_name()
+std::string xml_push_reader_wrapper::get_value()
 {
-    auto xml_char = xmlTextReaderLocalName(m_reader);
-    std::string result; 
+    const node& current = m_nodes[m_current];
+    return m_attribute == 0 ? current.value : current.attributes[m_attribute - 1].second;
+}
+
+void xml_push_reader_wrapper::get_value(std::string& value)
+{
+    const node& current = m_nodes[m_current];
+    value.assign(m_attribute == 0 ? current.value : current.attributes[m_attribute - 1].second);
+}
 
-    if (xml_char != nullptr)
+bool xml_push_reader_wrapper::move_to_first_attribute()
+{
+    if (m_nodes[m_current].attributes.empty())
     {
-        result = xml_char_to_string(xml_char);
-        xmlFree(xml_char);
+        return false;
     }
 
-    return result;
+    m_attribute = 1;
+    return true;
 }
 
-std::string xml_text_reader_wrapper::get_value()
+bool xml_push_reader_wrapper::move_to_next_attribute()
 {
-    auto xml_char = xmlTextReaderValue(m_reader);
-    std::string result;
+    if (m_attribute == 0 || m_attribute >= m_nodes[m_current].attributes.size())
+    {
+        return false;
+    }
+
+    ++m_attribute;
+    return true;
+}
+
+void xml_push_reader_wrapper::start_element(void* context, const xmlChar* local_name, const xmlChar*, const xmlChar*, int namespace_count, const xmlChar** namespaces, int attribute_count, int, const xmlChar** attributes)
+{
+    static const xmlChar xmlns[] = "xmlns";
 
-    if (xml_char != nullptr)
+    auto reader = static_cast<xml_push_reader_wrapper*>(context);
+    reader->add_text_node();
+
+    node& element = reader->add_node(XML_READER_TYPE_ELEMENT, local_name);
+
+    // Namespace declarations are attributes too, named by their prefix as xmlTextReader does.
+    for (int i = 0; i < namespace_count; ++i)
     {
-        result = xml_char_to_string(xml_char);
-        xmlFree(xml_char);
+        const xmlChar* prefix = namespaces[i * 2];
+        const xmlChar* uri = namespaces[i * 2 + 1];
+        element.attributes.push_back(std::make_pair(prefix != nullptr ? prefix : xmlns, uri != nullptr ? xml_char_to_string(uri) : std::string()));
+    }
+
+    // Each attribute is given as its local name, prefix, namespace and the start and end of its value.
+    for (int i = 0; i < attribute_count; ++i)
+    {
+        const xmlChar** attribute = attributes + i * 5;
+        element.attributes.push_back(std::make_pair(attribute[0], std::string(reinterpret_cast<const char*>(attribute[3]), attribute[4] - attribute[3])));
     }
-    return result;
 }
 
-bool xml_text_reader_wrapper::move_to_first_attribute()
+void xml_push_reader_wrapper::end_element(void* context, const xmlChar* local_name, const xmlChar*, const xmlChar*)
 {
-    return xmlTextReaderMoveToFirstAttribute(m_reader) != 0;
+    auto reader = static_cast<xml_push_reader_wrapper*>(context);
+    reader->add_text_node();
+    reader->add_node(XML_READER_TYPE_END_ELEMENT, local_name);
 }
 
-bool xml_text_reader_wrapper::move_to_next_attribute()
+void xml_push_reader_wrapper::characters(void* context, const xmlChar* text, int length)
 {
-    return xmlTextReaderMoveToNextAttribute(m_reader) != 0;
+    // The text of an element can come in several calls, for example around entities or when it spans two pieces of the document.
+    auto reader = static_cast<xml_push_reader_wrapper*>(context);
+    reader->m_text.append(reinterpret_cast<const char*>(text), length);
+}
+
+xml_push_reader_wrapper::node& xml_push_reader_wrapper::add_node(unsigned type, const xmlChar* local_name)
+{
+    if (m_node_count == m_nodes.size())
+    {
+        m_nodes.push_back(node());
+    }
+
+    node& result = m_nodes[m_node_count++];
+    result.type = type;
+    result.local_name = local_name;
+    result.value.clear();
+    result.attributes.clear();
+    return result;
+}
+
+void xml_push_reader_wrapper::add_text_node()
+{
+    if (!m_text.empty())
+    {
+        add_node(XML_READER_TYPE_TEXT, nullptr).value.assign(m_text);
+        m_text.clear();
+    }
 }
 
 xml_element_wrapper::~xml_element_wrapper()
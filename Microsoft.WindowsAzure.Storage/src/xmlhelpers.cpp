@@ -42,14 +42,16 @@
 #include "stdafx.h"
 #include "wascore/xmlhelpers.h"
 
+#include <algorithm>
+
 #ifdef _WIN32
 #include "wascore/xmlstream.h"
 #else
 typedef int XmlNodeType;
-#define XmlNodeType_Element xmlElementType::XML_ELEMENT_NODE
-#define XmlNodeType_Text xmlElementType::XML_TEXT_NODE
-#define XmlNodeType_EndElement xmlElementType::XML_ELEMENT_DECL
-#define XmlNodeType_Whitespace xmlElementType::XML_DTD_NODE //? not align with tinyxml?
+#define XmlNodeType_Element XML_READER_TYPE_ELEMENT
+#define XmlNodeType_Text XML_READER_TYPE_TEXT
+#define XmlNodeType_EndElement XML_READER_TYPE_END_ELEMENT
+#define XmlNodeType_Whitespace XML_READER_TYPE_SIGNIFICANT_WHITESPACE
 #endif
 
 using namespace web;
@@ -58,6 +60,11 @@ using namespace concurrency;
 
 namespace azure { namespace storage { namespace core { namespace xml {
 
+#ifndef _WIN32
+    // The largest piece of a response that is pushed to the parser at a time.
+    const size_t xml_input_buffer_size = 64 * 1024;
+#endif
+
     void xml_reader::initialize(streams::istream stream)
     {
 #ifdef _WIN32
@@ -96,22 +103,122 @@ namespace azure { namespace storage { namespace core { namespace xml {
             throw utility::details::create_system_error(error);
         }
 #else
-        concurrency::streams::stringstreambuf buffer;
-        stream.read_to_end(buffer).get();
-        m_data = buffer.collection();
-        if (m_data.empty())
-            m_reader.reset();
-        else
-            m_reader.reset(new xml_text_reader_wrapper(reinterpret_cast<const unsigned char*>(m_data.data()), static_cast<unsigned int>(m_data.size())));
+        // Nothing is read here. The stream is pushed to the parser by read_async, or by parse if it was not read before.
+        m_reader = std::make_shared<xml_push_reader_wrapper>();
+        m_input = stream.streambuf();
+#endif
+    }
+
+    pplx::task<void> xml_reader::read_async()
+    {
+#ifdef _WIN32
+        return pplx::task_from_result();
+#else
+        if (!m_input)
+        {
+            return pplx::task_from_result();
+        }
+
+        return pplx::details::_do_while([this]() -> pplx::task<bool>
+        {
+            // Data that has already arrived is parsed straight from the stream buffer, so the body is not copied first.
+            uint8_t* data;
+            size_t count;
+            while (m_input.acquire(data, count))
+            {
+                if (count == 0)
+                {
+                    m_input = concurrency::streams::streambuf<uint8_t>();
+                    m_reader->finish();
+                    read_nodes();
+                    return pplx::task_from_result(false);
+                }
+
+                push_input(data, count);
+                m_input.release(data, count);
+            }
+
+            // Otherwise wait for the next piece. Stream buffers that do not support acquire are read this way too.
+            if (m_inputBuffer.empty())
+            {
+                m_inputBuffer.resize(xml_input_buffer_size);
+            }
+
+            return m_input.getn(m_inputBuffer.data(), m_inputBuffer.size()).then([this](size_t read_count) -> bool
+            {
+                if (read_count == 0)
+                {
+                    m_input = concurrency::streams::streambuf<uint8_t>();
+                    m_reader->finish();
+                    read_nodes();
+                    return false;
+                }
+
+                push_input(m_inputBuffer.data(), read_count);
+                return true;
+            });
+        }).then([](bool)
+        {
+        });
 #endif
     }
 
+#ifndef _WIN32
+    void xml_reader::push_input(const uint8_t* data, size_t count)
+    {
+        // The nodes are handled after every piece, so they do not pile up when the whole body is available at once.
+        while (count > 0)
+        {
+            size_t piece = std::min(count, xml_input_buffer_size);
+            m_reader->push(reinterpret_cast<const char*>(data), piece);
+            read_nodes();
+            data += piece;
+            count -= piece;
+        }
+    }
+#endif
+
     xml_reader::parse_result xml_reader::parse()
     {
         if (m_streamDone) return xml_reader::parse_result::cannot_continue;
         // Set this to true each time the parse routine is invoked. Most derived readers will only invoke parse once.
         m_continueParsing = true;
 
+#ifndef _WIN32
+        if (m_reader == nullptr)
+            return xml_reader::parse_result::cannot_continue; // no XML document to read
+
+        // The stream was not read with read_async, so it is read here and the parsed nodes are handled as it goes.
+        if (m_input)
+        {
+            read_async().get();
+        }
+#endif
+
+        read_nodes();
+
+        xml_reader::parse_result result = xml_reader::parse_result::can_continue;
+        // If the loop was terminated because there was no more to read from the stream, set m_streamDone to true, so exit early
+        // the next time parse is invoked.
+        // if stream is not done, it means that the parsing is interuptted by pause().
+        // if the element stack is not empty when the stream is done, it means that the xml is not complete.
+        if (m_continueParsing)
+        {
+            m_streamDone = true;
+            if (m_elementStack.empty())
+            {
+                result = xml_reader::parse_result::cannot_continue;
+            }
+            else
+            {
+                result = xml_reader::parse_result::xml_not_complete;
+            }
+        }
+        return result;
+    }
+
+    void xml_reader::read_nodes()
+    {
         // read until there are no more nodes
 #ifdef _WIN32
         HRESULT hr;
@@ -119,9 +226,6 @@ namespace azure { namespace storage { namespace core { namespace xml {
         while (m_continueParsing && S_OK == (hr = m_reader->Read(&nodeType)))
         {
 #else
-        if (m_reader == nullptr)
-            return xml_reader::parse_result::cannot_continue; // no XML document to read
-
         while (m_continueParsing && m_reader->read())
         {
             auto nodeType = m_reader->get_node_type();
@@ -163,25 +267,6 @@ namespace azure { namespace storage { namespace core { namespace xml {
                 break;
             }
         }
-
-        xml_reader::parse_result result = xml_reader::parse_result::can_continue;
-        // If the loop was terminated because there was no more to read from the stream, set m_streamDone to true, so exit early
-        // the next time parse is invoked.
-        // if stream is not done, it means that the parsing is interuptted by pause().
-        // if the element stack is not empty when the stream is done, it means that the xml is not complete.
-        if (m_continueParsing)
-        {
-            m_streamDone = true;
-            if (m_elementStack.empty())
-            {
-                result = xml_reader::parse_result::cannot_continue;
-            }
-            else
-            {
-                result = xml_reader::parse_result::xml_not_complete;
-            }
-        }
-        return result;
     }
 
     utility::string_t xml_reader::get_parent_element_name(size_t pos)
@@ -256,6 +341,26 @@ namespace azure { namespace storage { namespace core { namespace xml {
 #endif
     }
 
+    void xml_reader::read_current_element_text(utility::string_t& value)
+    {
+#ifdef _WIN32
+        HRESULT hr;
+        const wchar_t * pwszValue;
+        UINT length;
+
+        if (FAILED(hr = m_reader->GetValue(&pwszValue, &length)))
+        {
+            auto error = GetLastError();
+            log_error_message(_XPLATSTR("XML reader GetValue failed"), error);
+            throw utility::details::create_system_error(error);
+        }
+
+        value.assign(pwszValue, length);
+#else
+        m_reader->get_value(value);
+#endif
+    }
+
     bool xml_reader::move_to_first_attribute()
     {
 #ifdef _WIN32
@@ -19,6 +19,11 @@
 #include "blob_test_base.h"
 #include "check_macros.h"
 #include "wascore/hashing.h"
+#include "wascore/adaptive_upload.h"
+#include "wascore/async_semaphore.h"
+#include "wascore/buffer_pool.h"
+#include "wascore/hash_pipeline.h"
+#include "wascore/md5_multi_buffer.h"
 
 size_t seek_read_and_compare(concurrency::streams::istream stream, std::vector<uint8_t> buffer_to_compare, utility::size64_t offset, size_t count, size_t expected_read_count)
 {
@@ -215,6 +220,210 @@ SUITE(Blob)
         CHECK(origin_md5 == downloaded_md5);
     }
 
+    TEST_FIXTURE(block_blob_test_base, blob_write_stream_adaptive_upload)
+    {
+        azure::storage::blob_request_options options;
+        options.set_use_adaptive_upload(true);
+        options.set_parallelism_factor(4);
+        options.set_stream_write_size_in_bytes(512 * 1024);
+
+        std::vector<uint8_t> buffer;
+        buffer.resize(24 * 1024 * 1024);
+        auto md5 = fill_buffer_and_get_md5(buffer);
+
+        concurrency::streams::container_buffer<std::vector<uint8_t>> input_buffer(buffer);
+        m_blob.upload_from_stream(input_buffer.create_istream(), azure::storage::access_condition(), options, m_context);
+
+        auto blocks = m_blob.download_block_list(azure::storage::block_listing_filter::committed, azure::storage::access_condition(), options, m_context);
+        CHECK(blocks.size() <= buffer.size() / (512 * 1024));
+        for (auto& block : blocks)
+        {
+            CHECK(block.size() >= 512 * 1024 || &block == &blocks.back());
+        }
+
+        concurrency::streams::container_buffer<std::vector<uint8_t>> output_buffer;
+        m_blob.download_to_stream(output_buffer.create_ostream(), azure::storage::access_condition(), options, m_context);
+        CHECK_EQUAL(buffer.size(), output_buffer.collection().size());
+        CHECK_ARRAY_EQUAL(buffer, output_buffer.collection(), (int)buffer.size());
+        CHECK_UTF8_EQUAL(md5, m_blob.properties().content_md5());
+    }
+
+    TEST_FIXTURE(test_base, adaptive_upload_controller_backoff)
+    {
+        azure::storage::core::adaptive_upload_controller controller(1024, 8 * 1024, 8);
+        CHECK_EQUAL(1024U, controller.block_size());
+        CHECK_EQUAL(4, controller.parallelism());
+
+        // Throttling halves the parallelism once per epoch and never goes below the minimum block size.
+        controller.throttled();
+        CHECK_EQUAL(2, controller.parallelism());
+        CHECK_EQUAL(1024U, controller.block_size());
+        controller.throttled();
+        CHECK_EQUAL(2, controller.parallelism());
+
+        // The first complete epoch after backing off probes one more block in flight.
+        for (int i = 0; i < 4; ++i)
+        {
+            controller.block_completed(1024);
+        }
+        CHECK_EQUAL(3, controller.parallelism());
+
+        for (int i = 0; i < 4; ++i)
+        {
+            controller.throttled();
+        }
+        CHECK_EQUAL(1, controller.parallelism());
+        CHECK_EQUAL(1024U, controller.block_size());
+    }
+
+    TEST_FIXTURE(test_base, buffer_pool_reuse)
+    {
+        auto max_pooled_bytes = azure::storage::core::buffer_pool::max_pooled_bytes();
+        azure::storage::core::buffer_pool::clear();
+        azure::storage::core::buffer_pool::set_max_pooled_bytes(2 * 1024 * 1024);
+
+        // Sizes are rounded up to a power-of-two size class.
+        auto statistics = azure::storage::core::buffer_pool::statistics();
+        auto buffer = azure::storage::core::buffer_pool::acquire(1000 * 1000);
+        CHECK(buffer.empty());
+        CHECK(buffer.capacity() >= 1024 * 1024);
+        buffer.resize(1000 * 1000);
+        auto data = buffer.data();
+        azure::storage::core::buffer_pool::release(std::move(buffer));
+        CHECK_EQUAL(statistics.pooled_bytes + 1024 * 1024, azure::storage::core::buffer_pool::statistics().pooled_bytes);
+
+        // A request of the same size class gets the returned buffer back, without allocating.
+        buffer = azure::storage::core::buffer_pool::acquire(512 * 1024 + 1);
+        CHECK(buffer.empty());
+        CHECK(data == buffer.data());
+        CHECK_EQUAL(statistics.reuses + 1, azure::storage::core::buffer_pool::statistics().reuses);
+        CHECK_EQUAL(statistics.allocations + 1, azure::storage::core::buffer_pool::statistics().allocations);
+
+        // Returned buffers that do not fit under the cap are freed.
+        auto other_buffer = azure::storage::core::buffer_pool::acquire(2 * 1024 * 1024);
+        azure::storage::core::buffer_pool::release(std::move(buffer));
+        azure::storage::core::buffer_pool::release(std::move(other_buffer));
+        CHECK_EQUAL(1024U * 1024U, azure::storage::core::buffer_pool::statistics().pooled_bytes);
+        CHECK_EQUAL(statistics.discards + 1, azure::storage::core::buffer_pool::statistics().discards);
+        CHECK_EQUAL(statistics.outstanding_bytes, azure::storage::core::buffer_pool::statistics().outstanding_bytes);
+
+        azure::storage::core::buffer_pool::clear();
+        CHECK_EQUAL(0U, azure::storage::core::buffer_pool::statistics().pooled_bytes);
+
+        // The cap only bounds idle buffers, so buffers in use are still handed out and reported as outstanding.
+        azure::storage::core::buffer_pool::set_max_pooled_bytes(0);
+        buffer = azure::storage::core::buffer_pool::acquire(1024 * 1024);
+        CHECK(buffer.capacity() >= 1024 * 1024);
+        CHECK_EQUAL(statistics.outstanding_bytes + 1024 * 1024, azure::storage::core::buffer_pool::statistics().outstanding_bytes);
+        azure::storage::core::buffer_pool::release(std::move(buffer));
+        CHECK_EQUAL(statistics.outstanding_bytes, azure::storage::core::buffer_pool::statistics().outstanding_bytes);
+        CHECK_EQUAL(0U, azure::storage::core::buffer_pool::statistics().pooled_bytes);
+
+        azure::storage::core::buffer_pool::set_max_pooled_bytes(max_pooled_bytes);
+    }
+
+    TEST_FIXTURE(test_base, hash_pipeline_md5)
+    {
+        // Buffer sizes cover every padding case, and differ so that lanes finish at different times.
+        std::vector<size_t> sizes = { 0, 1, 55, 56, 63, 64, 65, 119, 120, 4096, 100003, 1024 * 1024 + 7 };
+        std::vector<std::vector<uint8_t>> buffers;
+        std::vector<utility::string_t> expected;
+        for (auto size : sizes)
+        {
+            std::vector<uint8_t> buffer(size);
+            for (size_t i = 0; i < size; ++i)
+            {
+                buffer[i] = static_cast<uint8_t>(get_random_int32());
+            }
+
+            azure::storage::core::hash_provider provider = azure::storage::core::hash_provider::create_md5_hash_provider();
+            provider.write(buffer.data(), buffer.size());
+            provider.close();
+            expected.push_back(provider.hash());
+            buffers.push_back(std::move(buffer));
+        }
+
+        std::vector<const uint8_t*> data;
+        std::vector<size_t> counts;
+        for (const auto& buffer : buffers)
+        {
+            data.push_back(buffer.data());
+            counts.push_back(buffer.size());
+        }
+
+        std::vector<uint8_t> digests(buffers.size() * azure::storage::core::md5_digest_size);
+        azure::storage::core::md5_multi_buffer(data.data(), counts.data(), buffers.size(), digests.data());
+
+        std::vector<pplx::task<utility::string_t>> tasks;
+        for (size_t i = 0; i < buffers.size(); ++i)
+        {
+            std::vector<uint8_t> digest(digests.begin() + i * azure::storage::core::md5_digest_size, digests.begin() + (i + 1) * azure::storage::core::md5_digest_size);
+            CHECK_UTF8_EQUAL(expected[i], utility::conversions::to_base64(digest));
+
+            tasks.push_back(azure::storage::core::hash_pipeline::md5_async(buffers[i].data(), buffers[i].size()));
+        }
+
+        for (size_t i = 0; i < buffers.size(); ++i)
+        {
+            CHECK_UTF8_EQUAL(expected[i], tasks[i].get());
+        }
+    }
+
+    TEST_FIXTURE(test_base, async_semaphore_weighted)
+    {
+        azure::storage::core::async_semaphore semaphore(100);
+
+        CHECK(semaphore.try_lock(60));
+        CHECK(!semaphore.try_lock(50));
+        CHECK(semaphore.lock_async(40).is_done());
+
+        // Waiters are released in order, once enough units have been returned for the first one.
+        auto large = semaphore.lock_async(70);
+        auto small = semaphore.lock_async(10);
+        semaphore.unlock(60);
+        CHECK(!large.is_done());
+        CHECK(!small.is_done());
+        CHECK(!semaphore.try_lock(1));
+
+        semaphore.unlock(40);
+        CHECK(large.is_done());
+        CHECK(small.is_done());
+
+        auto idle = semaphore.wait_all_async();
+        CHECK(!idle.is_done());
+        semaphore.unlock(70);
+        CHECK(!idle.is_done());
+        semaphore.unlock(10);
+        CHECK(idle.is_done());
+
+        // An acquisition larger than the count is granted once nothing else is held.
+        CHECK(semaphore.lock_async(250).is_done());
+        CHECK(!semaphore.try_lock());
+        semaphore.unlock(250);
+        CHECK(semaphore.try_lock());
+        semaphore.unlock();
+        CHECK(semaphore.wait_all_async().is_done());
+    }
+
+    TEST_FIXTURE(test_base, async_semaphore_wait_all_with_handed_over_unit)
+    {
+        azure::storage::core::async_semaphore semaphore(1);
+
+        CHECK(semaphore.lock_async().is_done());
+        auto pending = semaphore.lock_async();
+        auto idle = semaphore.wait_all_async();
+        CHECK(!pending.is_done());
+        CHECK(!idle.is_done());
+
+        // The returned unit goes straight to the queued waiter, so the semaphore never becomes idle.
+        semaphore.unlock();
+        CHECK(pending.is_done());
+        CHECK(!idle.is_done());
+
+        semaphore.unlock();
+        CHECK(idle.is_done());
+    }
+
     TEST_FIXTURE(block_blob_test_base, blob_read_stream_download)
     {
         azure::storage::blob_request_options options;
@@ -236,6 +445,49 @@ SUITE(Blob)
         CHECK_ARRAY_EQUAL(buffer, output_buffer.collection(), (int)output_buffer.collection().size());
     }
 
+    TEST_FIXTURE(block_blob_test_base, blob_read_stream_read_ahead)
+    {
+        azure::storage::blob_request_options options;
+        options.set_stream_read_size_in_bytes(1 * 1024 * 1024);
+        options.set_read_ahead_range_count(2);
+        options.set_parallelism_factor(2);
+
+        std::vector<uint8_t> buffer;
+        buffer.resize(5 * 1024 * 1024 + 1024);
+        fill_buffer_and_get_md5(buffer);
+        m_blob.upload_from_stream(concurrency::streams::bytestream::open_istream(buffer), azure::storage::access_condition(), options, m_context);
+
+        {
+            auto stream = m_blob.open_read(azure::storage::access_condition(), options, m_context);
+            size_t requests = m_context.request_results().size();
+
+            concurrency::streams::container_buffer<std::vector<uint8_t>> output_buffer;
+            stream.read_to_end(output_buffer).wait();
+            stream.close().wait();
+
+            CHECK_EQUAL(buffer.size(), output_buffer.collection().size());
+            CHECK_ARRAY_EQUAL(buffer, output_buffer.collection(), (int)output_buffer.collection().size());
+
+            // Ranges downloaded ahead are used by the reader, so every range is downloaded exactly once.
+            CHECK_EQUAL(requests + 6, m_context.request_results().size());
+        }
+
+        {
+            // Seeking away drops the ranges downloaded ahead, and reading sequentially again turns read-ahead back on.
+            auto stream = m_blob.open_read(azure::storage::access_condition(), options, m_context);
+            size_t position = 0;
+            position += seek_read_and_compare(stream, buffer, position, 1024, 1024);
+            position = 3 * 1024 * 1024 + 512;
+            stream.seek(position);
+            position += seek_read_and_compare(stream, buffer, position, 1024, 1024);
+            position = 1024;
+            stream.seek(position);
+            position += seek_read_and_compare(stream, buffer, position, 3 * 1024 * 1024, 3 * 1024 * 1024);
+            CHECK_EQUAL(position, stream.tell());
+            stream.close().wait();
+        }
+    }
+
     TEST_FIXTURE(block_blob_test_base, blob_read_stream_etag_lock)
     {
         azure::storage::blob_request_options options;
@@ -19,6 +19,7 @@
 #include "blob_test_base.h"
 #include "check_macros.h"
 
+#include "wascore/protocol_xml.h"
 #include "wascore/util.h"
 #include "cpprest/asyncrt_utils.h"
 
@@ -820,4 +821,147 @@ SUITE(Blob)
             CHECK_EQUAL("", ex_msg);
         }
     }
+
+    TEST_FIXTURE(container_test_base, container_list_blobs_reader_incremental)
+    {
+        std::string body = "<?xml version=\"1.0\" encoding=\"utf-8\"?><EnumerationResults ServiceEndpoint=\"https://myaccount.blob.core.windows.net/\" ContainerName=\"mycontainer\"><Blobs>";
+        for (int i = 0; i < 1000; ++i)
+        {
+            body += "<Blob><Name>blob &amp; " + std::to_string(i) + "</Name><Properties><Content-Length>" + std::to_string(i) + "</Content-Length><BlobType>BlockBlob</BlobType></Properties></Blob>";
+        }
+        body += "<BlobPrefix><Name>dir/</Name></BlobPrefix></Blobs><NextMarker>marker</NextMarker></EnumerationResults>";
+        size_t half = body.size() / 2;
+
+        {
+            concurrency::streams::producer_consumer_buffer<uint8_t> buffer;
+            auto reader = std::make_shared<azure::storage::protocol::list_blobs_reader>(buffer.create_istream());
+
+            buffer.putn_nocopy(reinterpret_cast<const uint8_t*>(body.data()), half).wait();
+            auto read_task = reader->read_async();
+#ifndef _WIN32
+            // The first half is parsed right away, and the reader then waits for the rest without holding a thread.
+            CHECK(!read_task.is_done());
+#endif
+
+            buffer.putn_nocopy(reinterpret_cast<const uint8_t*>(body.data()) + half, body.size() - half).wait();
+            buffer.close(std::ios_base::out).wait();
+            read_task.get();
+
+            auto blob_items = reader->move_blob_items();
+            CHECK_EQUAL(1000U, blob_items.size());
+            CHECK_UTF8_EQUAL(_XPLATSTR("blob & 999"), blob_items.back().move_name());
+            CHECK_EQUAL(999U, blob_items.back().move_properties().size());
+            CHECK_EQUAL(1U, reader->move_blob_prefix_items().size());
+            CHECK_UTF8_EQUAL(_XPLATSTR("marker"), reader->move_next_marker());
+        }
+
+        {
+            concurrency::streams::producer_consumer_buffer<uint8_t> buffer;
+            auto reader = std::make_shared<azure::storage::protocol::list_blobs_reader>(buffer.create_istream());
+
+            buffer.putn_nocopy(reinterpret_cast<const uint8_t*>(body.data()), half).wait();
+            buffer.close(std::ios_base::out).wait();
+            reader->read_async().get();
+
+            CHECK_THROW(reader->move_blob_items(), azure::storage::storage_exception);
+        }
+    }
+
+    TEST_FIXTURE(container_test_base, container_list_blobs_compact_reader)
+    {
+        std::string body = "<?xml version=\"1.0\" encoding=\"utf-8\"?><EnumerationResults ServiceEndpoint=\"https://myaccount.blob.core.windows.net/\" ContainerName=\"mycontainer\"><Blobs>";
+        body += "<Blob><Name>blob1</Name><Snapshot>2011-03-09T01:42:34.9360000Z</Snapshot><Properties><Last-Modified>Wed, 09 Mar 2011 01:42:34 GMT</Last-Modified><Etag>0x8CDA5B1E8A9B1F2</Etag><Content-Length>1024</Content-Length><BlobType>PageBlob</BlobType></Properties><Metadata><color>blue</color><size>large</size></Metadata></Blob>";
+        body += "<Blob><Name>blob &amp; 2</Name><Properties><Last-Modified>Mon, 01 Jan 2018 23:59:59 GMT</Last-Modified><Content-Length>0</Content-Length><BlobType>BlockBlob</BlobType></Properties><Metadata /></Blob>";
+        body += "<BlobPrefix><Name>dir/</Name></BlobPrefix></Blobs><NextMarker>marker</NextMarker></EnumerationResults>";
+
+        concurrency::streams::producer_consumer_buffer<uint8_t> buffer;
+        buffer.putn_nocopy(reinterpret_cast<const uint8_t*>(body.data()), body.size()).wait();
+        buffer.close(std::ios_base::out).wait();
+
+        auto reader = std::make_shared<azure::storage::protocol::compact_list_blobs_reader>(buffer.create_istream());
+        reader->read_async().get();
+        auto segment = reader->move_segment(azure::storage::storage_location::secondary);
+
+        CHECK_EQUAL(3U, segment.size());
+        CHECK_UTF8_EQUAL(_XPLATSTR("marker"), segment.continuation_token().next_marker());
+        CHECK(segment.continuation_token().target_location() == azure::storage::storage_location::secondary);
+
+        auto blob1 = segment[0];
+        CHECK(blob1.is_blob());
+        CHECK_UTF8_EQUAL(_XPLATSTR("blob1"), blob1.name());
+        CHECK_UTF8_EQUAL(_XPLATSTR("2011-03-09T01:42:34.9360000Z"), blob1.snapshot_time());
+        CHECK_UTF8_EQUAL(_XPLATSTR("\"0x8CDA5B1E8A9B1F2\""), blob1.etag());
+        CHECK_EQUAL(1024U, blob1.size());
+        CHECK(blob1.type() == azure::storage::blob_type::page_blob);
+        CHECK(blob1.last_modified() == utility::datetime::from_string(_XPLATSTR("Wed, 09 Mar 2011 01:42:34 GMT")));
+        CHECK_EQUAL(2U, blob1.metadata_count());
+        CHECK_UTF8_EQUAL(_XPLATSTR("color"), blob1.metadata_name(0));
+        CHECK_UTF8_EQUAL(_XPLATSTR("blue"), blob1.metadata_value(0));
+        CHECK_UTF8_EQUAL(_XPLATSTR("size"), blob1.metadata_name(1));
+        CHECK_UTF8_EQUAL(_XPLATSTR("large"), blob1.metadata_value(1));
+
+        auto blob2 = segment[1];
+        CHECK(blob2.is_blob());
+        CHECK_UTF8_EQUAL(_XPLATSTR("blob & 2"), blob2.name());
+        CHECK_UTF8_EQUAL(_XPLATSTR(""), blob2.snapshot_time());
+        CHECK_EQUAL(0U, blob2.size());
+        CHECK(blob2.type() == azure::storage::blob_type::block_blob);
+        CHECK(blob2.last_modified() == utility::datetime::from_string(_XPLATSTR("Mon, 01 Jan 2018 23:59:59 GMT")));
+        CHECK_EQUAL(0U, blob2.metadata_count());
+
+        auto prefix = segment[2];
+        CHECK(!prefix.is_blob());
+        CHECK_UTF8_EQUAL(_XPLATSTR("dir/"), prefix.name());
+    }
+
+    TEST_FIXTURE(container_test_base, container_list_blobs_parallel)
+    {
+        m_container.create(azure::storage::blob_container_public_access_type::off, azure::storage::blob_request_options(), m_context);
+
+        std::set<utility::string_t> names;
+        const utility::string_t prefixes[] = { _XPLATSTR(""), _XPLATSTR("a/"), _XPLATSTR("a/b/"), _XPLATSTR("a/b/c/"), _XPLATSTR("d/") };
+        for (const auto& prefix : prefixes)
+        {
+            for (int i = 0; i < 3; ++i)
+            {
+                auto blob = m_container.get_block_blob_reference(prefix + _XPLATSTR("blob") + azure::storage::core::convert_to_string(i));
+                blob.upload_text(blob.name());
+                names.insert(blob.name());
+            }
+        }
+
+        {
+            // The consumer is never called concurrently, so it does not need a lock.
+            std::set<utility::string_t> listed;
+            m_container.list_blobs_parallel(utility::string_t(), azure::storage::blob_listing_details::metadata, 2, [&listed](const azure::storage::list_blob_item& item)
+            {
+                CHECK(item.is_blob());
+                CHECK(listed.insert(item.as_blob().name()).second);
+            }, azure::storage::blob_request_options(), m_context);
+
+            CHECK(names == listed);
+        }
+
+        {
+            std::set<utility::string_t> listed;
+            m_container.list_blobs_parallel_async(_XPLATSTR("a/b/"), [&listed](const azure::storage::list_blob_item& item)
+            {
+                listed.insert(item.as_blob().name());
+            }).wait();
+
+            CHECK_EQUAL(6U, listed.size());
+            CHECK(listed.find(_XPLATSTR("a/b/c/blob2")) != listed.end());
+        }
+
+        {
+            auto task = m_container.list_blobs_parallel_async(utility::string_t(), azure::storage::blob_listing_details::none, 2, [](const azure::storage::list_blob_item&)
+            {
+                throw std::runtime_error("consumer failed");
+            }, azure::storage::blob_request_options(), m_context);
+            CHECK_THROW(task.get(), std::runtime_error);
+        }
+
+        CHECK_THROW(m_container.list_blobs_parallel_async(utility::string_t(), azure::storage::blob_listing_details::snapshots, 2, [](const azure::storage::list_blob_item&) {}, azure::storage::blob_request_options(), m_context), std::invalid_argument);
+        CHECK_THROW(m_container.list_blobs_parallel_async(utility::string_t(), azure::storage::blob_listing_details::none, 0, [](const azure::storage::list_blob_item&) {}, azure::storage::blob_request_options(), m_context), std::invalid_argument);
+    }
 }
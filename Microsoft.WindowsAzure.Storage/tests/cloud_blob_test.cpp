@@ -971,6 +971,56 @@ SUITE(Blob)
         }
     }
 
+    /// <summary>
+    /// Test parallel download to a seekable target that does not start at position zero, and to a non-seekable target
+    /// </summary>
+    TEST_FIXTURE(blob_test_base, parallel_download_target_position)
+    {
+        auto blob_name = get_random_string(20);
+        auto blob = m_container.get_block_blob_reference(blob_name);
+        size_t target_length = 100 * 1024 * 1024;
+        azure::storage::blob_request_options option;
+        option.set_parallelism_factor(8);
+        std::vector<uint8_t> data;
+        data.resize(target_length);
+        for (size_t i = 0; i < target_length; ++i)
+        {
+            data[i] = i % 255;
+        }
+        concurrency::streams::container_buffer<std::vector<uint8_t>> upload_buffer(data);
+        blob.upload_from_stream(upload_buffer.create_istream(), azure::storage::access_condition(), option, m_context);
+
+        // seekable target with existing content, segments are written to their final positions out of order.
+        {
+            const size_t prefix_length = 1000;
+            concurrency::streams::container_buffer<std::vector<uint8_t>> download_buffer;
+            auto download_stream = download_buffer.create_ostream();
+            std::vector<uint8_t> prefix(prefix_length, 0xff);
+            download_stream.streambuf().putn_nocopy(prefix.data(), prefix.size()).wait();
+
+            azure::storage::operation_context context;
+            blob.download_to_stream(download_stream, azure::storage::access_condition(), option, context);
+
+            check_parallelism(context, 8);
+            CHECK(download_stream.tell() == static_cast<concurrency::streams::ostream::pos_type>(prefix_length + target_length));
+            CHECK(download_buffer.collection().size() == prefix_length + target_length);
+            CHECK(std::equal(prefix.begin(), prefix.end(), download_buffer.collection().begin()));
+            CHECK(std::equal(data.begin(), data.end(), download_buffer.collection().begin() + prefix_length));
+        }
+
+        // non-seekable target, segments are written in order.
+        {
+            concurrency::streams::producer_consumer_buffer<uint8_t> download_buffer;
+            azure::storage::operation_context context;
+            blob.download_to_stream(download_buffer.create_ostream(), azure::storage::access_condition(), option, context);
+            download_buffer.close(std::ios_base::out).wait();
+
+            std::vector<uint8_t> downloaded(target_length);
+            CHECK_EQUAL(target_length, download_buffer.getn(downloaded.data(), downloaded.size()).get());
+            CHECK(std::equal(data.begin(), data.end(), downloaded.begin()));
+        }
+    }
+
     TEST_FIXTURE(blob_test_base, parallel_download_with_md5)
     {
         // transactional md5 enabled.
@@ -22,6 +22,7 @@
 #include "cpprest/producerconsumerstream.h"
 #include "cpprest/rawptrstream.h"
 #include "wascore/constants.h"
+#include "wascore/crc64.h"
 #include "wascore/util.h"
 
 #pragma region Fixture
@@ -547,6 +548,98 @@ SUITE(Blob)
         CHECK_THROW(m_blob.download_to_file(file2.path(), azure::storage::access_condition(), options, m_context), azure::storage::storage_exception);
     }
 
+    TEST_FIXTURE(block_blob_test_base, block_blob_file_upload_parallel)
+    {
+        azure::storage::blob_request_options options;
+        options.set_store_blob_content_md5(true);
+        options.set_use_transactional_md5(true);
+        options.set_stream_write_size_in_bytes(1 * 1024 * 1024);
+        options.set_parallelism_factor(4);
+
+        temp_file file(10 * 1024 * 1024 + 123);
+        m_blob.upload_from_file(file.path(), azure::storage::access_condition(), options, m_context);
+
+        auto blocks = m_blob.download_block_list(azure::storage::block_listing_filter::committed, azure::storage::access_condition(), options, m_context);
+        CHECK_EQUAL(11U, blocks.size());
+
+        m_blob.download_attributes(azure::storage::access_condition(), options, m_context);
+        CHECK_UTF8_EQUAL(file.content_md5(), m_blob.properties().content_md5());
+
+        temp_file file2(0);
+        m_blob.download_to_file(file2.path(), azure::storage::access_condition(), options, m_context);
+
+        concurrency::streams::container_buffer<std::vector<uint8_t>> original_file_buffer;
+        auto original_file = concurrency::streams::file_stream<uint8_t>::open_istream(file.path()).get();
+        original_file.read_to_end(original_file_buffer).wait();
+        original_file.close().wait();
+
+        concurrency::streams::container_buffer<std::vector<uint8_t>> downloaded_file_buffer;
+        auto downloaded_file = concurrency::streams::file_stream<uint8_t>::open_istream(file2.path()).get();
+        downloaded_file.read_to_end(downloaded_file_buffer).wait();
+        downloaded_file.close().wait();
+
+        CHECK_EQUAL(original_file_buffer.collection().size(), downloaded_file_buffer.collection().size());
+        CHECK_ARRAY_EQUAL(original_file_buffer.collection(), downloaded_file_buffer.collection(), (int) downloaded_file_buffer.collection().size());
+    }
+
+    TEST_FIXTURE(block_blob_test_base, block_blob_crc64)
+    {
+        const char* check_data = "123456789";
+        CHECK_EQUAL(0xAE8B14860A799888ULL, azure::storage::core::update_crc64(reinterpret_cast<const uint8_t*>(check_data), 9, 0));
+
+        // The accelerated path must agree with the table-driven one for any length and alignment.
+        std::vector<uint8_t> data(70000);
+        for (size_t i = 0; i < data.size(); ++i)
+        {
+            data[i] = static_cast<uint8_t>(get_random_int32());
+        }
+
+        for (size_t offset = 0; offset < 16; ++offset)
+        {
+            size_t count = data.size() - offset * 8;
+            CHECK_EQUAL(azure::storage::core::update_crc64_portable(data.data() + offset, count, 0), azure::storage::core::update_crc64(data.data() + offset, count, 0));
+        }
+
+        // Feeding the data in pieces must give the same checksum as a single update.
+        uint64_t crc = azure::storage::core::update_crc64(data.data(), 1000, 0);
+        crc = azure::storage::core::update_crc64(data.data() + 1000, data.size() - 1000, crc);
+        CHECK_EQUAL(azure::storage::core::update_crc64(data.data(), data.size(), 0), crc);
+    }
+
+    TEST_FIXTURE(block_blob_test_base, block_blob_upload_transactional_crc64)
+    {
+        azure::storage::blob_request_options options;
+        options.set_use_transactional_crc64(true);
+        options.set_stream_write_size_in_bytes(1 * 1024 * 1024);
+        options.set_parallelism_factor(4);
+
+        std::vector<uint8_t> buffer;
+        buffer.resize(3 * 1024 * 1024 + 321);
+        fill_buffer(buffer);
+
+        size_t crc64_requests = 0;
+        m_context.set_sending_request([&crc64_requests](web::http::http_request& request, azure::storage::operation_context)
+        {
+            if (request.headers().has(azure::storage::protocol::ms_header_content_crc64))
+            {
+                ++crc64_requests;
+            }
+        });
+
+        m_blob.upload_from_stream(concurrency::streams::bytestream::open_istream(buffer), azure::storage::access_condition(), options, m_context);
+        CHECK_EQUAL(4U, crc64_requests);
+        m_context.set_sending_request(std::function<void(web::http::http_request &, azure::storage::operation_context)>());
+
+        auto blocks = m_blob.download_block_list(azure::storage::block_listing_filter::committed, azure::storage::access_condition(), options, m_context);
+        CHECK_EQUAL(4U, blocks.size());
+
+        concurrency::streams::container_buffer<std::vector<uint8_t>> target;
+        m_blob.download_range_to_stream(target.create_ostream(), 0, 4 * 1024 * 1024, azure::storage::access_condition(), options, m_context);
+
+        CHECK_EQUAL(buffer.size(), target.collection().size());
+        CHECK_ARRAY_EQUAL(buffer, target.collection(), (int)buffer.size());
+    }
+
     TEST_FIXTURE(block_blob_test_base, block_blob_constructor)
     {
         m_blob.upload_block_list(std::vector<azure::storage::block_list_item>(), azure::storage::access_condition(), azure::storage::blob_request_options(), m_context);
@@ -497,4 +497,42 @@ SUITE(File)
 
         check_equal(root_direcotry, parent_directory);
     }
+
+    TEST_FIXTURE(file_directory_test_base, directory_list_files_and_directories_parallel)
+    {
+        m_directory.create_if_not_exists(azure::storage::file_access_condition(), azure::storage::file_request_options(), m_context);
+
+        std::set<utility::string_t> expected;
+        std::vector<azure::storage::cloud_file_directory> directories(1, m_directory);
+        for (size_t level = 0; level < 3; ++level)
+        {
+            auto parent = directories.back();
+            for (size_t i = 0; i < 2; ++i)
+            {
+                auto file = parent.get_file_reference(_XPLATSTR("file") + get_random_string(10));
+                file.create_if_not_exists(512U, azure::storage::file_access_condition(), azure::storage::file_request_options(), m_context);
+                expected.insert(file.uri().primary_uri().to_string());
+            }
+
+            auto directory = parent.get_subdirectory_reference(_XPLATSTR("directory") + get_random_string(10));
+            directory.create_if_not_exists(azure::storage::file_access_condition(), azure::storage::file_request_options(), m_context);
+            expected.insert(directory.uri().primary_uri().to_string());
+            directories.push_back(directory);
+        }
+
+        std::set<utility::string_t> listed;
+        m_directory.list_files_and_directories_parallel(2, [&listed](const azure::storage::list_file_and_directory_item& item)
+        {
+            auto uri = item.is_directory() ? item.as_directory().uri() : item.as_file().uri();
+            CHECK(listed.insert(uri.primary_uri().to_string()).second);
+        }, azure::storage::file_request_options(), m_context);
+
+        CHECK(expected == listed);
+
+        auto task = m_directory.list_files_and_directories_parallel_async([](const azure::storage::list_file_and_directory_item&)
+        {
+            throw std::runtime_error("consumer failed");
+        });
+        CHECK_THROW(task.get(), std::runtime_error);
+    }
 }
\ No newline at end of file
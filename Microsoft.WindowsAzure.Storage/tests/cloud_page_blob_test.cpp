@@ -381,6 +381,7 @@ SUITE(Blob)
 
         temp_file invalid_file(1000);
         CHECK_THROW(m_blob.upload_from_file(invalid_file.path(), 0, azure::storage::access_condition(), options, m_context), azure::storage::storage_exception);
+        CHECK(!m_blob.exists(azure::storage::blob_request_options(), m_context));
 
         temp_file file(1024);
         m_blob.upload_from_file(file.path(), 0, azure::storage::access_condition(), options, m_context);
@@ -18,6 +18,10 @@
 #include "stdafx.h"
 #include "queue_test_base.h"
 #include "was/queue.h"
+#include "wascore/base64.h"
+
+#include <mutex>
+#include <set>
 
 SUITE(Queue)
 {
@@ -170,6 +174,54 @@ SUITE(Queue)
         CHECK_EQUAL(0, message.dequeue_count());
     }
 
+    TEST_FIXTURE(queue_service_test_base, Message_Base64)
+    {
+        std::string encoded;
+        azure::storage::core::append_base64(reinterpret_cast<const uint8_t*>("fooba"), 5, encoded);
+        CHECK_EQUAL("Zm9vYmE=", encoded);
+
+        // The accelerated codec must agree with the table-driven one for any length and alignment.
+        std::vector<uint8_t> data(1000);
+        for (size_t i = 0; i < data.size(); ++i)
+        {
+            data[i] = static_cast<uint8_t>(get_random_int32());
+        }
+
+        for (size_t count = 0; count < 200; ++count)
+        {
+            for (size_t offset = 0; offset < 3; ++offset)
+            {
+                std::string accelerated;
+                std::string portable;
+                azure::storage::core::append_base64(data.data() + offset, count, accelerated);
+                azure::storage::core::append_base64_portable(data.data() + offset, count, portable);
+                CHECK_EQUAL(portable, accelerated);
+
+                std::vector<uint8_t> decoded;
+                CHECK(azure::storage::core::append_from_base64(accelerated.data(), accelerated.size(), decoded));
+                CHECK_EQUAL(count, decoded.size());
+                CHECK(std::equal(decoded.begin(), decoded.end(), data.begin() + offset));
+            }
+        }
+
+        // A character outside the alphabet is rejected wherever it appears.
+        std::string text;
+        azure::storage::core::append_base64(data.data(), 48, text);
+        for (size_t i = 0; i < text.size(); ++i)
+        {
+            std::string invalid = text;
+            invalid[i] = '-';
+            std::vector<uint8_t> decoded;
+            CHECK(!azure::storage::core::append_from_base64(invalid.data(), invalid.size(), decoded));
+            CHECK(!azure::storage::core::append_from_base64_portable(invalid.data(), invalid.size(), decoded));
+        }
+
+        std::vector<uint8_t> decoded;
+        CHECK(!azure::storage::core::append_from_base64("Zm9", 3, decoded));
+        CHECK(!azure::storage::core::append_from_base64("Zm=v", 4, decoded));
+        CHECK_THROW(azure::storage::core::from_base64(_XPLATSTR("Zm 9v")), std::runtime_error);
+    }
+
     TEST_FIXTURE(queue_service_test_base, Message_IdAndPopReceipt)
     {
         utility::string_t id = get_random_string();
@@ -1906,4 +1958,131 @@ SUITE(Queue)
             CHECK(context.request_results()[0].extended_error().details().empty());
         }
     }
+
+    TEST_FIXTURE(queue_service_test_base, Queue_AddMessages)
+    {
+        azure::storage::cloud_queue queue = get_queue();
+
+        std::vector<azure::storage::cloud_queue_message> messages;
+        std::vector<utility::string_t> contents;
+        for (int i = 0; i < 100; ++i)
+        {
+            contents.push_back(get_random_string());
+            messages.push_back(azure::storage::cloud_queue_message(contents.back()));
+        }
+
+        // A message over 64KB is rejected by the service, which must not affect the other messages.
+        const size_t too_large_index = 37;
+        messages[too_large_index] = azure::storage::cloud_queue_message(utility::string_t(65 * 1024, _XPLATSTR('a')));
+
+        azure::storage::queue_request_options options;
+        std::vector<azure::storage::add_message_result> results = queue.add_messages(messages, std::chrono::seconds(3600), std::chrono::seconds(0), 8, options, m_context);
+        CHECK_EQUAL(messages.size(), results.size());
+
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            if (i == too_large_index)
+            {
+                CHECK(!results[i].succeeded());
+                CHECK_THROW(std::rethrow_exception(results[i].exception()), azure::storage::storage_exception);
+            }
+            else
+            {
+                CHECK(results[i].succeeded());
+                CHECK(results[i].exception() == nullptr);
+                CHECK(!results[i].message().id().empty());
+                CHECK(!results[i].message().pop_receipt().empty());
+                CHECK(results[i].message().content_as_string() == contents[i]);
+            }
+        }
+
+        queue.download_attributes();
+        CHECK_EQUAL(99, queue.approximate_message_count());
+
+        CHECK_THROW(queue.add_messages(messages, std::chrono::seconds(3600), std::chrono::seconds(0), 0, options, m_context), std::invalid_argument);
+        CHECK(queue.add_messages(std::vector<azure::storage::cloud_queue_message>()).empty());
+    }
+
+    TEST_FIXTURE(queue_service_test_base, Queue_Processor)
+    {
+        azure::storage::cloud_queue queue = get_queue();
+
+        const size_t message_count = 50;
+        std::set<utility::string_t> contents;
+        for (size_t i = 0; i < message_count; ++i)
+        {
+            utility::string_t content = get_random_string();
+            contents.insert(content);
+            queue.add_message(azure::storage::cloud_queue_message(content));
+        }
+
+        utility::string_t slow_content = *contents.begin();
+        utility::string_t failing_content = *contents.rbegin();
+
+        std::mutex mutex;
+        std::set<utility::string_t> handled;
+        auto handler = [&](const azure::storage::cloud_queue_message& message)
+        {
+            utility::string_t content = message.content_as_string();
+            if (content == failing_content)
+            {
+                throw std::runtime_error("handler failed");
+            }
+
+            if (content == slow_content)
+            {
+                // Longer than the visibility timeout, so the message is only kept hidden by renewing it.
+                std::this_thread::sleep_for(std::chrono::seconds(5));
+            }
+
+            std::lock_guard<std::mutex> guard(mutex);
+            handled.insert(content);
+        };
+
+        azure::storage::queue_processor_options processor_options;
+        processor_options.set_receive_loops(2);
+        processor_options.set_messages_per_receive(16);
+        processor_options.set_visibility_timeout(std::chrono::seconds(2));
+        processor_options.set_max_backoff(std::chrono::milliseconds(500));
+
+        {
+            azure::storage::queue_processor_options invalid_options(processor_options);
+            invalid_options.set_messages_per_receive(33);
+            CHECK_THROW(azure::storage::cloud_queue_processor(queue, handler, invalid_options, azure::storage::queue_request_options(), m_context), std::invalid_argument);
+
+            invalid_options = processor_options;
+            invalid_options.set_max_backoff(std::chrono::milliseconds(50));
+            CHECK_THROW(azure::storage::cloud_queue_processor(queue, handler, invalid_options, azure::storage::queue_request_options(), m_context), std::invalid_argument);
+        }
+
+        azure::storage::cloud_queue_processor processor(queue, handler, processor_options, azure::storage::queue_request_options(), m_context);
+        processor.start();
+        CHECK_THROW(processor.start(), std::runtime_error);
+
+        for (int i = 0; i < 300 && processor.statistics().processed_count() < message_count - 1; ++i)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+
+        processor.stop();
+
+        azure::storage::queue_processor_statistics statistics = processor.statistics();
+        CHECK_EQUAL(message_count - 1, statistics.processed_count());
+        CHECK_EQUAL(statistics.processed_count(), statistics.deleted_count());
+        CHECK_EQUAL(0U, statistics.failed_delete_count());
+        CHECK(statistics.failed_count() >= 1U);
+        CHECK(statistics.visibility_update_count() >= 1U);
+        CHECK(statistics.received_count() >= message_count);
+        CHECK(statistics.max_handler_latency() >= std::chrono::seconds(5));
+        CHECK(statistics.messages_per_second() > 0.0);
+
+        contents.erase(failing_content);
+        CHECK(contents == handled);
+
+        // Only the message whose handler failed is left, and it becomes visible again once its visibility timeout expires.
+        std::this_thread::sleep_for(std::chrono::seconds(3));
+        queue.download_attributes();
+        CHECK_EQUAL(1, queue.approximate_message_count());
+        CHECK(queue.get_message().content_as_string() == failing_content);
+    }
 }
@@ -24,6 +24,7 @@
 #include "was/queue.h"
 #include "was/table.h"
 #include "was/file.h"
+#include "was/auth.h"
 #include "wascore/constants.h"
 
 const utility::string_t test_uri(_XPLATSTR("http://test/abc"));
@@ -539,6 +540,50 @@ SUITE(Core)
         CHECK_EQUAL(true, creds2.is_shared_key());
     }
 
+    TEST_FIXTURE(test_base, storage_credentials_hmac_sha256_hash)
+    {
+        azure::storage::storage_credentials creds(test_account_name, test_account_key);
+        CHECK_UTF8_EQUAL(_XPLATSTR("RX1KS6rcujBt38JefxKNs/g8TNUvZQ0g2VBJlD0k+xk="), azure::storage::protocol::calculate_hmac_sha256_hash(_XPLATSTR("GET\n/test/container"), creds));
+
+        // Keys longer than the hash block are hashed first
+        azure::storage::storage_credentials long_key_creds(test_account_name, std::vector<uint8_t>(100, 'k'));
+        CHECK_UTF8_EQUAL(_XPLATSTR("sdssbbjDO63OS9G4VJwi+xf+/53/SDCrVfkM2Rn9awE="), azure::storage::protocol::calculate_hmac_sha256_hash(_XPLATSTR("GET\n/test/container"), long_key_creds));
+    }
+
+    TEST_FIXTURE(test_base, shared_key_canonicalize_and_sign)
+    {
+        web::http::http_request request(web::http::methods::PUT);
+        request.set_request_uri(web::http::uri(_XPLATSTR("https://test.blob.core.windows.net/container/blob?restype=x&comp=list&Prefix=a%2Fb&comp=block&b=1")));
+        request.headers().add(web::http::header_names::content_length, 0);
+        request.headers().add(web::http::header_names::content_type, _XPLATSTR("text/plain"));
+        request.headers().add(_XPLATSTR("x-ms-version"), _XPLATSTR("2018-03-28"));
+        request.headers().add(_XPLATSTR("x-ms-meta-Name"), _XPLATSTR("Value"));
+
+        azure::storage::operation_context context;
+        auto canonicalizer = std::make_shared<azure::storage::protocol::shared_key_blob_queue_canonicalizer>(test_account_name);
+        azure::storage::protocol::shared_key_lite_blob_queue_canonicalizer lite_canonicalizer(test_account_name);
+        azure::storage::storage_credentials creds(test_account_name, test_account_key);
+        azure::storage::protocol::shared_key_authentication_handler handler(canonicalizer, creds);
+        handler.sign_request(request, context);
+
+        utility::string_t date;
+        CHECK(request.headers().match(_XPLATSTR("x-ms-date"), date));
+        CHECK(!date.empty());
+
+        // Parameters are sorted by their names as given and the last value of a repeated name wins
+        utility::string_t expected = _XPLATSTR("PUT\n\n\n\n\ntext/plain\n\n\n\n\n\n\nx-ms-date:") + date + _XPLATSTR("\nx-ms-meta-name:Value\nx-ms-version:2018-03-28\n/test/container/blob\nprefix:a/b\nb:1\ncomp:block\nrestype:x");
+        CHECK_UTF8_EQUAL(expected, canonicalizer->canonicalize(request, context));
+        CHECK_UTF8_EQUAL(_XPLATSTR("PUT\n\ntext/plain\n\nx-ms-date:") + date + _XPLATSTR("\nx-ms-meta-name:Value\nx-ms-version:2018-03-28\n/test/container/blob?comp=block"), lite_canonicalizer.canonicalize(request, context));
+
+        utility::string_t appended(_XPLATSTR("prefix"));
+        canonicalizer->append_canonicalized(request, appended, context);
+        CHECK_UTF8_EQUAL(_XPLATSTR("prefix") + expected, appended);
+
+        utility::string_t authorization;
+        CHECK(request.headers().match(web::http::header_names::authorization, authorization));
+        CHECK_UTF8_EQUAL(_XPLATSTR("SharedKey test:") + azure::storage::protocol::calculate_hmac_sha256_hash(expected, creds), authorization);
+    }
+
     TEST_FIXTURE(test_base, cloud_storage_account_devstore)
     {
         auto account = azure::storage::cloud_storage_account::development_storage_account();
@@ -19,6 +19,9 @@
 #include "table_test_base.h"
 #include "was/table.h"
 #include "was/storage_account.h"
+#include "wascore/protocol.h"
+#include "wascore/protocol_json.h"
+#include "wascore/util.h"
 
 // TODO: Consider making storage_account.h automatically included from blob.h/table.h/queue.h
 
@@ -753,6 +756,309 @@ SUITE(Table)
         CHECK(entity.properties().size() == 5U);
     }
 
+    TEST_FIXTURE(table_service_test_base, Entity_QueryReader)
+    {
+        // The streaming reader has to produce the same entities as the parser of the JSON document.
+        utility::string_t body = _XPLATSTR("{\"odata.metadata\":\"https://account.table.core.windows.net/$metadata#table\",\"value\":[")
+            _XPLATSTR("{\"odata.etag\":\"W/\\\"datetime'2018-01-01T00%3A00%3A00.1234567Z'\\\"\",\"PartitionKey\":\"pk\",\"RowKey\":\"rk1\",\"Timestamp\":\"2018-01-01T00:00:00.1234567Z\",")
+            _XPLATSTR("\"Int32\":42,\"Negative\":-7,\"Int64@odata.type\":\"Edm.Int64\",\"Int64\":\"9223372036854775807\",\"Double\":1.5e3,\"Boolean\":true,")
+            _XPLATSTR("\"Guid@odata.type\":\"Edm.Guid\",\"Guid\":\"7d1b6a3c-95a2-4ad6-9b3e-3f2d7b1e0c4a\",\"Escaped\":\"a\\\"b\\\\c\\/d\\n\\u00e9\\ud83d\\ude00\",\"Null\":null},")
+            _XPLATSTR("{\"PartitionKey\":\"pk\",\"RowKey\":\"rk2\",\"Timestamp\":\"2018-01-01T00:00:01Z\",\"Int32\":1,\"Binary\":\"AQID\",\"Binary@odata.type\":\"Edm.Binary\",")
+            _XPLATSTR("\"Ignored@odata.type\":\"Edm.Int64\",\"Ignored\":5,\"Nested\":{\"a\":[1,2,{\"b\":\"}\"}]},\"Ne\\u0077\":\"escaped name\"},")
+            _XPLATSTR("{},")
+            _XPLATSTR("{\"PartitionKey\":\"pk\",\"RowKey\":\"rk3\",\"Int32\":3}")
+            _XPLATSTR("],\"odata.nextLink\":null}");
+
+        auto expected = azure::storage::protocol::table_response_parsers::parse_query_results(web::json::value::parse(body));
+        std::string utf8_body = utility::conversions::to_utf8string(body);
+        azure::storage::protocol::table_query_reader reader(utf8_body.data(), utf8_body.size());
+        auto actual = reader.move_entities();
+
+        CHECK_EQUAL(3U, expected.size());
+        CHECK_EQUAL(expected.size(), actual.size());
+        for (size_t i = 0; i < expected.size() && i < actual.size(); ++i)
+        {
+            CHECK(expected[i].partition_key() == actual[i].partition_key());
+            CHECK(expected[i].row_key() == actual[i].row_key());
+            CHECK(expected[i].etag() == actual[i].etag());
+            CHECK(expected[i].timestamp() == actual[i].timestamp());
+            CHECK_EQUAL(expected[i].properties().size(), actual[i].properties().size());
+            for (const auto& property : expected[i].properties())
+            {
+                auto it = actual[i].properties().find(property.first);
+                CHECK(it != actual[i].properties().end());
+                if (it != actual[i].properties().end())
+                {
+                    CHECK(property.second.property_type() == it->second.property_type());
+                    CHECK_EQUAL(property.second.is_null(), it->second.is_null());
+                    CHECK(property.second.str() == it->second.str());
+                }
+            }
+        }
+
+        std::string truncated = utf8_body.substr(0, utf8_body.size() / 2);
+        azure::storage::protocol::table_query_reader truncated_reader(truncated.data(), truncated.size());
+        CHECK_THROW(truncated_reader.move_entities(), azure::storage::storage_exception);
+    }
+
+    TEST_FIXTURE(table_service_test_base, Entity_CompactQueryReader)
+    {
+        std::string body =
+            "{\"odata.metadata\":\"https://account.table.core.windows.net/$metadata#table\",\"value\":["
+            "{\"odata.etag\":\"W/\\\"1\\\"\",\"PartitionKey\":\"pk\",\"RowKey\":\"rk1\",\"Timestamp\":\"2018-01-01T00:00:00.1Z\",\"Int32\":5,\"Int64@odata.type\":\"Edm.Int64\",\"Int64\":\"12345678901\",\"String\":\"s\",\"Double\":1.5,\"Boolean\":true},"
+            "{\"odata.etag\":\"W/\\\"2\\\"\",\"PartitionKey\":\"pk\",\"RowKey\":\"rk2\",\"Int32\":6,\"Int64\":\"-7\",\"Int64@odata.type\":\"Edm.Int64\",\"String\":\"t\",\"Double\":2.5,\"Boolean\":false,\"Nan@odata.type\":\"Edm.Double\",\"Nan\":\"NaN\"}]}";
+
+        std::shared_ptr<const azure::storage::table_entity_schema> schema;
+        azure::storage::protocol::table_query_reader reader(body.data(), body.size());
+        std::vector<azure::storage::compact_table_entity> entities = reader.move_compact_entities(schema);
+
+        CHECK_EQUAL(2U, entities.size());
+        CHECK_EQUAL(6U, schema->size());
+        CHECK(entities[1].schema() == schema);
+        CHECK(entities[0].etag() == _XPLATSTR("W/\"1\""));
+        CHECK(entities[0].row_key() == _XPLATSTR("rk1"));
+        CHECK(entities[0].timestamp().is_initialized());
+        CHECK_EQUAL(5, entities[0].value(_XPLATSTR("Int32")).int32_value());
+        CHECK_EQUAL(12345678901LL, entities[0].value(_XPLATSTR("Int64")).int64_value());
+        CHECK_EQUAL(-7LL, entities[1].value(_XPLATSTR("Int64")).int64_value());
+        CHECK(entities[1].value(_XPLATSTR("String")).string_value() == _XPLATSTR("t"));
+        CHECK_EQUAL(2.5, entities[1].value(_XPLATSTR("Double")).double_value());
+        CHECK(!entities[1].value(_XPLATSTR("Boolean")).boolean_value());
+        CHECK(azure::storage::core::is_nan(entities[1].value(_XPLATSTR("Nan")).double_value()));
+        CHECK(entities[0].value(_XPLATSTR("Nan")).is_null());
+        CHECK_THROW(entities[0].value(_XPLATSTR("Int32")).string_value(), std::runtime_error);
+
+        // A segment without new properties keeps the schema
+        std::string next_body = "{\"value\":[{\"PartitionKey\":\"pk\",\"RowKey\":\"rk3\",\"Int32\":7}]}";
+        std::shared_ptr<const azure::storage::table_entity_schema> previous_schema = schema;
+        azure::storage::protocol::table_query_reader next_reader(next_body.data(), next_body.size());
+        std::vector<azure::storage::compact_table_entity> next_entities = next_reader.move_compact_entities(schema);
+        CHECK_EQUAL(1U, next_entities.size());
+        CHECK(schema == previous_schema);
+        CHECK_EQUAL(7, next_entities[0].value(_XPLATSTR("Int32")).int32_value());
+
+        // The request body is written from the typed values and reads back to the same values
+        std::vector<utility::string_t> property_names;
+        property_names.push_back(_XPLATSTR("Whole"));
+        property_names.push_back(_XPLATSTR("Int64"));
+        property_names.push_back(_XPLATSTR("Missing"));
+        property_names.push_back(_XPLATSTR("Text"));
+        azure::storage::compact_table_entity entity(std::make_shared<azure::storage::table_entity_schema>(property_names), _XPLATSTR("pk"), _XPLATSTR("rk"));
+        entity.set_value(0, azure::storage::compact_entity_value(3.0));
+        entity.set_value(1, azure::storage::compact_entity_value((int64_t)-5));
+        entity.set_value(3, azure::storage::compact_entity_value(_XPLATSTR("a\"b\n")));
+        CHECK_THROW(entity.set_value(4, azure::storage::compact_entity_value(true)), std::out_of_range);
+
+        std::string request_body = "{\"value\":[" + azure::storage::protocol::generate_compact_json_body(entity) + "]}";
+        std::shared_ptr<const azure::storage::table_entity_schema> request_schema;
+        azure::storage::protocol::table_query_reader request_reader(request_body.data(), request_body.size());
+        std::vector<azure::storage::compact_table_entity> written = request_reader.move_compact_entities(request_schema);
+        CHECK_EQUAL(1U, written.size());
+        CHECK(written[0].partition_key() == _XPLATSTR("pk"));
+        CHECK(written[0].value(_XPLATSTR("Whole")).property_type() == azure::storage::edm_type::double_floating_point);
+        CHECK_EQUAL(3.0, written[0].value(_XPLATSTR("Whole")).double_value());
+        CHECK_EQUAL(-5LL, written[0].value(_XPLATSTR("Int64")).int64_value());
+        CHECK(written[0].value(_XPLATSTR("Text")).string_value() == _XPLATSTR("a\"b\n"));
+        CHECK_EQUAL(3U, request_schema->size());
+
+        azure::storage::table_entity converted = entity.to_table_entity();
+        CHECK_EQUAL(3U, converted.properties().size());
+        CHECK_EQUAL(-5LL, converted.properties()[_XPLATSTR("Int64")].int64_value());
+
+        // Null values read from the body are kept as null properties, while properties of the shared schema that the entity does not have are left out
+        std::string null_body = "{\"value\":[{\"PartitionKey\":\"pk\",\"RowKey\":\"rk1\",\"Int32\":1,\"Empty\":null},{\"PartitionKey\":\"pk\",\"RowKey\":\"rk2\",\"Empty\":null}]}";
+        std::shared_ptr<const azure::storage::table_entity_schema> null_schema;
+        azure::storage::protocol::table_query_reader null_reader(null_body.data(), null_body.size());
+        std::vector<azure::storage::compact_table_entity> null_entities = null_reader.move_compact_entities(null_schema);
+        CHECK_EQUAL(2U, null_entities.size());
+        CHECK(null_entities[1].value(_XPLATSTR("Empty")).is_set());
+        CHECK(!null_entities[1].value(_XPLATSTR("Int32")).is_set());
+
+        azure::storage::protocol::table_query_reader null_entity_reader(null_body.data(), null_body.size());
+        std::vector<azure::storage::table_entity> null_table_entities = null_entity_reader.move_entities();
+        azure::storage::table_entity converted_null = null_entities[1].to_table_entity();
+        CHECK_EQUAL(null_table_entities[1].properties().size(), converted_null.properties().size());
+        CHECK_EQUAL(1U, converted_null.properties().size());
+        CHECK(converted_null.properties()[_XPLATSTR("Empty")].is_null());
+        CHECK_EQUAL(2U, null_entities[0].to_table_entity().properties().size());
+    }
+
+    struct mapped_test_entity
+    {
+        mapped_test_entity()
+            : m_int32(-1), m_int64(0), m_double(0.0)
+        {
+        }
+
+        utility::string_t m_partition_key;
+        utility::string_t m_row_key;
+        utility::string_t m_etag;
+        int32_t m_int32;
+        int64_t m_int64;
+        double m_double;
+        utility::string_t m_string;
+    };
+
+    TEST_FIXTURE(table_service_test_base, Entity_MappedQueryReader)
+    {
+        azure::storage::table_entity_mapping<mapped_test_entity> mapping;
+        mapping.map_partition_key(&mapped_test_entity::m_partition_key)
+            .map_row_key(&mapped_test_entity::m_row_key)
+            .map_etag(&mapped_test_entity::m_etag)
+            .map(_XPLATSTR("Int32"), &mapped_test_entity::m_int32)
+            .map(_XPLATSTR("Int64"), &mapped_test_entity::m_int64)
+            .map(_XPLATSTR("Double"), &mapped_test_entity::m_double)
+            .map(_XPLATSTR("String"), &mapped_test_entity::m_string);
+
+        CHECK_EQUAL(4U, mapping.select_columns().size());
+        CHECK_THROW(mapping.map(_XPLATSTR("Int32"), &mapped_test_entity::m_int32), std::invalid_argument);
+
+        // Values without type annotations, as with the no metadata format, are converted to the type of their column
+        std::string body =
+            "{\"value\":["
+            "{\"odata.etag\":\"W/\\\"1\\\"\",\"PartitionKey\":\"pk\",\"RowKey\":\"rk1\",\"Int32\":5,\"Int64@odata.type\":\"Edm.Int64\",\"Int64\":\"12345678901\",\"Double\":2,\"String\":\"s\",\"Other\":{\"a\":1}},"
+            "{\"PartitionKey\":\"pk\",\"RowKey\":\"rk2\",\"Timestamp\":\"2018-01-01T00:00:00.1Z\",\"Int64\":\"-7\",\"Double\":\"Infinity\"}]}";
+
+        std::vector<mapped_test_entity> entities;
+        azure::storage::protocol::table_query_reader reader(body.data(), body.size());
+        reader.move_mapped_entities(mapping, [&entities]() -> void*
+        {
+            entities.push_back(mapped_test_entity());
+            return &entities.back();
+        });
+
+        CHECK_EQUAL(2U, entities.size());
+        CHECK(entities[0].m_partition_key == _XPLATSTR("pk"));
+        CHECK(entities[0].m_row_key == _XPLATSTR("rk1"));
+        CHECK(entities[0].m_etag == _XPLATSTR("W/\"1\""));
+        CHECK_EQUAL(5, entities[0].m_int32);
+        CHECK_EQUAL(12345678901LL, entities[0].m_int64);
+        CHECK_EQUAL(2.0, entities[0].m_double);
+        CHECK(entities[0].m_string == _XPLATSTR("s"));
+        CHECK(entities[1].m_etag == azure::storage::protocol::get_etag_from_timestamp(_XPLATSTR("2018-01-01T00:00:00.1Z")));
+        CHECK_EQUAL(-1, entities[1].m_int32);
+        CHECK_EQUAL(-7LL, entities[1].m_int64);
+        CHECK_EQUAL(std::numeric_limits<double>::infinity(), entities[1].m_double);
+    }
+
+    TEST_FIXTURE(table_service_test_base, Entity_MappedQueryReader_WideNumbers)
+    {
+        azure::storage::table_entity_mapping<mapped_test_entity> mapping;
+        mapping.map(_XPLATSTR("Int32"), &mapped_test_entity::m_int32)
+            .map(_XPLATSTR("Int64"), &mapped_test_entity::m_int64)
+            .map(_XPLATSTR("Double"), &mapped_test_entity::m_double);
+
+        // Whole numbers above INT32_MAX keep their value in 64-bit integer and double columns
+        std::string body = "{\"value\":[{\"Int32\":7,\"Int64\":5000000000,\"Double\":5000000000},{\"Int64\":-5000000000,\"Double\":-9007199254740993}]}";
+
+        std::vector<mapped_test_entity> entities;
+        azure::storage::protocol::table_query_reader reader(body.data(), body.size());
+        reader.move_mapped_entities(mapping, [&entities]() -> void*
+        {
+            entities.push_back(mapped_test_entity());
+            return &entities.back();
+        });
+
+        CHECK_EQUAL(2U, entities.size());
+        CHECK_EQUAL(7, entities[0].m_int32);
+        CHECK_EQUAL(5000000000LL, entities[0].m_int64);
+        CHECK_EQUAL(5000000000.0, entities[0].m_double);
+        CHECK_EQUAL(-5000000000LL, entities[1].m_int64);
+        CHECK_EQUAL(-9007199254740992.0, entities[1].m_double);
+
+        // A 32-bit column cannot hold it
+        std::string overflow_body = "{\"value\":[{\"Int32\":5000000000}]}";
+        azure::storage::protocol::table_query_reader overflow_reader(overflow_body.data(), overflow_body.size());
+        CHECK_THROW(overflow_reader.move_mapped_entities(mapping, [&entities]() -> void*
+        {
+            entities.push_back(mapped_test_entity());
+            return &entities.back();
+        }), azure::storage::storage_exception);
+    }
+
+    TEST_FIXTURE(table_service_test_base, Entity_BatchResponseParser)
+    {
+        std::string changeset_response =
+            "--batchresponse_1\r\nContent-Type: multipart/mixed; boundary=changesetresponse_2\r\n\r\n"
+            "--changesetresponse_2\r\nContent-Type: application/http\r\nContent-Transfer-Encoding: binary\r\n\r\n"
+            "HTTP/1.1 204 No Content\r\nX-Content-Type-Options: nosniff\r\nETag: W/\"datetime'2018-01-01T00%3A00%3A00.1Z'\"\r\n\r\n\r\n"
+            "--changesetresponse_2\r\nContent-Type: application/http\r\nContent-Transfer-Encoding: binary\r\n\r\n"
+            "HTTP/1.1 201 Created\r\netag: W/\"2\"\r\n\r\n{\"PartitionKey\":\"--changesetresponse_2\"}\r\n"
+            "--changesetresponse_2\r\nContent-Type: application/http\r\nContent-Transfer-Encoding: binary\r\n\r\n"
+            "HTTP/1.1 204 No Content\r\n\r\n\r\n"
+            "--changesetresponse_2--\r\n--batchresponse_1--\r\n";
+
+        web::http::http_response response(web::http::status_codes::Accepted);
+        Concurrency::streams::stringstreambuf changeset_buffer(changeset_response);
+        auto results = azure::storage::protocol::table_response_parsers::parse_batch_results(response, changeset_buffer, false, 3);
+        CHECK_EQUAL(3U, results.size());
+        CHECK_EQUAL(204, results[0].http_status_code());
+        CHECK(results[0].etag() == _XPLATSTR("W/\"datetime'2018-01-01T00%3A00%3A00.1Z'\""));
+        CHECK_EQUAL(201, results[1].http_status_code());
+        CHECK(results[1].etag() == _XPLATSTR("W/\"2\""));
+        CHECK(results[2].etag().empty());
+
+        Concurrency::streams::stringstreambuf mismatch_buffer(changeset_response);
+        CHECK_THROW(azure::storage::protocol::table_response_parsers::parse_batch_results(response, mismatch_buffer, false, 2), azure::storage::storage_exception);
+
+        std::string query_response =
+            "--batchresponse_3\r\nContent-Type: application/http\r\nContent-Transfer-Encoding: binary\r\n\r\n"
+            "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nETag: W/\"3\"\r\n\r\n"
+            "{\"PartitionKey\":\"pk\",\"RowKey\":\"rk\",\"Int32\":5}\r\n--batchresponse_3--\r\n";
+
+        Concurrency::streams::stringstreambuf query_buffer(query_response);
+        results = azure::storage::protocol::table_response_parsers::parse_batch_results(response, query_buffer, true, 1);
+        CHECK_EQUAL(1U, results.size());
+        CHECK_EQUAL(200, results[0].http_status_code());
+        CHECK(results[0].entity().partition_key() == _XPLATSTR("pk"));
+        CHECK(results[0].entity().row_key() == _XPLATSTR("rk"));
+        CHECK(results[0].entity().etag() == _XPLATSTR("W/\"3\""));
+        CHECK_EQUAL(5, results[0].entity().properties().at(_XPLATSTR("Int32")).int32_value());
+
+        std::string error_response =
+            "--batchresponse_4\r\nContent-Type: multipart/mixed; boundary=changesetresponse_5\r\n\r\n"
+            "--changesetresponse_5\r\nContent-Type: application/http\r\nContent-Transfer-Encoding: binary\r\n\r\n"
+            "HTTP/1.1 409 Conflict\r\nContent-Type: application/json\r\n\r\n"
+            "{\"odata.error\":{\"code\":\"EntityAlreadyExists\",\"message\":{\"lang\":\"en-US\",\"value\":\"0:The specified entity already exists.\"}}}\r\n"
+            "--changesetresponse_5--\r\n--batchresponse_4--\r\n";
+
+        Concurrency::streams::stringstreambuf error_buffer(error_response);
+        try
+        {
+            azure::storage::protocol::table_response_parsers::parse_batch_results(response, error_buffer, false, 1);
+            CHECK(false);
+        }
+        catch (const azure::storage::storage_exception& e)
+        {
+            CHECK_EQUAL(409, e.result().http_status_code());
+            CHECK(e.result().extended_error().code() == _XPLATSTR("EntityAlreadyExists"));
+        }
+    }
+
+    TEST_FIXTURE(table_service_test_base, Entity_BatchRequestBody)
+    {
+        azure::storage::core::mime_multipart_body body;
+        size_t repeated = body.add_piece(_XPLATSTR("--boundary\r\n"));
+        body.append_piece(repeated);
+        body.append(_XPLATSTR("first"));
+        body.append(utility::string_t());
+        body.append_piece(repeated);
+        body.append(_XPLATSTR("second"));
+
+        std::string expected("--boundary\r\nfirst--boundary\r\nsecond");
+        CHECK_EQUAL(expected.size(), body.size());
+
+        concurrency::streams::istream stream = body.create_istream();
+        concurrency::streams::container_buffer<std::vector<uint8_t>> buffer;
+        stream.read_to_end(buffer).wait();
+        CHECK(std::string(buffer.collection().begin(), buffer.collection().end()) == expected);
+
+        stream.seek(14);
+        std::vector<uint8_t> tail(64);
+        size_t read = stream.streambuf().getn(tail.data(), tail.size()).get();
+        CHECK(std::string(tail.begin(), tail.begin() + read) == expected.substr(14));
+    }
+
     TEST_FIXTURE(table_service_test_base, Operation_Delete)
     {
         utility::string_t partition_key = get_random_string();
@@ -3511,6 +3817,97 @@ SUITE(Table)
         CHECK_THROW(table.execute_batch(operation, options, context), std::invalid_argument);
     }
 
+    TEST_FIXTURE(table_service_test_base, EntityBatch_Writer)
+    {
+        azure::storage::cloud_table table = get_table();
+
+        azure::storage::table_request_options options;
+        azure::storage::operation_context context;
+        print_client_request_id(context, _XPLATSTR(""));
+
+        azure::storage::table_batch_writer writer(table, 100, std::chrono::milliseconds(50), 4, options, context);
+
+        std::vector<utility::string_t> partition_keys;
+        for (int partition = 0; partition < 3; ++partition)
+        {
+            partition_keys.push_back(get_random_string());
+        }
+
+        std::vector<pplx::task<azure::storage::table_result>> results;
+        for (int row = 0; row < 250; ++row)
+        {
+            azure::storage::table_entity entity(partition_keys[row % 3], get_string((utility::char_t)('a' + row / 26), (utility::char_t)('a' + row % 26)));
+            entity.properties().insert(azure::storage::table_entity::property_type(_XPLATSTR("PropertyA"), azure::storage::entity_property(row)));
+            results.push_back(writer.execute_async(azure::storage::table_operation::insert_entity(entity)));
+        }
+
+        // the second operation on the same entity is sent after the batch that inserts it
+        azure::storage::table_entity merged(partition_keys[0], get_string('a', 'a'));
+        merged.properties().insert(azure::storage::table_entity::property_type(_XPLATSTR("PropertyB"), azure::storage::entity_property(1)));
+        results.push_back(writer.execute_async(azure::storage::table_operation::merge_entity(merged)));
+
+        writer.flush();
+
+        for (auto& result : results)
+        {
+            CHECK_EQUAL(204, result.get().http_status_code());
+        }
+
+        CHECK_EQUAL(200, writer.execute(azure::storage::table_operation::retrieve_entity(partition_keys[1], get_string('a', 'b'))).http_status_code());
+
+        azure::storage::table_result merged_result = table.execute(azure::storage::table_operation::retrieve_entity(partition_keys[0], get_string('a', 'a')), options, context);
+        CHECK_EQUAL(200, merged_result.http_status_code());
+        CHECK(merged_result.entity().properties().find(_XPLATSTR("PropertyA")) != merged_result.entity().properties().cend());
+        CHECK(merged_result.entity().properties().find(_XPLATSTR("PropertyB")) != merged_result.entity().properties().cend());
+
+        // inserting an entity that already exists fails the whole batch
+        auto duplicate = writer.execute_async(azure::storage::table_operation::insert_entity(azure::storage::table_entity(partition_keys[2], get_string('a', 'c'))));
+        auto fresh = writer.execute_async(azure::storage::table_operation::insert_entity(azure::storage::table_entity(partition_keys[2], get_random_string())));
+        writer.flush();
+
+        CHECK_THROW(duplicate.get(), azure::storage::storage_exception);
+        CHECK_THROW(fresh.get(), azure::storage::storage_exception);
+
+        CHECK_THROW(azure::storage::table_batch_writer(table, 101, std::chrono::milliseconds(50), 4, options, context), std::invalid_argument);
+        CHECK_THROW(azure::storage::table_batch_writer(table, 100, std::chrono::milliseconds(50), 0, options, context), std::invalid_argument);
+    }
+
+    TEST_FIXTURE(table_service_test_base, EntityBatch_Writer_PayloadLimit)
+    {
+        azure::storage::cloud_table table = get_table();
+
+        azure::storage::table_request_options options;
+        azure::storage::operation_context context;
+        print_client_request_id(context, _XPLATSTR(""));
+
+        // No latency, so only the payload limit splits the batch before the flush.
+        azure::storage::table_batch_writer writer(table, 100, std::chrono::milliseconds(0), 4, options, context);
+
+        // Twelve entities of about 360KB are more than the service accepts in one batch.
+        utility::string_t partition_key = get_random_string();
+        utility::string_t large_value(30 * 1024, _XPLATSTR('x'));
+        std::vector<pplx::task<azure::storage::table_result>> results;
+        for (int row = 0; row < 12; ++row)
+        {
+            azure::storage::table_entity entity(partition_key, get_string(_XPLATSTR('a'), (utility::char_t)(_XPLATSTR('a') + row)));
+            for (int property = 0; property < 12; ++property)
+            {
+                entity.properties().insert(azure::storage::table_entity::property_type(get_string(_XPLATSTR('p'), (utility::char_t)(_XPLATSTR('a') + property)), azure::storage::entity_property(large_value)));
+            }
+
+            results.push_back(writer.execute_async(azure::storage::table_operation::insert_entity(entity)));
+        }
+
+        // The batch that reached the limit has been sent already.
+        CHECK_EQUAL(204, results.front().get().http_status_code());
+
+        writer.flush();
+        for (auto& result : results)
+        {
+            CHECK_EQUAL(204, result.get().http_status_code());
+        }
+    }
+
     TEST_FIXTURE(table_service_test_base, EntityQuery_Normal)
     {
         azure::storage::cloud_table table = get_table();
@@ -4107,6 +4504,176 @@ SUITE(Table)
         table.delete_table();
     }
 
+    TEST_FIXTURE(table_service_test_base, EntityQuery_Parallel)
+    {
+        azure::storage::cloud_table table = get_table();
+
+        for (int partition = 0; partition < 8; ++partition)
+        {
+            utility::string_t partition_key = get_string((utility::char_t)('a' + partition * 3), (utility::char_t)('m'));
+
+            azure::storage::table_batch_operation operation;
+            for (int row = 0; row < 20; ++row)
+            {
+                azure::storage::table_entity entity(partition_key, get_string((utility::char_t)('a' + row), (utility::char_t)('a')));
+                entity.properties().insert(azure::storage::table_entity::property_type(_XPLATSTR("PropertyA"), azure::storage::entity_property(row)));
+                operation.insert_entity(entity);
+            }
+
+            table.execute_batch(operation);
+        }
+
+        azure::storage::table_request_options options;
+        azure::storage::operation_context context;
+        print_client_request_id(context, _XPLATSTR(""));
+
+        std::vector<utility::string_t> boundaries = table.sample_partition_key_boundaries(4, options, context);
+        CHECK(boundaries.size() <= 3);
+        CHECK(std::is_sorted(boundaries.cbegin(), boundaries.cend()));
+
+        azure::storage::table_query query;
+        query.set_take_count(7);
+        query.set_filter_string(azure::storage::table_query::generate_filter_condition(_XPLATSTR("PropertyA"), azure::storage::query_comparison_operator::less_than, 15));
+
+        std::vector<azure::storage::table_entity> results;
+        table.execute_query_parallel(query, boundaries, 3, [&results](const std::vector<azure::storage::table_entity>& segment)
+        {
+            CHECK(segment.size() <= 7);
+            results.insert(results.end(), segment.cbegin(), segment.cend());
+        }, options, context);
+
+        CHECK_EQUAL(8U * 15U, results.size());
+
+        std::vector<utility::string_t> keys;
+        for (std::vector<azure::storage::table_entity>::const_iterator itr = results.cbegin(); itr != results.cend(); ++itr)
+        {
+            keys.push_back(itr->partition_key() + _XPLATSTR("/") + itr->row_key());
+        }
+
+        std::sort(keys.begin(), keys.end());
+        CHECK(std::unique(keys.begin(), keys.end()) == keys.end());
+
+        CHECK_THROW(table.execute_query_parallel(query, boundaries, 2, [](const std::vector<azure::storage::table_entity>&)
+        {
+            throw std::runtime_error("handler failed");
+        }, options, context), std::runtime_error);
+
+        CHECK_THROW(table.execute_query_parallel(query, boundaries, 0, [](const std::vector<azure::storage::table_entity>&) {}, options, context), std::invalid_argument);
+    }
+
+    TEST_FIXTURE(table_service_test_base, EntityQuery_Compact)
+    {
+        azure::storage::cloud_table table = get_table();
+        utility::string_t partition_key = get_random_string();
+
+        std::vector<utility::string_t> property_names;
+        property_names.push_back(_XPLATSTR("PropertyA"));
+        property_names.push_back(_XPLATSTR("PropertyB"));
+        property_names.push_back(_XPLATSTR("PropertyC"));
+        std::shared_ptr<const azure::storage::table_entity_schema> schema = std::make_shared<azure::storage::table_entity_schema>(property_names);
+
+        azure::storage::table_request_options options;
+        azure::storage::operation_context context;
+        print_client_request_id(context, _XPLATSTR(""));
+
+        utility::datetime now = utility::datetime::utc_now();
+        for (int row = 0; row < 5; ++row)
+        {
+            azure::storage::compact_table_entity entity(schema, partition_key, get_string((utility::char_t)('a' + row), (utility::char_t)('a')));
+            entity.set_value(0, azure::storage::compact_entity_value(row));
+            entity.set_value(1, azure::storage::compact_entity_value((int64_t)row << 40));
+            entity.set_value(2, azure::storage::compact_entity_value(now));
+
+            azure::storage::table_result result = table.execute(azure::storage::table_operation_type::insert_operation, entity, options, context);
+            CHECK(!result.etag().empty());
+        }
+
+        azure::storage::table_query query;
+        query.set_filter_string(azure::storage::table_query::generate_filter_condition(_XPLATSTR("PartitionKey"), azure::storage::query_comparison_operator::equal, partition_key));
+        query.set_take_count(2);
+
+        int count = 0;
+        std::shared_ptr<const azure::storage::table_entity_schema> result_schema;
+        for (azure::storage::compact_table_query_iterator itr = table.execute_compact_query(query, options, context); itr != azure::storage::compact_table_query_iterator(); ++itr)
+        {
+            CHECK_EQUAL(count, itr->value(_XPLATSTR("PropertyA")).int32_value());
+            CHECK_EQUAL((int64_t)count << 40, itr->value(_XPLATSTR("PropertyB")).int64_value());
+            CHECK(itr->value(_XPLATSTR("PropertyC")).datetime_value().to_interval() / 10000000 == now.to_interval() / 10000000);
+
+            // Every segment starts from the schema of the previous one
+            if (result_schema == nullptr)
+            {
+                result_schema = itr->schema();
+            }
+
+            CHECK(itr->schema() == result_schema);
+            ++count;
+        }
+
+        CHECK_EQUAL(5, count);
+
+        azure::storage::compact_table_entity entity(schema, partition_key, get_string('a', 'a'));
+        table.execute(azure::storage::table_operation_type::delete_operation, entity, options, context);
+        CHECK_THROW(table.execute(azure::storage::table_operation_type::retrieve_operation, entity, options, context), std::invalid_argument);
+    }
+
+    TEST_FIXTURE(table_service_test_base, EntityQuery_Mapped)
+    {
+        azure::storage::cloud_table table = get_table();
+        utility::string_t partition_key = get_random_string();
+
+        azure::storage::table_batch_operation operation;
+        for (int row = 0; row < 5; ++row)
+        {
+            azure::storage::table_entity entity(partition_key, get_string((utility::char_t)('a' + row), (utility::char_t)('a')));
+            entity.properties().insert(azure::storage::table_entity::property_type(_XPLATSTR("Int32"), azure::storage::entity_property(row)));
+            entity.properties().insert(azure::storage::table_entity::property_type(_XPLATSTR("Int64"), azure::storage::entity_property((int64_t)row << 40)));
+            entity.properties().insert(azure::storage::table_entity::property_type(_XPLATSTR("String"), azure::storage::entity_property(get_random_string())));
+            entity.properties().insert(azure::storage::table_entity::property_type(_XPLATSTR("Unmapped"), azure::storage::entity_property(get_random_string())));
+            operation.insert_entity(entity);
+        }
+
+        table.execute_batch(operation);
+
+        azure::storage::table_entity_mapping<mapped_test_entity> mapping;
+        mapping.map_partition_key(&mapped_test_entity::m_partition_key)
+            .map_row_key(&mapped_test_entity::m_row_key)
+            .map_etag(&mapped_test_entity::m_etag)
+            .map(_XPLATSTR("Int32"), &mapped_test_entity::m_int32)
+            .map(_XPLATSTR("Int64"), &mapped_test_entity::m_int64);
+
+        azure::storage::table_query query;
+        query.set_filter_string(azure::storage::table_query::generate_filter_condition(_XPLATSTR("PartitionKey"), azure::storage::query_comparison_operator::equal, partition_key));
+        query.set_take_count(2);
+
+        azure::storage::table_request_options options;
+        azure::storage::operation_context context;
+        print_client_request_id(context, _XPLATSTR(""));
+
+        // Both payload formats give the same objects, as the mapping provides the types that no metadata leaves out
+        for (int format = 0; format < 2; ++format)
+        {
+            options.set_payload_format(format == 0 ? azure::storage::table_payload_format::json : azure::storage::table_payload_format::json_no_metadata);
+
+            int count = 0;
+            for (azure::storage::result_iterator<mapped_test_entity> itr = table.execute_query(query, mapping, options, context); itr != azure::storage::result_iterator<mapped_test_entity>(); ++itr)
+            {
+                CHECK(itr->m_partition_key == partition_key);
+                CHECK(!itr->m_etag.empty());
+                CHECK_EQUAL(count, itr->m_int32);
+                CHECK_EQUAL((int64_t)count << 40, itr->m_int64);
+                CHECK(itr->m_string.empty());
+                ++count;
+            }
+
+            CHECK_EQUAL(5, count);
+        }
+
+        azure::storage::result_segment<mapped_test_entity> segment = table.execute_query_segmented_async(query, azure::storage::continuation_token(), mapping, options, context).get();
+        CHECK_EQUAL(2U, segment.results().size());
+        CHECK(!segment.continuation_token().empty());
+    }
+
     TEST_FIXTURE(table_service_test_base, EntityQuery_Empty)
     {
         azure::storage::cloud_table table = get_table();
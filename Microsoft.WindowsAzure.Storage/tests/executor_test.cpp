@@ -20,6 +20,10 @@
 #include "check_macros.h"
 #include "wascore/util.h"
 
+#ifndef _WIN32
+#include "cpprest/http_listener.h"
+#endif
+
 SUITE(Core)
 {
     TEST_FIXTURE(test_base, timeout)
@@ -238,5 +242,99 @@ SUITE(Core)
         // check the client is identical.
         CHECK_EQUAL(first_client, second_client);
     }
+
+    TEST_FIXTURE(test_base, http_client_pool)
+    {
+        auto uri = azure::storage::storage_uri(_XPLATSTR("http://www.nonexistenthost.com/test2")).primary_uri();
+        web::http::client::http_client_config config;
+
+        auto statistics = azure::storage::core::http_client_reusable::statistics();
+        auto first_client = azure::storage::core::http_client_reusable::get_http_client(uri, config);
+        auto second_client = azure::storage::core::http_client_reusable::get_http_client(uri, config);
+        CHECK_EQUAL(first_client, second_client);
+
+        auto new_statistics = azure::storage::core::http_client_reusable::statistics();
+        CHECK(new_statistics.creations >= statistics.creations + 1);
+        CHECK(new_statistics.hits >= statistics.hits + 1);
+        CHECK(new_statistics.cached_clients >= 1);
+
+        // Eviction is given a point in time past the idle timeout, so the test does not wait for clients to go idle.
+        auto idle_timeout = azure::storage::core::http_client_reusable::idle_timeout();
+        auto after_idle_timeout = [idle_timeout]()
+        {
+            return std::chrono::steady_clock::now() + idle_timeout + std::chrono::seconds(1);
+        };
+
+        // A client that is still in use is not evicted.
+        azure::storage::core::http_client_reusable::evict_idle_clients(after_idle_timeout());
+        CHECK_EQUAL(first_client, azure::storage::core::http_client_reusable::get_http_client(uri, config));
+
+        // Nor is a client that has not been idle for longer than the timeout.
+        first_client.reset();
+        second_client.reset();
+        azure::storage::core::http_client_reusable::evict_idle_clients();
+        auto creations = azure::storage::core::http_client_reusable::statistics().creations;
+        azure::storage::core::http_client_reusable::get_http_client(uri, config);
+        CHECK_EQUAL(creations, azure::storage::core::http_client_reusable::statistics().creations);
+
+        // An unused client is evicted once it has been idle for longer than the timeout, and is created again on the next lookup.
+        CHECK(azure::storage::core::http_client_reusable::evict_idle_clients(after_idle_timeout()) >= 1);
+        CHECK(azure::storage::core::http_client_reusable::statistics().evictions >= new_statistics.evictions + 1);
+        azure::storage::core::http_client_reusable::get_http_client(uri, config);
+        CHECK_EQUAL(creations + 1, azure::storage::core::http_client_reusable::statistics().creations);
+    }
+
+    TEST_FIXTURE(test_base, http_client_pool_max_connections_per_host)
+    {
+        // A local listener that only answers when the test tells it to, so the test controls how long each request holds its slot.
+        web::http::experimental::listener::http_listener listener(_XPLATSTR("http://127.0.0.1:34571/"));
+        std::mutex mutex;
+        std::vector<web::http::http_request> received;
+        std::vector<pplx::task_completion_event<void>> received_events(2);
+        listener.support([&mutex, &received, &received_events](web::http::http_request request)
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            received.push_back(request);
+            received_events[received.size() - 1].set();
+        });
+        listener.open().wait();
+
+        auto uri = web::uri(_XPLATSTR("http://127.0.0.1:34571/"));
+        web::http::client::http_client_config config;
+        auto statistics = azure::storage::core::http_client_reusable::statistics();
+        azure::storage::core::http_client_reusable::set_max_connections_per_host(1);
+        CHECK_EQUAL(1U, azure::storage::core::http_client_reusable::max_connections_per_host());
+
+        auto first_task = azure::storage::core::http_client_reusable::request(uri, config, web::http::http_request(web::http::methods::GET), pplx::cancellation_token::none());
+        auto second_task = azure::storage::core::http_client_reusable::request(uri, config, web::http::http_request(web::http::methods::GET), pplx::cancellation_token::none());
+
+        // While the first request is unanswered, the second one waits for the only slot.
+        pplx::create_task(received_events[0]).wait();
+        CHECK_EQUAL(statistics.waiting_requests + 1, azure::storage::core::http_client_reusable::statistics().waiting_requests);
+        web::http::http_request first_request;
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            CHECK_EQUAL(1U, received.size());
+            first_request = received[0];
+        }
+
+        first_request.reply(web::http::status_codes::OK).wait();
+
+        pplx::create_task(received_events[1]).wait();
+        CHECK_EQUAL(statistics.waiting_requests, azure::storage::core::http_client_reusable::statistics().waiting_requests);
+        web::http::http_request second_request;
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            second_request = received[1];
+        }
+
+        second_request.reply(web::http::status_codes::OK).wait();
+
+        CHECK_EQUAL(web::http::status_codes::OK, first_task.get().status_code());
+        CHECK_EQUAL(web::http::status_codes::OK, second_task.get().status_code());
+
+        azure::storage::core::http_client_reusable::set_max_connections_per_host(0);
+        listener.close().wait();
+    }
 #endif
 }
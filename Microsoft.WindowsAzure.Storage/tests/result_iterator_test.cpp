@@ -222,4 +222,79 @@ SUITE(Core)
             CHECK(*iter == (int)count);
         }
     }
+
+    TEST_FIXTURE(test_base, result_iterator_prefetch_get_results)
+    {
+        size_t test_data[][6] = {
+                /*{total_results, segment_size, return_full_segment, max_results, max_results_per_segment, num_of_results_returned}*/
+                { 0, 1000, 1, 0, 0, 0 },            // empty result
+                { 3201, 1000, 1, 0, 0, 3201 },      // many segments
+                { 100, 1000, 1, 50, 0, 50 },        // return partial results: max_results = 50
+                { 100, 1000, 1, 99, 50, 99 },       // max_results_per_segment = 50
+                { 250, 1000, 1, 500, 50, 250 },     // max_results > total_results
+                { 500, 100, 0, 400, 100, 400 },     // return_full_segment = false
+                { 500, 100, 0, 1000, 100, 500 },    // return_full_segment = false
+        };
+
+        for (size_t prefetch_depth = 1; prefetch_depth <= 3; prefetch_depth += 2)
+        {
+            for (auto& data : test_data)
+            {
+                test_result_provider provider(data[0], data[1], data[2] != 0);
+                auto generator = [&provider](const azure::storage::continuation_token &token, size_t max_results_per_segment) -> pplx::task<azure::storage::result_segment<int>>
+                {
+                    return pplx::create_task([&provider, token, max_results_per_segment]() -> azure::storage::result_segment<int>
+                    {
+                        return provider.get_next_segment(token, max_results_per_segment);
+                    });
+                };
+
+                azure::storage::result_iterator<int> iter(generator, data[3], data[4], prefetch_depth);
+                int count = 0;
+                for (auto& item : iter)
+                {
+                    count++;
+                    CHECK(item == count);
+                }
+
+                CHECK_EQUAL(data[5], (size_t)count);
+            }
+        }
+    }
+
+    TEST_FIXTURE(test_base, result_iterator_prefetch_fail_to_fetch_next_segment)
+    {
+        test_result_provider provider(1000, 200, true);
+        auto generator = [&provider](const azure::storage::continuation_token &token, size_t max_results_per_segment) -> pplx::task<azure::storage::result_segment<int>>
+        {
+            if (token.next_marker() == _XPLATSTR("600"))
+            {
+                return pplx::task_from_exception<azure::storage::result_segment<int>>(std::runtime_error("result_iterator next segment error"));
+            }
+
+            return pplx::task_from_result(provider.get_next_segment(token, max_results_per_segment));
+        };
+
+        azure::storage::result_iterator<int> end_of_results;
+        azure::storage::result_iterator<int> iter(generator, 0, 0, 2);
+
+        int count = 0;
+        bool failed = false;
+        try
+        {
+            for (; iter != end_of_results; ++iter)
+            {
+                count++;
+                CHECK(*iter == (int)count);
+            }
+        }
+        catch (std::runtime_error&)
+        {
+            failed = true;
+        }
+
+        // the segments before the failed request are still enumerated
+        CHECK(failed);
+        CHECK_EQUAL(600, count);
+    }
 }
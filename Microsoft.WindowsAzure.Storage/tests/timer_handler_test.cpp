@@ -71,4 +71,111 @@ SUITE(Core)
 
         CHECK_EQUAL("", exception_msg);
     }
+
+    TEST_FIXTURE(test_base, timer_handler_timeout_test)
+    {
+        azure::storage::core::timer_handler handler(pplx::cancellation_token::none());
+        auto start = std::chrono::steady_clock::now();
+        handler.start_timer(std::chrono::milliseconds(60000));
+
+        // Starting the timer again replaces the first deadline.
+        handler.start_timer(std::chrono::milliseconds(50));
+
+        while (!handler.is_canceled() && std::chrono::steady_clock::now() - start < std::chrono::seconds(10))
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+
+        CHECK(handler.is_canceled());
+        CHECK(handler.is_canceled_by_timeout());
+        CHECK(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(50));
+    }
+
+    TEST_FIXTURE(test_base, timer_handler_restart_test)
+    {
+        // A retry restarts the timer, so the deadline of the earlier attempt no longer applies.
+        azure::storage::core::timer_handler handler(pplx::cancellation_token::none());
+        handler.start_timer(std::chrono::milliseconds(50));
+        handler.start_timer(std::chrono::milliseconds(60000));
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+        CHECK(!handler.is_canceled());
+        CHECK(!handler.is_canceled_by_timeout());
+        handler.stop_timer();
+    }
+
+    TEST_FIXTURE(test_base, timer_handler_cascaded_timeout_test)
+    {
+        // These deadlines start in the second and third levels of the wheel and are cascaded down before they fire.
+        const std::chrono::milliseconds timeouts[] = { std::chrono::milliseconds(150), std::chrono::milliseconds(4200) };
+        azure::storage::core::timer_handler short_handler(pplx::cancellation_token::none());
+        azure::storage::core::timer_handler long_handler(pplx::cancellation_token::none());
+        azure::storage::core::timer_handler* handlers[] = { &short_handler, &long_handler };
+
+        auto start = std::chrono::steady_clock::now();
+        short_handler.start_timer(timeouts[0]);
+        long_handler.start_timer(timeouts[1]);
+
+        for (int i = 0; i < 2; ++i)
+        {
+            while (!handlers[i]->is_canceled() && std::chrono::steady_clock::now() - start < std::chrono::seconds(30))
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            }
+
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            CHECK(handlers[i]->is_canceled_by_timeout());
+            CHECK(elapsed >= timeouts[i]);
+            CHECK(elapsed < timeouts[i] + std::chrono::seconds(2));
+        }
+    }
+
+    TEST_FIXTURE(test_base, timer_handler_stop_test)
+    {
+        azure::storage::core::timer_handler handler(pplx::cancellation_token::none());
+        handler.start_timer(std::chrono::milliseconds(20));
+        handler.stop_timer();
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        CHECK(!handler.is_canceled());
+        CHECK(!handler.is_canceled_by_timeout());
+    }
+
+    TEST_FIXTURE(test_base, timer_handler_user_cancellation_test)
+    {
+        pplx::cancellation_token_source source;
+        azure::storage::core::timer_handler handler(source.get_token());
+        handler.start_timer(std::chrono::milliseconds(60000));
+        source.cancel();
+
+        CHECK(handler.is_canceled());
+        CHECK(!handler.is_canceled_by_timeout());
+    }
+
+    TEST_FIXTURE(test_base, timer_handler_many_timers_test)
+    {
+        // Handlers that are destroyed while their timers are armed or firing must not be touched by the wheel afterwards.
+        for (int round = 0; round < 20; ++round)
+        {
+            std::vector<std::unique_ptr<azure::storage::core::timer_handler>> handlers;
+            for (int i = 0; i < 1000; ++i)
+            {
+                handlers.emplace_back(new azure::storage::core::timer_handler(pplx::cancellation_token::none()));
+                handlers.back()->start_timer(std::chrono::milliseconds(i % 5));
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            handlers.clear();
+        }
+
+        azure::storage::core::timer_handler handler(pplx::cancellation_token::none());
+        auto start = std::chrono::steady_clock::now();
+        handler.start_timer(std::chrono::milliseconds(1));
+        while (!handler.is_canceled() && std::chrono::steady_clock::now() - start < std::chrono::seconds(10))
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+
+        CHECK(handler.is_canceled_by_timeout());
+    }
 }
\ No newline at end of file